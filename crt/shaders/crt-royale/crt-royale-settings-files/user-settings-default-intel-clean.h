@@ -20,6 +20,7 @@
 #define RUNTIME_PHOSPHOR_BLOOM_SIGMA
 #define RUNTIME_ANTIALIAS_WEIGHTS
 //#define RUNTIME_ANTIALIAS_SUBPIXEL_OFFSETS
+//#define ANTIALIAS_ADAPTIVE
 #define RUNTIME_SCANLINES_HORIZ_FILTER_COLORSPACE
 #define RUNTIME_GEOMETRY_TILT
 #define RUNTIME_GEOMETRY_MODE
@@ -69,6 +70,8 @@
     static const float2 aa_subpixel_r_offset_static = float2(-1.0/3.0, 0.0);//float2(0.0);
     static const float aa_cubic_c_static = 0.5;                 //  range [0, 4]
     static const float aa_gauss_sigma_static = 0.5;             //  range [0.0625, 1.0]
+    static const float aa_adaptive_quality_static = 1.0;        //  range [0.25, 4]
+    static const bool aa_adaptive_debug_static = false;
     static const float mask_type_static = 1.0;                  //  range [0, 2]
     static const float mask_sample_mode_static = 0.0;           //  range [0, 2]
     static const float mask_specify_num_triads_static = 0.0;    //  range [0, 1]
@@ -82,6 +82,10 @@
 #define RUNTIME_ANTIALIAS_WEIGHTS
 //  Specify subpixel offsets at runtime? (WARNING: EXTREMELY EXPENSIVE!)
 //#define RUNTIME_ANTIALIAS_SUBPIXEL_OFFSETS
+//  Pick the AA sample pattern per pixel, from 4x up to aa_level, based on the
+//  curvature and local contrast?  (Needs aa_level >= 8; see tex2Dantialias.h)
+//  crt-royale-adaptive-aa.slangp enables it for its last pass alone.
+//#define ANTIALIAS_ADAPTIVE
 //  Make beam_horiz_filter and beam_horiz_linear_rgb_weight into runtime shader
 //  parameters?  This will require more math or dynamic branching.
 #define RUNTIME_SCANLINES_HORIZ_FILTER_COLORSPACE
@@ -255,6 +259,10 @@
     static const float aa_cubic_c_static = 0.5;             //  range [0, 4]
     //  Standard deviation for Gaussian antialiasing: Try 0.5/aa_pixel_diameter.
     static const float aa_gauss_sigma_static = 0.5;     //  range [0.0625, 1.0]
+    //  Adaptive AA: Samples per texel of filter footprint (higher is smoother
+    //  and slower), and show a heatmap of the pattern picked for each pixel?
+    static const float aa_adaptive_quality_static = 1.0;    //  range [0.25, 4]
+    static const bool aa_adaptive_debug_static = false;
 
 //  PHOSPHOR MASK:
     //  Mask type: 0 = aperture grille, 1 = slot mask, 2 = EDP shadow mask
@@ -56,6 +56,10 @@ layout(std140, set = 0, binding = 0) uniform UBO
 	float aa_subpixel_r_offset_y_runtime;
 	float aa_cubic_c;
 	float aa_gauss_sigma;
+#ifdef RUNTIME_ANTIALIAS_ADAPTIVE
+	float aa_adaptive_quality;
+	float aa_adaptive_debug;
+#endif
 	float geom_mode_runtime;
 	float geom_radius;
 	float geom_view_dist;
@@ -96,6 +100,12 @@ static const float gba_gamma = 3.5; //  Irrelevant but necessary to define.
         static const float aa_cubic_c = aa_cubic_c_static;                              //  Clamp to [0, 4]?
         static const float aa_gauss_sigma = max(FIX_ZERO(0.0), aa_gauss_sigma_static);  //  Clamp to [FIXZERO(0), 1]?
     #endif
+    #ifdef ANTIALIAS_ADAPTIVE
+    #ifndef RUNTIME_ANTIALIAS_ADAPTIVE
+        static const float aa_adaptive_quality = clamp(aa_adaptive_quality_static, 0.25, 4.0);
+        static const float aa_adaptive_debug = float(aa_adaptive_debug_static);
+    #endif
+    #endif
 #else
 	#define HARDCODE_SETTINGS
 #endif
@@ -135,6 +145,10 @@ static const float gba_gamma = 3.5; //  Irrelevant but necessary to define.
     static const float aa_subpixel_r_offset_y_runtime = clamp(aa_subpixel_r_offset_static.y, -0.5, 0.5);
     static const float aa_cubic_c = aa_cubic_c_static;                              //  Clamp to [0, 4]?
     static const float aa_gauss_sigma = max(FIX_ZERO(0.0), aa_gauss_sigma_static);  //  Clamp to [FIXZERO(0), 1]?
+    #ifdef ANTIALIAS_ADAPTIVE
+        static const float aa_adaptive_quality = clamp(aa_adaptive_quality_static, 0.25, 4.0);
+        static const float aa_adaptive_debug = float(aa_adaptive_debug_static);
+    #endif
     static const float geom_mode_runtime = clamp(geom_mode_static, 0.0, 3.0);
     static const float geom_radius = max(1.0/(2.0*pi), geom_radius_static);         //  Clamp to [1/(2*pi), 1024]?
     static const float geom_view_dist = max(0.5, geom_view_dist_static);            //  Clamp to [0.5, 1024]?
@@ -206,6 +220,13 @@ static const float gba_gamma = 3.5; //  Irrelevant but necessary to define.
 #define aa_cubic_c global.aa_cubic_c
 #pragma parameter aa_gauss_sigma "AA - Gaussian Sigma" 0.5 0.0625 1.0 0.015625
 #define aa_gauss_sigma global.aa_gauss_sigma
+//  #pragma parameter is read as text regardless of #ifdef, so the adaptive AA
+//  parameters are declared by the one pass that reads them, in
+//  crt-royale-geometry-aa-last-pass-adaptive.slang.
+#ifdef RUNTIME_ANTIALIAS_ADAPTIVE
+#define aa_adaptive_quality global.aa_adaptive_quality
+#define aa_adaptive_debug global.aa_adaptive_debug
+#endif
 #pragma parameter geom_mode_runtime "Geometry - Mode" 0.0 0.0 3.0 1.0
 #define geom_mode_runtime global.geom_mode_runtime
 #pragma parameter geom_radius "Geometry - Radius" 2.0 0.16 1024.0 0.1
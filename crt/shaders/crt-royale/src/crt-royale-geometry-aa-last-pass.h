@@ -25,10 +25,24 @@ layout(push_constant) uniform Push
 	vec4 MASKED_SCANLINESSize;
 	vec4 HALATION_BLURSize;
 	vec4 BRIGHTPASSSize;
+	vec4 FinalViewportSize;
 } params;
 
 /////////////////////////////  SETTINGS MANAGEMENT  ////////////////////////////
 
+//  This file also builds the passes of crt-royale-warp-map.slangp:
+//  1.) GEOMETRY_WARP_MAP_PASS: Write the curved video_uv and tangent matrix
+//      to an R32G32B32A32_UINT warp map at a quarter of the viewport size,
+//      and copy last frame's map instead whenever the key from
+//      crt-royale-geometry-warp-key.slang hasn't changed.  The tangent
+//      matrix is still per viewport pixel, so geometry_output_size is the
+//      final viewport size here.  LAST_PASS stays defined so derivatives get
+//      the last pass's +y direction.
+//  2.) GEOMETRY_WARP_MAP_INPUT: Interpolate both from that map instead of
+//      ray-casting the CRT for every pixel; see get_warp_map_video_uv.
+//      Source is the map then, so the image comes in through the
+//      RECONSTITUTED alias.  The last pass is viewport-sized, so
+//      IN.video_size still describes the image.
 #define LAST_PASS
 #define SIMULATE_CRT_ON_LCD
 #include "../../../../include/compat_macros.inc"
@@ -36,6 +50,12 @@ layout(push_constant) uniform Push
 #include "derived-settings-and-constants.h"
 #include "bind-shader-params.h"
 
+#ifdef GEOMETRY_WARP_MAP_PASS
+    #define geometry_output_size IN.FinalViewportSize.xy
+#else
+    #define geometry_output_size IN.output_size
+#endif
+
 #ifndef RUNTIME_GEOMETRY_TILT
     //  Create a local-to-global rotation matrix for the CRT's coordinate frame
     //  and its global-to-local inverse.  See the vertex shader for details.
@@ -87,10 +107,11 @@ void main()
    tex_uv = TexCoord;
     video_and_texture_size_inv =
         float4(1.0, 1.0, 1.0, 1.0) / float4(IN.video_size, IN.texture_size);
-    output_size_inv = float2(1.0, 1.0)/IN.output_size;
+    output_size_inv = float2(1.0, 1.0)/geometry_output_size;
 
     //  Get aspect/overscan vectors from scalar parameters (likely uniforms):
-    const float viewport_aspect_ratio = IN.output_size.x/IN.output_size.y;
+    const float viewport_aspect_ratio =
+        geometry_output_size.x/geometry_output_size.y;
     const float2 geom_aspect = get_aspect_vector(viewport_aspect_ratio);
     const float2 geom_overscan = get_geom_overscan_vector();
     geom_aspect_and_overscan = float4(geom_aspect, geom_overscan);
@@ -156,18 +177,31 @@ layout(location = 4) in vec4 geom_aspect_and_overscan;
 layout(location = 5) in vec3 global_to_local_row0;
 layout(location = 6) in vec3 global_to_local_row1;
 layout(location = 7) in vec3 global_to_local_row2;
-layout(location = 0) out vec4 FragColor;
-layout(set = 0, binding = 2) uniform sampler2D Source;
-#define input_texture Source
+#ifdef GEOMETRY_WARP_MAP_PASS
+    layout(location = 0) out uvec4 FragColor;
+    layout(set = 0, binding = 2) uniform usampler2D GEOMETRY_WARP_KEY;
+    layout(set = 0, binding = 3) uniform usampler2D GEOMETRY_WARP_KEYFeedback;
+    layout(set = 0, binding = 4) uniform usampler2D GEOMETRY_WARP_MAPFeedback;
+#else
+    layout(location = 0) out vec4 FragColor;
+    #ifdef GEOMETRY_WARP_MAP_INPUT
+        layout(set = 0, binding = 2) uniform usampler2D GEOMETRY_WARP_MAP;
+        layout(set = 0, binding = 3) uniform sampler2D RECONSTITUTED;
+        #define input_texture RECONSTITUTED
+    #else
+        layout(set = 0, binding = 2) uniform sampler2D Source;
+        #define input_texture Source
+    #endif
+#endif
 
-void main()
+float2 get_video_uv_no_geom_overscan(const float2 flat_video_uv,
+    out float2x2 pixel_to_video_uv)
 {
-    //  Localize some parameters:
+    //  Requires:   flat_video_uv is the fragment's uncurved video_uv.
+    //  Returns:    Return the curved video_uv before overscan correction,
+    //              and return a pixel-space to video_uv matrix in the out
+    //              parameter.
     const float2 geom_aspect = geom_aspect_and_overscan.xy;
-    const float2 geom_overscan = geom_aspect_and_overscan.zw;
-    const float2 video_size_inv = video_and_texture_size_inv.xy;
-    const float2 texture_size_inv = video_and_texture_size_inv.zw;
-    //const float2 output_size_inv = output_size_inv;
     #ifdef RUNTIME_GEOMETRY_TILT
         const float3x3 global_to_local = float3x3(global_to_local_row0,
             global_to_local_row1, global_to_local_row2);
@@ -179,27 +213,114 @@ void main()
     #else
         static const float geom_mode = geom_mode_static;
     #endif
-
-    //  Get flat and curved texture coords for the current fragment point sample
-    //  and a pixel_to_tangent_video_uv matrix for transforming pixel offsets:
-    //  video_uv = relative position in video frame, mapped to [0.0, 1.0] range
-    //  tex_uv = relative position in padded texture, mapped to [0.0, 1.0] range
-    const float2 flat_video_uv = tex_uv * (IN.texture_size * video_size_inv);
-    float2x2 pixel_to_video_uv;
-    float2 video_uv_no_geom_overscan;
     if(geom_mode > 0.5)
     {
-        video_uv_no_geom_overscan =
-            get_curved_video_uv_coords_and_tangent_matrix(flat_video_uv,
-                eye_pos_local, output_size_inv, geom_aspect,
-                geom_mode, global_to_local, pixel_to_video_uv);
+        return get_curved_video_uv_coords_and_tangent_matrix(flat_video_uv,
+            eye_pos_local, output_size_inv, geom_aspect,
+            geom_mode, global_to_local, pixel_to_video_uv);
     }
     else
     {
-        video_uv_no_geom_overscan = flat_video_uv;
         pixel_to_video_uv = float2x2(
             output_size_inv.x, 0.0, 0.0, output_size_inv.y);
+        return flat_video_uv;
+    }
+}
+
+#ifdef GEOMETRY_WARP_MAP_INPUT
+
+float2 get_warp_map_video_uv(out float2x2 pixel_to_video_uv)
+{
+    //  Requires:   GEOMETRY_WARP_MAP holds at least 2x2 texels written by
+    //              encode_geometry_warp at their own centers.
+    //  Returns:    Return the curved video_uv before overscan correction at
+    //              tex_uv, and return a pixel-space to video_uv matrix in the
+    //              out parameter, both bilinearly interpolated from the map.
+    //              Integer textures can't be filtered, so blend 4 texels by
+    //              hand.  The warp is smooth, so a quarter-size map is off by
+    //              a tiny fraction of a pixel, and extrapolating past the
+    //              outer texel centers keeps the flat mapping exact.
+    const ivec2 map_size = textureSize(GEOMETRY_WARP_MAP, 0);
+    const float2 map_pos = tex_uv * float2(map_size) - float2(0.5);
+    const ivec2 p0 =
+        clamp(ivec2(floor(map_pos)), ivec2(0), map_size - ivec2(2));
+    const ivec2 p1 = p0 + ivec2(1);
+    const float2 weight = map_pos - float2(p0);
+    float2x2 m00, m10, m01, m11;
+    const float2 uv00 = decode_geometry_warp(
+        texelFetch(GEOMETRY_WARP_MAP, p0, 0), m00);
+    const float2 uv10 = decode_geometry_warp(
+        texelFetch(GEOMETRY_WARP_MAP, ivec2(p1.x, p0.y), 0), m10);
+    const float2 uv01 = decode_geometry_warp(
+        texelFetch(GEOMETRY_WARP_MAP, ivec2(p0.x, p1.y), 0), m01);
+    const float2 uv11 = decode_geometry_warp(
+        texelFetch(GEOMETRY_WARP_MAP, p1, 0), m11);
+    pixel_to_video_uv =
+        (m00 * (1.0 - weight.x) + m10 * weight.x) * (1.0 - weight.y) +
+        (m01 * (1.0 - weight.x) + m11 * weight.x) * weight.y;
+    return lerp(lerp(uv00, uv10, weight.x), lerp(uv01, uv11, weight.x),
+        weight.y);
+}
+
+#endif  //  GEOMETRY_WARP_MAP_INPUT
+
+#ifdef GEOMETRY_WARP_MAP_PASS
+
+void main()
+{
+    //  The map only changes with the geometry parameters or the viewport
+    //  size, so ray-cast the CRT only on frames where the key says one of
+    //  them changed.  The key is the same for every fragment, so the branch
+    //  is uniform.  The first frame always misses, because the key is
+    //  never 0 and last frame's key starts out cleared.
+    const ivec2 pixel = ivec2(tex_uv * IN.output_size);
+    const uint key = texelFetch(GEOMETRY_WARP_KEY, ivec2(0, 0), 0).r;
+    const uint last_key = texelFetch(GEOMETRY_WARP_KEYFeedback, ivec2(0, 0), 0).r;
+    if(key == last_key)
+    {
+        FragColor = texelFetch(GEOMETRY_WARP_MAPFeedback, pixel, 0);
     }
+    else
+    {
+        const float2 video_size_inv = video_and_texture_size_inv.xy;
+        const float2 flat_video_uv = tex_uv * (IN.texture_size * video_size_inv);
+        float2x2 pixel_to_video_uv;
+        const float2 video_uv_no_geom_overscan =
+            get_video_uv_no_geom_overscan(flat_video_uv, pixel_to_video_uv);
+        FragColor = encode_geometry_warp(
+            video_uv_no_geom_overscan, pixel_to_video_uv);
+    }
+}
+
+#else
+
+void main()
+{
+    //  Localize some parameters:
+    const float2 geom_aspect = geom_aspect_and_overscan.xy;
+    const float2 geom_overscan = geom_aspect_and_overscan.zw;
+    const float2 video_size_inv = video_and_texture_size_inv.xy;
+    const float2 texture_size_inv = video_and_texture_size_inv.zw;
+    //const float2 output_size_inv = output_size_inv;
+    #ifdef RUNTIME_GEOMETRY_MODE
+        const float geom_mode = geom_mode_runtime;
+    #else
+        static const float geom_mode = geom_mode_static;
+    #endif
+
+    //  Get flat and curved texture coords for the current fragment point sample
+    //  and a pixel_to_tangent_video_uv matrix for transforming pixel offsets:
+    //  video_uv = relative position in video frame, mapped to [0.0, 1.0] range
+    //  tex_uv = relative position in padded texture, mapped to [0.0, 1.0] range
+    float2x2 pixel_to_video_uv;
+    #ifdef GEOMETRY_WARP_MAP_INPUT
+        const float2 video_uv_no_geom_overscan =
+            get_warp_map_video_uv(pixel_to_video_uv);
+    #else
+        const float2 flat_video_uv = tex_uv * (IN.texture_size * video_size_inv);
+        const float2 video_uv_no_geom_overscan =
+            get_video_uv_no_geom_overscan(flat_video_uv, pixel_to_video_uv);
+    #endif
     //  Correct for overscan here (not in curvature code):
     const float2 video_uv =
         (video_uv_no_geom_overscan - float2(0.5, 0.5))/geom_overscan + float2(0.5, 0.5);
@@ -242,3 +363,5 @@ void main()
 
     FragColor = encode_output(float4(final_color, 1.0));
 }
+
+#endif  //  GEOMETRY_WARP_MAP_PASS
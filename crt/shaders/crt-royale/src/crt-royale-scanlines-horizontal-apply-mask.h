@@ -36,6 +36,9 @@ layout(push_constant) uniform Push
 #define HALATION_BLURtexture HALATION_BLUR
 #define HALATION_BLURtexture_size params.HALATION_BLURSize.xy
 #define HALATION_BLURvideo_size params.HALATION_BLURSize.xy
+//  With PHOSPHOR_MASK_ATLAS, crt-royale-mask-atlas.slangp loads the pre-
+//  resized mask atlas as a LUT named MASK_RESIZE instead of running the mask
+//  resize passes, so MASK_RESIZE and its size describe the atlas.
 #ifdef INTEGRATED_GRAPHICS_COMPATIBILITY_MODE
 	#define MASK_RESIZEtexture Source
 #else
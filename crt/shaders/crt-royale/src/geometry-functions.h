@@ -662,6 +662,56 @@ float2 get_curved_video_uv_coords_and_tangent_matrix(
     return video_uv;
 }
 
+uint get_geometry_warp_key(const float2 viewport_size)
+{
+    //  Requires:   viewport_size is the final pass's output size.
+    //  Returns:    Return a nonzero hash of everything the output of
+    //              get_curved_video_uv_coords_and_tangent_matrix depends on
+    //              besides flat_video_uv: the geometry parameters and the
+    //              viewport size.  crt-royale-geometry-warp-map.slang
+    //              compares this frame's key to last frame's to decide if
+    //              it can reuse its last output.  Overscan is left out on
+    //              purpose, since the last pass applies it after the lookup.
+    const float inputs[9] = float[](geom_mode_runtime, geom_radius,
+        geom_view_dist, geom_tilt_angle_x, geom_tilt_angle_y,
+        geom_aspect_ratio_x, geom_aspect_ratio_y,
+        viewport_size.x, viewport_size.y);
+    //  FNV-1a over the raw bits, a word at a time:
+    uint key = 2166136261u;
+    for(int i = 0; i < 9; ++i)
+    {
+        key = (key ^ floatBitsToUint(inputs[i])) * 16777619u;
+    }
+    //  Feedback textures start out cleared, so keep 0 for "no map yet":
+    return key | 1u;
+}
+
+uvec4 encode_geometry_warp(const float2 video_uv,
+    const float2x2 pixel_to_video_uv)
+{
+    //  Requires:   video_uv and pixel_to_video_uv are the results of
+    //              get_curved_video_uv_coords_and_tangent_matrix.
+    //  Returns:    Pack them into one R32G32B32A32_UINT texel: video_uv at
+    //              full precision (16-bit floats would be off by up to a
+    //              pixel at 4K), and the matrix columns as half floats.
+    //              The matrix only sizes and orients the antialiasing
+    //              footprint, so 11 bits of mantissa are plenty.
+    return uvec4(floatBitsToUint(video_uv),
+        packHalf2x16(pixel_to_video_uv[0]),
+        packHalf2x16(pixel_to_video_uv[1]));
+}
+
+float2 decode_geometry_warp(const uvec4 warp,
+    out float2x2 pixel_to_video_uv)
+{
+    //  Requires:   warp was written by encode_geometry_warp.
+    //  Returns:    Return video_uv, and return pixel_to_video_uv in the out
+    //              parameter.
+    pixel_to_video_uv = float2x2(unpackHalf2x16(warp.z),
+        unpackHalf2x16(warp.w));
+    return uintBitsToFloat(warp.xy);
+}
+
 float get_border_dim_factor(const float2 video_uv, const float2 geom_aspect)
 {
     //  COPYRIGHT NOTE FOR THIS FUNCTION:
@@ -56,6 +56,21 @@ static const float max_sinc_resize_samples_float = 2.0 * mask_sinc_lobes *
 static const float max_sinc_resize_samples_m4 = ceil(
     max_sinc_resize_samples_float * 0.25) * 4.0;
 
+#ifdef PHOSPHOR_MASK_ATLAS
+    //  PHOSPHOR_MASK_ATLAS samples TileableLinearMaskAtlas.png, which holds
+    //  the mask LUT's pre-resized to every tile size the mask resize passes
+    //  can produce, instead of their output.  The atlas has one band of rows
+    //  per mask type (grille, slot, shadow), each band holds the tiles from
+    //  the smallest size to the largest left to right, and every tile has a
+    //  border of wrapped texels.  tools/slang-maskatlas.py bakes it from the
+    //  settings above and updates this block to match:
+// BEGIN MASK ATLAS LAYOUT: generated by tools/slang-maskatlas.py
+static const float mask_atlas_min_tile_size = 16.0;
+static const float mask_atlas_max_tile_size = 64.0;
+static const float mask_atlas_border_texels = 2.0;
+// END MASK ATLAS LAYOUT
+#endif
+
 
 /////////////////////////  RESAMPLING FUNCTION HELPERS  ////////////////////////
 
@@ -530,6 +545,30 @@ float2 get_resized_mask_tile_size(const float2 estimated_viewport_size,
     return final_resized_tile_size;
 }
 
+uint get_mask_resize_key(const float2 viewport_size)
+{
+    //  Requires:   viewport_size is the final pass's output size.
+    //  Returns:    Return a nonzero hash of everything MASK_RESIZE depends on
+    //              besides the mask LUT's themselves: the mask parameters
+    //              get_resized_mask_tile_size reads, the mask type and the
+    //              viewport size (the mask resize passes are viewport-scaled).
+    //              The mask resize passes of crt-royale-cached-mask.slangp
+    //              compare this frame's key to last frame's to decide if
+    //              they can reuse MASK_RESIZE from last frame.
+    const float inputs[9] = float[](mask_type, get_mask_sample_mode(),
+        global.mask_specify_num_triads, global.mask_triad_size_desired,
+        global.mask_num_triads_desired, geom_aspect_ratio_x,
+        geom_aspect_ratio_y, viewport_size.x, viewport_size.y);
+    //  FNV-1a over the raw bits, a word at a time:
+    uint key = 2166136261u;
+    for(int i = 0; i < 9; ++i)
+    {
+        key = (key ^ floatBitsToUint(inputs[i])) * 16777619u;
+    }
+    //  Feedback textures start out cleared, so keep 0 for "no mask yet":
+    return key | 1u;
+}
+
 
 /////////////////////////  FINAL MASK SAMPLING HELPERS  ////////////////////////
 
@@ -558,19 +597,48 @@ float4 get_mask_sampling_parameters(const float2 mask_resize_texture_size,
     //  guaranteed correct in all passes...but if we lie, we'll get inconsistent
     //  sizes across passes, resulting in broken texture coordinates.)
     const float mask_sample_mode = get_mask_sample_mode();
-    const float2 mask_resize_tile_size = get_resized_mask_tile_size(
-        true_viewport_size, mask_resize_video_size, false);
+    #ifdef PHOSPHOR_MASK_ATLAS
+        //  The atlas stands in for MASK_RESIZE, so limit the tile size to what
+        //  MASK_RESIZE could hold, estimated the same way as in the brightpass:
+        const float2 mask_resize_tile_size = get_resized_mask_tile_size(
+            true_viewport_size, true_viewport_size * mask_resize_viewport_scale,
+            false);
+    #else
+        const float2 mask_resize_tile_size = get_resized_mask_tile_size(
+            true_viewport_size, mask_resize_video_size, false);
+    #endif
     if(mask_sample_mode < 0.5)
     {
-        //  Sample MASK_RESIZE: The resized tile is a fraction of the texture
-        //  size and starts at a nonzero offset to allow for border texels:
-        const float2 mask_tile_uv_size = mask_resize_tile_size /
-            mask_resize_texture_size;
-        const float2 skipped_tiles = mask_start_texels/mask_resize_tile_size;
-        const float2 mask_tile_start_uv = skipped_tiles * mask_tile_uv_size;
-        //  mask_tiles_per_screen must be based on the *true* viewport size:
-        mask_tiles_per_screen = true_viewport_size / mask_resize_tile_size;
-        return float4(mask_tile_start_uv, mask_tile_uv_size);
+        #ifdef PHOSPHOR_MASK_ATLAS
+            //  Find the tile in the atlas (see MASK ATLAS LAYOUT above).  The
+            //  tiles are square, and each tile before ours takes its size plus
+            //  two borders:
+            const float tile_size = clamp(mask_resize_tile_size.x,
+                mask_atlas_min_tile_size, mask_atlas_max_tile_size);
+            const float tiles_before = tile_size - mask_atlas_min_tile_size;
+            const float tile_x = tiles_before * (mask_atlas_min_tile_size +
+                tile_size - 1.0) * 0.5 + tiles_before *
+                2.0 * mask_atlas_border_texels + mask_atlas_border_texels;
+            const float band = mask_type < 0.5 ? 0.0 :
+                mask_type < 1.5 ? 1.0 : 2.0;
+            const float tile_y = band * (mask_atlas_max_tile_size +
+                2.0 * mask_atlas_border_texels) + mask_atlas_border_texels;
+            mask_tiles_per_screen = true_viewport_size / tile_size;
+            return float4(float2(tile_x, tile_y), float2(tile_size)) /
+                mask_resize_texture_size.xyxy;
+        #else
+            //  Sample MASK_RESIZE: The resized tile is a fraction of the
+            //  texture size and starts at a nonzero offset to allow for
+            //  border texels:
+            const float2 mask_tile_uv_size = mask_resize_tile_size /
+                mask_resize_texture_size;
+            const float2 skipped_tiles =
+                mask_start_texels/mask_resize_tile_size;
+            const float2 mask_tile_start_uv = skipped_tiles * mask_tile_uv_size;
+            //  mask_tiles_per_screen must be based on the *true* viewport size:
+            mask_tiles_per_screen = true_viewport_size / mask_resize_tile_size;
+            return float4(mask_tile_start_uv, mask_tile_uv_size);
+        #endif
     }
     else
     {
@@ -644,16 +712,23 @@ float2 convert_phosphor_tile_uv_wrap_to_tex_uv(const float2 tile_uv_wrap,
         //  First get fractional tile_uv coords.  Using frac/fmod on coords
         //  confuses anisotropic filtering; fix it as user options dictate.
         //  derived-settings-and-constants.h disables incompatible options.
-        #ifdef ANISOTROPIC_TILING_COMPAT_TILE_FLAT_TWICE
-            float2 tile_uv = frac(tile_uv_wrap * 0.5) * 2.0;
+        #ifdef PHOSPHOR_MASK_ATLAS
+            //  The atlas holds one tile of each size with a thin border, not
+            //  the extra tiles the other strategies sample, and it has no mip
+            //  levels to confuse:
+            const float2 tile_uv = frac(tile_uv_wrap);
         #else
-            float2 tile_uv = frac(tile_uv_wrap);
-        #endif
-        #ifdef ANISOTROPIC_TILING_COMPAT_FIX_DISCONTINUITIES
-            const float2 tile_uv_dx = ddx(tile_uv);
-            const float2 tile_uv_dy = ddy(tile_uv);
-            tile_uv = fix_tiling_discontinuities_normalized(tile_uv,
-                tile_uv_dx, tile_uv_dy);
+            #ifdef ANISOTROPIC_TILING_COMPAT_TILE_FLAT_TWICE
+                float2 tile_uv = frac(tile_uv_wrap * 0.5) * 2.0;
+            #else
+                float2 tile_uv = frac(tile_uv_wrap);
+            #endif
+            #ifdef ANISOTROPIC_TILING_COMPAT_FIX_DISCONTINUITIES
+                const float2 tile_uv_dx = ddx(tile_uv);
+                const float2 tile_uv_dy = ddy(tile_uv);
+                tile_uv = fix_tiling_discontinuities_normalized(tile_uv,
+                    tile_uv_dx, tile_uv_dy);
+            #endif
         #endif
         //  The tile is embedded in a padded FBO, and it may start at a
         //  nonzero offset if border texels are used to avoid artifacts:
@@ -293,6 +293,107 @@ inline float3 scanline_contrib(float3 dist, float3 color,
     }
 }
 
+float3 scanline_gaussian_integral_contrib_lut(const sampler2D lut,
+    const float3 dist, const float3 color, const float pixel_height,
+    const float sigma_range)
+{
+    //  Requires:   1.) Requirements of scanline_gaussian_integral_contrib()
+    //                  must be met.
+    //              2.) lut is include/special-functions-lut.png, loaded as
+    //                  include/special-functions.h describes.
+    //  Returns:    scanline_gaussian_integral_contrib(), reading erf() from
+    //              lut instead of evaluating it.
+    const float3 sigma = get_gaussian_sigma(color, sigma_range);
+    const float3 ph_offset = float3(pixel_height * 0.5);
+    const float3 denom_inv = 1.0/(sigma*sqrt(2.0));
+    const float3 integral_high = erf_lut(lut, (dist + ph_offset)*denom_inv);
+    const float3 integral_low = erf_lut(lut, (dist - ph_offset)*denom_inv);
+    return color * 0.5*(integral_high - integral_low)/pixel_height;
+}
+
+float3 scanline_generalized_gaussian_integral_contrib_lut(const sampler2D lut,
+    float3 dist, float3 color, float pixel_height, float sigma_range,
+    float shape_range)
+{
+    //  Requires:   1.) Requirements of
+    //                  scanline_generalized_gaussian_integral_contrib() must
+    //                  be met.
+    //              2.) lut is include/special-functions-lut.png, loaded as
+    //                  include/special-functions.h describes.
+    //  Returns:    scanline_generalized_gaussian_integral_contrib(), reading
+    //              the incomplete gamma function from lut, which needs
+    //              neither gamma(1/beta) nor its inverse.
+    const float3 alpha = sqrt(2.0) * get_gaussian_sigma(color, sigma_range);
+    const float3 beta = get_generalized_gaussian_beta(color, shape_range);
+    const float3 alpha_inv = float3(1.0)/alpha;
+    const float3 s = float3(1.0)/beta;
+    const float3 ph_offset = float3(pixel_height * 0.5);
+    const float3 dist1 = dist + ph_offset;
+    const float3 dist0 = dist - ph_offset;
+    const float3 integral_high = sign(dist1) * normalized_ligamma_lut(lut,
+        s, pow(abs(dist1)*alpha_inv, beta));
+    const float3 integral_low = sign(dist0) * normalized_ligamma_lut(lut,
+        s, pow(abs(dist0)*alpha_inv, beta));
+    return color * 0.5*(integral_high - integral_low)/pixel_height;
+}
+
+inline float3 scanline_contrib_speclut(const sampler2D lut, float3 dist,
+    float3 color, float pixel_height, const float sigma_range,
+    const float shape_range)
+{
+    //  Requires:   1.) Requirements of scanline_contrib() must be met.
+    //              2.) lut is include/special-functions-lut.png, loaded as
+    //                  include/special-functions.h describes.
+    //  Returns:    Return a scanline's light output over a given pixel as an
+    //              integral, as with beam_antialias_level 2, but with erf()
+    //              or the incomplete gamma function read from lut.  Used by
+    //              crt-royale-speclut.slangp.
+    if(beam_generalized_gaussian)
+    {
+        return scanline_generalized_gaussian_integral_contrib_lut(lut,
+            dist, color, pixel_height, sigma_range, shape_range);
+    }
+    else
+    {
+        return scanline_gaussian_integral_contrib_lut(lut,
+            dist, color, pixel_height, sigma_range);
+    }
+}
+
+//  crt-royale-scanline-beam-lut.slang renders scanline_contrib()/color for the
+//  current beam_* parameters and pixel height to a beam_lut_size R16_SFLOAT
+//  texture every frame, so crt-royale-beam-lut.slangp can replace each
+//  scanline_contrib() with three filtered fetches.  The profile is symmetric,
+//  so texel (i, j) holds distance beam_lut_max_dist * i/(beam_lut_size.x - 1)
+//  and color (j/(beam_lut_size.y - 1))**2: the beam widens with
+//  pow(color, beam_spot_power), which changes fastest near black.  With the
+//  default parameters, the bilinear error stays under 0.2/255.
+static const float2 beam_lut_size = float2(256.0, 32.0);
+//  Scanlines are up to beam_num_scanlines/2 away, plus up to 2.0 scanlines of
+//  vertical convergence offset:
+static const float beam_lut_max_dist = 0.5 * beam_num_scanlines + 2.0;
+//  scanline_contrib()/color has a finite limit at black, but we can't divide
+//  by zero, so the first row uses a tiny color instead:
+static const float beam_lut_min_color = 1.0/4096.0;
+
+float3 scanline_contrib_lut(const sampler2D beam_lut, const float3 dist,
+    const float3 color)
+{
+    //  Requires:   beam_lut must be the linearly filtered output of
+    //              crt-royale-scanline-beam-lut.slang for this frame.
+    //  Returns:    scanline_contrib() for the beam_* parameters and pixel
+    //              height beam_lut was rendered with.
+    const float2 texel_scale = (beam_lut_size - float2(1.0))/beam_lut_size;
+    const float2 texel_offset = float2(0.5)/beam_lut_size;
+    const float3 u = min(abs(dist)/beam_lut_max_dist, float3(1.0)) *
+        texel_scale.x + float3(texel_offset.x);
+    const float3 v = sqrt(saturate(color)) * texel_scale.y +
+        float3(texel_offset.y);
+    return color * float3(texture(beam_lut, float2(u.r, v.r)).r,
+        texture(beam_lut, float2(u.g, v.g)).r,
+        texture(beam_lut, float2(u.b, v.b)).r);
+}
+
 inline float3 get_raw_interpolated_color(const float3 color0,
     const float3 color1, const float3 color2, const float3 color3,
     const float4 weights)
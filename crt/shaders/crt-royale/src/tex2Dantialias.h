@@ -72,6 +72,9 @@
 //                  for compatibility with scalar runtime shader params.  Return
 //                  a float2 pixel offset in [-0.5, 0.5] for the red subpixel:
 //                      float2 get_aa_subpixel_r_offset()
+//              4.) With ANTIALIAS_ADAPTIVE (see below), adaptive AA knobs:
+//                      static const float aa_adaptive_quality = 1.0;
+//                      static const float aa_adaptive_debug = 0.0;
 //              The user may also #define ANTIALIAS_OVERRIDE_STATIC_CONSTANTS to
 //              override (all of) the following default static values.  However,
 //              the file's structure requires them to be declared static const:
@@ -108,7 +111,11 @@
 //                  pixel diameter to e.g. sqrt(2.0), which may be a better
 //                  support range for cylindrical filters (they don't
 //                  currently discard out-of-circle samples though).
-//              Finally, there are two miscellaneous options:
+//              6.) static const float aa_adaptive_min_contrast = 1.0/64.0;
+//                  With ANTIALIAS_ADAPTIVE, a 4x lookup whose samples differ
+//                  by less than this (linear RGB, at aa_adaptive_quality 1.0)
+//                  is flat enough to keep instead of a larger pattern.
+//              Finally, there are three miscellaneous options:
 //              1.) If you want to antialias a manually tiled texture, you can
 //                  #define ANTIALIAS_DISABLE_ANISOTROPIC to use tex2Dlod() to
 //                  fix incompatibilities with anisotropic filtering.  This is
@@ -117,6 +124,12 @@
 //                  RUNTIME_ANTIALIAS_WEIGHTS to evaluate cubic weights once per
 //                  fragment instead of at the usage site (which is used by
 //                  default, because it enables static evaluation).
+//              3.) #define ANTIALIAS_ADAPTIVE to let tex2Daa() pick a sample
+//                  pattern per pixel, from 4x up to aa_level, when aa_level
+//                  is 8 or more.  See tex2Daa_adaptive() for the heuristic.
+//                  aa_adaptive_quality scales the samples it asks for, and
+//                  aa_adaptive_debug > 0.5 replaces the output with a heatmap
+//                  of the pattern used: blue (4x), through green, to red (24x).
 //  Description:
 //  Each antialiased lookup follows these steps:
 //  1.) Define a sample pattern of pixel offsets in the range of [-0.5, 0.5]
@@ -169,6 +182,7 @@
     //  them to be static constants; see the descriptions above.
     static const float aa_pixel_diameter = 1.0;
     static const float aa_lanczos_lobes = 3.0;
+    static const float aa_adaptive_min_contrast = 1.0/64.0;
     static const float aa_gauss_support = 1.0 / aa_pixel_diameter;
     static const float aa_tent_support = 1.0 / aa_pixel_diameter;
     
@@ -192,6 +206,8 @@
     //  4.) C = 0.0 is a soft spline filter.
     static const float aa_cubic_c = 0.5;
     static const float aa_gauss_sigma = 0.5 / aa_pixel_diameter;
+    static const float aa_adaptive_quality = 1.0;
+    static const float aa_adaptive_debug = 0.0;
     //  Users may override the subpixel offset accessor function with their own.
     //  A function is used for compatibility with scalar runtime shader params.
     inline float2 get_aa_subpixel_r_offset()
@@ -500,6 +516,26 @@ inline float4 tex2Daa_tiled_linearize(const sampler2D samp, const float2 s)
     #endif
 }
 
+inline float4 tex2Daa_tiled_linearize(const sampler2D samp, const float2 s,
+    const float2x2 pixel_to_tex_uv)
+{
+    //  tex2Daa_adaptive() picks a sample pattern per pixel, so its taps sit
+    //  in branches that can diverge within a pixel quad, where implicit
+    //  derivatives (and the mip level) are undefined.  pixel_to_tex_uv is
+    //  the same Jacobian, so pass its columns as explicit gradients instead:
+    #ifdef ANTIALIAS_ADAPTIVE
+        #ifdef ANTIALIAS_DISABLE_ANISOTROPIC
+            return tex2Dlod_linearize(samp, float4(s, 0.0, 0.0));
+        #else
+            return decode_input(textureGrad(samp, s,
+                mul(pixel_to_tex_uv, float2(1.0, 0.0)),
+                mul(pixel_to_tex_uv, float2(0.0, 1.0))));
+        #endif
+    #else
+        return tex2Daa_tiled_linearize(samp, s);
+    #endif
+}
+
 inline float2 get_frame_sign(const float frame)
 {
     if(aa_temporal)
@@ -535,9 +571,12 @@ float3 tex2Daa_subpixel_weights_only(const sampler2D tex,
 
 //  The tex2Daa* functions compile very slowly due to all the macros and
 //  compile-time math, so only include the ones we'll actually use!
-float3 tex2Daa4x(const sampler2D tex, const float2 tex_uv,
-    const float2x2 pixel_to_tex_uv, const float frame)
+float3 tex2Daa4x_and_contrast(const sampler2D tex, const float2 tex_uv,
+    const float2x2 pixel_to_tex_uv, const float frame, out float contrast)
 {
+    //  This is tex2Daa4x, but it also returns the largest difference between
+    //  its samples in any channel, which tex2Daa_adaptive uses to detect flat
+    //  input.  Callers that ignore it compile to plain tex2Daa4x.
     //  Use an RGMS4 pattern (4-queens):
     //  . . Q .  : off =(-1.5, -1.5)/4 + (2.0, 0.0)/4
     //  Q . . .  : off =(-1.5, -1.5)/4 + (0.0, 1.0)/4
@@ -572,15 +611,27 @@ float3 tex2Daa4x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset0 = mul(true_pixel_to_tex_uv, xy_offset0 * frame_sign);
     const float2 uv_offset1 = mul(true_pixel_to_tex_uv, xy_offset1 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample_max = max(max(sample0, sample1), max(sample2, sample3));
+    const float3 sample_min = min(min(sample0, sample1), min(sample2, sample3));
+    const float3 sample_range = sample_max - sample_min;
+    contrast = max(sample_range.r, max(sample_range.g, sample_range.b));
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (w0 * sample0 + w1 * sample1 +
         w2 * sample2 + w3 * sample3);
 }
 
+float3 tex2Daa4x(const sampler2D tex, const float2 tex_uv,
+    const float2x2 pixel_to_tex_uv, const float frame)
+{
+    float contrast;
+    return tex2Daa4x_and_contrast(
+        tex, tex_uv, pixel_to_tex_uv, frame, contrast);
+}
+
 float3 tex2Daa5x(const sampler2D tex, const float2 tex_uv,
     const float2x2 pixel_to_tex_uv, const float frame)
 {
@@ -619,11 +670,11 @@ float3 tex2Daa5x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset0 = mul(true_pixel_to_tex_uv, xy_offset0 * frame_sign);
     const float2 uv_offset1 = mul(true_pixel_to_tex_uv, xy_offset1 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (w0 * sample0 + w1 * sample1 +
         w2 * sample2 + w3 * sample3 + w4 * sample4);
@@ -673,12 +724,12 @@ float3 tex2Daa6x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset1 = mul(true_pixel_to_tex_uv, xy_offset1 * frame_sign);
     const float2 uv_offset2 = mul(true_pixel_to_tex_uv, xy_offset2 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (w0 * sample0 + w1 * sample1 + w2 * sample2 +
         w3 * sample3 + w4 * sample4 + w5 * sample5);
@@ -729,13 +780,13 @@ float3 tex2Daa7x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset1 = mul(true_pixel_to_tex_uv, xy_offset1 * frame_sign);
     const float2 uv_offset2 = mul(true_pixel_to_tex_uv, xy_offset2 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -789,14 +840,14 @@ float3 tex2Daa8x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset2 = mul(true_pixel_to_tex_uv, xy_offset2 * frame_sign);
     const float2 uv_offset3 = mul(true_pixel_to_tex_uv, xy_offset3 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -864,18 +915,18 @@ float3 tex2Daa12x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset4 = mul(true_pixel_to_tex_uv, xy_offset4 * frame_sign);
     const float2 uv_offset5 = mul(true_pixel_to_tex_uv, xy_offset5 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5).rgb;
-    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4).rgb;
-    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3).rgb;
-    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -956,22 +1007,22 @@ float3 tex2Daa16x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset6 = mul(true_pixel_to_tex_uv, xy_offset6 * frame_sign);
     const float2 uv_offset7 = mul(true_pixel_to_tex_uv, xy_offset7 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset6).rgb;
-    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset7).rgb;
-    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset7).rgb;
-    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset6).rgb;
-    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5).rgb;
-    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4).rgb;
-    const float3 sample12 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3).rgb;
-    const float3 sample13 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample14 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample15 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset6, pixel_to_tex_uv).rgb;
+    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset7, pixel_to_tex_uv).rgb;
+    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset7, pixel_to_tex_uv).rgb;
+    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset6, pixel_to_tex_uv).rgb;
+    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample12 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample13 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample14 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample15 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -1065,26 +1116,26 @@ float3 tex2Daa20x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset8 = mul(true_pixel_to_tex_uv, xy_offset8 * frame_sign);
     const float2 uv_offset9 = mul(true_pixel_to_tex_uv, xy_offset9 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset6).rgb;
-    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset7).rgb;
-    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset8).rgb;
-    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset9).rgb;
-    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset9).rgb;
-    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset8).rgb;
-    const float3 sample12 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset7).rgb;
-    const float3 sample13 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset6).rgb;
-    const float3 sample14 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5).rgb;
-    const float3 sample15 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4).rgb;
-    const float3 sample16 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3).rgb;
-    const float3 sample17 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample18 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample19 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset6, pixel_to_tex_uv).rgb;
+    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset7, pixel_to_tex_uv).rgb;
+    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset8, pixel_to_tex_uv).rgb;
+    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset9, pixel_to_tex_uv).rgb;
+    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset9, pixel_to_tex_uv).rgb;
+    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset8, pixel_to_tex_uv).rgb;
+    const float3 sample12 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset7, pixel_to_tex_uv).rgb;
+    const float3 sample13 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset6, pixel_to_tex_uv).rgb;
+    const float3 sample14 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample15 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample16 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample17 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample18 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample19 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -1192,30 +1243,30 @@ float3 tex2Daa24x(const sampler2D tex, const float2 tex_uv,
     const float2 uv_offset10 = mul(true_pixel_to_tex_uv, xy_offset10 * frame_sign);
     const float2 uv_offset11 = mul(true_pixel_to_tex_uv, xy_offset11 * frame_sign);
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset6).rgb;
-    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset7).rgb;
-    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset8).rgb;
-    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset9).rgb;
-    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset10).rgb;
-    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset11).rgb;
-    const float3 sample12 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset11).rgb;
-    const float3 sample13 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset10).rgb;
-    const float3 sample14 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset9).rgb;
-    const float3 sample15 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset8).rgb;
-    const float3 sample16 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset7).rgb;
-    const float3 sample17 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset6).rgb;
-    const float3 sample18 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5).rgb;
-    const float3 sample19 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4).rgb;
-    const float3 sample20 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3).rgb;
-    const float3 sample21 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2).rgb;
-    const float3 sample22 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1).rgb;
-    const float3 sample23 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset0, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset6, pixel_to_tex_uv).rgb;
+    const float3 sample7 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset7, pixel_to_tex_uv).rgb;
+    const float3 sample8 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset8, pixel_to_tex_uv).rgb;
+    const float3 sample9 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset9, pixel_to_tex_uv).rgb;
+    const float3 sample10 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset10, pixel_to_tex_uv).rgb;
+    const float3 sample11 = tex2Daa_tiled_linearize(tex, tex_uv + uv_offset11, pixel_to_tex_uv).rgb;
+    const float3 sample12 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset11, pixel_to_tex_uv).rgb;
+    const float3 sample13 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset10, pixel_to_tex_uv).rgb;
+    const float3 sample14 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset9, pixel_to_tex_uv).rgb;
+    const float3 sample15 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset8, pixel_to_tex_uv).rgb;
+    const float3 sample16 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset7, pixel_to_tex_uv).rgb;
+    const float3 sample17 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset6, pixel_to_tex_uv).rgb;
+    const float3 sample18 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset5, pixel_to_tex_uv).rgb;
+    const float3 sample19 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset4, pixel_to_tex_uv).rgb;
+    const float3 sample20 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset3, pixel_to_tex_uv).rgb;
+    const float3 sample21 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset2, pixel_to_tex_uv).rgb;
+    const float3 sample22 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset1, pixel_to_tex_uv).rgb;
+    const float3 sample23 = tex2Daa_tiled_linearize(tex, tex_uv - uv_offset0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -1282,22 +1333,22 @@ float3 tex2Daa_debug_16x_regular(const sampler2D tex, const float2 tex_uv,
     const float2 sample8_uv = sample0_uv + uv_step_y * 2.0;
     const float2 sample12_uv = sample0_uv + uv_step_y * 3.0;
     //  Load samples, linearizing if necessary, etc.:
-    const float3 sample0 = tex2Daa_tiled_linearize(tex, sample0_uv).rgb;
-    const float3 sample1 = tex2Daa_tiled_linearize(tex, sample0_uv + uv_step_x).rgb;
-    const float3 sample2 = tex2Daa_tiled_linearize(tex, sample0_uv + uv_step_x * 2.0).rgb;
-    const float3 sample3 = tex2Daa_tiled_linearize(tex, sample0_uv + uv_step_x * 3.0).rgb;
-    const float3 sample4 = tex2Daa_tiled_linearize(tex, sample4_uv).rgb;
-    const float3 sample5 = tex2Daa_tiled_linearize(tex, sample4_uv + uv_step_x).rgb;
-    const float3 sample6 = tex2Daa_tiled_linearize(tex, sample4_uv + uv_step_x * 2.0).rgb;
-    const float3 sample7 = tex2Daa_tiled_linearize(tex, sample4_uv + uv_step_x * 3.0).rgb;
-    const float3 sample8 = tex2Daa_tiled_linearize(tex, sample8_uv).rgb;
-    const float3 sample9 = tex2Daa_tiled_linearize(tex, sample8_uv + uv_step_x).rgb;
-    const float3 sample10 = tex2Daa_tiled_linearize(tex, sample8_uv + uv_step_x * 2.0).rgb;
-    const float3 sample11 = tex2Daa_tiled_linearize(tex, sample8_uv + uv_step_x * 3.0).rgb;
-    const float3 sample12 = tex2Daa_tiled_linearize(tex, sample12_uv).rgb;
-    const float3 sample13 = tex2Daa_tiled_linearize(tex, sample12_uv + uv_step_x).rgb;
-    const float3 sample14 = tex2Daa_tiled_linearize(tex, sample12_uv + uv_step_x * 2.0).rgb;
-    const float3 sample15 = tex2Daa_tiled_linearize(tex, sample12_uv + uv_step_x * 3.0).rgb;
+    const float3 sample0 = tex2Daa_tiled_linearize(tex, sample0_uv, pixel_to_tex_uv).rgb;
+    const float3 sample1 = tex2Daa_tiled_linearize(tex, sample0_uv + uv_step_x, pixel_to_tex_uv).rgb;
+    const float3 sample2 = tex2Daa_tiled_linearize(tex, sample0_uv + uv_step_x * 2.0, pixel_to_tex_uv).rgb;
+    const float3 sample3 = tex2Daa_tiled_linearize(tex, sample0_uv + uv_step_x * 3.0, pixel_to_tex_uv).rgb;
+    const float3 sample4 = tex2Daa_tiled_linearize(tex, sample4_uv, pixel_to_tex_uv).rgb;
+    const float3 sample5 = tex2Daa_tiled_linearize(tex, sample4_uv + uv_step_x, pixel_to_tex_uv).rgb;
+    const float3 sample6 = tex2Daa_tiled_linearize(tex, sample4_uv + uv_step_x * 2.0, pixel_to_tex_uv).rgb;
+    const float3 sample7 = tex2Daa_tiled_linearize(tex, sample4_uv + uv_step_x * 3.0, pixel_to_tex_uv).rgb;
+    const float3 sample8 = tex2Daa_tiled_linearize(tex, sample8_uv, pixel_to_tex_uv).rgb;
+    const float3 sample9 = tex2Daa_tiled_linearize(tex, sample8_uv + uv_step_x, pixel_to_tex_uv).rgb;
+    const float3 sample10 = tex2Daa_tiled_linearize(tex, sample8_uv + uv_step_x * 2.0, pixel_to_tex_uv).rgb;
+    const float3 sample11 = tex2Daa_tiled_linearize(tex, sample8_uv + uv_step_x * 3.0, pixel_to_tex_uv).rgb;
+    const float3 sample12 = tex2Daa_tiled_linearize(tex, sample12_uv, pixel_to_tex_uv).rgb;
+    const float3 sample13 = tex2Daa_tiled_linearize(tex, sample12_uv + uv_step_x, pixel_to_tex_uv).rgb;
+    const float3 sample14 = tex2Daa_tiled_linearize(tex, sample12_uv + uv_step_x * 2.0, pixel_to_tex_uv).rgb;
+    const float3 sample15 = tex2Daa_tiled_linearize(tex, sample12_uv + uv_step_x * 3.0, pixel_to_tex_uv).rgb;
     //  Sum weighted samples (weight sum must equal 1.0 for each channel):
     return w_sum_inv * (
         w0 * sample0 + w1 * sample1 + w2 * sample2 + w3 * sample3 +
@@ -1358,18 +1409,131 @@ float3 tex2Daa_debug_dynamic(const sampler2D tex, const float2 tex_uv,
             const float2 sample_uv =
                 row_i_first_sample_uv + j * uv_offset_step_x;
             sum += weights[i*grid_size + j] *
-                tex2Daa_tiled_linearize(tex, sample_uv).rgb;
+                tex2Daa_tiled_linearize(tex, sample_uv, pixel_to_tex_uv).rgb;
         }
     }
     return sum * weight_sum_inv;
 }
 
 
+////////////////////////////  ADAPTIVE ANTIALIASING  ///////////////////////////
+
+#ifdef ANTIALIAS_ADAPTIVE
+
+float get_aa_adaptive_level(const sampler2D tex,
+    const float2x2 pixel_to_tex_uv)
+{
+    //  Requires:   aa_level >= 8.0
+    //  Returns:    Return the sample count (4, 8, ..., up to aa_level's) that
+    //              the footprint of pixel_to_tex_uv needs.  Every N-queens
+    //              pattern puts one sample in each of its N rows and columns,
+    //              so its samples are footprint/N apart along each axis.  Ask
+    //              for aa_adaptive_quality samples per texel the filter
+    //              support spans: Bilinear taps no more than a texel apart
+    //              miss no texel.  Where the curvature stretches the image
+    //              the footprint shrinks, and where it compresses the image
+    //              (near the edges) it grows.
+    const float2 subpixel_support_diameter =
+        get_subpixel_support_diam_and_final_axis_importance().xy;
+    const float2x2 true_pixel_to_tex_uv =
+        float2x2((pixel_to_tex_uv * aa_pixel_diameter));
+    const float2 tex_size = float2(textureSize(tex, 0));
+    const float2 support_x = float2(subpixel_support_diameter.x, 0.0);
+    const float2 support_y = float2(0.0, subpixel_support_diameter.y);
+    const float2 footprint_x = tex_size * mul(true_pixel_to_tex_uv, support_x);
+    const float2 footprint_y = tex_size * mul(true_pixel_to_tex_uv, support_y);
+    const float samples_needed = aa_adaptive_quality *
+        max(length(footprint_x), length(footprint_y));
+    //  Round up to the patterns we have, and cap at what aa_level would use:
+    const float max_level = min(floor(aa_level/4.0) * 4.0, 24.0);
+    return clamp(ceil(samples_needed/4.0) * 4.0, 4.0, max_level);
+}
+
+float3 get_aa_adaptive_heat(const float level, const float3 color)
+{
+    //  Map 4x..24x to blue..green..red over the image's luminance, so the
+    //  heatmap still shows where things are.
+    const float t = (level - 4.0)/20.0;
+    const float3 heat = float3(t, 1.0 - abs(2.0*t - 1.0), 1.0 - t);
+    const float luma = dot(color, float3(0.2126, 0.7152, 0.0722));
+    return heat * (0.25 + 0.75*saturate(luma));
+}
+
+float3 tex2Daa_adaptive(const sampler2D tex, const float2 tex_uv,
+    const float2x2 pixel_to_tex_uv, const float frame)
+{
+    //  Requires:   aa_level >= 8.0
+    //  Returns:    Return tex2Daa() with the smallest sample pattern that
+    //              resolves this pixel:
+    //              1.) Footprints needing 8 or fewer samples get 4x or 8x
+    //                  right away.  Near the center of a curved screen this
+    //                  is most pixels.
+    //              2.) Larger footprints first take a 4x lookup and keep it
+    //                  if its samples are all within aa_adaptive_min_contrast
+    //                  (flat input like borders or black bars), since more
+    //                  samples of a flat area give the same result.
+    //              3.) Otherwise they get the full pattern, so edges look
+    //                  the same as without ANTIALIAS_ADAPTIVE.  These pixels
+    //                  cost 4 taps more than before.
+    //              The choice is made per pixel, so neighbors in a pixel
+    //              quad can take different branches.  The taps therefore
+    //              sample with gradients from pixel_to_tex_uv rather than
+    //              implicit derivatives (see tex2Daa_tiled_linearize()).
+    float level = get_aa_adaptive_level(tex, pixel_to_tex_uv);
+    float3 color;
+    if(level < 4.5)
+    {
+        color = tex2Daa4x(tex, tex_uv, pixel_to_tex_uv, frame);
+    }
+    else if(level < 8.5)
+    {
+        color = tex2Daa8x(tex, tex_uv, pixel_to_tex_uv, frame);
+    }
+    else
+    {
+        float contrast;
+        color = tex2Daa4x_and_contrast(
+            tex, tex_uv, pixel_to_tex_uv, frame, contrast);
+        if(contrast * aa_adaptive_quality < aa_adaptive_min_contrast)
+        {
+            level = 4.0;
+        }
+        //  The aa_level tests are static, so they prune patterns above it:
+        else if(level < 12.5 || aa_level < 15.5)
+        {
+            color = tex2Daa12x(tex, tex_uv, pixel_to_tex_uv, frame);
+        }
+        else if(level < 16.5 || aa_level < 19.5)
+        {
+            color = tex2Daa16x(tex, tex_uv, pixel_to_tex_uv, frame);
+        }
+        else if(level < 20.5 || aa_level < 23.5)
+        {
+            color = tex2Daa20x(tex, tex_uv, pixel_to_tex_uv, frame);
+        }
+        else
+        {
+            color = tex2Daa24x(tex, tex_uv, pixel_to_tex_uv, frame);
+        }
+    }
+    return aa_adaptive_debug > 0.5 ?
+        get_aa_adaptive_heat(level, color) : color;
+}
+
+#endif  //  ANTIALIAS_ADAPTIVE
+
+
 ///////////////////////  ANTIALIASING CODEPATH SELECTION  //////////////////////
 
 inline float3 tex2Daa(const sampler2D tex, const float2 tex_uv,
     const float2x2 pixel_to_tex_uv, const float frame)
 {
+    #ifdef ANTIALIAS_ADAPTIVE
+        if(aa_level > 7.5 && aa_level < 253.5)
+        {
+            return tex2Daa_adaptive(tex, tex_uv, pixel_to_tex_uv, frame);
+        }
+    #endif
     //  Statically switch between antialiasing modes/levels:
     return (aa_level < 0.5) ? tex2D_linearize(tex, tex_uv).rgb :
         (aa_level < 3.5) ? tex2Daa_subpixel_weights_only(
@@ -0,0 +1,117 @@
+#ifndef BLUR_DUAL_FILTER_H
+#define BLUR_DUAL_FILTER_H
+
+/////////////////////////////////  DESCRIPTION  ////////////////////////////////
+
+//  This file provides a large-radius blur built from a dual filter pyramid:
+//  each down pass halves the resolution with 5 bilinear taps, and each up
+//  pass doubles it again with 8.  Every pass costs the same per output pixel
+//  however large the blur is, and all of the passes below full resolution
+//  together cost less than the final full resolution up pass.  The radius
+//  grows by 2x per pyramid level instead of per tap.
+//  Like the blurs in blur-functions.h, the blur is specified by its standard
+//  deviation in destination pixels, i.e. pixels of the level 0 (full
+//  resolution) output.  Going down and back up L levels blurs by a variance
+//  of exactly (17/18)(4^L - 1) destination pixels^2 per axis, and each up pass
+//  crossfades to its own level of the down chain so that the output is a mix
+//  of the two nearest levels with the requested variance.  That makes sigma
+//  continuous from about 1.68 (one level) to about 31.1 (five levels); larger
+//  sigmas use every level in the chain, so the preset's level count sets the
+//  largest blur.  Use tex2DblurNfast for sigmas below one level.
+//  Requires:   1.) All requirements of gamma-management.h must be satisfied!
+//              2.) filter_linearN must == "true" in your preset for every
+//                  pass, and wrap_modeN should be "clamp_to_edge".
+//              3.) The level k passes (down pass k and the up pass that
+//                  outputs level k) must be exactly 2^-k times the size of
+//                  level 0, e.g. scale_typeN = "original" with scaleN = 2^-k.
+//              4.) dxdy must contain the uv texel size of the sampled texture:
+//                      dxdy = IN.SourceSize.zw
+//              5.) The up pass of level k > 0 must read the down pass of the
+//                  same level by its alias to crossfade to it; see the passes
+//                  in blurs/dual-filter/ and blurs/dual-filter.slangp.
+
+
+////////////////////////////////  LEVEL WEIGHTS  ///////////////////////////////
+
+float get_dual_filter_level(const float sigma)
+{
+    //  Returns:    The fractional pyramid level blurring by sigma: level L
+    //              blurs by (17/18)(4^L - 1) destination pixels^2, and the
+    //              fraction is the weight of level L + 1 in a two level mix
+    //              with the variance sigma^2.  Clamped to at least 1.0.
+    const float u = sigma * sigma * (18.0/17.0) + 1.0;
+    const float level = floor(0.5 * log2(u));
+    const float level_scale = exp2(2.0 * level);
+    return max(1.0, level + (u - level_scale)/(3.0 * level_scale));
+}
+
+float get_dual_filter_mix(const float k, const float sigma)
+{
+    //  Requires:   k is the level an up pass outputs.
+    //  Returns:    How much of the upsampled coarser level (vs. level k of the
+    //              down chain) the up pass outputs: 1.0 below the mixed
+    //              levels, the mix weight at the finer one, and 0.0 above.
+    return saturate(get_dual_filter_level(sigma) - k);
+}
+
+
+//////////////////////////////  DOWN AND UP PASSES  ////////////////////////////
+
+float3 tex2Ddual_filter_down(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    //  Requires:   The output is half the size of tex in both dimensions, and
+    //              dxdy is the uv size of a texel of tex.
+    //  Returns:    A 4x4 weighted average around tex_uv: the 2x2 box under the
+    //              output pixel (weight 1/2) and the diagonal boxes one texel
+    //              away (1/8 each), all from bilinear samples on texel corners.
+    const float2 dxdy_diag = float2(dxdy.x, -dxdy.y);
+    const float3 sum = 4.0 * tex2D_linearize(tex, tex_uv).rgb +
+        tex2D_linearize(tex, tex_uv - dxdy).rgb +
+        tex2D_linearize(tex, tex_uv + dxdy).rgb +
+        tex2D_linearize(tex, tex_uv - dxdy_diag).rgb +
+        tex2D_linearize(tex, tex_uv + dxdy_diag).rgb;
+    return sum * 0.125;
+}
+
+float3 tex2Ddual_filter_up(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    //  Requires:   The output is twice the size of tex in both dimensions, and
+    //              dxdy is the uv size of a texel of tex.
+    //  Returns:    A tent-shaped average around tex_uv: bilinear samples one
+    //              texel away along each axis (weight 1/12 each) and half a
+    //              texel away along each diagonal (1/6 each).
+    const float2 dx = float2(dxdy.x, 0.0);
+    const float2 dy = float2(0.0, dxdy.y);
+    const float2 half_diag1 = 0.5 * dxdy;
+    const float2 half_diag2 = float2(half_diag1.x, -half_diag1.y);
+    const float3 sum =
+        tex2D_linearize(tex, tex_uv - dx).rgb +
+        tex2D_linearize(tex, tex_uv + dx).rgb +
+        tex2D_linearize(tex, tex_uv - dy).rgb +
+        tex2D_linearize(tex, tex_uv + dy).rgb +
+        2.0 * (tex2D_linearize(tex, tex_uv - half_diag1).rgb +
+            tex2D_linearize(tex, tex_uv + half_diag1).rgb +
+            tex2D_linearize(tex, tex_uv - half_diag2).rgb +
+            tex2D_linearize(tex, tex_uv + half_diag2).rgb);
+    return sum * (1.0/12.0);
+}
+
+float3 tex2Ddual_filter_up_mix(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const sampler2D level_tex, const float mix_weight)
+{
+    //  Requires:   As tex2Ddual_filter_up; level_tex is the down chain's
+    //              output at the same level as this pass's output, and
+    //              mix_weight = get_dual_filter_mix(level, sigma).
+    //  Returns:    The upsampled coarser level crossfaded with level_tex.
+    //              mix_weight is uniform, so the branches are coherent and
+    //              skip the taps that do not contribute.
+    if(mix_weight <= 0.0) return tex2D_linearize(level_tex, tex_uv).rgb;
+    const float3 up = tex2Ddual_filter_up(tex, tex_uv, dxdy);
+    if(mix_weight >= 1.0) return up;
+    return lerp(tex2D_linearize(level_tex, tex_uv).rgb, up, mix_weight);
+}
+
+
+#endif  //  BLUR_DUAL_FILTER_H
@@ -92,6 +92,12 @@
 //              speed hit depends on the blur: On my machine, uniforms kill over
 //              53% of the framerate with tex2Dblur12x12shared, but they only
 //              drop the framerate by about 18% with tex2Dblur11fast.
+//              tex2Dblur_table avoids that for separable blurs by reading
+//              weights computed once per frame (see its section below).
+//              4.) The including file (or an earlier included file) may
+//                  optionally #define BLUR_HALF_PRECISION to compute colors
+//                  and kernel weights in mediump (FP16 on GPUs with 16-bit
+//                  ALUs).  See HALF PRECISION below for the rules and errors.
 //  Quality and Performance Comparisons:
 //  For the purposes of the following discussion, "no sRGB" means
 //  GAMMA_ENCODE_EVERY_FBO is #defined, and "sRGB" means it isn't.
@@ -100,6 +106,12 @@
 //      well, because they're the only ones that don't exploit bilinear samples.
 //      This also means they're the only functions which can be truly gamma-
 //      correct without linear (or sRGB FBO) input, but only at 1x scale.
+//      tex2DblurNgather lifts that limit: it decodes every texel before
+//      filtering, so it stays gamma-correct at any upsizing scale, at three
+//      textureGather fetches per tap instead of one bilinear fetch.  With
+//      linear input there is nothing to fix, and it compiles to
+//      tex2DblurNresize.  That costs too much to ship as blurs/ variants, so
+//      tools/blur-variants.txt only generates them for make blur-bench.
 //  3.) One-pass shared sample blurs only have a speed advantage without sRGB.
 //      They also have some inaccuracies due to their shared-[bilinear-]sample
 //      design, which grow increasingly bothersome for smaller blurs and higher-
@@ -144,6 +156,11 @@
 //                                                  tex2Dblur31fast
 //                                                  tex2Dblur43fast
 //                                                  tex2Dblur3x3resize
+//                                                  tex2Dblur3gather
+//                                                  tex2Dblur5gather
+//                                                  tex2Dblur7gather
+//                                                  tex2Dblur9gather
+//                                                  tex2Dblur11gather
 
 
 /////////////////////////////  SETTINGS MANAGEMENT  ////////////////////////////
@@ -200,6 +217,50 @@
 #endif
 
 
+//  HALF PRECISION:
+//  BLUR_HALF_PRECISION declares samples, kernel weights, sums and the results
+//  of the blurs below mediump (RelaxedPrecision in SPIR-V), which GPUs with
+//  16-bit ALUs run at up to twice the rate.  Texture coordinates, sample
+//  offsets and the weights those are computed from stay highp, so only the
+//  color math loses precision; for the same reason the shared-sample blurs
+//  (which exchange samples through derivatives) stay highp.  It implies
+//  GAMMA_HALF_PRECISION, which must be #defined by hand if gamma-management.h
+//  is included first.  tools/slang-halfprec.py measures every blur against
+//  highp on test images; its worst errors, in 8-bit output steps with
+//  GAMMA_ENCODE_EVERY_FBO (where every tap pays a mediump pow()), are:
+//      tex2Dblur_table       0.15    tex2Dblur3fast        0.16
+//      tex2Dblur3resize      0.20    tex2Dblur3x3          0.15
+//      tex2Dblur3x3resize    0.17    tex2Dblur5fast        0.16
+//      tex2Dblur5resize      0.18    tex2Dblur5x5          0.20
+//      tex2Dblur7fast        0.19    tex2Dblur7resize      0.23
+//      tex2Dblur7x7          0.18    tex2Dblur9fast        0.16
+//      tex2Dblur9resize      0.23    tex2Dblur9x9          0.22
+//      tex2Dblur11fast       0.18    tex2Dblur11resize     0.23
+//      tex2Dblur17fast       0.19    tex2Dblur25fast       0.18
+//      tex2Dblur31fast       0.23    tex2Dblur43fast       0.24
+//      tex2Ddual_filter_down 0.15    tex2Ddual_filter_up   0.17
+//      tex2Dblur3gather      0.20    tex2Dblur5gather      0.18
+//      tex2Dblur7gather      0.23    tex2Dblur9gather      0.23
+//      tex2Dblur11gather     0.23
+//  That is under a quarter step for every blur; the other modes (a pow() on
+//  the input only, or none) measure lower.
+#ifdef BLUR_HALF_PRECISION
+    #ifndef GAMMA_HALF_PRECISION
+        #ifdef GAMMA_MANAGEMENT_H
+            #error "BLUR_HALF_PRECISION needs GAMMA_HALF_PRECISION before gamma-management.h"
+        #endif
+        #define GAMMA_HALF_PRECISION
+    #endif
+    #define blur_float mediump float
+    #define blur_float3 mediump float3
+    #define blur_float4 mediump float4
+#else
+    #define blur_float float
+    #define blur_float3 float3
+    #define blur_float4 float4
+#endif
+
+
 //////////////////////////////////  INCLUDES  //////////////////////////////////
 
 //  gamma-management.h relies on pass-specific settings to guide its behavior:
@@ -242,9 +303,40 @@ inline float get_fast_gaussian_weight_sum_inv(const float sigma)
 }
 
 
+inline blur_float3 tex2Dgather_linearize(const sampler2D tex,
+    const float2 tex_uv, const float2 tex_size, const float2 tex_size_inv)
+{
+    //  Requires:   tex_size must be textureSize(tex, 0).
+    //  Returns:    The bilinear sample at tex_uv with each texel decoded
+    //              before filtering, which is gamma-correct at any position.
+    //              Bilinear filtering decodes after filtering unless the input
+    //              is already linear (sRGB or float), in which case this falls
+    //              back to it.  Otherwise textureGather fetches one channel of
+    //              the 2x2 texel footprint per call, in the order (0, 1),
+    //              (1, 1), (1, 0), (0, 0), for three fetches per tap.
+    if(!linearize_input) return tex2D_linearize(tex, tex_uv).rgb;
+    const float2 texel = tex_uv * tex_size - float2(0.5);
+    const float2 texel_floor = floor(texel);
+    const float2 f = texel - texel_floor;
+    //  Gather between the four texel centers, so rounding can't pick another
+    //  footprint:
+    const float2 gather_uv = (texel_floor + float2(1.0)) * tex_size_inv;
+    const blur_float4 r = textureGather(tex, gather_uv, 0);
+    const blur_float4 g = textureGather(tex, gather_uv, 1);
+    const blur_float4 b = textureGather(tex, gather_uv, 2);
+    const blur_float4 weights = float4((1.0 - f.x) * f.y, f.x * f.y,
+        f.x * (1.0 - f.y), (1.0 - f.x) * (1.0 - f.y));
+    const float gamma = get_pass_input_gamma();
+    return weights.x * decode_input_pow(float3(r.x, g.x, b.x), gamma) +
+        weights.y * decode_input_pow(float3(r.y, g.y, b.y), gamma) +
+        weights.z * decode_input_pow(float3(r.z, g.z, b.z), gamma) +
+        weights.w * decode_input_pow(float3(r.w, g.w, b.w), gamma);
+}
+
+
 ////////////////////  ARBITRARILY RESIZABLE SEPARABLE BLURS  ///////////////////
 
-float3 tex2Dblur11resize(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur11resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Global requirements must be met (see file description).
@@ -253,17 +345,17 @@ float3 tex2Dblur11resize(const sampler2D tex, const float2 tex_uv,
     //  Calculate Gaussian blur kernel weights and a normalization factor for
     //  distances of 0-4, ignoring constant factors (since we're normalizing).
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
-    const float w1 = exp(-1.0 * denom_inv);
-    const float w2 = exp(-4.0 * denom_inv);
-    const float w3 = exp(-9.0 * denom_inv);
-    const float w4 = exp(-16.0 * denom_inv);
-    const float w5 = exp(-25.0 * denom_inv);
-    const float weight_sum_inv = 1.0 /
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float w3 = exp(-9.0 * denom_inv);
+    const blur_float w4 = exp(-16.0 * denom_inv);
+    const blur_float w5 = exp(-25.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 /
         (w0 + 2.0 * (w1 + w2 + w3 + w4 + w5));
     //  Statically normalize weights, sum weighted samples, and return.  Blurs are
     //  currently optimized for dynamic weights.
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w5 * tex2D_linearize(tex, tex_uv - 5.0 * dxdy).rgb;
     sum += w4 * tex2D_linearize(tex, tex_uv - 4.0 * dxdy).rgb;
     sum += w3 * tex2D_linearize(tex, tex_uv - 3.0 * dxdy).rgb;
@@ -278,7 +370,7 @@ float3 tex2Dblur11resize(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur9resize(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur9resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Global requirements must be met (see file description).
@@ -286,14 +378,14 @@ float3 tex2Dblur9resize(const sampler2D tex, const float2 tex_uv,
     //              It may be mipmapped depending on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
-    const float w1 = exp(-1.0 * denom_inv);
-    const float w2 = exp(-4.0 * denom_inv);
-    const float w3 = exp(-9.0 * denom_inv);
-    const float w4 = exp(-16.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3 + w4));
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float w3 = exp(-9.0 * denom_inv);
+    const blur_float w4 = exp(-16.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3 + w4));
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w4 * tex2D_linearize(tex, tex_uv - 4.0 * dxdy).rgb;
     sum += w3 * tex2D_linearize(tex, tex_uv - 3.0 * dxdy).rgb;
     sum += w2 * tex2D_linearize(tex, tex_uv - 2.0 * dxdy).rgb;
@@ -306,7 +398,7 @@ float3 tex2Dblur9resize(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur7resize(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur7resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Global requirements must be met (see file description).
@@ -314,13 +406,13 @@ float3 tex2Dblur7resize(const sampler2D tex, const float2 tex_uv,
     //              It may be mipmapped depending on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
-    const float w1 = exp(-1.0 * denom_inv);
-    const float w2 = exp(-4.0 * denom_inv);
-    const float w3 = exp(-9.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3));
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float w3 = exp(-9.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3));
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w3 * tex2D_linearize(tex, tex_uv - 3.0 * dxdy).rgb;
     sum += w2 * tex2D_linearize(tex, tex_uv - 2.0 * dxdy).rgb;
     sum += w1 * tex2D_linearize(tex, tex_uv - 1.0 * dxdy).rgb;
@@ -331,7 +423,7 @@ float3 tex2Dblur7resize(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur5resize(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur5resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Global requirements must be met (see file description).
@@ -339,12 +431,12 @@ float3 tex2Dblur5resize(const sampler2D tex, const float2 tex_uv,
     //              It may be mipmapped depending on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
-    const float w1 = exp(-1.0 * denom_inv);
-    const float w2 = exp(-4.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2));
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2));
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w2 * tex2D_linearize(tex, tex_uv - 2.0 * dxdy).rgb;
     sum += w1 * tex2D_linearize(tex, tex_uv - 1.0 * dxdy).rgb;
     sum += w0 * tex2D_linearize(tex, tex_uv).rgb;
@@ -353,7 +445,7 @@ float3 tex2Dblur5resize(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur3resize(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur3resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Global requirements must be met (see file description).
@@ -361,11 +453,11 @@ float3 tex2Dblur3resize(const sampler2D tex, const float2 tex_uv,
     //              It may be mipmapped depending on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
-    const float w1 = exp(-1.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * w1);
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * w1);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w1 * tex2D_linearize(tex, tex_uv - 1.0 * dxdy).rgb;
     sum += w0 * tex2D_linearize(tex, tex_uv).rgb;
     sum += w1 * tex2D_linearize(tex, tex_uv + 1.0 * dxdy).rgb;
@@ -373,9 +465,187 @@ float3 tex2Dblur3resize(const sampler2D tex, const float2 tex_uv,
 }
 
 
+//////////////////  GAMMA-CORRECT RESIZABLE SEPARABLE BLURS  ///////////////////
+
+//  tex2DblurNresize with every tap read by tex2Dgather_linearize; see 2.) in
+//  Quality and Performance Comparisons above.  textureGather reads the base
+//  level only, so these upsize arbitrarily but don't downsize well.
+
+blur_float3 tex2Dblur11gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const float sigma)
+{
+    //  Requires:   Global requirements must be met (see file description).
+    //  Returns:    A 1D 11x Gaussian blurred texture lookup using a 11-tap blur,
+    //              like tex2Dblur11resize but with gamma-correct taps at any
+    //              scale (see tex2Dgather_linearize).  It is never mipmapped.
+    //  Calculate Gaussian blur kernel weights and a normalization factor as
+    //  in tex2Dblur11resize.
+    const float denom_inv = 0.5/(sigma*sigma);
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float w3 = exp(-9.0 * denom_inv);
+    const blur_float w4 = exp(-16.0 * denom_inv);
+    const blur_float w5 = exp(-25.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3 + w4 + w5));
+    const float2 size = float2(textureSize(tex, 0));
+    const float2 size_inv = float2(1.0)/size;
+    blur_float3 sum = float3(0.0,0.0,0.0);
+    sum += w5 * tex2Dgather_linearize(tex, tex_uv - 5.0 * dxdy,
+        size, size_inv);
+    sum += w4 * tex2Dgather_linearize(tex, tex_uv - 4.0 * dxdy,
+        size, size_inv);
+    sum += w3 * tex2Dgather_linearize(tex, tex_uv - 3.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv - 2.0 * dxdy,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv - 1.0 * dxdy,
+        size, size_inv);
+    sum += w0 * tex2Dgather_linearize(tex, tex_uv,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv + 1.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv + 2.0 * dxdy,
+        size, size_inv);
+    sum += w3 * tex2Dgather_linearize(tex, tex_uv + 3.0 * dxdy,
+        size, size_inv);
+    sum += w4 * tex2Dgather_linearize(tex, tex_uv + 4.0 * dxdy,
+        size, size_inv);
+    sum += w5 * tex2Dgather_linearize(tex, tex_uv + 5.0 * dxdy,
+        size, size_inv);
+    return sum * weight_sum_inv;
+}
+
+blur_float3 tex2Dblur9gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const float sigma)
+{
+    //  Requires:   Global requirements must be met (see file description).
+    //  Returns:    A 1D 9x Gaussian blurred texture lookup using a 9-tap blur,
+    //              like tex2Dblur9resize but with gamma-correct taps at any
+    //              scale (see tex2Dgather_linearize).  It is never mipmapped.
+    //  First get the texel weights and normalization factor as above.
+    const float denom_inv = 0.5/(sigma*sigma);
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float w3 = exp(-9.0 * denom_inv);
+    const blur_float w4 = exp(-16.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3 + w4));
+    const float2 size = float2(textureSize(tex, 0));
+    const float2 size_inv = float2(1.0)/size;
+    blur_float3 sum = float3(0.0,0.0,0.0);
+    sum += w4 * tex2Dgather_linearize(tex, tex_uv - 4.0 * dxdy,
+        size, size_inv);
+    sum += w3 * tex2Dgather_linearize(tex, tex_uv - 3.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv - 2.0 * dxdy,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv - 1.0 * dxdy,
+        size, size_inv);
+    sum += w0 * tex2Dgather_linearize(tex, tex_uv,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv + 1.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv + 2.0 * dxdy,
+        size, size_inv);
+    sum += w3 * tex2Dgather_linearize(tex, tex_uv + 3.0 * dxdy,
+        size, size_inv);
+    sum += w4 * tex2Dgather_linearize(tex, tex_uv + 4.0 * dxdy,
+        size, size_inv);
+    return sum * weight_sum_inv;
+}
+
+blur_float3 tex2Dblur7gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const float sigma)
+{
+    //  Requires:   Global requirements must be met (see file description).
+    //  Returns:    A 1D 7x Gaussian blurred texture lookup using a 7-tap blur,
+    //              like tex2Dblur7resize but with gamma-correct taps at any
+    //              scale (see tex2Dgather_linearize).  It is never mipmapped.
+    //  First get the texel weights and normalization factor as above.
+    const float denom_inv = 0.5/(sigma*sigma);
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float w3 = exp(-9.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3));
+    const float2 size = float2(textureSize(tex, 0));
+    const float2 size_inv = float2(1.0)/size;
+    blur_float3 sum = float3(0.0,0.0,0.0);
+    sum += w3 * tex2Dgather_linearize(tex, tex_uv - 3.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv - 2.0 * dxdy,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv - 1.0 * dxdy,
+        size, size_inv);
+    sum += w0 * tex2Dgather_linearize(tex, tex_uv,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv + 1.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv + 2.0 * dxdy,
+        size, size_inv);
+    sum += w3 * tex2Dgather_linearize(tex, tex_uv + 3.0 * dxdy,
+        size, size_inv);
+    return sum * weight_sum_inv;
+}
+
+blur_float3 tex2Dblur5gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const float sigma)
+{
+    //  Requires:   Global requirements must be met (see file description).
+    //  Returns:    A 1D 5x Gaussian blurred texture lookup using a 5-tap blur,
+    //              like tex2Dblur5resize but with gamma-correct taps at any
+    //              scale (see tex2Dgather_linearize).  It is never mipmapped.
+    //  First get the texel weights and normalization factor as above.
+    const float denom_inv = 0.5/(sigma*sigma);
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float w2 = exp(-4.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2));
+    const float2 size = float2(textureSize(tex, 0));
+    const float2 size_inv = float2(1.0)/size;
+    blur_float3 sum = float3(0.0,0.0,0.0);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv - 2.0 * dxdy,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv - 1.0 * dxdy,
+        size, size_inv);
+    sum += w0 * tex2Dgather_linearize(tex, tex_uv,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv + 1.0 * dxdy,
+        size, size_inv);
+    sum += w2 * tex2Dgather_linearize(tex, tex_uv + 2.0 * dxdy,
+        size, size_inv);
+    return sum * weight_sum_inv;
+}
+
+blur_float3 tex2Dblur3gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const float sigma)
+{
+    //  Requires:   Global requirements must be met (see file description).
+    //  Returns:    A 1D 3x Gaussian blurred texture lookup using a 3-tap blur,
+    //              like tex2Dblur3resize but with gamma-correct taps at any
+    //              scale (see tex2Dgather_linearize).  It is never mipmapped.
+    //  First get the texel weights and normalization factor as above.
+    const float denom_inv = 0.5/(sigma*sigma);
+    const blur_float w0 = 1.0;
+    const blur_float w1 = exp(-1.0 * denom_inv);
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * w1);
+    const float2 size = float2(textureSize(tex, 0));
+    const float2 size_inv = float2(1.0)/size;
+    blur_float3 sum = float3(0.0,0.0,0.0);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv - 1.0 * dxdy,
+        size, size_inv);
+    sum += w0 * tex2Dgather_linearize(tex, tex_uv,
+        size, size_inv);
+    sum += w1 * tex2Dgather_linearize(tex, tex_uv + 1.0 * dxdy,
+        size, size_inv);
+    return sum * weight_sum_inv;
+}
+
+
 ///////////////////////////  FAST SEPARABLE BLURS  ///////////////////////////
 
-float3 tex2Dblur11fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur11fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   1.) Global requirements must be met (see file description).
@@ -392,18 +662,18 @@ float3 tex2Dblur11fast(const sampler2D tex, const float2 tex_uv,
     const float w3 = exp(-9.0 * denom_inv);
     const float w4 = exp(-16.0 * denom_inv);
     const float w5 = exp(-25.0 * denom_inv);
-    const float weight_sum_inv = 1.0 /
+    const blur_float weight_sum_inv = 1.0 /
         (w0 + 2.0 * (w1 + w2 + w3 + w4 + w5));
     //  Calculate combined weights and linear sample ratios between texel pairs.
     //  The center texel (with weight w0) is used twice, so halve its weight.
-    const float w01 = w0 * 0.5 + w1;
-    const float w23 = w2 + w3;
-    const float w45 = w4 + w5;
-    const float w01_ratio = w1/w01;
-    const float w23_ratio = w3/w23;
-    const float w45_ratio = w5/w45;
+    const blur_float w01 = w0 * 0.5 + w1;
+    const blur_float w23 = w2 + w3;
+    const blur_float w45 = w4 + w5;
+    const float w01_ratio = w1/(w0 * 0.5 + w1);
+    const float w23_ratio = w3/(w2 + w3);
+    const float w45_ratio = w5/(w4 + w5);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w45 * tex2D_linearize(tex, tex_uv - (4.0 + w45_ratio) * dxdy).rgb;
     sum += w23 * tex2D_linearize(tex, tex_uv - (2.0 + w23_ratio) * dxdy).rgb;
     sum += w01 * tex2D_linearize(tex, tex_uv - w01_ratio * dxdy).rgb;
@@ -413,7 +683,7 @@ float3 tex2Dblur11fast(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur9fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur9fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -422,19 +692,19 @@ float3 tex2Dblur9fast(const sampler2D tex, const float2 tex_uv,
     //              on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
+    const blur_float w0 = 1.0;
     const float w1 = exp(-1.0 * denom_inv);
     const float w2 = exp(-4.0 * denom_inv);
     const float w3 = exp(-9.0 * denom_inv);
     const float w4 = exp(-16.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3 + w4));
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3 + w4));
     //  Calculate combined weights and linear sample ratios between texel pairs.
-    const float w12 = w1 + w2;
-    const float w34 = w3 + w4;
-    const float w12_ratio = w2/w12;
-    const float w34_ratio = w4/w34;
+    const blur_float w12 = w1 + w2;
+    const blur_float w34 = w3 + w4;
+    const float w12_ratio = w2/(w1 + w2);
+    const float w34_ratio = w4/(w3 + w4);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w34 * tex2D_linearize(tex, tex_uv - (3.0 + w34_ratio) * dxdy).rgb;
     sum += w12 * tex2D_linearize(tex, tex_uv - (1.0 + w12_ratio) * dxdy).rgb;
     sum += w0 * tex2D_linearize(tex, tex_uv).rgb;
@@ -443,7 +713,7 @@ float3 tex2Dblur9fast(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur7fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur7fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -455,15 +725,15 @@ float3 tex2Dblur7fast(const sampler2D tex, const float2 tex_uv,
     const float w1 = exp(-1.0 * denom_inv);
     const float w2 = exp(-4.0 * denom_inv);
     const float w3 = exp(-9.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3));
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2 + w3));
     //  Calculate combined weights and linear sample ratios between texel pairs.
     //  The center texel (with weight w0) is used twice, so halve its weight.
-    const float w01 = w0 * 0.5 + w1;
-    const float w23 = w2 + w3;
-    const float w01_ratio = w1/w01;
-    const float w23_ratio = w3/w23;
+    const blur_float w01 = w0 * 0.5 + w1;
+    const blur_float w23 = w2 + w3;
+    const float w01_ratio = w1/(w0 * 0.5 + w1);
+    const float w23_ratio = w3/(w2 + w3);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w23 * tex2D_linearize(tex, tex_uv - (2.0 + w23_ratio) * dxdy).rgb;
     sum += w01 * tex2D_linearize(tex, tex_uv - w01_ratio * dxdy).rgb;
     sum += w01 * tex2D_linearize(tex, tex_uv + w01_ratio * dxdy).rgb;
@@ -471,7 +741,7 @@ float3 tex2Dblur7fast(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur5fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur5fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -480,36 +750,35 @@ float3 tex2Dblur5fast(const sampler2D tex, const float2 tex_uv,
     //              on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
+    const blur_float w0 = 1.0;
     const float w1 = exp(-1.0 * denom_inv);
     const float w2 = exp(-4.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2));
+    const blur_float weight_sum_inv = 1.0 / (w0 + 2.0 * (w1 + w2));
     //  Calculate combined weights and linear sample ratios between texel pairs.
-    const float w12 = w1 + w2;
-    const float w12_ratio = w2/w12;
+    const blur_float w12 = w1 + w2;
+    const float w12_ratio = w2/(w1 + w2);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w12 * tex2D_linearize(tex, tex_uv - (1.0 + w12_ratio) * dxdy).rgb;
     sum += w0 * tex2D_linearize(tex, tex_uv).rgb;
     sum += w12 * tex2D_linearize(tex, tex_uv + (1.0 + w12_ratio) * dxdy).rgb;
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur3fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur3fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
     //  Returns:    A 1D 3x Gaussian blurred texture lookup using 2 linear
     //              taps.  It may be mipmapped depending on settings and dxdy.
-    //  First get the texel weights and normalization factor as above.
+    //  First get the texel weights as above.  Both taps get the same weight,
+    //  so no normalization factor is needed.
     const float denom_inv = 0.5/(sigma*sigma);
     const float w0 = 1.0;
     const float w1 = exp(-1.0 * denom_inv);
-    const float weight_sum_inv = 1.0 / (w0 + 2.0 * w1);
-    //  Calculate combined weights and linear sample ratios between texel pairs.
-    //  The center texel (with weight w0) is used twice, so halve its weight.
-    const float w01 = w0 * 0.5 + w1;
-    const float w01_ratio = w1/w01;
+    //  Calculate the linear sample ratio between texel pairs.  The center
+    //  texel (with weight w0) is used twice, so halve its weight.
+    const float w01_ratio = w1/(w0 * 0.5 + w1);
     //  Weights for all samples are the same, so just average them:
     return 0.5 * (
         tex2D_linearize(tex, tex_uv - w01_ratio * dxdy).rgb +
@@ -520,7 +789,7 @@ float3 tex2Dblur3fast(const sampler2D tex, const float2 tex_uv,
 ////////////////////////////  HUGE SEPARABLE BLURS  ////////////////////////////
 
 //  Huge separable blurs come only in "fast" versions.
-float3 tex2Dblur43fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur43fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -553,33 +822,33 @@ float3 tex2Dblur43fast(const sampler2D tex, const float2 tex_uv,
     //const float weight_sum_inv = 1.0 /
     //    (w0 + 2.0 * (w1 + w2 + w3 + w4 + w5 + w6 + w7 + w8 + w9 + w10 + w11 +
     //        w12 + w13 + w14 + w15 + w16 + w17 + w18 + w19 + w20 + w21));
-    const float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
+    const blur_float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
     //  Calculate combined weights and linear sample ratios between texel pairs.
     //  The center texel (with weight w0) is used twice, so halve its weight.
-    const float w0_1 = w0 * 0.5 + w1;
-    const float w2_3 = w2 + w3;
-    const float w4_5 = w4 + w5;
-    const float w6_7 = w6 + w7;
-    const float w8_9 = w8 + w9;
-    const float w10_11 = w10 + w11;
-    const float w12_13 = w12 + w13;
-    const float w14_15 = w14 + w15;
-    const float w16_17 = w16 + w17;
-    const float w18_19 = w18 + w19;
-    const float w20_21 = w20 + w21;
-    const float w0_1_ratio = w1/w0_1;
-    const float w2_3_ratio = w3/w2_3;
-    const float w4_5_ratio = w5/w4_5;
-    const float w6_7_ratio = w7/w6_7;
-    const float w8_9_ratio = w9/w8_9;
-    const float w10_11_ratio = w11/w10_11;
-    const float w12_13_ratio = w13/w12_13;
-    const float w14_15_ratio = w15/w14_15;
-    const float w16_17_ratio = w17/w16_17;
-    const float w18_19_ratio = w19/w18_19;
-    const float w20_21_ratio = w21/w20_21;
+    const blur_float w0_1 = w0 * 0.5 + w1;
+    const blur_float w2_3 = w2 + w3;
+    const blur_float w4_5 = w4 + w5;
+    const blur_float w6_7 = w6 + w7;
+    const blur_float w8_9 = w8 + w9;
+    const blur_float w10_11 = w10 + w11;
+    const blur_float w12_13 = w12 + w13;
+    const blur_float w14_15 = w14 + w15;
+    const blur_float w16_17 = w16 + w17;
+    const blur_float w18_19 = w18 + w19;
+    const blur_float w20_21 = w20 + w21;
+    const float w0_1_ratio = w1/(w0 * 0.5 + w1);
+    const float w2_3_ratio = w3/(w2 + w3);
+    const float w4_5_ratio = w5/(w4 + w5);
+    const float w6_7_ratio = w7/(w6 + w7);
+    const float w8_9_ratio = w9/(w8 + w9);
+    const float w10_11_ratio = w11/(w10 + w11);
+    const float w12_13_ratio = w13/(w12 + w13);
+    const float w14_15_ratio = w15/(w14 + w15);
+    const float w16_17_ratio = w17/(w16 + w17);
+    const float w18_19_ratio = w19/(w18 + w19);
+    const float w20_21_ratio = w21/(w20 + w21);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w20_21 * tex2D_linearize(tex, tex_uv - (20.0 + w20_21_ratio) * dxdy).rgb;
     sum += w18_19 * tex2D_linearize(tex, tex_uv - (18.0 + w18_19_ratio) * dxdy).rgb;
     sum += w16_17 * tex2D_linearize(tex, tex_uv - (16.0 + w16_17_ratio) * dxdy).rgb;
@@ -605,7 +874,7 @@ float3 tex2Dblur43fast(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur31fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur31fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -632,27 +901,27 @@ float3 tex2Dblur31fast(const sampler2D tex, const float2 tex_uv,
     //const float weight_sum_inv = 1.0 /
     //    (w0 + 2.0 * (w1 + w2 + w3 + w4 + w5 + w6 + w7 + w8 +
     //        w9 + w10 + w11 + w12 + w13 + w14 + w15));
-    const float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
+    const blur_float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
     //  Calculate combined weights and linear sample ratios between texel pairs.
     //  The center texel (with weight w0) is used twice, so halve its weight.
-    const float w0_1 = w0 * 0.5 + w1;
-    const float w2_3 = w2 + w3;
-    const float w4_5 = w4 + w5;
-    const float w6_7 = w6 + w7;
-    const float w8_9 = w8 + w9;
-    const float w10_11 = w10 + w11;
-    const float w12_13 = w12 + w13;
-    const float w14_15 = w14 + w15;
-    const float w0_1_ratio = w1/w0_1;
-    const float w2_3_ratio = w3/w2_3;
-    const float w4_5_ratio = w5/w4_5;
-    const float w6_7_ratio = w7/w6_7;
-    const float w8_9_ratio = w9/w8_9;
-    const float w10_11_ratio = w11/w10_11;
-    const float w12_13_ratio = w13/w12_13;
-    const float w14_15_ratio = w15/w14_15;
+    const blur_float w0_1 = w0 * 0.5 + w1;
+    const blur_float w2_3 = w2 + w3;
+    const blur_float w4_5 = w4 + w5;
+    const blur_float w6_7 = w6 + w7;
+    const blur_float w8_9 = w8 + w9;
+    const blur_float w10_11 = w10 + w11;
+    const blur_float w12_13 = w12 + w13;
+    const blur_float w14_15 = w14 + w15;
+    const float w0_1_ratio = w1/(w0 * 0.5 + w1);
+    const float w2_3_ratio = w3/(w2 + w3);
+    const float w4_5_ratio = w5/(w4 + w5);
+    const float w6_7_ratio = w7/(w6 + w7);
+    const float w8_9_ratio = w9/(w8 + w9);
+    const float w10_11_ratio = w11/(w10 + w11);
+    const float w12_13_ratio = w13/(w12 + w13);
+    const float w14_15_ratio = w15/(w14 + w15);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w14_15 * tex2D_linearize(tex, tex_uv - (14.0 + w14_15_ratio) * dxdy).rgb;
     sum += w12_13 * tex2D_linearize(tex, tex_uv - (12.0 + w12_13_ratio) * dxdy).rgb;
     sum += w10_11 * tex2D_linearize(tex, tex_uv - (10.0 + w10_11_ratio) * dxdy).rgb;
@@ -672,7 +941,7 @@ float3 tex2Dblur31fast(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -681,7 +950,7 @@ float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
     //              on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
+    const blur_float w0 = 1.0;
     const float w1 = exp(-1.0 * denom_inv);
     const float w2 = exp(-4.0 * denom_inv);
     const float w3 = exp(-9.0 * denom_inv);
@@ -696,22 +965,22 @@ float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
     const float w12 = exp(-144.0 * denom_inv);
     //const float weight_sum_inv = 1.0 / (w0 + 2.0 * (
     //    w1 + w2 + w3 + w4 + w5 + w6 + w7 + w8 + w9 + w10 + w11 + w12));
-    const float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
+    const blur_float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
     //  Calculate combined weights and linear sample ratios between texel pairs.
-    const float w1_2 = w1 + w2;
-    const float w3_4 = w3 + w4;
-    const float w5_6 = w5 + w6;
-    const float w7_8 = w7 + w8;
-    const float w9_10 = w9 + w10;
-    const float w11_12 = w11 + w12;
-    const float w1_2_ratio = w2/w1_2;
-    const float w3_4_ratio = w4/w3_4;
-    const float w5_6_ratio = w6/w5_6;
-    const float w7_8_ratio = w8/w7_8;
-    const float w9_10_ratio = w10/w9_10;
-    const float w11_12_ratio = w12/w11_12;
+    const blur_float w1_2 = w1 + w2;
+    const blur_float w3_4 = w3 + w4;
+    const blur_float w5_6 = w5 + w6;
+    const blur_float w7_8 = w7 + w8;
+    const blur_float w9_10 = w9 + w10;
+    const blur_float w11_12 = w11 + w12;
+    const float w1_2_ratio = w2/(w1 + w2);
+    const float w3_4_ratio = w4/(w3 + w4);
+    const float w5_6_ratio = w6/(w5 + w6);
+    const float w7_8_ratio = w8/(w7 + w8);
+    const float w9_10_ratio = w10/(w9 + w10);
+    const float w11_12_ratio = w12/(w11 + w12);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w11_12 * tex2D_linearize(tex, tex_uv - (11.0 + w11_12_ratio) * dxdy).rgb;
     sum += w9_10 * tex2D_linearize(tex, tex_uv - (9.0 + w9_10_ratio) * dxdy).rgb;
     sum += w7_8 * tex2D_linearize(tex, tex_uv - (7.0 + w7_8_ratio) * dxdy).rgb;
@@ -728,7 +997,7 @@ float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Same as tex2Dblur11()
@@ -737,7 +1006,7 @@ float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
     //              on settings and dxdy.
     //  First get the texel weights and normalization factor as above.
     const float denom_inv = 0.5/(sigma*sigma);
-    const float w0 = 1.0;
+    const blur_float w0 = 1.0;
     const float w1 = exp(-1.0 * denom_inv);
     const float w2 = exp(-4.0 * denom_inv);
     const float w3 = exp(-9.0 * denom_inv);
@@ -748,18 +1017,18 @@ float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
     const float w8 = exp(-64.0 * denom_inv);
     //const float weight_sum_inv = 1.0 / (w0 + 2.0 * (
     //    w1 + w2 + w3 + w4 + w5 + w6 + w7 + w8));
-    const float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
+    const blur_float weight_sum_inv = get_fast_gaussian_weight_sum_inv(sigma);
     //  Calculate combined weights and linear sample ratios between texel pairs.
-    const float w1_2 = w1 + w2;
-    const float w3_4 = w3 + w4;
-    const float w5_6 = w5 + w6;
-    const float w7_8 = w7 + w8;
-    const float w1_2_ratio = w2/w1_2;
-    const float w3_4_ratio = w4/w3_4;
-    const float w5_6_ratio = w6/w5_6;
-    const float w7_8_ratio = w8/w7_8;
+    const blur_float w1_2 = w1 + w2;
+    const blur_float w3_4 = w3 + w4;
+    const blur_float w5_6 = w5 + w6;
+    const blur_float w7_8 = w7 + w8;
+    const float w1_2_ratio = w2/(w1 + w2);
+    const float w3_4_ratio = w4/(w3 + w4);
+    const float w5_6_ratio = w6/(w5 + w6);
+    const float w7_8_ratio = w8/(w7 + w8);
     //  Statically normalize weights, sum weighted samples, and return:
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w7_8 * tex2D_linearize(tex, tex_uv - (7.0 + w7_8_ratio) * dxdy).rgb;
     sum += w5_6 * tex2D_linearize(tex, tex_uv - (5.0 + w5_6_ratio) * dxdy).rgb;
     sum += w3_4 * tex2D_linearize(tex, tex_uv - (3.0 + w3_4_ratio) * dxdy).rgb;
@@ -775,7 +1044,7 @@ float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
 
 ////////////////////  ARBITRARILY RESIZABLE ONE-PASS BLURS  ////////////////////
 
-float3 tex2Dblur3x3resize(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur3x3resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Requires:   Global requirements must be met (see file description).
@@ -793,22 +1062,22 @@ float3 tex2Dblur3x3resize(const sampler2D tex, const float2 tex_uv,
     const float2 dy = float2(0.0, dxdy.y);
     const float2 sample1_uv = sample4_uv - dy;
     const float2 sample7_uv = sample4_uv + dy;
-    const float3 sample0 = tex2D_linearize(tex, sample1_uv - dx).rgb;
-    const float3 sample1 = tex2D_linearize(tex, sample1_uv).rgb;
-    const float3 sample2 = tex2D_linearize(tex, sample1_uv + dx).rgb;
-    const float3 sample3 = tex2D_linearize(tex, sample4_uv - dx).rgb;
-    const float3 sample4 = tex2D_linearize(tex, sample4_uv).rgb;
-    const float3 sample5 = tex2D_linearize(tex, sample4_uv + dx).rgb;
-    const float3 sample6 = tex2D_linearize(tex, sample7_uv - dx).rgb;
-    const float3 sample7 = tex2D_linearize(tex, sample7_uv).rgb;
-    const float3 sample8 = tex2D_linearize(tex, sample7_uv + dx).rgb;
+    const blur_float3 sample0 = tex2D_linearize(tex, sample1_uv - dx).rgb;
+    const blur_float3 sample1 = tex2D_linearize(tex, sample1_uv).rgb;
+    const blur_float3 sample2 = tex2D_linearize(tex, sample1_uv + dx).rgb;
+    const blur_float3 sample3 = tex2D_linearize(tex, sample4_uv - dx).rgb;
+    const blur_float3 sample4 = tex2D_linearize(tex, sample4_uv).rgb;
+    const blur_float3 sample5 = tex2D_linearize(tex, sample4_uv + dx).rgb;
+    const blur_float3 sample6 = tex2D_linearize(tex, sample7_uv - dx).rgb;
+    const blur_float3 sample7 = tex2D_linearize(tex, sample7_uv).rgb;
+    const blur_float3 sample8 = tex2D_linearize(tex, sample7_uv + dx).rgb;
     //  Statically compute Gaussian sample weights:
-    const float w4 = 1.0;
-    const float w1_3_5_7 = exp(-LENGTH_SQ(float2(1.0, 0.0)) * denom_inv);
-    const float w0_2_6_8 = exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
-    const float weight_sum_inv = 1.0/(w4 + 4.0 * (w1_3_5_7 + w0_2_6_8));
+    const blur_float w4 = 1.0;
+    const blur_float w1_3_5_7 = exp(-LENGTH_SQ(float2(1.0, 0.0)) * denom_inv);
+    const blur_float w0_2_6_8 = exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
+    const blur_float weight_sum_inv = 1.0/(w4 + 4.0 * (w1_3_5_7 + w0_2_6_8));
     //  Weight and sum the samples:
-    const float3 sum = w4 * sample4 +
+    const blur_float3 sum = w4 * sample4 +
         w1_3_5_7 * (sample1 + sample3 + sample5 + sample7) +
         w0_2_6_8 * (sample0 + sample2 + sample6 + sample8);
     return sum * weight_sum_inv;
@@ -817,7 +1086,7 @@ float3 tex2Dblur3x3resize(const sampler2D tex, const float2 tex_uv,
 
 ////////////////////////////  FASTER ONE-PASS BLURS  ///////////////////////////
 
-float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Perform a 1-pass 9x9 blur with 5x5 bilinear samples.
@@ -880,30 +1149,30 @@ float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
     //  CALCULATE KERNEL WEIGHTS FOR ALL SAMPLES:
     //  Statically compute Gaussian texel weights for the bottom-right quadrant.
     //  Read underscores as "and."
-    const float w1R1 = w1off;
-    const float w1R2 = w2off;
-    const float w2R1 = w3off;
-    const float w2R2 = w4off;
-    const float w3d1 =     exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
-    const float w3d2_3d3 = exp(-LENGTH_SQ(float2(2.0, 1.0)) * denom_inv);
-    const float w3d4 =     exp(-LENGTH_SQ(float2(2.0, 2.0)) * denom_inv);
-    const float w4d1_5d1 = exp(-LENGTH_SQ(float2(3.0, 1.0)) * denom_inv);
-    const float w4d2_5d3 = exp(-LENGTH_SQ(float2(4.0, 1.0)) * denom_inv);
-    const float w4d3_5d2 = exp(-LENGTH_SQ(float2(3.0, 2.0)) * denom_inv);
-    const float w4d4_5d4 = exp(-LENGTH_SQ(float2(4.0, 2.0)) * denom_inv);
-    const float w6d1 =     exp(-LENGTH_SQ(float2(3.0, 3.0)) * denom_inv);
-    const float w6d2_6d3 = exp(-LENGTH_SQ(float2(4.0, 3.0)) * denom_inv);
-    const float w6d4 =     exp(-LENGTH_SQ(float2(4.0, 4.0)) * denom_inv);
+    const blur_float w1R1 = w1off;
+    const blur_float w1R2 = w2off;
+    const blur_float w2R1 = w3off;
+    const blur_float w2R2 = w4off;
+    const blur_float w3d1 =     exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
+    const blur_float w3d2_3d3 = exp(-LENGTH_SQ(float2(2.0, 1.0)) * denom_inv);
+    const blur_float w3d4 =     exp(-LENGTH_SQ(float2(2.0, 2.0)) * denom_inv);
+    const blur_float w4d1_5d1 = exp(-LENGTH_SQ(float2(3.0, 1.0)) * denom_inv);
+    const blur_float w4d2_5d3 = exp(-LENGTH_SQ(float2(4.0, 1.0)) * denom_inv);
+    const blur_float w4d3_5d2 = exp(-LENGTH_SQ(float2(3.0, 2.0)) * denom_inv);
+    const blur_float w4d4_5d4 = exp(-LENGTH_SQ(float2(4.0, 2.0)) * denom_inv);
+    const blur_float w6d1 =     exp(-LENGTH_SQ(float2(3.0, 3.0)) * denom_inv);
+    const blur_float w6d2_6d3 = exp(-LENGTH_SQ(float2(4.0, 3.0)) * denom_inv);
+    const blur_float w6d4 =     exp(-LENGTH_SQ(float2(4.0, 4.0)) * denom_inv);
     //  Statically add texel weights in each sample to get sample weights:
-    const float w0 = 1.0;
-    const float w1 = w1R1 + w1R2;
-    const float w2 = w2R1 + w2R2;
-    const float w3 = w3d1 + 2.0 * w3d2_3d3 + w3d4;
-    const float w4 = w4d1_5d1 + w4d2_5d3 + w4d3_5d2 + w4d4_5d4;
-    const float w5 = w4;
-    const float w6 = w6d1 + 2.0 * w6d2_6d3 + w6d4;
+    const blur_float w0 = 1.0;
+    const blur_float w1 = w1R1 + w1R2;
+    const blur_float w2 = w2R1 + w2R2;
+    const blur_float w3 = w3d1 + 2.0 * w3d2_3d3 + w3d4;
+    const blur_float w4 = w4d1_5d1 + w4d2_5d3 + w4d3_5d2 + w4d4_5d4;
+    const blur_float w5 = w4;
+    const blur_float w6 = w6d1 + 2.0 * w6d2_6d3 + w6d4;
     //  Get the weight sum inverse (normalization factor):
-    const float weight_sum_inv =
+    const blur_float weight_sum_inv =
         1.0/(w0 + 4.0 * (w1 + w2 + w3 + w4 + w5 + w6));
 
     //  LOAD TEXTURE SAMPLES:
@@ -915,35 +1184,35 @@ float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy_mirror_y = dxdy * mirror_y;
     const float2 dxdy_mirror_xy = dxdy * mirror_xy;
     //  Sampling order doesn't seem to affect performance, so just be clear:
-    const float3 sample0C = tex2D_linearize(tex, tex_uv).rgb;
-    const float3 sample1R = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset).rgb;
-    const float3 sample1D = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset.yx).rgb;
-    const float3 sample1L = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset).rgb;
-    const float3 sample1U = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset.yx).rgb;
-    const float3 sample2R = tex2D_linearize(tex, tex_uv + dxdy * sample2R_texel_offset).rgb;
-    const float3 sample2D = tex2D_linearize(tex, tex_uv + dxdy * sample2R_texel_offset.yx).rgb;
-    const float3 sample2L = tex2D_linearize(tex, tex_uv - dxdy * sample2R_texel_offset).rgb;
-    const float3 sample2U = tex2D_linearize(tex, tex_uv - dxdy * sample2R_texel_offset.yx).rgb;
-    const float3 sample3d = tex2D_linearize(tex, tex_uv + dxdy * sample3d_texel_offset).rgb;
-    const float3 sample3c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample3d_texel_offset).rgb;
-    const float3 sample3b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample3d_texel_offset).rgb;
-    const float3 sample3a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample3d_texel_offset).rgb;
-    const float3 sample4d = tex2D_linearize(tex, tex_uv + dxdy * sample4d_texel_offset).rgb;
-    const float3 sample4c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample4d_texel_offset).rgb;
-    const float3 sample4b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample4d_texel_offset).rgb;
-    const float3 sample4a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample4d_texel_offset).rgb;
-    const float3 sample5d = tex2D_linearize(tex, tex_uv + dxdy * sample5d_texel_offset).rgb;
-    const float3 sample5c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample5d_texel_offset).rgb;
-    const float3 sample5b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample5d_texel_offset).rgb;
-    const float3 sample5a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample5d_texel_offset).rgb;
-    const float3 sample6d = tex2D_linearize(tex, tex_uv + dxdy * sample6d_texel_offset).rgb;
-    const float3 sample6c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample6d_texel_offset).rgb;
-    const float3 sample6b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample6d_texel_offset).rgb;
-    const float3 sample6a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample6d_texel_offset).rgb;
+    const blur_float3 sample0C = tex2D_linearize(tex, tex_uv).rgb;
+    const blur_float3 sample1R = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset).rgb;
+    const blur_float3 sample1D = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset.yx).rgb;
+    const blur_float3 sample1L = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset).rgb;
+    const blur_float3 sample1U = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset.yx).rgb;
+    const blur_float3 sample2R = tex2D_linearize(tex, tex_uv + dxdy * sample2R_texel_offset).rgb;
+    const blur_float3 sample2D = tex2D_linearize(tex, tex_uv + dxdy * sample2R_texel_offset.yx).rgb;
+    const blur_float3 sample2L = tex2D_linearize(tex, tex_uv - dxdy * sample2R_texel_offset).rgb;
+    const blur_float3 sample2U = tex2D_linearize(tex, tex_uv - dxdy * sample2R_texel_offset.yx).rgb;
+    const blur_float3 sample3d = tex2D_linearize(tex, tex_uv + dxdy * sample3d_texel_offset).rgb;
+    const blur_float3 sample3c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample3d_texel_offset).rgb;
+    const blur_float3 sample3b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample3d_texel_offset).rgb;
+    const blur_float3 sample3a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample3d_texel_offset).rgb;
+    const blur_float3 sample4d = tex2D_linearize(tex, tex_uv + dxdy * sample4d_texel_offset).rgb;
+    const blur_float3 sample4c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample4d_texel_offset).rgb;
+    const blur_float3 sample4b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample4d_texel_offset).rgb;
+    const blur_float3 sample4a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample4d_texel_offset).rgb;
+    const blur_float3 sample5d = tex2D_linearize(tex, tex_uv + dxdy * sample5d_texel_offset).rgb;
+    const blur_float3 sample5c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample5d_texel_offset).rgb;
+    const blur_float3 sample5b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample5d_texel_offset).rgb;
+    const blur_float3 sample5a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample5d_texel_offset).rgb;
+    const blur_float3 sample6d = tex2D_linearize(tex, tex_uv + dxdy * sample6d_texel_offset).rgb;
+    const blur_float3 sample6c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample6d_texel_offset).rgb;
+    const blur_float3 sample6b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample6d_texel_offset).rgb;
+    const blur_float3 sample6a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample6d_texel_offset).rgb;
 
     //  SUM WEIGHTED SAMPLES:
     //  Statically normalize weights (so total = 1.0), and sum weighted samples.
-    float3 sum = w0 * sample0C;
+    blur_float3 sum = w0 * sample0C;
     sum += w1 * (sample1R + sample1D + sample1L + sample1U);
     sum += w2 * (sample2R + sample2D + sample2L + sample2U);
     sum += w3 * (sample3d + sample3c + sample3b + sample3a);
@@ -953,7 +1222,7 @@ float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Perform a 1-pass 7x7 blur with 5x5 bilinear samples.
@@ -998,23 +1267,23 @@ float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
     //  CALCULATE KERNEL WEIGHTS FOR ALL SAMPLES:
     //  Statically compute Gaussian texel weights for the bottom-right quadrant.
     //  Read underscores as "and."
-    const float w1abcd = 1.0;
-    const float w1bd2_1cd3 = exp(-LENGTH_SQ(float2(1.0, 0.0)) * denom_inv);
-    const float w2bd1_3cd1 = exp(-LENGTH_SQ(float2(2.0, 0.0)) * denom_inv);
-    const float w2bd2_3cd2 = exp(-LENGTH_SQ(float2(3.0, 0.0)) * denom_inv);
-    const float w1d4 =       exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
-    const float w2d3_3d2 =   exp(-LENGTH_SQ(float2(2.0, 1.0)) * denom_inv);
-    const float w2d4_3d4 =   exp(-LENGTH_SQ(float2(3.0, 1.0)) * denom_inv);
-    const float w4d1 =       exp(-LENGTH_SQ(float2(2.0, 2.0)) * denom_inv);
-    const float w4d2_4d3 =   exp(-LENGTH_SQ(float2(3.0, 2.0)) * denom_inv);
-    const float w4d4 =       exp(-LENGTH_SQ(float2(3.0, 3.0)) * denom_inv);
+    const blur_float w1abcd = 1.0;
+    const blur_float w1bd2_1cd3 = exp(-LENGTH_SQ(float2(1.0, 0.0)) * denom_inv);
+    const blur_float w2bd1_3cd1 = exp(-LENGTH_SQ(float2(2.0, 0.0)) * denom_inv);
+    const blur_float w2bd2_3cd2 = exp(-LENGTH_SQ(float2(3.0, 0.0)) * denom_inv);
+    const blur_float w1d4 =       exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
+    const blur_float w2d3_3d2 =   exp(-LENGTH_SQ(float2(2.0, 1.0)) * denom_inv);
+    const blur_float w2d4_3d4 =   exp(-LENGTH_SQ(float2(3.0, 1.0)) * denom_inv);
+    const blur_float w4d1 =       exp(-LENGTH_SQ(float2(2.0, 2.0)) * denom_inv);
+    const blur_float w4d2_4d3 =   exp(-LENGTH_SQ(float2(3.0, 2.0)) * denom_inv);
+    const blur_float w4d4 =       exp(-LENGTH_SQ(float2(3.0, 3.0)) * denom_inv);
     //  Statically add texel weights in each sample to get sample weights.
     //  Split weights for shared texels between samples sharing them:
-    const float w1 = w1abcd * 0.25 + w1bd2_1cd3 + w1d4;
-    const float w2_3 = (w2bd1_3cd1 + w2bd2_3cd2) * 0.5 + w2d3_3d2 + w2d4_3d4;
-    const float w4 = w4d1 + 2.0 * w4d2_4d3 + w4d4;
+    const blur_float w1 = w1abcd * 0.25 + w1bd2_1cd3 + w1d4;
+    const blur_float w2_3 = (w2bd1_3cd1 + w2bd2_3cd2) * 0.5 + w2d3_3d2 + w2d4_3d4;
+    const blur_float w4 = w4d1 + 2.0 * w4d2_4d3 + w4d4;
     //  Get the weight sum inverse (normalization factor):
-    const float weight_sum_inv =
+    const blur_float weight_sum_inv =
         1.0/(4.0 * (w1 + 2.0 * w2_3 + w4));
 
     //  LOAD TEXTURE SAMPLES:
@@ -1025,26 +1294,26 @@ float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy_mirror_x = dxdy * mirror_x;
     const float2 dxdy_mirror_y = dxdy * mirror_y;
     const float2 dxdy_mirror_xy = dxdy * mirror_xy;
-    const float3 sample1a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample1d_texel_offset).rgb;
-    const float3 sample2a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample2d_texel_offset).rgb;
-    const float3 sample3a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample3d_texel_offset).rgb;
-    const float3 sample4a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample4d_texel_offset).rgb;
-    const float3 sample1b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample1d_texel_offset).rgb;
-    const float3 sample2b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample2d_texel_offset).rgb;
-    const float3 sample3b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample3d_texel_offset).rgb;
-    const float3 sample4b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample4d_texel_offset).rgb;
-    const float3 sample1c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample1d_texel_offset).rgb;
-    const float3 sample2c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample2d_texel_offset).rgb;
-    const float3 sample3c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample3d_texel_offset).rgb;
-    const float3 sample4c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample4d_texel_offset).rgb;
-    const float3 sample1d = tex2D_linearize(tex, tex_uv + dxdy * sample1d_texel_offset).rgb;
-    const float3 sample2d = tex2D_linearize(tex, tex_uv + dxdy * sample2d_texel_offset).rgb;
-    const float3 sample3d = tex2D_linearize(tex, tex_uv + dxdy * sample3d_texel_offset).rgb;
-    const float3 sample4d = tex2D_linearize(tex, tex_uv + dxdy * sample4d_texel_offset).rgb;
+    const blur_float3 sample1a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample1d_texel_offset).rgb;
+    const blur_float3 sample2a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample2d_texel_offset).rgb;
+    const blur_float3 sample3a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample3d_texel_offset).rgb;
+    const blur_float3 sample4a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample4d_texel_offset).rgb;
+    const blur_float3 sample1b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample1d_texel_offset).rgb;
+    const blur_float3 sample2b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample2d_texel_offset).rgb;
+    const blur_float3 sample3b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample3d_texel_offset).rgb;
+    const blur_float3 sample4b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample4d_texel_offset).rgb;
+    const blur_float3 sample1c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample1d_texel_offset).rgb;
+    const blur_float3 sample2c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample2d_texel_offset).rgb;
+    const blur_float3 sample3c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample3d_texel_offset).rgb;
+    const blur_float3 sample4c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample4d_texel_offset).rgb;
+    const blur_float3 sample1d = tex2D_linearize(tex, tex_uv + dxdy * sample1d_texel_offset).rgb;
+    const blur_float3 sample2d = tex2D_linearize(tex, tex_uv + dxdy * sample2d_texel_offset).rgb;
+    const blur_float3 sample3d = tex2D_linearize(tex, tex_uv + dxdy * sample3d_texel_offset).rgb;
+    const blur_float3 sample4d = tex2D_linearize(tex, tex_uv + dxdy * sample4d_texel_offset).rgb;
 
     //  SUM WEIGHTED SAMPLES:
     //  Statically normalize weights (so total = 1.0), and sum weighted samples.
-    float3 sum = float3(0.0,0.0,0.0);
+    blur_float3 sum = float3(0.0,0.0,0.0);
     sum += w1 * (sample1a + sample1b + sample1c + sample1d);
     sum += w2_3 * (sample2a + sample2b + sample2c + sample2d);
     sum += w2_3 * (sample3a + sample3b + sample3c + sample3d);
@@ -1052,7 +1321,7 @@ float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur5x5(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur5x5(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Perform a 1-pass 5x5 blur with 3x3 bilinear samples.
@@ -1086,17 +1355,17 @@ float3 tex2Dblur5x5(const sampler2D tex, const float2 tex_uv,
     //  CALCULATE KERNEL WEIGHTS FOR ALL SAMPLES:
     //  Statically compute Gaussian texel weights for the bottom-right quadrant.
     //  Read underscores as "and."
-    const float w1R1 = w1off;
-    const float w1R2 = w2off;
-    const float w2d1 =   exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
-    const float w2d2_3 = exp(-LENGTH_SQ(float2(2.0, 1.0)) * denom_inv);
-    const float w2d4 =   exp(-LENGTH_SQ(float2(2.0, 2.0)) * denom_inv);
+    const blur_float w1R1 = w1off;
+    const blur_float w1R2 = w2off;
+    const blur_float w2d1 =   exp(-LENGTH_SQ(float2(1.0, 1.0)) * denom_inv);
+    const blur_float w2d2_3 = exp(-LENGTH_SQ(float2(2.0, 1.0)) * denom_inv);
+    const blur_float w2d4 =   exp(-LENGTH_SQ(float2(2.0, 2.0)) * denom_inv);
     //  Statically add texel weights in each sample to get sample weights:
-    const float w0 = 1.0;
-    const float w1 = w1R1 + w1R2;
-    const float w2 = w2d1 + 2.0 * w2d2_3 + w2d4;
+    const blur_float w0 = 1.0;
+    const blur_float w1 = w1R1 + w1R2;
+    const blur_float w2 = w2d1 + 2.0 * w2d2_3 + w2d4;
     //  Get the weight sum inverse (normalization factor):
-    const float weight_sum_inv = 1.0/(w0 + 4.0 * (w1 + w2));
+    const blur_float weight_sum_inv = 1.0/(w0 + 4.0 * (w1 + w2));
 
     //  LOAD TEXTURE SAMPLES:
     //  Load all 9 samples (1 nearest, 4 linear, 4 bilinear) using symmetry:
@@ -1106,25 +1375,25 @@ float3 tex2Dblur5x5(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy_mirror_x = dxdy * mirror_x;
     const float2 dxdy_mirror_y = dxdy * mirror_y;
     const float2 dxdy_mirror_xy = dxdy * mirror_xy;
-    const float3 sample0C = tex2D_linearize(tex, tex_uv).rgb;
-    const float3 sample1R = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset).rgb;
-    const float3 sample1D = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset.yx).rgb;
-    const float3 sample1L = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset).rgb;
-    const float3 sample1U = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset.yx).rgb;
-    const float3 sample2d = tex2D_linearize(tex, tex_uv + dxdy * sample2d_texel_offset).rgb;
-    const float3 sample2c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample2d_texel_offset).rgb;
-    const float3 sample2b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample2d_texel_offset).rgb;
-    const float3 sample2a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample2d_texel_offset).rgb;
+    const blur_float3 sample0C = tex2D_linearize(tex, tex_uv).rgb;
+    const blur_float3 sample1R = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset).rgb;
+    const blur_float3 sample1D = tex2D_linearize(tex, tex_uv + dxdy * sample1R_texel_offset.yx).rgb;
+    const blur_float3 sample1L = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset).rgb;
+    const blur_float3 sample1U = tex2D_linearize(tex, tex_uv - dxdy * sample1R_texel_offset.yx).rgb;
+    const blur_float3 sample2d = tex2D_linearize(tex, tex_uv + dxdy * sample2d_texel_offset).rgb;
+    const blur_float3 sample2c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample2d_texel_offset).rgb;
+    const blur_float3 sample2b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample2d_texel_offset).rgb;
+    const blur_float3 sample2a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample2d_texel_offset).rgb;
 
     //  SUM WEIGHTED SAMPLES:
     //  Statically normalize weights (so total = 1.0), and sum weighted samples.
-    float3 sum = w0 * sample0C;
+    blur_float3 sum = w0 * sample0C;
     sum += w1 * (sample1R + sample1D + sample1L + sample1U);
     sum += w2 * (sample2a + sample2b + sample2c + sample2d);
     return sum * weight_sum_inv;
 }
 
-float3 tex2Dblur3x3(const sampler2D tex, const float2 tex_uv,
+blur_float3 tex2Dblur3x3(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy, const float sigma)
 {
     //  Perform a 1-pass 3x3 blur with 5x5 bilinear samples.
@@ -1161,10 +1430,10 @@ float3 tex2Dblur3x3(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy_mirror_x = dxdy * mirror_x;
     const float2 dxdy_mirror_y = dxdy * mirror_y;
     const float2 dxdy_mirror_xy = dxdy * mirror_xy;
-    const float3 sample0a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample0d_texel_offset).rgb;
-    const float3 sample0b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample0d_texel_offset).rgb;
-    const float3 sample0c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample0d_texel_offset).rgb;
-    const float3 sample0d = tex2D_linearize(tex, tex_uv + dxdy * sample0d_texel_offset).rgb;
+    const blur_float3 sample0a = tex2D_linearize(tex, tex_uv + dxdy_mirror_xy * sample0d_texel_offset).rgb;
+    const blur_float3 sample0b = tex2D_linearize(tex, tex_uv + dxdy_mirror_y * sample0d_texel_offset).rgb;
+    const blur_float3 sample0c = tex2D_linearize(tex, tex_uv + dxdy_mirror_x * sample0d_texel_offset).rgb;
+    const blur_float3 sample0d = tex2D_linearize(tex, tex_uv + dxdy * sample0d_texel_offset).rgb;
 
     //  SUM WEIGHTED SAMPLES:
     //  Weights for all samples are the same, so just average them:
@@ -1181,7 +1450,9 @@ float3 tex2Dblur12x12shared(const sampler2D tex,
     //  Perform a 1-pass mipmapped blur with shared samples across a pixel quad.
     //  Requires:   1.) Same as tex2Dblur9()
     //              2.) ddx() and ddy() are present in the current Cg profile.
-    //              3.) The GPU driver is using fine/high-quality derivatives.
+    //              3.) The GPU driver is using fine/high-quality derivatives,
+    //                  or the pass defines QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+    //                  (see quad-pixel-communication.h).
     //              4.) quad_vector *correctly* describes the current fragment's
     //                  location in its pixel quad, by the conventions noted in
     //                  get_quad_vector[_naive].
@@ -1784,107 +2055,188 @@ float3 tex2Dblur6x6shared(const sampler2D tex,
 }
 
 
+///////////////////  RUNTIME SIGMA SEPARABLE BLURS WITH TABLES  //////////////////
+
+//  Uniform sigmas cost 18-53% (see the description) because every fragment
+//  recomputes the same weights.  These blurs read them from a 1xN weight table
+//  instead, computed once per frame for a runtime sigma by a tiny prepass
+//  (see blurs/blur-weights.slang and blurs/blur-runtime-sigma.slangp):
+//      texel 0:    x = normalized center weight
+//      texel i:    x = normalized weight of texels 2i-1 and 2i combined
+//                  y = their bilinear tap offset in dxdy strides
+//  A table N texels wide gives a (4N - 3)x blur with 2N - 1 taps, e.g. 12
+//  texels match tex2Dblur43fast with a 45x kernel.  Sigmas much larger than
+//  (N - 1) truncate the kernel like an oversized blurN_std_dev would.
+
+float2 get_blur_table_entry(const int i, const int pairs, const float sigma)
+{
+    //  Requires:   0 <= i <= pairs
+    //  Returns:    Texel i of the weight table for the given sigma.
+    const float denom_inv = 0.5/(sigma*sigma);
+    float weight_sum = 1.0;
+    for(int k = 1; k <= 2 * pairs; k++)
+    {
+        weight_sum += 2.0 * exp(-float(k * k) * denom_inv);
+    }
+    if(i == 0) return float2(1.0/weight_sum, 0.0);
+    const float dist = float(2 * i - 1);
+    const float w_near = exp(-dist * dist * denom_inv);
+    const float w_far = exp(-(dist + 1.0) * (dist + 1.0) * denom_inv);
+    const float w_pair = w_near + w_far;
+    //  Far pairs of tiny sigmas underflow; their weight is 0 either way.
+    const float ratio = w_pair > 0.0 ? w_far/w_pair : 0.5;
+    return float2(w_pair/weight_sum, dist + ratio);
+}
+
+blur_float3 tex2Dblur_table(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy, const sampler2D weights)
+{
+    //  Requires:   1.) Same as tex2Dblur11()
+    //              2.) weights is a 1xN R32G32_SFLOAT table as above.
+    //  Returns:    A 1D Gaussian blurred texture lookup using 2N - 1 taps
+    //              and the sigma the table was computed for.
+    const int pairs = textureSize(weights, 0).x - 1;
+    const blur_float w0 = texelFetch(weights, ivec2(0, 0), 0).x;
+    blur_float3 sum = w0 * tex2D_linearize(tex, tex_uv).rgb;
+    for(int i = 1; i <= pairs; i++)
+    {
+        //  The offset stays highp; only the weight joins the color math.
+        const float2 w = texelFetch(weights, ivec2(i, 0), 0).xy;
+        const blur_float w_pair = w.x;
+        sum += w_pair * (tex2D_linearize(tex, tex_uv - w.y * dxdy).rgb +
+            tex2D_linearize(tex, tex_uv + w.y * dxdy).rgb);
+    }
+    return sum;
+}
+
+
 ///////////////////////  MAX OPTIMAL SIGMA BLUR WRAPPERS  //////////////////////
 
 //  The following blurs are static wrappers around the dynamic blurs above.
 //  HOPEFULLY, the compiler will be smart enough to do constant-folding.
 
 //  Resizable separable blurs:
-inline float3 tex2Dblur11resize(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur11resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur11resize(tex, tex_uv, dxdy, blur11_std_dev);
 }
-inline float3 tex2Dblur9resize(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur9resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur9resize(tex, tex_uv, dxdy, blur9_std_dev);
 }
-inline float3 tex2Dblur7resize(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur7resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur7resize(tex, tex_uv, dxdy, blur7_std_dev);
 }
-inline float3 tex2Dblur5resize(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur5resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur5resize(tex, tex_uv, dxdy, blur5_std_dev);
 }
-inline float3 tex2Dblur3resize(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur3resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur3resize(tex, tex_uv, dxdy, blur3_std_dev);
 }
+//  Gamma-correct resizable separable blurs:
+inline blur_float3 tex2Dblur11gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    return tex2Dblur11gather(tex, tex_uv, dxdy, blur11_std_dev);
+}
+inline blur_float3 tex2Dblur9gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    return tex2Dblur9gather(tex, tex_uv, dxdy, blur9_std_dev);
+}
+inline blur_float3 tex2Dblur7gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    return tex2Dblur7gather(tex, tex_uv, dxdy, blur7_std_dev);
+}
+inline blur_float3 tex2Dblur5gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    return tex2Dblur5gather(tex, tex_uv, dxdy, blur5_std_dev);
+}
+inline blur_float3 tex2Dblur3gather(const sampler2D tex, const float2 tex_uv,
+    const float2 dxdy)
+{
+    return tex2Dblur3gather(tex, tex_uv, dxdy, blur3_std_dev);
+}
 //  Fast separable blurs:
-inline float3 tex2Dblur11fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur11fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur11fast(tex, tex_uv, dxdy, blur11_std_dev);
 }
-inline float3 tex2Dblur9fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur9fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur9fast(tex, tex_uv, dxdy, blur9_std_dev);
 }
-inline float3 tex2Dblur7fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur7fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur7fast(tex, tex_uv, dxdy, blur7_std_dev);
 }
-inline float3 tex2Dblur5fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur5fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur5fast(tex, tex_uv, dxdy, blur5_std_dev);
 }
-inline float3 tex2Dblur3fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur3fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur3fast(tex, tex_uv, dxdy, blur3_std_dev);
 }
 //  Huge, "fast" separable blurs:
-inline float3 tex2Dblur43fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur43fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur43fast(tex, tex_uv, dxdy, blur43_std_dev);
 }
-inline float3 tex2Dblur31fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur31fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur31fast(tex, tex_uv, dxdy, blur31_std_dev);
 }
-inline float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur25fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur25fast(tex, tex_uv, dxdy, blur25_std_dev);
 }
-inline float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur17fast(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur17fast(tex, tex_uv, dxdy, blur17_std_dev);
 }
 //  Resizable one-pass blurs:
-inline float3 tex2Dblur3x3resize(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur3x3resize(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur3x3resize(tex, tex_uv, dxdy, blur3_std_dev);
 }
 //  "Fast" one-pass blurs:
-inline float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur9x9(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur9x9(tex, tex_uv, dxdy, blur9_std_dev);
 }
-inline float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur7x7(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur7x7(tex, tex_uv, dxdy, blur7_std_dev);
 }
-inline float3 tex2Dblur5x5(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur5x5(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur5x5(tex, tex_uv, dxdy, blur5_std_dev);
 }
-inline float3 tex2Dblur3x3(const sampler2D tex, const float2 tex_uv,
+inline blur_float3 tex2Dblur3x3(const sampler2D tex, const float2 tex_uv,
     const float2 dxdy)
 {
     return tex2Dblur3x3(tex, tex_uv, dxdy, blur3_std_dev);
@@ -41,6 +41,19 @@
 //              If an option in [5, 8] is #defined in the first or last pass, it
 //              should be #defined for both.  It shouldn't make a difference
 //              whether it's #defined for intermediate passes or not.
+//              9.) With GAMMA_ENCODE_EVERY_FBO, #define GAMMA_LINEAR_INPUT if
+//                  this pass's input is nevertheless stored linear (the
+//                  previous pass has srgb_framebufferN or float_framebufferN
+//                  = "true" and #defines GAMMA_LINEAR_OUTPUT), and
+//                  GAMMA_LINEAR_OUTPUT if this pass's own output is.  Neither
+//                  affects FIRST_PASS input or LAST_PASS output, and they are
+//                  redundant without GAMMA_ENCODE_EVERY_FBO.
+//              10.)#define GAMMA_FAST_POW to decode inputs with a polynomial
+//                  instead of pow() for the standard gammas; see
+//                  decode_input_pow() below.  It only takes effect when the
+//                  pass gammas are static, i.e. without OVERRIDE_*_GAMMA,
+//                  or with GAMMA_OVERRIDES_STATIC if the overrides are
+//                  static constants rather than runtime parameters.
 //  Optional:   The including file (or an earlier included file) may optionally
 //              #define a number of macros indicating it will override certain
 //              macros and associated constants are as follows:
@@ -82,6 +95,14 @@
 //              Finally, use the global gamma_aware_bilinear boolean if you want
 //              to statically branch based on whether bilinear filtering is
 //              gamma-correct or not (e.g. for placing Gaussian blur samples).
+//  Half Precision:
+//  #define GAMMA_HALF_PRECISION to decode, encode and return colors as mediump
+//  (RelaxedPrecision in SPIR-V).  GPUs with 16-bit ALUs then run the pow()
+//  per texture read at twice the rate, and math on the returned colors stays
+//  in mediump as long as everything else it touches does too.  Texture
+//  coordinates are unaffected.  Over [0, 1] the decoded colors are within
+//  about 0.1% of highp, well under an 8-bit step; see tools/slang-halfprec.py
+//  for measured errors.
 //
 //  Detailed Policy:
 //  tex*D*_linearize() functions enforce a consistent gamma-management policy
@@ -230,18 +251,32 @@
         inline float get_pass_output_gamma()    {   return 1.0;                 }
     #endif
 #else
-    static const bool linearize_input = true;
-    static const bool gamma_encode_output = true;
+    //  GAMMA_LINEAR_INPUT/GAMMA_LINEAR_OUTPUT mark sRGB or float framebuffers
+    //  between passes that otherwise encode every FBO:
     #ifdef FIRST_PASS
+        static const bool linearize_input = true;
         inline float get_pass_input_gamma()     {   return get_input_gamma();   }
     #else
+    #ifdef GAMMA_LINEAR_INPUT
+        static const bool linearize_input = false;
+        inline float get_pass_input_gamma()     {   return 1.0;                 }
+    #else
+        static const bool linearize_input = true;
         inline float get_pass_input_gamma()     {   return get_intermediate_gamma();    }
-    #endif
+    #endif  //  GAMMA_LINEAR_INPUT
+    #endif  //  FIRST_PASS
     #ifdef LAST_PASS
+        static const bool gamma_encode_output = true;
         inline float get_pass_output_gamma()    {   return get_output_gamma();  }
     #else
+    #ifdef GAMMA_LINEAR_OUTPUT
+        static const bool gamma_encode_output = false;
+        inline float get_pass_output_gamma()    {   return 1.0;                 }
+    #else
+        static const bool gamma_encode_output = true;
         inline float get_pass_output_gamma()    {   return get_intermediate_gamma();    }
-    #endif
+    #endif  //  GAMMA_LINEAR_OUTPUT
+    #endif  //  LAST_PASS
 #endif
 
 //  Users might want to know if bilinear filtering will be gamma-correct:
@@ -250,17 +285,95 @@ static const bool gamma_aware_bilinear = !linearize_input;
 
 //////////////////////  COLOR ENCODING/DECODING FUNCTIONS  /////////////////////
 
-inline float4 encode_output(const float4 color)
+//  Colors are mediump with GAMMA_HALF_PRECISION.  A constructor takes the
+//  precision of its arguments, so the gammas are copied into gamma_float3
+//  locals to keep pow() in that precision too.
+#ifdef GAMMA_HALF_PRECISION
+    #define gamma_float3 mediump float3
+    #define gamma_float4 mediump float4
+#else
+    #define gamma_float3 float3
+    #define gamma_float4 float4
+#endif
+
+//  GAMMA_FAST_POW decodes with pow(x, gamma) ~= x^2 * (c.x + c.y*s + c.z*s^2 +
+//  c.w*s^3), s = sqrt(x), for the standard gammas (2.2, 2.35, 2.5, 2.8 and
+//  3.5) and sRGB's 2.4: one sqrt() per channel instead of a log2() and an
+//  exp2(), which matters because decode_input() runs on every texture tap.
+//  The coefficients come from tools/slang-gamma.py fit: over the 256 8-bit
+//  inputs, the decoded values re-encode to within 0.07 8-bit steps of the
+//  input (2.5 and 3.5 are exact).  Other gammas still use pow().  Choosing
+//  the polynomial costs nothing only when the gamma is a compile-time
+//  constant; with a runtime parameter every tap would pay the comparisons on
+//  top of the pow(), so the fast path is compiled in only when the pass gammas
+//  are static (GAMMA_FAST_POW_STATIC below).  Encoding happens once per pixel,
+//  so encode_output() keeps pow().
+#ifdef GAMMA_FAST_POW
+    #ifdef GAMMA_OVERRIDES_STATIC
+        #define GAMMA_FAST_POW_STATIC
+    #else
+    #ifndef OVERRIDE_STANDARD_GAMMA
+    #ifndef OVERRIDE_DEVICE_GAMMA
+    #ifndef OVERRIDE_FINAL_GAMMA
+        #define GAMMA_FAST_POW_STATIC
+    #endif  //  OVERRIDE_FINAL_GAMMA
+    #endif  //  OVERRIDE_DEVICE_GAMMA
+    #endif  //  OVERRIDE_STANDARD_GAMMA
+    #endif  //  GAMMA_OVERRIDES_STATIC
+#endif  //  GAMMA_FAST_POW
+
+static const float4 gamma_fast_pow_2_2 =
+    float4(0.30319255, 1.26903457, -0.86558475, 0.29335762);
+static const float4 gamma_fast_pow_2_35 =
+    float4(0.08156704, 1.31441398, -0.58635296, 0.19037194);
+static const float4 gamma_fast_pow_2_4 =
+    float4(0.04298533, 1.23471725, -0.40743177, 0.12972919);
+static const float4 gamma_fast_pow_2_5 =
+    float4(0.0, 1.0, 0.0, 0.0);
+static const float4 gamma_fast_pow_2_8 =
+    float4(-0.00978143, 0.25750266, 0.92823776, -0.17595899);
+static const float4 gamma_fast_pow_3_5 =
+    float4(0.0, 0.0, 0.0, 1.0);
+
+inline gamma_float3 gamma_fast_pow(const gamma_float3 color,
+    const gamma_float4 c)
+{
+    const gamma_float3 s = sqrt(color);
+    return color * color * (c.x + s * (c.y + s * (c.z + s * c.w)));
+}
+
+inline gamma_float3 decode_input_pow(const gamma_float3 color,
+    const float gamma)
+{
+    //  Requires:   color is in [0, 1], i.e. read from a UNORM texture.
+    //  Returns:    pow(color, gamma), approximated with GAMMA_FAST_POW.  The
+    //              pass gammas are static constants under
+    //              GAMMA_FAST_POW_STATIC, so the comparisons fold away at
+    //              compile time.
+    #ifdef GAMMA_FAST_POW_STATIC
+        if(gamma == 2.2) return gamma_fast_pow(color, gamma_fast_pow_2_2);
+        if(gamma == 2.35) return gamma_fast_pow(color, gamma_fast_pow_2_35);
+        if(gamma == 2.4) return gamma_fast_pow(color, gamma_fast_pow_2_4);
+        if(gamma == 2.5) return gamma_fast_pow(color, gamma_fast_pow_2_5);
+        if(gamma == 2.8) return gamma_fast_pow(color, gamma_fast_pow_2_8);
+        if(gamma == 3.5) return gamma_fast_pow(color, gamma_fast_pow_3_5);
+    #endif
+    const gamma_float3 gamma3 = float3(gamma);
+    return pow(color, gamma3);
+}
+
+inline gamma_float4 encode_output(const gamma_float4 color)
 {
     if(gamma_encode_output)
     {
+        const gamma_float3 gamma = float3(1.0/get_pass_output_gamma());
         if(assume_opaque_alpha)
         {
-            return float4(pow(color.rgb, float3(1.0/get_pass_output_gamma())), 1.0);
+            return float4(pow(color.rgb, gamma), 1.0);
         }
         else
         {
-            return float4(pow(color.rgb, float3(1.0/get_pass_output_gamma())), color.a);
+            return float4(pow(color.rgb, gamma), color.a);
         }
     }
     else
@@ -269,17 +382,19 @@ inline float4 encode_output(const float4 color)
     }
 }
 
-inline float4 decode_input(const float4 color)
+inline gamma_float4 decode_input(const gamma_float4 color)
 {
     if(linearize_input)
     {
+        const gamma_float3 linear_color =
+            decode_input_pow(color.rgb, get_pass_input_gamma());
         if(assume_opaque_alpha)
         {
-            return float4(pow(color.rgb, float3(get_pass_input_gamma())), 1.0);
+            return float4(linear_color, 1.0);
         }
         else
         {
-            return float4(pow(color.rgb, float3(get_pass_input_gamma())), color.a);
+            return float4(linear_color, color.a);
         }
     }
     else
@@ -288,7 +403,8 @@ inline float4 decode_input(const float4 color)
     }
 }
 
-inline float4 decode_gamma_input(const float4 color, const float3 gamma)
+inline gamma_float4 decode_gamma_input(const gamma_float4 color,
+    const gamma_float3 gamma)
 {
     if(assume_opaque_alpha)
     {
@@ -379,16 +495,16 @@ inline float4 tex1Dproj_linearize(const sampler1D tex, const float3 tex_coords,
 {   return decode_input(tex1Dproj(tex, tex_coords, texel_off));    }
 */
 //  tex2D:
-inline float4 tex2D_linearize(const sampler2D tex, float2 tex_coords)
+inline gamma_float4 tex2D_linearize(const sampler2D tex, float2 tex_coords)
 {   return decode_input(texture(tex, tex_coords));   }
 
-inline float4 tex2D_linearize(const sampler2D tex, float3 tex_coords)
+inline gamma_float4 tex2D_linearize(const sampler2D tex, float3 tex_coords)
 {   return decode_input(texture(tex, tex_coords.xy));   }
 
-inline float4 tex2D_linearize(const sampler2D tex, float2 tex_coords, int texel_off)
+inline gamma_float4 tex2D_linearize(const sampler2D tex, float2 tex_coords, int texel_off)
 {   return decode_input(textureLod(tex, tex_coords, texel_off));    }
 
-inline float4 tex2D_linearize(const sampler2D tex, float3 tex_coords, int texel_off)
+inline gamma_float4 tex2D_linearize(const sampler2D tex, float3 tex_coords, int texel_off)
 {   return decode_input(textureLod(tex, tex_coords.xy, texel_off));    }
 
 //inline float4 tex2D_linearize(const sampler2D tex, const float2 tex_coords, const float2 dx, const float2 dy)
@@ -418,10 +534,10 @@ inline float4 tex2D_linearize(const sampler2D tex, float3 tex_coords, int texel_
 //{   return decode_input(tex2Dfetch(tex, tex_coords, texel_off));   }
 
 //  tex2Dlod:
-inline float4 tex2Dlod_linearize(const sampler2D tex, float4 tex_coords)
+inline gamma_float4 tex2Dlod_linearize(const sampler2D tex, float4 tex_coords)
 {   return decode_input(textureLod(tex, tex_coords.xy, 0.0));    }
 
-inline float4 tex2Dlod_linearize(const sampler2D tex, float4 tex_coords, int texel_off)
+inline gamma_float4 tex2Dlod_linearize(const sampler2D tex, float4 tex_coords, int texel_off)
 {   return decode_input(textureLod(tex, tex_coords.xy, texel_off));     }
 /*
 //  tex2Dproj:
@@ -497,10 +613,10 @@ inline float4 tex3Dproj_linearize(const sampler3D tex, const float4 tex_coords,
 //  LUT's and for reading the input of pass0 in a later pass.
 
 //  tex2D:
-inline float4 tex2D_linearize_gamma(const sampler2D tex, const float2 tex_coords, const float3 gamma)
+inline gamma_float4 tex2D_linearize_gamma(const sampler2D tex, const float2 tex_coords, const float3 gamma)
 {   return decode_gamma_input(texture(tex, tex_coords), gamma);   }
 
-inline float4 tex2D_linearize_gamma(const sampler2D tex, const float3 tex_coords, const float3 gamma)
+inline gamma_float4 tex2D_linearize_gamma(const sampler2D tex, const float3 tex_coords, const float3 gamma)
 {   return decode_gamma_input(texture(tex, tex_coords.xy), gamma);   }
 
 //inline float4 tex2D_linearize_gamma(const sampler2D tex, const float2 tex_coords, const int texel_off, const float3 gamma)
@@ -536,10 +652,10 @@ inline float4 tex2Dfetch_linearize_gamma(const sampler2D tex, const int4 tex_coo
 {   return decode_gamma_input(tex2Dfetch(tex, tex_coords, texel_off), gamma);   }
 */
 //  tex2Dlod:
-inline float4 tex2Dlod_linearize_gamma(const sampler2D tex, float4 tex_coords, float3 gamma)
+inline gamma_float4 tex2Dlod_linearize_gamma(const sampler2D tex, float4 tex_coords, float3 gamma)
 {   return decode_gamma_input(textureLod(tex, tex_coords.xy, 0.0), gamma);    }
 
-inline float4 tex2Dlod_linearize_gamma(const sampler2D tex, float4 tex_coords, int texel_off, float3 gamma)
+inline gamma_float4 tex2Dlod_linearize_gamma(const sampler2D tex, float4 tex_coords, int texel_off, float3 gamma)
 {   return decode_gamma_input(textureLod(tex, tex_coords.xy, texel_off), gamma);     }
 
 
@@ -43,6 +43,26 @@
 //              2.) The GPU driver is using fine/high-quality derivatives.
 //                  Functions will give incorrect results if this is not true,
 //                  so a test function is included.
+//  Subgroup Backend:
+//  #define QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS before including this file
+//  to exchange values with GL_KHR_shader_subgroup_quad instead: a quad swap
+//  reads the neighbor's value exactly, where the derivative trick recovers it
+//  from a difference (with rounding error, and only with fine derivatives),
+//  and the fragment's place in its quad comes from its subgroup invocation
+//  instead of from pixel number parity, so odd quad starts are no concern.
+//  A preset selects the backend by using a pass that defines the macro, like
+//  blurs/subgroups/blur12x12shared.slang.  Such a pass must be compiled for
+//  Vulkan 1.1 (SPIR-V 1.3) or later and run on a device supporting quad
+//  operations in fragment shaders.  RetroArch and tools/slang-runner.py
+//  compile for Vulkan 1.0 (SPIR-V 1.0), where it fails to compile.
+
+
+/////////////////////////////  SUBGROUP SELECTION  /////////////////////////////
+
+#ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+    #extension GL_KHR_shader_subgroup_basic : require
+    #extension GL_KHR_shader_subgroup_quad : require
+#endif
 
 
 /////////////////////  QUAD-PIXEL COMMUNICATION PRIMITIVES  ////////////////////
@@ -79,13 +99,24 @@ float4 get_quad_vector(const float4 output_pixel_num_wrt_uvxy)
     //  Returns:    Same as get_quad_vector_naive() (see that first), but it's
     //              correct even if the 2x2 pixel quad starts at an odd pixel,
     //              which can occur at odd resolutions.
-    const float4 quad_vector_guess =
-        get_quad_vector_naive(output_pixel_num_wrt_uvxy);
-    //  If quad_vector_guess.zw doesn't increase with screen xy, we know
-    //  the 2x2 pixel quad starts at an odd pixel:
-    const float2 odd_start_mirror = 0.5 * float2(ddx(quad_vector_guess.z),
-                                                ddy(quad_vector_guess.w));
-    return quad_vector_guess * odd_start_mirror.xyxy;
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        //  Quad invocations 0-3 are the top-left, top-right, bottom-left and
+        //  bottom-right fragments; screen xy increases with .zw:
+        const float2 screen_uv_mirror = float2(
+            ddx(output_pixel_num_wrt_uvxy.x), ddy(output_pixel_num_wrt_uvxy.y));
+        const uint quad_index = gl_SubgroupInvocationID & 3u;
+        const float2 quad_vector_screen = float2(
+            float(quad_index & 1u), float(quad_index >> 1u)) * 2.0 - float2(1.0);
+        return float4(quad_vector_screen * screen_uv_mirror, quad_vector_screen);
+    #else
+        const float4 quad_vector_guess =
+            get_quad_vector_naive(output_pixel_num_wrt_uvxy);
+        //  If quad_vector_guess.zw doesn't increase with screen xy, we know
+        //  the 2x2 pixel quad starts at an odd pixel:
+        const float2 odd_start_mirror = 0.5 * float2(ddx(quad_vector_guess.z),
+                                                    ddy(quad_vector_guess.w));
+        return quad_vector_guess * odd_start_mirror.xyxy;
+    #endif
 }
 
 float4 get_quad_vector(const float2 output_pixel_num_wrt_uv)
@@ -99,20 +130,24 @@ float4 get_quad_vector(const float2 output_pixel_num_wrt_uv)
     //              which can occur at odd resolutions.
     //  Caveats:    This function requires less information than the version
     //              taking a float4, but it's potentially slower.
-    //  Do screen coords increase with or against uv?  Get the direction
-    //  with respect to (uv.x, uv.y) for (screen.x, screen.y) in {-1, 1}.
-    const float2 screen_uv_mirror = float2(ddx(output_pixel_num_wrt_uv.x),
-                                        ddy(output_pixel_num_wrt_uv.y));
-    const float2 pixel_odd_wrt_uv = frac(output_pixel_num_wrt_uv * 0.5) * 2.0;
-    const float2 quad_vector_uv_guess = (pixel_odd_wrt_uv - float2(0.5)) * 2.0;
-    const float2 quad_vector_screen_guess = quad_vector_uv_guess * screen_uv_mirror;
-    //  If quad_vector_screen_guess doesn't increase with screen xy, we know
-    //  the 2x2 pixel quad starts at an odd pixel:
-    const float2 odd_start_mirror = 0.5 * float2(ddx(quad_vector_screen_guess.x),
-                                                ddy(quad_vector_screen_guess.y));
-    const float4 quad_vector_guess = float4(
-        quad_vector_uv_guess, quad_vector_screen_guess);
-    return quad_vector_guess * odd_start_mirror.xyxy;
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        return get_quad_vector(output_pixel_num_wrt_uv.xyxy);
+    #else
+        //  Do screen coords increase with or against uv?  Get the direction
+        //  with respect to (uv.x, uv.y) for (screen.x, screen.y) in {-1, 1}.
+        const float2 screen_uv_mirror = float2(ddx(output_pixel_num_wrt_uv.x),
+                                            ddy(output_pixel_num_wrt_uv.y));
+        const float2 pixel_odd_wrt_uv = frac(output_pixel_num_wrt_uv * 0.5) * 2.0;
+        const float2 quad_vector_uv_guess = (pixel_odd_wrt_uv - float2(0.5)) * 2.0;
+        const float2 quad_vector_screen_guess = quad_vector_uv_guess * screen_uv_mirror;
+        //  If quad_vector_screen_guess doesn't increase with screen xy, we know
+        //  the 2x2 pixel quad starts at an odd pixel:
+        const float2 odd_start_mirror = 0.5 * float2(ddx(quad_vector_screen_guess.x),
+                                                    ddy(quad_vector_screen_guess.y));
+        const float4 quad_vector_guess = float4(
+            quad_vector_uv_guess, quad_vector_screen_guess);
+        return quad_vector_guess * odd_start_mirror.xyxy;
+    #endif
 }
 
 void quad_gather(const float4 quad_vector, const float4 curr,
@@ -125,27 +160,45 @@ void quad_gather(const float4 quad_vector, const float4 curr,
     //              4.) curr is any vector you wish to get neighboring values of.
     //  Returns:    Values of an input vector (curr) at neighboring fragments
     //              adjacent x, adjacent y, and diagonal (via out parameters).
-    adjx = curr - ddx(curr) * quad_vector.z;
-    adjy = curr - ddy(curr) * quad_vector.w;
-    diag = adjx - ddy(adjx) * quad_vector.w;
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        adjx = subgroupQuadSwapHorizontal(curr);
+        adjy = subgroupQuadSwapVertical(curr);
+        diag = subgroupQuadSwapDiagonal(curr);
+    #else
+        adjx = curr - ddx(curr) * quad_vector.z;
+        adjy = curr - ddy(curr) * quad_vector.w;
+        diag = adjx - ddy(adjx) * quad_vector.w;
+    #endif
 }
 
 void quad_gather(const float4 quad_vector, const float3 curr,
     out float3 adjx, out float3 adjy, out float3 diag)
 {
     //  Float3 version
-    adjx = curr - ddx(curr) * quad_vector.z;
-    adjy = curr - ddy(curr) * quad_vector.w;
-    diag = adjx - ddy(adjx) * quad_vector.w;
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        adjx = subgroupQuadSwapHorizontal(curr);
+        adjy = subgroupQuadSwapVertical(curr);
+        diag = subgroupQuadSwapDiagonal(curr);
+    #else
+        adjx = curr - ddx(curr) * quad_vector.z;
+        adjy = curr - ddy(curr) * quad_vector.w;
+        diag = adjx - ddy(adjx) * quad_vector.w;
+    #endif
 }
 
 void quad_gather(const float4 quad_vector, const float2 curr,
     out float2 adjx, out float2 adjy, out float2 diag)
 {
     //  Float2 version
-    adjx = curr - ddx(curr) * quad_vector.z;
-    adjy = curr - ddy(curr) * quad_vector.w;
-    diag = adjx - ddy(adjx) * quad_vector.w;
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        adjx = subgroupQuadSwapHorizontal(curr);
+        adjy = subgroupQuadSwapVertical(curr);
+        diag = subgroupQuadSwapDiagonal(curr);
+    #else
+        adjx = curr - ddx(curr) * quad_vector.z;
+        adjy = curr - ddy(curr) * quad_vector.w;
+        diag = adjx - ddy(adjx) * quad_vector.w;
+    #endif
 }
 
 float4 quad_gather(const float4 quad_vector, const float curr)
@@ -155,42 +208,68 @@ float4 quad_gather(const float4 quad_vector, const float curr)
     //              return.y == adjacent x
     //              return.z == adjacent y
     //              return.w == diagonal
-    float4 all = float4(curr);
-    all.y = all.x - ddx(all.x) * quad_vector.z;
-    all.zw = all.xy - ddy(all.xy) * quad_vector.w;
-    return all;
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        return float4(curr, subgroupQuadSwapHorizontal(curr),
+            subgroupQuadSwapVertical(curr), subgroupQuadSwapDiagonal(curr));
+    #else
+        float4 all = float4(curr);
+        all.y = all.x - ddx(all.x) * quad_vector.z;
+        all.zw = all.xy - ddy(all.xy) * quad_vector.w;
+        return all;
+    #endif
 }
 
 float4 quad_gather_sum(const float4 quad_vector, const float4 curr)
 {
     //  Requires:   Same as quad_gather()
     //  Returns:    Sum of an input vector (curr) at all fragments in a quad.
-    float4 adjx, adjy, diag;
-    quad_gather(quad_vector, curr, adjx, adjy, diag);
-    return (curr + adjx + adjy + diag);
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        //  Two swaps: sum the rows, then swap the row sums.
+        const float4 row_sum = curr + subgroupQuadSwapHorizontal(curr);
+        return row_sum + subgroupQuadSwapVertical(row_sum);
+    #else
+        float4 adjx, adjy, diag;
+        quad_gather(quad_vector, curr, adjx, adjy, diag);
+        return (curr + adjx + adjy + diag);
+    #endif
 }
 
 float3 quad_gather_sum(const float4 quad_vector, const float3 curr)
 {
     //  Float3 version:
-    float3 adjx, adjy, diag;
-    quad_gather(quad_vector, curr, adjx, adjy, diag);
-    return (curr + adjx + adjy + diag);
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        const float3 row_sum = curr + subgroupQuadSwapHorizontal(curr);
+        return row_sum + subgroupQuadSwapVertical(row_sum);
+    #else
+        float3 adjx, adjy, diag;
+        quad_gather(quad_vector, curr, adjx, adjy, diag);
+        return (curr + adjx + adjy + diag);
+    #endif
 }
 
 float2 quad_gather_sum(const float4 quad_vector, const float2 curr)
 {
     //  Float2 version:
-    float2 adjx, adjy, diag;
-    quad_gather(quad_vector, curr, adjx, adjy, diag);
-    return (curr + adjx + adjy + diag);
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        const float2 row_sum = curr + subgroupQuadSwapHorizontal(curr);
+        return row_sum + subgroupQuadSwapVertical(row_sum);
+    #else
+        float2 adjx, adjy, diag;
+        quad_gather(quad_vector, curr, adjx, adjy, diag);
+        return (curr + adjx + adjy + diag);
+    #endif
 }
 
 float quad_gather_sum(const float4 quad_vector, const float curr)
 {
     //  Float version:
-    const float4 all_values = quad_gather(quad_vector, curr);
-    return (all_values.x + all_values.y + all_values.z + all_values.w);
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        const float row_sum = curr + subgroupQuadSwapHorizontal(curr);
+        return row_sum + subgroupQuadSwapVertical(row_sum);
+    #else
+        const float4 all_values = quad_gather(quad_vector, curr);
+        return (all_values.x + all_values.y + all_values.z + all_values.w);
+    #endif
 }
 
 bool fine_derivatives_working(const float4 quad_vector, float4 curr)
@@ -208,14 +287,20 @@ bool fine_derivatives_working(const float4 quad_vector, float4 curr)
     //                  (ddy(curr) != ddy(adjx)) or (ddx(curr) != ddx(adjy))
     //              The more values we test (e.g. test a float4 two ways), the
     //              easier it is to demonstrate fine derivatives are working.
+    //              With QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS nothing depends on
+    //              derivatives, and this is always true.
     //  TODO: Check for floating point exact comparison issues!
-    float4 ddx_curr = ddx(curr);
-    float4 ddy_curr = ddy(curr);
-    float4 adjx = curr - ddx_curr * quad_vector.z;
-    float4 adjy = curr - ddy_curr * quad_vector.w;
-    bool ddy_different = any(bool4(ddy_curr.x != ddy(adjx).x, ddy_curr.y != ddy(adjx).y, ddy_curr.z != ddy(adjx).z, ddy_curr.w != ddy(adjx).w));
-    bool ddx_different = any(bool4(ddx_curr.x != ddx(adjy).x, ddx_curr.y != ddx(adjy).y, ddx_curr.z != ddx(adjy).z, ddx_curr.w != ddx(adjy).w));
-    return any(bool2(ddy_different, ddx_different));
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        return true;
+    #else
+        float4 ddx_curr = ddx(curr);
+        float4 ddy_curr = ddy(curr);
+        float4 adjx = curr - ddx_curr * quad_vector.z;
+        float4 adjy = curr - ddy_curr * quad_vector.w;
+        bool ddy_different = any(bool4(ddy_curr.x != ddy(adjx).x, ddy_curr.y != ddy(adjx).y, ddy_curr.z != ddy(adjx).z, ddy_curr.w != ddy(adjx).w));
+        bool ddx_different = any(bool4(ddx_curr.x != ddx(adjy).x, ddx_curr.y != ddx(adjy).y, ddx_curr.z != ddx(adjy).z, ddx_curr.w != ddx(adjy).w));
+        return any(bool2(ddy_different, ddx_different));
+    #endif
 }
 
 bool fine_derivatives_working_fast(const float4 quad_vector, float curr)
@@ -233,10 +318,14 @@ bool fine_derivatives_working_fast(const float4 quad_vector, float curr)
     //              the driver enforces that promise by making a single fragment
     //              control branch decisions).  If that ever happens, this
     //              version may become a more economical choice.
-    float ddx_curr = ddx(curr);
-    float ddy_curr = ddy(curr);
-    float adjx = curr - ddx_curr * quad_vector.z;
-    return (ddy_curr != ddy(adjx));
+    #ifdef QUAD_PIXEL_COMMUNICATION_USE_SUBGROUPS
+        return true;
+    #else
+        float ddx_curr = ddx(curr);
+        float ddy_curr = ddy(curr);
+        float adjx = curr - ddx_curr * quad_vector.z;
+        return (ddy_curr != ddy(adjx));
+    #endif
 }
 
 #endif  //  QUAD_PIXEL_COMMUNICATION_H
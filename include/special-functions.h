@@ -43,6 +43,22 @@
 //  these functions will require a whole lot of maintenance changes unless
 //  someone ever has need for more robust incomplete gamma functions, so code
 //  duplication seems to be the lesser evil in this case.
+//
+//  Lookup Texture:
+//  erf_lut(), gamma_impl_lut() and normalized_ligamma_lut() read the same
+//  functions from include/special-functions-lut.png instead of evaluating
+//  them: one filtered fetch replaces the exp/pow/divide chains.  The texture
+//  is baked by tools/slang-speclut.py, which also measures both versions.
+//  Callers pass the sampler, and their preset must load the texture with
+//  clamp to edge and linear filtering:
+//      textures = "special_functions_lut"
+//      special_functions_lut = ".../include/special-functions-lut.png"
+//      special_functions_lut_linear = "true"
+//      special_functions_lut_wrap_mode = "clamp_to_edge"
+//  The texture only covers what crt-royale's scanlines need, so the _lut
+//  versions have narrower domains than the analytic ones: gamma_impl_lut()
+//  requires s in (0, 0.5], and normalized_ligamma_lut() is accurate for s in
+//  [1/32, 0.5] (generalized Gaussian beam shapes up to 32).
 
 
 ///////////////////////////  GAUSSIAN ERROR FUNCTION  //////////////////////////
@@ -505,6 +521,170 @@ float normalized_ligamma(const float s, const float z)
 }
 
 
+//////////////////////////////  LOOKUP TEXTURE  //////////////////////////////
+
+//  Layout (see tools/slangtools/speclut.py): the first row holds erf(x) for
+//  x in [0, 4] in .rg and gamma(s + 1) for s in [0, 0.5] in .ba; each further
+//  row holds normalized_ligamma(s, u**(1/s)) for u in [0, 4.5] in .rg, s
+//  going from 0 in the second row to 0.5 in the last.  Every value is stored
+//  as 16 bits split over two 8 bit channels, which filter independently and
+//  still add up to the filtered 16 bit value.
+static const float special_lut_erf_max = 4.0;
+static const float special_lut_s_max = 0.5;
+static const float special_lut_u_max = 4.5;
+
+float4 special_lut_texel(const sampler2D lut, const float2 texel)
+{
+    //  Requires:   texel is a position in texels, (0, 0) being the center of
+    //              the top left texel.
+    //  Returns:    The bilinearly filtered texture at that position.
+	const float2 size_inv = float2(1.0)/float2(textureSize(lut, 0));
+	return textureLod(lut, (texel + float2(0.5))*size_inv, 0.0);
+}
+
+float special_lut_unpack(const float2 hi_lo)
+{
+    //  Returns:    The 16 bit value stored as its high and low bytes.
+	return dot(hi_lo, float2(65280.0/65535.0, 255.0/65535.0));
+}
+
+float special_lut_erf(const sampler2D lut, const float x)
+{
+    //  Returns:    erf(x) to within ~1.5*10**-5 (see tools/slang-speclut.py).
+	const float last = float(textureSize(lut, 0).x) - 1.0;
+	const float x_texel = min(abs(x), special_lut_erf_max) *
+		(last/special_lut_erf_max);
+	return sign(x) * special_lut_unpack(special_lut_texel(lut,
+		float2(x_texel, 0.0)).rg);
+}
+
+float special_lut_gamma_plus_one(const sampler2D lut, const float s)
+{
+    //  Requires:   s is in [0, 0.5]
+    //  Returns:    gamma(s + 1) = s * gamma(s)
+	const float last = float(textureSize(lut, 0).x) - 1.0;
+	const float s_texel = min(s, special_lut_s_max) * (last/special_lut_s_max);
+	return special_lut_unpack(special_lut_texel(lut, float2(s_texel, 0.0)).ba);
+}
+
+float special_lut_normalized_ligamma(const sampler2D lut, const float s,
+    const float u)
+{
+    //  Requires:   1.) s is in [0, 0.5]
+    //              2.) u = z**s, the z of normalized_ligamma(s, z)
+    //  Returns:    normalized_ligamma(s, z), read in u because that is smooth
+    //              where z is not: for a generalized Gaussian with shape
+    //              1/s, u is the distance in units of the beam's alpha.
+	const float2 last = float2(textureSize(lut, 0)) - float2(1.0, 2.0);
+	const float2 texel = float2(min(u, special_lut_u_max) *
+		(last.x/special_lut_u_max), 1.0 + min(s, special_lut_s_max) *
+		(last.y/special_lut_s_max));
+	return special_lut_unpack(special_lut_texel(lut, texel).rg);
+}
+
+float4 erf_lut(const sampler2D lut, const float4 x)
+{
+    //  Requires:   lut is include/special-functions-lut.png (see above).
+    //  Returns:    erf(x), read from lut.
+	return float4(special_lut_erf(lut, x.x), special_lut_erf(lut, x.y),
+		special_lut_erf(lut, x.z), special_lut_erf(lut, x.w));
+}
+
+float3 erf_lut(const sampler2D lut, const float3 x)
+{
+    //  Float3 version:
+	return float3(special_lut_erf(lut, x.x), special_lut_erf(lut, x.y),
+		special_lut_erf(lut, x.z));
+}
+
+float2 erf_lut(const sampler2D lut, const float2 x)
+{
+    //  Float2 version:
+	return float2(special_lut_erf(lut, x.x), special_lut_erf(lut, x.y));
+}
+
+float erf_lut(const sampler2D lut, const float x)
+{
+    //  Float version:
+	return special_lut_erf(lut, x);
+}
+
+float4 gamma_impl_lut(const sampler2D lut, const float4 s, const float4 s_inv)
+{
+    //  Requires:   1.) lut is include/special-functions-lut.png (see above).
+    //              2.) s is in (0, 0.5], unlike gamma_impl()'s [0, 36].
+    //              3.) s_inv = 1.0/s, as for gamma_impl().
+    //  Returns:    gamma(s), read from lut.
+	return float4(special_lut_gamma_plus_one(lut, s.x),
+		special_lut_gamma_plus_one(lut, s.y),
+		special_lut_gamma_plus_one(lut, s.z),
+		special_lut_gamma_plus_one(lut, s.w)) * s_inv;
+}
+
+float3 gamma_impl_lut(const sampler2D lut, const float3 s, const float3 s_inv)
+{
+    //  Float3 version:
+	return float3(special_lut_gamma_plus_one(lut, s.x),
+		special_lut_gamma_plus_one(lut, s.y),
+		special_lut_gamma_plus_one(lut, s.z)) * s_inv;
+}
+
+float2 gamma_impl_lut(const sampler2D lut, const float2 s, const float2 s_inv)
+{
+    //  Float2 version:
+	return float2(special_lut_gamma_plus_one(lut, s.x),
+		special_lut_gamma_plus_one(lut, s.y)) * s_inv;
+}
+
+float gamma_impl_lut(const sampler2D lut, const float s, const float s_inv)
+{
+    //  Float version:
+	return special_lut_gamma_plus_one(lut, s) * s_inv;
+}
+
+float4 normalized_ligamma_lut(const sampler2D lut, const float4 s,
+    const float4 z)
+{
+    //  Requires:   1.) lut is include/special-functions-lut.png (see above).
+    //              2.) s is in [1/32, 0.5] for full accuracy.
+    //  Returns:    normalized_ligamma(s, z), read from lut.  Unlike
+    //              normalized_ligamma_impl(), it needs neither 1/s nor
+    //              1/gamma(s).  The pow() undoes the caller's, which is where
+    //              z usually came from.
+	const float4 u = pow(z, s);
+	return float4(special_lut_normalized_ligamma(lut, s.x, u.x),
+		special_lut_normalized_ligamma(lut, s.y, u.y),
+		special_lut_normalized_ligamma(lut, s.z, u.z),
+		special_lut_normalized_ligamma(lut, s.w, u.w));
+}
+
+float3 normalized_ligamma_lut(const sampler2D lut, const float3 s,
+    const float3 z)
+{
+    //  Float3 version:
+	const float3 u = pow(z, s);
+	return float3(special_lut_normalized_ligamma(lut, s.x, u.x),
+		special_lut_normalized_ligamma(lut, s.y, u.y),
+		special_lut_normalized_ligamma(lut, s.z, u.z));
+}
+
+float2 normalized_ligamma_lut(const sampler2D lut, const float2 s,
+    const float2 z)
+{
+    //  Float2 version:
+	const float2 u = pow(z, s);
+	return float2(special_lut_normalized_ligamma(lut, s.x, u.x),
+		special_lut_normalized_ligamma(lut, s.y, u.y));
+}
+
+float normalized_ligamma_lut(const sampler2D lut, const float s,
+    const float z)
+{
+    //  Float version:
+	return special_lut_normalized_ligamma(lut, s, pow(z, s));
+}
+
+
 #endif  //  SPECIAL_FUNCTIONS_H
 
 
@@ -1,3 +1,55 @@
+// mask_weights() returns the per channel weights of phosphor_layout at pixel
+// coord: 1.0 where the layout lights a channel, 1 - mask_intensity where it
+// dims it, 0.0 for layout 0 and out of range layouts.
+//
+// With SUBPIXEL_MASKS_USE_LUT the layouts are read from a baked texture with
+// one texelFetch instead of being built per fragment.  The shader declares
+//    layout(set = 0, binding = N) uniform sampler2D subpixel_masks_lut;
+// before including this file, and its preset loads the texture:
+//    textures = "subpixel_masks_lut"
+//    subpixel_masks_lut = "<path to include>/subpixel-masks-lut.png"
+//    subpixel_masks_lut_linear = "false"
+// coord must not be negative.  tools/slang-masks.py bakes the texture and the
+// table below from the ALU path, so both stay in step when a layout changes.
+
+#ifdef SUBPIXEL_MASKS_USE_LUT
+
+// BEGIN TILE TABLE: generated by tools/slang-masks.py
+const ivec3 subpixel_mask_tiles[20] = ivec3[](
+   ivec3(1, 1, 0),    // layout 0
+   ivec3(2, 1, 1),    // layout 1
+   ivec3(2, 2, 2),    // layout 2
+   ivec3(4, 3, 4),    // layout 3
+   ivec3(2, 1, 7),    // layout 4
+   ivec3(2, 2, 8),    // layout 5
+   ivec3(4, 1, 10),   // layout 6
+   ivec3(5, 1, 11),   // layout 7
+   ivec3(7, 1, 12),   // layout 8
+   ivec3(4, 1, 13),   // layout 9
+   ivec3(4, 1, 14),   // layout 10
+   ivec3(4, 2, 15),   // layout 11
+   ivec3(4, 2, 17),   // layout 12
+   ivec3(4, 4, 19),   // layout 13
+   ivec3(6, 3, 23),   // layout 14
+   ivec3(8, 4, 26),   // layout 15
+   ivec3(4, 3, 30),   // layout 16
+   ivec3(10, 4, 33),  // layout 17
+   ivec3(10, 4, 37),  // layout 18
+   ivec3(14, 6, 41)   // layout 19
+);
+// END TILE TABLE
+
+vec3 mask_weights(vec2 coord, float mask_intensity, int phosphor_layout){
+   // Each layout's tile is (width, height, first row) of the texture; the
+   // blank tile of layout 0 has alpha 0.
+   int index = (phosphor_layout < 1 || phosphor_layout > 19) ? 0 : phosphor_layout;
+   ivec3 tile = subpixel_mask_tiles[index];
+   vec4 texel = texelFetch(subpixel_masks_lut, ivec2(coord) % tile.xy + ivec2(0, tile.z), 0);
+   return texel.a * mix(vec3(1. - mask_intensity), vec3(1.), texel.rgb);
+}
+
+#else
+
 vec3 mask_weights(vec2 coord, float mask_intensity, int phosphor_layout){
    vec3 weights = vec3(0.,0.,0.);
    float intens = 1.;
@@ -244,4 +296,6 @@ vec3 mask_weights(vec2 coord, float mask_intensity, int phosphor_layout){
    }
 
    return weights;
-}
\ No newline at end of file
+}
+
+#endif // SUBPIXEL_MASKS_USE_LUT
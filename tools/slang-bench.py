@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Headless per-pass benchmark of presets on Mesa's lavapipe.
+
+Usage: slang-bench.py [--runner CMD] [--content WxH,...] [--viewport WxH]
+                      [--frames N] [--json FILE] [--baseline FILE]
+                      [--tolerance PCT] [--plan] PRESET...
+
+For every preset and content resolution the harness resolves the chain,
+synthesizes the input frames (a scrolling test pattern, so OriginalHistoryN
+and feedback passes see real motion) and hands a job to the runner, which
+renders the frames and reports how long each pass took.  The runner is
+slang-runner.py unless --runner or $SLANG_RUNNER names another Vulkan filter
+chain host; the harness forces it onto lavapipe through
+VK_ICD_FILENAMES/VK_DRIVER_FILES so results do not depend on the machine's GPU.
+
+The job and result formats are described in slangtools/runner.py.
+
+--plan only prints the resolved chain and needs no runner.  --baseline compares
+the total ns/frame against an earlier --json report and fails if any preset got
+slower by more than --tolerance percent.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import chain, preset, runner, source
+
+DEFAULT_CONTENT = "256x224,320x240,640x480"
+INPUT_FRAMES = 4
+
+
+def _size(text):
+    w, _, h = text.lower().partition("x")
+    return int(w), int(h)
+
+
+def compare(results, baseline, tolerance):
+    old = dict(((r["preset"], tuple(r["content"])), r["total_ns"]) for r in baseline)
+    regressions = 0
+    for r in results:
+        before = old.get((r["preset"], tuple(r["content"])))
+        if not before:
+            continue
+        change = 100.0 * (r["total_ns"] - before) / before
+        if change > tolerance:
+            regressions += 1
+            print("REGRESSION %s %dx%d: %.0f -> %.0f ns/frame (%+.1f%%)"
+                  % (r["preset"], r["content"][0], r["content"][1],
+                     before, r["total_ns"], change))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("presets", nargs="+", metavar="PRESET")
+    parser.add_argument("--runner", default=os.environ.get(runner.ENV, runner.DEFAULT))
+    parser.add_argument("--bundles", help="directory of .slangpb bundles to pass on")
+    parser.add_argument("--content", default=DEFAULT_CONTENT)
+    parser.add_argument("--viewport", default="1920x1080", type=_size)
+    parser.add_argument("--frames", type=int, default=300)
+    parser.add_argument("--warmup", type=int, default=30)
+    parser.add_argument("--json", help="write the results to this file")
+    parser.add_argument("--baseline", help="earlier --json report to compare to")
+    parser.add_argument("--tolerance", type=float, default=5.0)
+    parser.add_argument("--any-device", action="store_true",
+                        help="do not force lavapipe")
+    parser.add_argument("--plan", action="store_true",
+                        help="print the resolved chains without running them")
+    args = parser.parse_args()
+    contents = [_size(c) for c in args.content.split(",")]
+
+    env = None
+    if not args.plan:
+        try:
+            env = runner.environment(not args.any_device)
+        except runner.RunnerError as e:
+            parser.error("%s, or pass --any-device" % e)
+
+    tmp = tempfile.mkdtemp(prefix="slang-bench-")
+    shaders = {}
+    results = []
+    failed = 0
+    for content in contents:
+        inputs = []
+        if not args.plan:
+            inputs = runner.write_inputs(tmp, content, INPUT_FRAMES)
+
+        for path in args.presets:
+            try:
+                plans = chain.plan(preset.load(path), content, args.viewport, shaders)
+            except (preset.PresetError, source.SourceError, chain.ChainError) as e:
+                sys.stderr.write("%s: %s\n" % (path, e))
+                failed += 1
+                continue
+            if args.plan:
+                print("%s @ %dx%d" % ((path,) + content))
+                for pp in plans:
+                    print("  pass %-2d %5dx%-5d %-20s %s" % (
+                        (pp.index,) + pp.output_size +
+                        (pp.format, os.path.relpath(pp.shader.path))))
+                continue
+
+            bundle = None
+            if args.bundles:
+                bundle = os.path.join(args.bundles, os.path.relpath(path) + "b")
+            job = runner.job(path, plans, content, args.viewport, inputs,
+                             args.frames, args.warmup, bundle)
+            try:
+                result = runner.run(args.runner, job, env)
+            except runner.RunnerError as e:
+                sys.stderr.write("%s @ %dx%d: %s\n" % ((path,) + content + (e,)))
+                failed += 1
+                continue
+
+            passes = [p["ns"] for p in result["passes"]]
+            results.append({
+                "preset": os.path.relpath(path),
+                "content": list(content),
+                "viewport": list(args.viewport),
+                "device": result.get("device"),
+                "passes": passes,
+                "total_ns": sum(passes),
+            })
+            print("%s @ %dx%d: %.0f ns/frame" % ((path,) + content + (sum(passes),)))
+            for pp, ns in zip(plans, passes):
+                print("  pass %-2d %5dx%-5d %12.0f ns  %s" % (
+                    (pp.index,) + pp.output_size +
+                    (ns, os.path.basename(pp.shader.path))))
+
+    shutil.rmtree(tmp)
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=1, sort_keys=True)
+    if args.baseline:
+        with open(args.baseline) as f:
+            failed += compare(results, json.load(f), args.tolerance)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Generates the blurs/ variant family from tools/blur-variants.txt.
+
+Usage: slang-blurgen.py generate [--check]
+       slang-blurgen.py presets --out DIR
+       slang-blurgen.py coverage BENCH.json...
+
+generate writes every variant the table lists into blurs/ (see
+slangtools/blurgen.py for the table); --check only reports variants which
+are missing or differ from what the table generates, and blurs/blurN*.slang
+files the table does not list.  presets writes a one pass benchmark preset
+per variant into DIR for slang-bench.py, along with the shaders of the
+variants the table marks bench.  coverage reads slang-bench.py
+--json reports and prints which variants have been timed, as a matrix of
+kernels against pass positions: x timed, . generated but never timed.
+"""
+
+import argparse
+import glob
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import blurgen, preset
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+TABLE = os.path.join(TOOLS, "blur-variants.txt")
+BLURS = os.path.join(ROOT, "blurs")
+INCLUDE = os.path.join(ROOT, "include")
+HEADER = os.path.join(INCLUDE, "blur-functions.h")
+
+
+def generate(vs, check):
+    stale = 0
+    vs = [v for v in vs if not v.bench]
+    for v in vs:
+        path = os.path.join(BLURS, v.name)
+        text = v.render()
+        try:
+            with open(path, "r", newline="") as f:
+                current = f.read()
+        except IOError:
+            current = None
+        if current == text:
+            continue
+        stale += 1
+        if check:
+            print("%s: %s" % (v.name, "missing" if current is None else "differs"))
+            continue
+        with open(path, "w", newline="") as f:
+            f.write(text)
+        print("wrote %s" % v.name)
+    names = set(v.name for v in vs)
+    unlisted = sorted(os.path.basename(p) for p in glob.glob(os.path.join(BLURS, "blur[0-9]*.slang"))
+                      if os.path.basename(p) not in names)
+    for name in unlisted:
+        print("%s: not in %s" % (name, os.path.relpath(TABLE)))
+    print("%d variants, %d %s, %d unlisted" % (
+        len(vs), stale, "stale" if check else "written", len(unlisted)))
+    return 1 if check and (stale or unlisted) else 0
+
+
+def presets(vs, out):
+    os.makedirs(out, exist_ok=True)
+    for v in vs:
+        path = os.path.join(out, os.path.splitext(v.name)[0] + ".slangp")
+        if v.bench:
+            shader = v.name
+            with open(os.path.join(out, shader), "w", newline="") as f:
+                f.write(v.render_at(os.path.relpath(BLURS, out), os.path.relpath(INCLUDE, out)))
+        else:
+            shader = os.path.relpath(os.path.join(BLURS, v.name), out)
+        with open(path, "w") as f:
+            f.write(blurgen.bench_preset(v, shader))
+    print("%d benchmark presets in %s" % (len(vs), out))
+    return 0
+
+
+def coverage(vs, reports):
+    timed = set()
+    for report in reports:
+        with open(report) as f:
+            results = json.load(f)
+        for r in results:
+            try:
+                p = preset.load(r["preset"])
+            except (IOError, preset.PresetError):
+                continue
+            timed.update(os.path.normpath(ps.shader) for ps in p.passes)
+    timed_names = set(os.path.basename(path) for path in timed)
+
+    rows = []
+    cells = {}
+    for v in vs:
+        key = (v.row, v.gamma)
+        if key not in cells:
+            rows.append(key)
+            cells[key] = {}
+        if v.bench:
+            tested = v.name in timed_names
+        else:
+            tested = os.path.normpath(os.path.join(BLURS, v.name)) in timed
+        cells[key][v.slot] = "x" if tested else "."
+    slots = [s for s in blurgen.SLOTS if any(s in c for c in cells.values())]
+    print("| kernel | gamma | %s |" % " | ".join(slots))
+    print("|---|---|%s" % ("---|" * len(slots)))
+    for key in rows:
+        (kernel, kind), gamma = key
+        print("| %s %s | %s | %s |" % (kernel, kind, gamma,
+                                       " | ".join(cells[key].get(s, " ") for s in slots)))
+    total = sum(len(c) for c in cells.values())
+    done = sum(1 for c in cells.values() for x in c.values() if x == "x")
+    print("\n%d of %d variants timed" % (done, total))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command")
+    gen = sub.add_parser("generate")
+    gen.add_argument("--check", action="store_true", help="only report stale variants")
+    pre = sub.add_parser("presets")
+    pre.add_argument("--out", required=True)
+    cov = sub.add_parser("coverage")
+    cov.add_argument("reports", nargs="+", metavar="BENCH.json")
+    args = parser.parse_args()
+    if not args.command:
+        parser.error("no command")
+
+    try:
+        vs = blurgen.variants(blurgen.load_table(TABLE))
+        blurgen.check_functions(vs, HEADER)
+    except (IOError, blurgen.BlurGenError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+    if args.command == "generate":
+        return generate(vs, args.check)
+    if args.command == "presets":
+        return presets(vs, args.out)
+    return coverage(vs, args.reports)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
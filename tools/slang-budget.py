@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Framebuffer memory and bandwidth budgets of presets.
+
+Usage: slang-budget.py [--input WxH] [--viewport WxH] [--max-mb MB] [-q]
+                       PRESET...
+
+Resolves every pass of each preset for the given input and viewport size
+(scale types, #pragma format, float/sRGB framebuffers, mipmap_input,
+OriginalHistoryN, feedback) and prints the bytes it allocates, writes and is
+estimated to read per frame; the model is described in
+slangtools/budget.py.  With --max-mb every preset allocating more than MB
+megabytes fails, so presets can be gated for low memory devices.  -q only
+prints the totals.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import budget, chain, preset, source
+
+
+def _size(text):
+    w, _, h = text.lower().partition("x")
+    return int(w), int(h)
+
+
+def _mb(n):
+    return "%9.2f" % (n / budget.MB)
+
+
+def report(path, b, args):
+    print("%s @ %dx%d -> %dx%d" % ((path,) + args.input + args.viewport))
+    if not args.quiet:
+        print("  pass  size          format                  alloc MB  write MB   read MB")
+        for pb in b.passes:
+            pp = pb.plan
+            print("  %4d  %-12s  %-22s %s %s %s  %s" % (
+                pp.index, "%dx%d" % pp.output_size, pp.format, _mb(pb.allocated),
+                _mb(pb.written), _mb(pb.read), " ".join(pb.notes)))
+        print("  input + %d history%s %s" % (b.history, " " * 26, _mb(b.input_allocated)))
+        print("  %d textures%s %s" % (b.textures, " " * 33, _mb(b.texture_allocated)))
+    print("  total%s %s %s %s" % (" " * 38, _mb(b.allocated), _mb(b.written), _mb(b.read)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--input", type=_size, default=(320, 240))
+    parser.add_argument("--viewport", type=_size, default=(1920, 1080))
+    parser.add_argument("--max-mb", type=float,
+                        help="fail presets allocating more than this")
+    parser.add_argument("-q", "--quiet", action="store_true")
+    parser.add_argument("presets", nargs="+", metavar="PRESET")
+    args = parser.parse_args()
+
+    failed = over = 0
+    shaders = {}
+    for path in args.presets:
+        try:
+            p = preset.load(path)
+            plans = chain.plan(p, args.input, args.viewport, shaders)
+            b = budget.compute(p, plans)
+        except (IOError, preset.PresetError, source.SourceError,
+                chain.ChainError, budget.BudgetError) as e:
+            sys.stderr.write("%s: %s\n" % (path, e))
+            failed += 1
+            continue
+        report(path, b, args)
+        if args.max_mb is not None and b.allocated > args.max_mb * budget.MB:
+            print("  OVER BUDGET: %.2f MB allocated, limit %.2f MB"
+                  % (b.allocated / budget.MB, args.max_mb))
+            over += 1
+    if args.max_mb is not None:
+        print("%d of %d presets over %.2f MB" % (over, len(args.presets), args.max_mb))
+    return 1 if failed or over else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
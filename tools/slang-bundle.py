@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Compiles .slangp presets into pre-reflected .slangpb bundles.
+
+Usage: slang-bundle.py [-j N] [--root DIR] [--cache DIR] --out DIR [PRESET...]
+
+Without PRESET arguments every .slangp below ROOT is bundled.  Every preset
+is written to OUT/<path relative to ROOT>b, e.g. crt/crt-royale.slangp becomes
+OUT/crt/crt-royale.slangpb.  Shaders shared between presets are compiled once, and with --cache only stages whose expanded
+source changed since the last run are compiled at all.  See slangtools/bundle.py for the format.
+
+Presets setting parameters_frozen get their parameters compiled in as
+constants, see slangtools/freeze.py.
+"""
+
+import argparse
+import functools
+import hashlib
+import multiprocessing
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import bundle, cache, compiler, freeze, glsl, preset, source, spirv
+
+
+def _axis(axis):
+    if axis is None:
+        return None
+    return {"type": axis.scale_type, "scale": axis.scale}
+
+
+def _key(shader):
+    return hashlib.sha256(shader.text.encode("utf-8")).hexdigest()
+
+
+def _compile(cache_dir, shader):
+    """Pool worker: compiles and reflects both stages of one shader."""
+    compile_stage = compiler.compile_stage
+    if cache_dir:
+        compile_stage = cache.Cache(cache_dir).compile_stage
+    try:
+        code = {}
+        refl = {}
+        for stage in source.STAGES:
+            code[stage] = compile_stage(shader.stages[stage], stage, shader.path)
+            refl[stage] = spirv.reflect(code[stage])
+        return _key(shader), (code["vertex"], code["fragment"], refl), None
+    except (compiler.CompileError, spirv.SpirvError) as e:
+        return _key(shader), None, str(e)
+
+
+def _meta(p, shaders, passes_, frozen, root):
+    """shaders maps paths to loaded shaders, passes_ holds the compiled ones."""
+    base = p.directory
+    passes = []
+    parameters = []
+    seen = set()
+    for ps, compiled in zip(p.passes, passes_):
+        sh = shaders[ps.shader]
+        passes.append({
+            "shader": os.path.relpath(ps.shader, root),
+            "name": sh.name,
+            "format": sh.format,
+            "alias": ps.alias,
+            "filter_linear": ps.filter_linear,
+            "wrap_mode": ps.wrap_mode,
+            "mipmap_input": ps.mipmap_input,
+            "float_framebuffer": ps.float_framebuffer,
+            "srgb_framebuffer": ps.srgb_framebuffer,
+            "frame_count_mod": ps.frame_count_mod,
+            "scale_x": _axis(ps.scale_x),
+            "scale_y": _axis(ps.scale_y),
+            "source_hash": _key(compiled),
+        })
+        for param in sh.parameters:
+            if param.name in seen:
+                continue
+            seen.add(param.name)
+            parameters.append({
+                "name": param.name,
+                "desc": param.desc,
+                "initial": param.initial,
+                "minimum": param.minimum,
+                "maximum": param.maximum,
+                "step": param.step,
+                "value": p.parameters.get(param.name, param.initial),
+                "frozen": param.name in frozen,
+            })
+    textures = [{
+        "name": t.name,
+        "path": os.path.relpath(t.path, base),
+        "linear": t.linear,
+        "mipmap": t.mipmap,
+        "wrap_mode": t.wrap_mode,
+    } for t in p.textures]
+    return {"passes": passes, "textures": textures, "parameters": parameters}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("presets", nargs="*", metavar="PRESET")
+    parser.add_argument("--out", required=True, help="output directory")
+    parser.add_argument("--root", default=".",
+                        help="tree the preset paths are made relative to")
+    parser.add_argument("--cache", help="SPIR-V cache directory, see slang-cache.py")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    args = parser.parse_args()
+
+    root = os.path.abspath(args.root)
+    if not args.presets:
+        args.presets = list(preset.find_presets(root))
+    failed = 0
+    presets = []
+    shaders = {}
+    jobs = {}
+    for path in args.presets:
+        try:
+            p = preset.load(path)
+            for ps in p.passes:
+                if ps.shader not in shaders:
+                    shaders[ps.shader] = source.load(ps.shader)
+            loaded = [shaders[ps.shader] for ps in p.passes]
+            frozen = freeze.values(p, loaded)
+            variants = [freeze.freeze(sh, frozen) for sh in loaded]
+            for sh in variants:
+                jobs[_key(sh)] = sh
+            presets.append((p, variants, frozen))
+        except (preset.PresetError, source.SourceError, freeze.FreezeError,
+                glsl.GlslError) as e:
+            sys.stderr.write("%s: %s\n" % (path, e))
+            failed += 1
+
+    compiled = {}
+    with multiprocessing.Pool(max(1, args.jobs)) as pool:
+        for key, result, error in pool.imap_unordered(
+                functools.partial(_compile, args.cache), jobs.values()):
+            if error:
+                sys.stderr.write("%s\n" % error)
+            compiled[key] = result
+
+    for p, variants, frozen in presets:
+        passes = [compiled[_key(sh)] for sh in variants]
+        if None in passes:
+            sys.stderr.write("%s: not bundled, a shader failed to compile\n" % p.path)
+            failed += 1
+            continue
+        rel = os.path.relpath(os.path.abspath(p.path), root)
+        out = os.path.join(args.out, rel + "b")
+        os.makedirs(os.path.dirname(out), exist_ok=True)
+        bundle.write(out, _meta(p, shaders, variants, frozen, root), passes)
+
+    print("%d bundles written, %d failed" % (len(args.presets) - failed, failed))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
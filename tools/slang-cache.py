@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Content addressed SPIR-V cache for the shader tree.
+
+Usage: slang-cache.py [--cache DIR] build [-j N] [PRESET|SHADER...]
+       slang-cache.py [--cache DIR] stats [-v] [PRESET|SHADER...]
+
+build compiles every stage whose expanded source is not cached yet.  stats
+reports, per top level directory and for the whole tree, how many stages would
+be served from the cache.  Without arguments both operate on every shader
+referenced by a preset below the current directory.
+"""
+
+import argparse
+import multiprocessing
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import cache, compiler, preset, source
+
+
+def _shader_paths(args):
+    paths, errors = preset.shader_paths(args)
+    for e in errors:
+        sys.stderr.write("%s\n" % e)
+    return paths
+
+
+def _load(paths):
+    shaders = []
+    for path in paths:
+        try:
+            shaders.append(source.load(path))
+        except source.SourceError as e:
+            sys.stderr.write("%s\n" % e)
+    return shaders
+
+
+def _build_one(job):
+    directory, shader = job
+    c = cache.Cache(directory)
+    errors = []
+    for stage in source.STAGES:
+        try:
+            c.compile_stage(shader.stages[stage], stage, shader.path)
+        except compiler.CompileError as e:
+            errors.append(str(e))
+    return c.hits, c.misses, errors
+
+
+def build(args):
+    shaders = _load(_shader_paths(args.paths))
+    hits = misses = failed = 0
+    with multiprocessing.Pool(max(1, args.jobs)) as pool:
+        jobs = [(args.cache, s) for s in shaders]
+        for h, m, errors in pool.imap_unordered(_build_one, jobs):
+            hits += h
+            misses += m
+            failed += len(errors)
+            for e in errors:
+                sys.stderr.write("%s\n" % e)
+    print("%d stages: %d cached, %d compiled, %d failed"
+          % (hits + misses, hits, misses - failed, failed))
+    return 1 if failed else 0
+
+
+def _percent(n, total):
+    return 100.0 * n / total if total else 100.0
+
+
+def stats(args):
+    c = cache.Cache(args.cache)
+    groups = {}
+    unique = {}
+    for shader in _load(_shader_paths(args.paths)):
+        group = os.path.relpath(shader.path).split(os.sep)[0]
+        for stage in source.STAGES:
+            key = c.key(stage, shader.stages[stage])
+            hit = os.path.exists(c.path(key))
+            g = groups.setdefault(group, [0, 0])
+            g[0] += hit
+            g[1] += 1
+            unique[key] = hit
+            if args.verbose and not hit:
+                print("miss  %s (%s)" % (shader.path, stage))
+
+    total = sum(g[1] for g in groups.values())
+    hits = sum(g[0] for g in groups.values())
+    for name in sorted(groups):
+        h, n = groups[name]
+        print("%-24s %5d/%-5d %6.1f%%" % (name, h, n, _percent(h, n)))
+    print("%-24s %5d/%-5d %6.1f%%" % ("total", hits, total, _percent(hits, total)))
+    u = sum(unique.values())
+    print("%d stages share %d distinct expanded sources, %d of them cached (%.1f%%)"
+          % (total, len(unique), u, _percent(u, len(unique))))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--cache", default=os.path.join("build", "cache"),
+                        help="cache directory (default: build/cache)")
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+    b = sub.add_parser("build")
+    b.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    b.add_argument("paths", nargs="*")
+    s = sub.add_parser("stats")
+    s.add_argument("-v", "--verbose", action="store_true", help="list misses")
+    s.add_argument("paths", nargs="*")
+    args = parser.parse_args()
+    return build(args) if args.command == "build" else stats(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Deduplicates an installed shader tree.
+
+Usage: slang-dedup.py [--min-body BYTES] [--source DIR] INSTALLDIR
+       slang-dedup.py --check [--source DIR] INSTALLDIR
+
+Rewrites the variant families under INSTALLDIR, files that only differ in the
+macros they #define, as define stubs that #include one shared <stem>.inc body,
+then hardlinks files with identical contents (see slangtools/dedup.py).
+Families whose body would be shorter than --min-body bytes stay as they are.
+Every installed file is then checked against the tree in --source (the
+current directory by default): with its body put back it must be byte for
+byte the original.  --check only runs that verification.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import dedup
+
+
+def _mb(n):
+    return "%.2f MB" % (n / (1024.0 * 1024.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("root", metavar="INSTALLDIR")
+    parser.add_argument("--source", default=".", help="the tree INSTALLDIR was copied from")
+    parser.add_argument("--min-body", type=int, default=dedup.MIN_BODY)
+    parser.add_argument("--check", action="store_true", help="only verify")
+    args = parser.parse_args()
+
+    if not os.path.isdir(args.root):
+        sys.stderr.write("%s: not a directory\n" % args.root)
+        return 1
+    if not args.check:
+        before, files = dedup.size(args.root)
+        try:
+            stats = dedup.dedup(args.root, args.min_body)
+        except (IOError, OSError, dedup.DedupError) as e:
+            sys.stderr.write("%s\n" % e)
+            return 1
+        after, inodes = dedup.size(args.root)
+        print("%d stubs over %d bodies, %d hardlinks: %d files in %s -> %d in %s"
+              % (stats.stubs, stats.bodies, stats.links, files, _mb(before),
+                 inodes, _mb(after)))
+
+    errors = dedup.verify(args.source, args.root)
+    for e in errors:
+        sys.stderr.write("%s\n" % e)
+    print("%s: %s" % (args.root, "%d files differ" % len(errors) if errors else "verified"))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""Writes static copies of presets with their parameters compiled in.
+
+Usage: slang-freeze.py [--all] --out DIR PRESET...
+
+Frontends do not know parameters_frozen, so presets meant to ship with it are
+turned into plain presets here: every shader with a frozen parameter is
+written, includes expanded, to DIR/<preset path>/passN.slang with the
+parameter replaced by its value (see slangtools/freeze.py), and the preset
+to DIR/<preset path>.slangp.  --all freezes every parameter of presets which
+do not set parameters_frozen themselves.  slang-bundle.py applies the same
+rewrite when building bundles.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import freeze, glsl, preset, source
+
+
+def freeze_preset(path, out, force):
+    p = preset.load(path)
+    if force and p.option(freeze.OPTION) is None:
+        p.conf[freeze.OPTION] = "true"
+    shaders = [source.load(ps.shader) for ps in p.passes]
+    frozen = freeze.values(p, shaders)
+
+    target = os.path.join(out, os.path.relpath(path))
+    stem = os.path.splitext(target)[0]
+    directory = os.path.dirname(target)
+    os.makedirs(directory, exist_ok=True)
+    conf = preset.relocated(p, directory)
+    for ps, sh in zip(p.passes, shaders):
+        frozen_sh = freeze.freeze(sh, frozen)
+        if frozen_sh is sh:
+            continue
+        os.makedirs(stem, exist_ok=True)
+        shader = os.path.join(stem, "pass%d.slang" % ps.index)
+        version, _, rest = frozen_sh.text.partition("\n")
+        with open(shader, "w") as f:
+            f.write("%s\n\n// Generated by tools/slang-freeze.py from\n//   %s\n"
+                    "// See that file and its includes for authorship and license "
+                    "terms.\n%s" % (version, os.path.relpath(sh.path), rest))
+        conf["shader%d" % ps.index] = os.path.relpath(shader, directory)
+
+    conf.pop(freeze.OPTION, None)
+    names = [n for n in conf.get("parameters", "").split(";") if n and n not in frozen]
+    for name in frozen:
+        conf.pop(name, None)
+    if names:
+        conf["parameters"] = ";".join(names)
+    else:
+        conf.pop("parameters", None)
+    preset.write(target, conf)
+    return target, len(frozen)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--out", required=True)
+    parser.add_argument("--all", action="store_true",
+                        help="freeze every parameter unless the preset says otherwise")
+    parser.add_argument("presets", nargs="+", metavar="PRESET")
+    args = parser.parse_args()
+
+    failed = 0
+    for path in args.presets:
+        try:
+            target, count = freeze_preset(path, args.out, args.all)
+        except (IOError, preset.PresetError, source.SourceError,
+                freeze.FreezeError, glsl.GlslError) as e:
+            sys.stderr.write("%s: %s\n" % (path, e))
+            failed += 1
+            continue
+        print("%s: %d parameters frozen -> %s" % (path, count, target))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Pass fusion for presets.
+
+Usage: slang-fuse.py [--max-taps N] [--check] [--out DIR] PRESET...
+
+Folds every pass that renders 1:1 and only transforms the texel under it
+(colour conversion, gamma, simple grading) into the pass after it, so the
+intermediate framebuffer is never written or read.  Without --out the
+fusable pairs and the reason every other pair was refused are reported.  With
+--out the fused shaders and rewritten presets are written to
+DIR/<preset path>.slangp and DIR/<preset path>/passN.slang.
+
+A pair is only fused when the consumer reads Source with filter_linear =
+false and no mipmaps, nothing else reads the producer (aliases, feedback,
+PassOutputN) and both shaders fit the shape slangtools/fuse.py understands.
+The consumer may sample Source up to --max-taps times (1); the producer is
+then evaluated once per tap.  --check compiles both stages of every fused
+shader with glslangValidator and fails if one does not compile; the output
+still needs checking against the original with slang-golden.py.
+"""
+
+import argparse
+import os
+import shutil
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import chain, compiler, fuse, glsl, preset, source
+
+# Sizes only matter for scale checks, which are size independent here.
+CONTENT = (320, 240)
+VIEWPORT = (640, 480)
+
+
+def fuse_preset(path, tmp, max_taps):
+    """Fuses what it can.  Returns (report lines, conf, {index: text})."""
+    p = preset.load(path)
+    conf = preset.relocated(p)
+    origins = [[i] for i in range(len(p.passes))]
+    texts = {}
+    report = []
+    current = path
+    i = 0
+    count = 0
+    while True:
+        p = preset.load(current)
+        plans = chain.plan(p, CONTENT, VIEWPORT)
+        if i >= len(plans) - 1:
+            break
+        label = "passes %s + %s" % ("+".join(map(str, origins[i])),
+                                    "+".join(map(str, origins[i + 1])))
+        try:
+            fuse.check_pair(plans, i)
+            a = fuse.Stage(plans[i], [os.path.relpath(plans[i].pass_.shader)])
+            b = fuse.Stage(plans[i + 1], [os.path.relpath(plans[i + 1].pass_.shader)])
+            if i in texts:
+                a.origin = texts[i][1]
+            if i + 1 in texts:
+                b.origin = texts[i + 1][1]
+            text = fuse.fuse_sources(a, b, "fused_pass%d" % origins[i][-1], max_taps)
+        except (fuse.FuseError, glsl.GlslError) as e:
+            report.append("  %s: %s" % (label, e))
+            i += 1
+            continue
+        report.append("  %s: fused" % label)
+
+        count += 1
+        shader = os.path.join(tmp, "fused%d.slang" % count)
+        with open(shader, "w") as f:
+            f.write(text)
+        conf = fuse.renumber(conf, i)
+        conf["shader%d" % i] = shader
+        origins[i:i + 2] = [origins[i] + origins[i + 1]]
+        texts = dict((n - 1 if n > i else n, t) for n, t in texts.items() if n != i)
+        texts[i] = (text, a.origin + b.origin)
+        current = os.path.join(tmp, "preset%d.slangp" % count)
+        preset.write(current, conf)
+        # The merged pass may fold into the next one as well.
+    return report, conf, dict((n, t[0]) for n, t in texts.items())
+
+
+def compile_errors(text, tmp, name):
+    """Compiles both stages of a fused shader.  Returns the compiler logs."""
+    shader = os.path.join(tmp, "check.slang")
+    with open(shader, "w") as f:
+        f.write(text)
+    errors = []
+    try:
+        loaded = source.load(shader)
+        for stage in source.STAGES:
+            compiler.compile_stage(loaded.stages[stage], stage, name)
+    except (source.SourceError, compiler.CompileError) as e:
+        errors.append(str(e))
+    return errors
+
+
+def write_output(path, out, conf, texts):
+    target = os.path.join(out, os.path.relpath(path))
+    stem = os.path.splitext(target)[0]
+    directory = os.path.dirname(target)
+    os.makedirs(directory, exist_ok=True)
+    if texts:
+        os.makedirs(stem, exist_ok=True)
+    conf = dict(conf)
+    for key in list(conf):
+        value = conf[key]
+        if os.path.isabs(value):
+            conf[key] = os.path.relpath(value, directory)
+    for n, text in texts.items():
+        shader = os.path.join(stem, "pass%d.slang" % n)
+        with open(shader, "w") as f:
+            f.write(text)
+        conf["shader%d" % n] = os.path.relpath(shader, directory)
+    preset.write(target, conf)
+    return target
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--max-taps", type=int, default=1,
+                        help="texture(Source) calls allowed in the consumer")
+    parser.add_argument("--out", help="write fused presets below DIR")
+    parser.add_argument("--check", action="store_true",
+                        help="compile every fused shader")
+    parser.add_argument("presets", nargs="+", metavar="PRESET")
+    args = parser.parse_args()
+
+    failed = fused = broken = 0
+    tmp = tempfile.mkdtemp(prefix="slang-fuse-")
+    try:
+        for path in args.presets:
+            try:
+                report, conf, texts = fuse_preset(path, tmp, args.max_taps)
+            except (IOError, preset.PresetError, source.SourceError,
+                    chain.ChainError) as e:
+                sys.stderr.write("%s: %s\n" % (path, e))
+                failed += 1
+                continue
+            print(path)
+            for line in report:
+                print(line)
+            fused += len(texts)
+            for n, text in sorted(texts.items()) if args.check else ():
+                for error in compile_errors(text, tmp, "fused pass %d" % n):
+                    print("  %s" % error)
+                    broken += 1
+            if args.out:
+                print("  -> %s" % write_output(path, args.out, conf, texts))
+    finally:
+        shutil.rmtree(tmp)
+    print("%d fused passes, %d presets failed to load" % (fused, failed))
+    if args.check:
+        print("%d fused passes do not compile" % broken)
+    return 1 if failed or broken else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Finds and removes per-tap pow() calls in gamma-managed presets.
+
+Usage: slang-gamma.py check [PRESET...]
+       slang-gamma.py rewrite [--exact-pow] --out DIR PRESET...
+       slang-gamma.py fit
+
+check lists, for every preset (default: all below the current directory),
+the passes that decode their input with pow() on every texture tap, and
+which boundaries between GAMMA_ENCODE_EVERY_FBO passes could be stored
+linear in an sRGB framebuffer instead, or why not (see
+slangtools/gamma.py).  It exits 1 if any boundary could.
+
+rewrite writes copies of the presets the way slang-freeze.py does: every
+changed shader, includes expanded, to DIR/<preset path>/passN.slang with
+GAMMA_LINEAR_INPUT/GAMMA_LINEAR_OUTPUT #defined, and the preset, with
+srgb_framebufferN set, to DIR/<preset path>.slangp.  Passes that still
+decode per tap with static gammas get GAMMA_FAST_POW unless --exact-pow
+is given.
+
+fit prints the GAMMA_FAST_POW coefficients gamma-management.h uses and
+their error.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import chain, gamma, preset, source
+
+
+def check(paths):
+    found = 0
+    for path in paths:
+        try:
+            passes, boundaries = gamma.analyze(preset.load(path))
+        except (IOError, preset.PresetError, source.SourceError, chain.ChainError) as e:
+            print("%s: %s" % (path, e))
+            continue
+        decoding = [pg.index for pg in passes if pg.decodes]
+        if not decoding and not boundaries:
+            continue
+        print(path)
+        for pg in passes:
+            if pg.decodes:
+                fast = ""
+                if not pg.static_gamma:
+                    fast = " (runtime gamma)"
+                elif pg.defined("GAMMA_FAST_POW"):
+                    fast = " (GAMMA_FAST_POW)"
+                print("  pass %d: pow() per tap%s" % (pg.index, fast))
+        for b in boundaries:
+            if b.linear:
+                found += 1
+                print("  pass %d -> %d: can be stored linear" % (b.upstream.index, b.index))
+            else:
+                print("  pass %d -> %d: %s" % (b.upstream.index, b.index, b.reason))
+    print("%d boundaries can be stored linear" % found)
+    return 1 if found else 0
+
+
+def rewrite_preset(path, out, fast_pow):
+    p = preset.load(path)
+    passes, boundaries = gamma.analyze(p)
+    keys, defines = gamma.rewrite(p, passes, boundaries, fast_pow)
+
+    target = os.path.join(out, os.path.relpath(path))
+    stem = os.path.splitext(target)[0]
+    directory = os.path.dirname(target)
+    os.makedirs(directory, exist_ok=True)
+    conf = preset.relocated(p, directory)
+    conf.update(keys)
+    for pg in passes:
+        if pg.index not in defines:
+            continue
+        os.makedirs(stem, exist_ok=True)
+        shader = os.path.join(stem, "pass%d.slang" % pg.index)
+        with open(shader, "w") as f:
+            f.write(gamma.add_defines(pg.plan.shader.text, defines[pg.index]))
+        conf["shader%d" % pg.index] = os.path.relpath(shader, directory)
+    preset.write(target, conf)
+    linear = sum(1 for b in boundaries if b.linear)
+    return target, linear, len(defines)
+
+
+def fit():
+    for g in gamma.FAST_POW_GAMMAS:
+        c = gamma.fit_decode(g)
+        print("%-5g float4(%s)  max %.3f steps" % (
+            g, ", ".join("%.8f" % (round(x, 8) + 0.0) for x in c), gamma.decode_error(g, c)))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command")
+    chk = sub.add_parser("check")
+    chk.add_argument("presets", nargs="*", metavar="PRESET")
+    rew = sub.add_parser("rewrite")
+    rew.add_argument("--out", required=True)
+    rew.add_argument("--exact-pow", action="store_true",
+                     help="do not add GAMMA_FAST_POW to passes still decoding per tap")
+    rew.add_argument("presets", nargs="+", metavar="PRESET")
+    sub.add_parser("fit")
+    args = parser.parse_args()
+    if not args.command:
+        parser.error("no command")
+
+    if args.command == "check":
+        return check(args.presets or list(preset.find_presets(".")))
+    if args.command == "fit":
+        return fit()
+    failed = 0
+    for path in args.presets:
+        try:
+            target, linear, changed = rewrite_preset(path, args.out, not args.exact_pow)
+        except (IOError, preset.PresetError, source.SourceError, chain.ChainError) as e:
+            sys.stderr.write("%s: %s\n" % (path, e))
+            failed += 1
+            continue
+        print("%s: %d boundaries linear, %d shaders changed -> %s"
+              % (path, linear, changed, target))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
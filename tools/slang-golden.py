@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Golden image regression tests for presets.
+
+Usage: slang-golden.py render [options] --out DIR PRESET...
+       slang-golden.py check [options] [--min-psnr DB] [--max-abs N]
+                             --golden DIR PRESET...
+       slang-golden.py diff [--min-psnr DB] [--max-abs N] A B
+
+render runs every preset frame by frame on lavapipe and dumps the output of
+every pass to DIR/<preset path without .slangp>/frame<F>-pass<N>.png.  The
+filter chain semantics (scale types, FrameCount with frame_count_mod,
+OriginalHistoryN, PassFeedbackN, aliases) are resolved here by
+slangtools/chain.py and handed to the runner as an explicit per-frame binding
+schedule, so every runner is held to the same reading of spec/SHADER_SPEC.md;
+the runner only executes the SPIR-V.  Dumps are checked against the pass sizes
+the chain resolved.
+
+check renders into a temporary directory and compares against a golden tree
+made by render.  A pass fails if its PSNR drops below --min-psnr or any
+channel is off by more than --max-abs (in 1/255 steps).  diff compares two
+dump trees or two images directly and needs no runner.
+
+Options: --runner CMD (or $SLANG_RUNNER, slang-runner.py by default),
+--frames N (8), --content WxH (320x240), --viewport WxH (640x480), -j N,
+--any-device.
+"""
+
+import argparse
+import concurrent.futures
+import multiprocessing
+import os
+import shutil
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import chain, imagediff, png, preset, runner, source
+
+INPUT_FRAMES = 4
+
+
+def _size(text):
+    w, _, h = text.lower().partition("x")
+    return int(w), int(h)
+
+
+def _dump_dir(out, path):
+    return os.path.join(out, os.path.splitext(os.path.relpath(path))[0])
+
+
+def render_one(args, env, tmp, path, out):
+    """Renders one preset into out.  Returns a list of error strings."""
+    try:
+        p = preset.load(path)
+        plans = chain.plan(p, args.content, args.viewport)
+        sched = [chain.schedule(plans, p.textures, f) for f in range(args.frames)]
+    except (preset.PresetError, source.SourceError, chain.ChainError) as e:
+        return ["%s: %s" % (path, e)]
+
+    dump = _dump_dir(out, path)
+    if os.path.isdir(dump):
+        shutil.rmtree(dump)
+    os.makedirs(dump)
+    inputs = runner.write_inputs(tmp, args.content, INPUT_FRAMES)
+    job = runner.job(path, plans, args.content, args.viewport, inputs,
+                     args.frames, dump=dump, schedule=sched)
+    try:
+        runner.run(args.runner, job, env)
+    except runner.RunnerError as e:
+        return ["%s: %s" % (path, e)]
+
+    errors = []
+    for f in range(args.frames):
+        for pp in plans:
+            name = os.path.join(dump, "frame%d-pass%d.png" % (f, pp.index))
+            try:
+                img = png.read(name)
+            except (IOError, png.PngError) as e:
+                errors.append("%s: %s" % (name, e))
+                continue
+            if (img.width, img.height) != pp.output_size:
+                errors.append("%s: %dx%d, chain resolved %dx%d" % (
+                    (name, img.width, img.height) + pp.output_size))
+    return errors
+
+
+def render_all(args, out):
+    try:
+        env = runner.environment(not args.any_device)
+    except runner.RunnerError as e:
+        sys.exit("%s, or pass --any-device" % e)
+    tmp = tempfile.mkdtemp(prefix="slang-golden-")
+    # Inputs are shared between presets; write them before fanning out.
+    runner.write_inputs(tmp, args.content, INPUT_FRAMES)
+    errors = []
+    with concurrent.futures.ThreadPoolExecutor(max(1, args.jobs)) as pool:
+        futures = [pool.submit(render_one, args, env, tmp, path, out)
+                   for path in args.presets]
+        for fut in futures:
+            errors.extend(fut.result())
+    shutil.rmtree(tmp)
+    for e in errors:
+        sys.stderr.write("%s\n" % e)
+    return errors
+
+
+def _compare(pair):
+    a, b = pair
+    try:
+        return a, imagediff.compare_files(a, b), None
+    except (IOError, png.PngError, imagediff.DiffError) as e:
+        return a, None, str(e)
+
+
+def diff_trees(a, b, args):
+    """Compares every PNG below b with its counterpart below a."""
+    if os.path.isfile(b):
+        pairs = [(a, b)]
+    else:
+        pairs = []
+        for dirpath, _, filenames in os.walk(b):
+            for name in sorted(filenames):
+                if name.endswith(".png"):
+                    rel = os.path.relpath(os.path.join(dirpath, name), b)
+                    pairs.append((os.path.join(a, rel), os.path.join(b, rel)))
+    failed = 0
+    with multiprocessing.Pool(max(1, args.jobs)) as pool:
+        for name, d, error in pool.imap(_compare, sorted(pairs)):
+            if error:
+                print("FAIL  %s: %s" % (name, error))
+                failed += 1
+            elif not d.within(args.min_psnr, args.max_abs):
+                print("FAIL  %s: PSNR %.2f dB, max error %.1f, %d pixels differ"
+                      % (name, d.psnr, d.max_abs, d.differing))
+                failed += 1
+            elif args.verbose:
+                print("ok    %s: PSNR %.2f dB, max error %.1f" % (name, d.psnr, d.max_abs))
+    print("%d of %d images within tolerance" % (len(pairs) - failed, len(pairs)))
+    return failed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command")
+    sub.required = True
+    commands = {}
+    for name in ("render", "check", "diff"):
+        s = sub.add_parser(name)
+        s.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+        if name != "diff":
+            s.add_argument("presets", nargs="+", metavar="PRESET")
+            s.add_argument("--runner", default=os.environ.get(runner.ENV, runner.DEFAULT))
+            s.add_argument("--frames", type=int, default=8)
+            s.add_argument("--content", type=_size, default=(320, 240))
+            s.add_argument("--viewport", type=_size, default=(640, 480))
+            s.add_argument("--any-device", action="store_true",
+                           help="do not force lavapipe")
+        if name != "render":
+            s.add_argument("--min-psnr", type=float, default=50.0)
+            s.add_argument("--max-abs", type=float, default=2.0)
+            s.add_argument("-v", "--verbose", action="store_true")
+        commands[name] = s
+    commands["render"].add_argument("--out", required=True)
+    commands["check"].add_argument("--golden", required=True)
+    commands["diff"].add_argument("a")
+    commands["diff"].add_argument("b")
+    args = parser.parse_args()
+
+    if args.command == "diff":
+        return 1 if diff_trees(args.a, args.b, args) else 0
+    if args.command == "render":
+        return 1 if render_all(args, args.out) else 0
+
+    out = tempfile.mkdtemp(prefix="slang-golden-check-")
+    try:
+        failed = len(render_all(args, out))
+        for path in args.presets:
+            failed += diff_trees(_dump_dir(out, path), _dump_dir(args.golden, path), args)
+    finally:
+        shutil.rmtree(out)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+"""Measures what BLUR_HALF_PRECISION costs each blur, on the CPU.
+
+Usage: slang-halfprec.py [--mode MODE]... [--size N] [--image PNG]...
+                         [-j N] [KERNEL...]
+
+Every blur in include/blur-functions.h and include/blur-dual-filter.h that
+takes (tex, tex_uv, dxdy), and tex2Dblur_table with a weights table for
+sigma 1.75, is evaluated at highp (FP32) and with BLUR_HALF_PRECISION, every
+mediump operation rounded to FP16 (see slangtools/halfprec.py).  Both are
+written out the way a blur pass writes its output, and the table reports the
+largest difference in 8 bit output steps and the share of channel values that
+land on a different 8 bit value.  Modes:
+
+    encode   GAMMA_ENCODE_EVERY_FBO: decode and encode every pass with pow
+    first    FIRST_PASS into an sRGB framebuffer: decode the input with pow
+    middle   a pass between sRGB framebuffers: no pow at all
+
+The default test images are synthetic (ramps, a 1 pixel checker, noise and a
+dark ramp near black, where FP16 is coarsest relative to an 8 bit step);
+--image adds the top left corner of a PNG.  Kernels sharing samples through
+derivatives (tex2DblurNxNshared) cannot be emulated per pixel and are listed
+as skipped.  Exits 1 if a kernel fails to evaluate.
+"""
+
+import argparse
+import multiprocessing
+import os
+import random
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import halfprec, png
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+INCLUDES = ("compat_macros.inc", "blur-functions.h", "blur-dual-filter.h")
+MODES = {
+    "encode": ("GAMMA_ENCODE_EVERY_FBO", "FIRST_PASS"),
+    "first": ("FIRST_PASS",),
+    "middle": (),
+}
+TABLE_SIGMA = 1.75
+TABLE_PAIRS = 11
+
+_programs = {}
+
+
+def _srgb_decode(c):
+    return c / 12.92 if c <= 0.04045 else ((c + 0.055) / 1.055) ** 2.4
+
+
+def _srgb_encode(c):
+    c = min(max(c, 0.0), 1.0)
+    return c * 12.92 if c <= 0.0031308 else 1.055 * c ** (1.0 / 2.4) - 0.055
+
+
+def test_images(size, paths):
+    """(name, [RGBA float texels]) in [0, 1], quantized to 8 bits."""
+    def q(x):
+        return round(x * 255.0) / 255.0
+    rng = random.Random(1)
+    n = float(size - 1)
+    images = [
+        ("ramps", [(q(x / n), q(y / n), q((x + y) / (2 * n)), 1.0)
+                   for y in range(size) for x in range(size)]),
+        ("checker", [((x + y) % 2, (x + y) % 2, 1 - (x + y) % 2, 1.0)
+                     for y in range(size) for x in range(size)]),
+        ("noise", [(q(rng.random()), q(rng.random()), q(rng.random()), 1.0)
+                   for _ in range(size * size)]),
+        ("dark", [(q(0.1 * x / n), q(0.05 * y / n), q(0.02 * ((x ^ y) & 7) / 7), 1.0)
+                  for y in range(size) for x in range(size)]),
+    ]
+    for path in paths:
+        img = png.read(path)
+        if img.width < size or img.height < size:
+            raise halfprec.HalfPrecError("%s is smaller than %dx%d" % (path, size, size))
+        texels = img.normalized()
+        images.append((os.path.basename(path),
+                       [texels[y * img.width + x] for y in range(size) for x in range(size)]))
+    return images
+
+
+def program(mode, half):
+    key = (mode, half)
+    if key not in _programs:
+        defines = MODES[mode] + (("BLUR_HALF_PRECISION",) if half else ())
+        with tempfile.NamedTemporaryFile("w", suffix=".h", delete=False) as f:
+            for name in INCLUDES:
+                f.write('#include "%s"\n' % os.path.join(ROOT, "include", name))
+        try:
+            _programs[key] = halfprec.Program(f.name, defines)
+        finally:
+            os.unlink(f.name)
+    return _programs[key]
+
+
+def kernels(prog):
+    """(name, two dimensional) of the blurs to measure, and skipped names."""
+    out = []
+    skipped = []
+    for name, types in prog.signatures():
+        if not name.startswith(("tex2Dblur", "tex2Ddual_filter")):
+            continue
+        if "shared" in name:
+            if name not in skipped:
+                skipped.append(name)
+            continue
+        if types == ["sampler2D", "vec2", "vec2"]:
+            two_d = "x" in name[len("tex2Dblur"):] or name.startswith("tex2Ddual")
+            out.append((name, two_d))
+        elif name == "tex2Dblur_table" and len(types) == 4:
+            out.append((name, False))
+    return out, skipped
+
+
+def weights_table(prog):
+    texels = []
+    for i in range(TABLE_PAIRS + 1):
+        v = prog.call("get_blur_table_entry", [
+            halfprec.Val([i], None, "int"), halfprec.Val([TABLE_PAIRS], None, "int"),
+            halfprec.Val([TABLE_SIGMA], "high", "float")])
+        texels.append((v.comps[0], v.comps[1], 0.0, 0.0))
+    return halfprec.Texture(len(texels), 1, texels)
+
+
+def render(mode, half, kernel, two_d, size, texels):
+    """The stored output of kernel over texels, as flat channel lists."""
+    prog = program(mode, half)
+    if mode == "middle":
+        texels = [tuple(_srgb_decode(c) for c in t[:3]) + t[3:] for t in texels]
+    tex = halfprec.Texture(size, size, texels)
+    env = {
+        "tex": tex,
+        "tex_uv": halfprec.Val([[(x + 0.5) / size for y in range(size) for x in range(size)],
+                                [(y + 0.5) / size for y in range(size) for x in range(size)]],
+                               "high", "float"),
+        "dxdy": halfprec.Val([1.0 / size, 1.0 / size if two_d else 0.0], "high", "float"),
+    }
+    call = "%s(tex, tex_uv, dxdy)" % kernel
+    if kernel == "tex2Dblur_table":
+        env["weights"] = weights_table(prog)
+        call = "tex2Dblur_table(tex, tex_uv, dxdy, weights)"
+    out = prog.evaluate("encode_output(vec4(%s, 1.0))" % call, env)
+    channels = []
+    for c in out.comps[:3]:
+        c = c if isinstance(c, list) else [c] * (size * size)
+        channels.append([_srgb_encode(x) for x in c] if mode != "encode" else c)
+    return channels
+
+
+def measure(job):
+    kernel, two_d, mode, size, images = job
+    worst = 0.0
+    changed = 0
+    total = 0
+    try:
+        for _, texels in images:
+            full = render(mode, False, kernel, two_d, size, texels)
+            half = render(mode, True, kernel, two_d, size, texels)
+            for a, b in zip(full, half):
+                for x, y in zip(a, b):
+                    if y != y:
+                        return kernel, mode, None, None, "NaN at mediump"
+                    x = min(max(x, 0.0), 1.0)
+                    y = min(max(y, 0.0), 1.0)
+                    worst = max(worst, abs(x - y) * 255.0)
+                    changed += round(x * 255.0) != round(y * 255.0)
+                    total += 1
+    except halfprec.HalfPrecError as e:
+        return kernel, mode, None, None, str(e)
+    return kernel, mode, worst, 100.0 * changed / total, None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("kernels", nargs="*", metavar="KERNEL",
+                        help="only these functions (default: all)")
+    parser.add_argument("--mode", action="append", choices=sorted(MODES),
+                        help="gamma handling to measure (default: all three)")
+    parser.add_argument("--size", type=int, default=24, help="test image size (default 24)")
+    parser.add_argument("--image", action="append", default=[], metavar="PNG",
+                        help="also measure the top left SIZExSIZE of this PNG")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1)
+    args = parser.parse_args()
+
+    try:
+        found, skipped = kernels(program("middle", False))
+        images = test_images(args.size, args.image)
+    except (IOError, png.PngError, halfprec.HalfPrecError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+    if args.kernels:
+        unknown = set(args.kernels) - set(k for k, _ in found) - set(skipped)
+        if unknown:
+            sys.stderr.write("unknown kernels: %s\n" % ", ".join(sorted(unknown)))
+            return 1
+        found = [k for k in found if k[0] in args.kernels]
+        skipped = [k for k in skipped if k in args.kernels]
+    modes = args.mode or ["encode", "first", "middle"]
+    jobs = [(k, two_d, m, args.size, images) for k, two_d in found for m in modes]
+    if args.jobs > 1:
+        with multiprocessing.Pool(args.jobs) as pool:
+            results = pool.map(measure, jobs)
+    else:
+        results = [measure(j) for j in jobs]
+
+    failed = 0
+    print("%-24s %-7s %9s %8s" % ("kernel", "mode", "max step", "changed"))
+    for kernel, mode, worst, changed, error in results:
+        if error:
+            failed += 1
+            print("%-24s %-7s %s" % (kernel, mode, error))
+        else:
+            print("%-24s %-7s %9.3f %7.2f%%" % (kernel, mode, worst, changed))
+    for kernel in skipped:
+        print("%-24s skipped: shares samples through derivatives" % kernel)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
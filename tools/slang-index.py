@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""Builds and checks the preset index, shaders_slang.idx.
+
+Usage: slang-index.py [ROOT]
+       slang-index.py --check [IDX]
+       slang-index.py --list [IDX]
+
+Writes ROOT/shaders_slang.idx (ROOT is the current directory by default)
+listing every preset below ROOT with its passes, aliases, lookup textures and
+#pragma parameter metadata, plus the size, mtime and hash of every file
+read, so a menu can be built from one read instead of opening every preset
+and shader.  The format is described in slangtools/index.py.
+
+--check rebuilds the index from the tree next to IDX and reports every file
+whose contents changed and every entry that is missing or out of date.
+--list prints the presets as a menu would see them, from the index alone.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import index
+
+
+def _list(idx):
+    for path in idx.presets():
+        p = idx.preset(path)
+        if p.error:
+            print("%s: %s" % (path, p.error))
+            continue
+        names = [s.get("name") or os.path.basename(s.get("path") or idx.files[s["file"]][0])
+                 for s, _ in p.passes]
+        print("%s: %d passes (%s), %d parameters" % (
+            path, len(p.passes), ", ".join(names), len(p.parameters())))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("path", nargs="?", metavar="ROOT|IDX")
+    mode = parser.add_mutually_exclusive_group()
+    mode.add_argument("--check", action="store_true", help="verify IDX against its tree")
+    mode.add_argument("--list", action="store_true", help="print the presets in IDX")
+    args = parser.parse_args()
+
+    if not args.check and not args.list:
+        root = args.path or "."
+        out = os.path.join(root, index.NAME)
+        body = index.build(root)
+        index.write(out, body)
+        failed = sum(1 for e in body["presets"] if "error" in e)
+        print("%s: %d presets, %d shaders, %d files, %d bytes%s" % (
+            out, len(body["presets"]), len(body["shaders"]), len(body["files"]),
+            os.path.getsize(out), ", %d presets failed to load" % failed if failed else ""))
+        return 0
+
+    path = args.path or index.NAME
+    try:
+        idx = index.Index(path)
+    except (IOError, index.IndexFormatError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+    if args.list:
+        _list(idx)
+        return 0
+    errors = index.check(idx)
+    for e in errors:
+        sys.stderr.write("%s\n" % e)
+    print("%s: %s" % (path, "%d differences" % len(errors) if errors else "up to date"))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""Push constant / UBO split for the shaders of the tree.
+
+Usage: slang-layout.py [--cache DIR] [--textual] [--write] [-v] [PRESET|SHADER...]
+
+For every shader the members the fragment stage reads are packed into the
+128 byte push constant block, hottest first, and the MVP and everything else
+into the UBO (see slangtools/layout.py).  The report lists the shaders whose
+blocks differ from that, e.g. because they leave push constant space unused
+while the fragment stage reads the UBO; -v lists every shader.
+
+--write rewrites the block declarations and the accesses of moved members
+in place.  Only blocks declared in the .slang itself are rewritten, and only
+when no include accesses a moved member; blocks in shared headers such as
+crt-royale's bind-shader-params.h are reported but left alone.  Member use is
+reflected from SPIR-V when glslangValidator is available, unless --textual.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import cache, compiler, glsl, layout, preset, source
+
+
+def _shader_paths(args):
+    paths, errors = preset.shader_paths(args)
+    for e in errors:
+        sys.stderr.write("%s\n" % e)
+    return paths
+
+
+def _blocks(text):
+    ubo = push = None
+    for blk in glsl.blocks(text):
+        if blk.push_constant:
+            push = blk
+        else:
+            ubo = blk
+    return ubo, push
+
+
+def _rewrite(path, shader, result):
+    """The rewritten text of path, or None with a reason."""
+    with open(path, "r", encoding="utf-8", newline="") as f:
+        text = f.read()
+    ubo, push = _blocks(glsl.blank_comments(text))
+    if ubo is None or (result.push is not None and push is None):
+        return None, "blocks are declared in an include"
+    instances = set([ubo.instance] + ([push.instance] if push else []))
+    for inst in instances:
+        if re.search(r'^[ \t]*#[ \t]*define[ \t]+\w+[ \t]+%s[ \t]*$' % inst, shader.text, re.M):
+            return None, "'%s' is aliased by a macro" % inst
+    moved = result.moved()
+    push_inst = push.instance if push else "params"
+    if push is None and re.search(r'\bparams\b', shader.text):
+        push_inst = "push"
+    old = dict((n, ubo.instance if where == "push" else push_inst)
+               for n, where in moved.items())
+    new = dict((n, push_inst if where == "push" else ubo.instance)
+               for n, where in moved.items())
+    for inc in shader.includes[1:]:
+        with open(inc, "r", encoding="utf-8", errors="replace") as f:
+            inc_text = glsl.strip_comments(f.read())
+        for n, inst in old.items():
+            if re.search(r'\b%s\s*\.\s*%s\b' % (inst, n), inc_text):
+                return None, "%s accesses %s.%s" % (inc, inst, n)
+
+    text = re.sub(r'\b(\w+)(\s*\.\s*)(\w+)\b',
+                  lambda m: (new[m.group(3)] + m.group(2) + m.group(3)
+                             if old.get(m.group(3)) == m.group(1) else m.group(0)),
+                  text)
+    ubo, push = _blocks(glsl.blank_comments(text))
+    # Match the file's line endings and member indentation.
+    nl = "\r\n" if "\r\n" in text else "\n"
+    m = re.search(r'\{[ \t]*\r?\n([ \t]*)\w', text[ubo.span[0]:ubo.span[1]])
+    indent = m.group(1) if m else "\t"
+    edits = []
+    ubo.members = result.ubo_members
+    edits.append((ubo.span, ubo.declaration(indent, nl).rstrip(nl)))
+    if push is not None and result.push_members:
+        push.members = result.push_members
+        edits.append((push.span, push.declaration(indent, nl).rstrip(nl)))
+    elif push is not None:
+        edits.append((push.span, ""))
+    elif result.push_members:
+        push = glsl.Block("push_constant", "Push", push_inst, result.push_members)
+        edits.append(((ubo.span[0], ubo.span[0]), push.declaration(indent, nl) + nl))
+    for (start, end), replacement in sorted(edits, reverse=True):
+        text = text[:start] + replacement + text[end:]
+    return text, None
+
+
+def _check(path):
+    """Reloads a rewritten shader and checks every access hits its block."""
+    reloaded = source.load(path)
+    text = glsl.strip_comments(reloaded.text)
+    blocks = dict((b.instance, set(n for _, n in b.members)) for b in glsl.blocks(text))
+    for inst, name in re.findall(r'\b(\w+)\s*\.\s*(\w+)\b', text):
+        if inst in blocks and name not in blocks[inst]:
+            return "%s.%s no longer resolves" % (inst, name)
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("paths", nargs="*", metavar="PRESET|SHADER")
+    parser.add_argument("--cache", help="SPIR-V cache directory, see slang-cache.py")
+    parser.add_argument("--textual", action="store_true",
+                        help="approximate member use from the source")
+    parser.add_argument("--write", action="store_true", help="rewrite the shaders")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    args = parser.parse_args()
+
+    reflect = not args.textual and compiler.version() != ""
+    compile_stage = compiler.compile_stage
+    if args.cache:
+        compile_stage = cache.Cache(args.cache).compile_stage
+    if not reflect and not args.textual:
+        sys.stderr.write("%s not available, approximating member use from the "
+                         "source\n" % compiler.GLSLANG)
+
+    changed = written = failed = 0
+    for path in _shader_paths(args.paths):
+        try:
+            shader = source.load(path)
+            ubo, push = _blocks(glsl.strip_comments(shader.text))
+            instances = [b.instance for b in (ubo, push) if b]
+            if reflect:
+                usage = layout.spirv_usage(shader, instances, compile_stage)
+            else:
+                usage = layout.textual_usage(shader, instances)
+            result = layout.plan(ubo, push, usage)
+        except (source.SourceError, glsl.GlslError, layout.LayoutError,
+                compiler.CompileError) as e:
+            sys.stderr.write("%s: %s\n" % (path, e))
+            failed += 1
+            continue
+        if not result.changed:
+            if args.verbose:
+                print("%s: push %d/%d bytes, optimal" % (
+                    path, result.push_bytes, layout.PUSH_CONSTANT_LIMIT))
+            continue
+        changed += 1
+        moved = result.moved()
+        to_push = sorted(n for n, w in moved.items() if w == "push")
+        to_ubo = sorted(n for n, w in moved.items() if w == "ubo")
+        print("%s: push %d -> %d/%d bytes, %d members to push, %d to UBO" % (
+            path, result.push_bytes, result.new_push_bytes,
+            layout.PUSH_CONSTANT_LIMIT, len(to_push), len(to_ubo)))
+        if args.verbose:
+            print("  to push: %s\n  to UBO: %s" % (" ".join(to_push) or "-",
+                                                   " ".join(to_ubo) or "-"))
+        if not args.write:
+            continue
+        text, reason = _rewrite(path, shader, result)
+        if text is None:
+            print("  not rewritten: %s" % reason)
+            continue
+        with open(path, "r", encoding="utf-8", newline="") as f:
+            original = f.read()
+        with open(path, "w", encoding="utf-8", newline="") as f:
+            f.write(text)
+        error = _check(path)
+        if error:
+            with open(path, "w", encoding="utf-8", newline="") as f:
+                f.write(original)
+            print("  not rewritten: %s" % error)
+            continue
+        written += 1
+
+    print("%d shaders could use a better split, %d rewritten, %d failed"
+          % (changed, written, failed))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Bakes crt-royale's pre-resized phosphor mask atlas.
+
+Usage: slang-maskatlas.py generate [--check]
+
+generate Lanczos-resizes crt-royale's grille, slot and shadow mask LUT's to
+every tile size the mask resize passes can produce, the way the passes do it
+(see slangtools/maskatlas.py), and writes them to
+crt/shaders/crt-royale/TileableLinearMaskAtlas.png and the tile size range
+to the layout block in phosphor-mask-resizing.h.  The resize settings come
+from crt-royale's user-settings.h and user-cgp-constants.h.  It then
+measures the atlas against the same resize without the passes' 8 bit
+rounding and fails if any texel is further off than the passes themselves
+can be.  --check writes nothing and exits 1 if the atlas or the layout block
+is out of date.
+"""
+
+import argparse
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import maskatlas, png
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+ROYALE = os.path.join(ROOT, "crt", "shaders", "crt-royale")
+HEADER = os.path.join(ROYALE, "src", "phosphor-mask-resizing.h")
+USER_SETTINGS = os.path.join(ROYALE, "user-settings.h")
+CGP_CONSTANTS = os.path.join(ROYALE, "src", "user-cgp-constants.h")
+TEXTURE = os.path.join(ROYALE, "TileableLinearMaskAtlas.png")
+# The small LUT's crt-royale.slangp resizes, in maskatlas.MASK_TYPES order:
+LUTS = ("TileableLinearApertureGrille15Wide8And5d5SpacingResizeTo64.png",
+        "TileableLinearSlotMaskTall15Wide9And4d5Horizontal9d14VerticalSpacingResizeTo64.png",
+        "TileableLinearShadowMaskEDPResizeTo64.png")
+
+
+def _read(path):
+    with open(path, newline="") as f:
+        return f.read()
+
+
+def _same(a, b):
+    return (a.width, a.height, a.channels, a.depth) == \
+        (b.width, b.height, b.channels, b.depth) and list(a.pixels) == list(b.pixels)
+
+
+def generate(check):
+    settings = maskatlas.Settings.parse(_read(USER_SETTINGS), _read(CGP_CONSTANTS))
+    tiles = [maskatlas.read_tile(os.path.join(ROYALE, name)) for name in LUTS]
+    img, layout = maskatlas.bake(tiles, settings)
+    text = _read(HEADER)
+    header = maskatlas.replace_layout(text, layout)
+    if check:
+        stale = 0
+        try:
+            if not _same(png.read(TEXTURE), img):
+                print("%s is stale" % os.path.relpath(TEXTURE))
+                stale += 1
+        except (IOError, png.PngError) as e:
+            print("%s: %s" % (TEXTURE, e))
+            stale += 1
+        if header != text:
+            print("%s: the mask atlas layout is stale" % os.path.relpath(HEADER))
+            stale += 1
+        if stale:
+            return 1
+    else:
+        png.write(TEXTURE, img)
+        if header != text:
+            with open(HEADER, "w", newline="") as f:
+                f.write(header)
+        print("%s: %dx%d" % (os.path.relpath(TEXTURE), img.width, img.height))
+    worst, mask_type, size = maskatlas.error(img, layout, tiles, settings)
+    print("%d tile sizes from %d to %d, largest error %.2f/255 (%s, %d texels)"
+          % (layout.max_tile - layout.min_tile + 1, layout.min_tile, layout.max_tile,
+             worst * 255.0, mask_type, size))
+    if worst > maskatlas.TOLERANCE:
+        print("the atlas is off by more than %.2f/255" % (maskatlas.TOLERANCE * 255.0))
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command")
+    gen = sub.add_parser("generate")
+    gen.add_argument("--check", action="store_true",
+                     help="only check that the atlas and layout are up to date")
+    args = parser.parse_args()
+    if not args.command:
+        parser.error("no command")
+
+    try:
+        return generate(args.check)
+    except (IOError, png.PngError, maskatlas.MaskAtlasError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
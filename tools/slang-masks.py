@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Bakes the phosphor mask texture of SUBPIXEL_MASKS_USE_LUT.
+
+Usage: slang-masks.py generate [--check]
+       slang-masks.py presets --out DIR
+
+generate evaluates mask_weights() from include/subpixel_masks.h on the CPU
+(see slangtools/halfprec.py), finds each layout's tile and writes the tiles
+to include/subpixel-masks-lut.png and their positions to the table in the
+header.  It then evaluates the SUBPIXEL_MASKS_USE_LUT version against the
+texture and fails if any layout differs from the ALU path.  --check writes
+nothing and exits 1 if the texture or the table is out of date.
+
+presets writes one pass benchmark presets into DIR for slang-bench.py, ALU
+and texture versions at a few layouts.
+"""
+
+import argparse
+import os
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import halfprec, masks, png
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+INCLUDE = os.path.join(ROOT, "include")
+HEADER = os.path.join(INCLUDE, "subpixel_masks.h")
+TEXTURE = os.path.join(INCLUDE, "subpixel-masks-lut.png")
+
+
+def program(lut, texture=None):
+    with tempfile.NamedTemporaryFile("w", suffix=".h", delete=False) as f:
+        f.write('#include "%s"\n' % os.path.join(INCLUDE, "compat_macros.inc"))
+        f.write("uniform sampler2D %s;\n" % masks.SAMPLER)
+        f.write('#include "%s"\n' % HEADER)
+    try:
+        prog = halfprec.Program(f.name, ("SUBPIXEL_MASKS_USE_LUT",) if lut else ())
+    finally:
+        os.unlink(f.name)
+    if texture:
+        prog.bind(masks.SAMPLER, texture)
+    return prog
+
+
+def _same(a, b):
+    return (a.width, a.height, a.channels, a.depth) == \
+        (b.width, b.height, b.channels, b.depth) and list(a.pixels) == list(b.pixels)
+
+
+def generate(check):
+    alu = program(False)
+    img, table = masks.bake(masks.tiles(alu))
+    with open(HEADER, newline="") as f:
+        text = f.read()
+    header = masks.replace_table(text, table)
+    if check:
+        stale = 0
+        try:
+            if not _same(png.read(TEXTURE), img):
+                print("%s is stale" % os.path.relpath(TEXTURE))
+                stale += 1
+        except (IOError, png.PngError) as e:
+            print("%s: %s" % (TEXTURE, e))
+            stale += 1
+        if header != text:
+            print("%s: the tile table is stale" % os.path.relpath(HEADER))
+            stale += 1
+        if stale:
+            return 1
+    else:
+        png.write(TEXTURE, img)
+        if header != text:
+            with open(HEADER, "w", newline="") as f:
+                f.write(header)
+        print("%s: %dx%d" % (os.path.relpath(TEXTURE), img.width, img.height))
+    differ = masks.compare(alu, program(True, masks.texture(img)))
+    for layout, intensity in differ:
+        print("layout %d, mask_intensity %g: the texture differs from the ALU path"
+              % (layout, intensity))
+    if differ:
+        return 1
+    print("%d layouts match the ALU path" % masks.LAYOUTS)
+    return 0
+
+
+def presets(out):
+    os.makedirs(out, exist_ok=True)
+    includes = os.path.relpath(INCLUDE, out)
+    for version, lut in (("alu", False), ("lut", True)):
+        shader = "subpixel-masks-%s.slang" % version
+        with open(os.path.join(out, shader), "w") as f:
+            f.write(masks.bench_shader(includes, lut))
+        for layout in masks.BENCH_LAYOUTS:
+            path = os.path.join(out, "subpixel-masks-%s-layout%d.slangp" % (version, layout))
+            with open(path, "w") as f:
+                f.write(masks.bench_preset(
+                    shader, layout, os.path.relpath(TEXTURE, out) if lut else None))
+            print(path)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command")
+    gen = sub.add_parser("generate")
+    gen.add_argument("--check", action="store_true",
+                     help="only check that the texture and table are up to date")
+    pre = sub.add_parser("presets")
+    pre.add_argument("--out", required=True)
+    args = parser.parse_args()
+    if not args.command:
+        parser.error("no command")
+
+    try:
+        if args.command == "generate":
+            return generate(args.check)
+        return presets(args.out)
+    except (IOError, png.PngError, masks.MaskError, halfprec.HalfPrecError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
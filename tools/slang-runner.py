@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Headless Vulkan runner for slang-bench.py and slang-golden.py.
+
+Usage: slang-runner.py [JOB] > RESULT
+
+Reads a JSON job from the file JOB or from stdin, builds the filter chain it
+describes on the first Vulkan device the loader offers, renders the frames
+and writes the JSON result to stdout.  The job and result formats are
+described in slangtools/runner.py, the chain semantics in slangtools/host.py.
+slang-bench.py and slang-golden.py start this runner on lavapipe unless they
+are given another one with --runner or $SLANG_RUNNER.
+
+Needs the Vulkan loader (libvulkan.so.1, or $SLANG_VULKAN_LIBRARY), and
+glslangValidator unless the job names a bundle.
+"""
+
+import argparse
+import json
+import os
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import (bundle, chain, compiler, freeze, host, preset, source,
+                        spirv, vulkan)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("job", nargs="?", help="job file, stdin by default")
+    args = parser.parse_args()
+
+    try:
+        if args.job:
+            with open(args.job) as f:
+                job = json.load(f)
+        else:
+            job = json.load(sys.stdin)
+    except (IOError, ValueError) as e:
+        sys.stderr.write("cannot read the job: %s\n" % e)
+        return 1
+
+    try:
+        result = host.run(job)
+    except (host.HostError, vulkan.VulkanError, bundle.BundleError, chain.ChainError,
+            compiler.CompileError, freeze.FreezeError, preset.PresetError,
+            source.SourceError, spirv.SpirvError, IOError) as e:
+        sys.stderr.write("%s: %s\n" % (job.get("preset"), e))
+        return 1
+    json.dump(result, sys.stdout)
+    sys.stdout.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
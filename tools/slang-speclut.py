@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""Bakes and measures the lookup texture of special-functions.h.
+
+Usage: slang-speclut.py generate [--check]
+       slang-speclut.py measure [--points N]
+       slang-speclut.py presets --out DIR
+
+generate writes include/special-functions-lut.png at the smallest size
+within the tolerances in slangtools/speclut.py and prints the error of each
+table; --check only reports whether the file is up to date and exits 1 if
+not.
+
+measure evaluates erf(), gamma() and normalized_ligamma() from
+include/special-functions.h and their erf_lut(), gamma_impl_lut() and
+normalized_ligamma_lut() counterparts on the CPU, at FP32 and with the texture filtered with 8 bit weights (see
+slangtools/halfprec.py), and prints each version's largest error against
+double precision references and the operations one scalar call costs per
+pixel.  normalized_ligamma is measured for s in [1/32, 0.5] and only where
+z = u**(1/s) is a normal FP32 number; below that z underflows in the caller
+in either version.
+
+presets writes a one pass benchmark preset per version into DIR, doing the
+special function work of crt-royale's scanline pass, for slang-bench.py.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from slangtools import halfprec, png, speclut
+
+TOOLS = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(TOOLS)
+INCLUDE = os.path.join(ROOT, "include")
+TEXTURE = os.path.join(INCLUDE, "special-functions-lut.png")
+SAMPLER = "special_functions_lut"
+TRANSCENDENTAL = ("exp", "exp2", "log", "log2", "pow", "sqrt", "inversesqrt",
+                  "tanh", "sin", "cos")
+FETCHES = ("texture", "textureLod")
+
+
+def generate(check):
+    width, rows = speclut.resolution()
+    img = speclut.bake(width, rows)
+    if check:
+        try:
+            old = png.read(TEXTURE)
+        except (IOError, png.PngError) as e:
+            print("%s: %s" % (TEXTURE, e))
+            return 1
+        if (old.width, old.height, old.channels, old.depth) != \
+                (img.width, img.height, img.channels, img.depth) or \
+                list(old.pixels) != list(img.pixels):
+            print("%s is stale" % os.path.relpath(TEXTURE))
+            return 1
+        print("%s is up to date" % os.path.relpath(TEXTURE))
+        return 0
+    png.write(TEXTURE, img)
+    print("%s: %dx%d" % (os.path.relpath(TEXTURE), img.width, img.height))
+    print("  erf      %.3g absolute" % speclut.erf_error(width))
+    print("  gamma    %.3g relative" % speclut.gamma_error(width))
+    print("  ligamma  %.3g absolute" % speclut.ligamma_error(width, rows))
+    return 0
+
+
+def program(texture):
+    with tempfile.NamedTemporaryFile("w", suffix=".h", delete=False) as f:
+        f.write('#include "%s"\n' % os.path.join(INCLUDE, "compat_macros.inc"))
+        f.write("uniform sampler2D %s;\n" % SAMPLER)
+        f.write('#include "%s"\n' % os.path.join(INCLUDE, "special-functions.h"))
+    try:
+        prog = halfprec.Program(f.name)
+    finally:
+        os.unlink(f.name)
+    prog.bind(SAMPLER, texture)
+    return prog
+
+
+def _fp32(x):
+    return struct.unpack("f", struct.pack("f", x))[0]
+
+
+def _val(values):
+    return halfprec.Val([[_fp32(v) for v in values]], "high", "float")
+
+
+def cases(points):
+    """(function, analytic expression, lut expression, env, reference values,
+    relative) to measure."""
+    n = points
+    xs = [-4.5 + 9.0 * i / (n - 1) for i in range(n)]
+    ss = [speclut.S_MAX * (i + 1) / n for i in range(n)]
+    lig_s = []
+    lig_z = []
+    for i in range(n // 8):
+        s = speclut.S_MIN + (speclut.S_MAX - speclut.S_MIN) * i / (n // 8 - 1)
+        for k in range(1, n + 1):
+            z = _fp32((3.5 * k / n) ** (1.0 / s))
+            if z >= 2.0 ** -126:
+                lig_s.append(_fp32(s))
+                lig_z.append(z)
+    xv, sv = _val(xs), _val(ss)
+    return [
+        ("erf", "erf(x)", "erf_lut(%s, x)" % SAMPLER, {"x": xv},
+         [speclut.erf(x) for x in xv.comps[0]], False),
+        ("gamma", "gamma(s)", "gamma_impl_lut(%s, s, 1.0/s)" % SAMPLER, {"s": sv},
+         [speclut.gamma_plus_one(s) / s for s in sv.comps[0]], True),
+        ("normalized_ligamma", "normalized_ligamma(s, z)",
+         "normalized_ligamma_lut(%s, s, z)" % SAMPLER,
+         {"s": _val(lig_s), "z": _val(lig_z)},
+         [speclut.ligamma(s, z ** s) for s, z in zip(lig_s, lig_z)], False),
+    ]
+
+
+def costs(ops):
+    """(transcendental, divide, fetch, other) operation counts."""
+    out = [0, 0, 0, 0]
+    for name, count in ops.items():
+        if name in TRANSCENDENTAL:
+            out[0] += count
+        elif name == "/":
+            out[1] += count
+        elif name in FETCHES:
+            out[2] += count
+        else:
+            out[3] += count
+    return out
+
+
+def measure(points):
+    img = png.read(TEXTURE)
+    texture = halfprec.Texture(img.width, img.height,
+                               [tuple(c / 255.0 for c in p) for p in img.pixels],
+                               speclut.WEIGHT_BITS)
+    prog = program(texture)
+    print("%-19s %-9s %-20s %6s %4s %6s %6s" % (
+        "function", "version", "max error", "trans.", "div", "fetch", "other"))
+    for name, analytic, lut, env, refs, relative in cases(points):
+        for version, expr in (("analytic", analytic), ("lut", lut)):
+            prog.ops.clear()
+            out = prog.evaluate(expr, env).comps[0]
+            if relative:
+                worst = max(abs(v / r - 1.0) for v, r in zip(out, refs))
+            else:
+                worst = max(abs(v - r) for v, r in zip(out, refs))
+            print("%-19s %-9s %-20s %6d %4d %6d %6d" % tuple(
+                [name, version, "%.3g %s" % (worst, "relative" if relative else "absolute")] +
+                costs(prog.ops)))
+    return 0
+
+
+def presets(out):
+    os.makedirs(out, exist_ok=True)
+    includes = os.path.relpath(INCLUDE, out)
+    for version, lut in (("analytic", False), ("lut", True)):
+        shader = "special-functions-%s.slang" % version
+        with open(os.path.join(out, shader), "w") as f:
+            f.write(speclut.bench_shader(includes, lut))
+        path = os.path.join(out, "special-functions-%s.slangp" % version)
+        with open(path, "w") as f:
+            f.write(speclut.bench_preset(shader, os.path.relpath(TEXTURE, out) if lut else None))
+        print(path)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    sub = parser.add_subparsers(dest="command")
+    gen = sub.add_parser("generate")
+    gen.add_argument("--check", action="store_true",
+                     help="only check that the texture is up to date")
+    mea = sub.add_parser("measure")
+    mea.add_argument("--points", type=int, default=256,
+                     help="inputs per function and dimension (default 256)")
+    pre = sub.add_parser("presets")
+    pre.add_argument("--out", required=True)
+    args = parser.parse_args()
+    if not args.command:
+        parser.error("no command")
+
+    try:
+        if args.command == "generate":
+            return generate(args.check)
+        if args.command == "measure":
+            return measure(max(args.points, 16))
+        return presets(args.out)
+    except (IOError, png.PngError, speclut.SpecLutError, halfprec.HalfPrecError) as e:
+        sys.stderr.write("%s\n" % e)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,6 @@
+"""Offline helpers for the slang shader tree.
+
+These modules mirror the parts of the RetroArch filter chain that can be
+resolved without a GPU: .slangp parsing, #include expansion and #pragma
+handling.  The scripts in tools/ are thin command line wrappers around them.
+"""
@@ -0,0 +1,319 @@
+"""Generation of the blurs/ variant family from a declarative table.
+
+Every blurs/blurN*.slang is the same shader around one blur-functions.h
+kernel; only the kernel, the vertex shader computing blur_dxdy and the
+gamma-management.h pass settings differ.  The table (tools/blur-variants.txt)
+has one or more rows per kernel:
+
+    KERNEL  KIND  POSITIONS  GAMMA  [bench]
+
+KIND is fast, resize or gather (separable, tex2DblurNfast/resize/gather),
+onepass or onepass-resize (tex2DblurNxN, tex2DblurNxNresize) or shared
+(tex2DblurNxNshared).  POSITIONS is a comma separated subset of first, mid
+and last: separable kernels get vertical-first-pass, vertical and
+horizontal, and horizontal-last-pass variants, one-pass kernels
+-first-pass, plain and -last-pass ones.  GAMMA is a subset of srgb (sRGB
+framebuffers) and encode (-gamma-encode-every-fbo, GAMMA_ENCODE_EVERY_FBO).
+A trailing bench marks variants that are only generated next to their
+benchmark presets and never shipped in blurs/.
+"""
+
+import os
+import re
+import string
+
+KINDS = {
+    # kind: (function suffix, vertex shader, separable)
+    "fast": ("fast", "vertex-shader-blur-fast-%s.h", True),
+    "resize": ("resize", "vertex-shader-blur-resize-%s.h", True),
+    "gather": ("gather", "vertex-shader-blur-resize-%s.h", True),
+    "onepass": ("", "vertex-shader-blur-one-pass.h", False),
+    "onepass-resize": ("resize", "vertex-shader-blur-one-pass-resize.h", False),
+    "shared": ("shared", "vertex-shader-blur-one-pass-shared-sample.h", False),
+}
+POSITIONS = ("first", "mid", "last")
+GAMMA = ("srgb", "encode")
+
+# Coverage matrix columns: (direction, position) as named by Variant.slot.
+SLOTS = ("v-first", "v", "h", "h-last", "1p-first", "1p", "1p-last")
+
+# Files that predate the generator and keep their own layout, so regenerating
+# them changes nothing: the license ahead of the push constants, an extra
+# blank line after the settings, both includes ahead of the vertex stage, the
+# Cg names input_texture and float4 in main(), a trailing newline.
+LAYOUTS = {
+    "blur3fast-horizontal.slang": ("gap",),
+    "blur3fast-horizontal-gamma-encode-every-fbo.slang": ("gap",),
+    "blur3fast-horizontal-last-pass-gamma-encode-every-fbo.slang": ("gap",),
+    "blur5x5-gamma-encode-every-fbo.slang": ("gap", "shared-includes"),
+    "blur9fast-horizontal.slang": ("license-first", "newline"),
+    "blur9fast-vertical.slang": ("license-first", "cg-names", "newline"),
+    "blur12x12shared.slang": ("license-first",),
+}
+
+
+class BlurGenError(Exception):
+    pass
+
+
+class Variant(object):
+    def __init__(self, row, direction, position, gamma, bench=False):
+        self.row = row
+        self.direction = direction
+        self.position = position
+        self.gamma = gamma
+        self.bench = bench
+        kernel, kind = row
+        suffix, vertex, separable = KINDS[kind]
+        self.function = "tex2Dblur%s%s" % (kernel, suffix)
+        self.vertex = vertex % direction if separable else vertex
+        name = "blur%s%s" % (kernel, suffix)
+        if direction:
+            name += "-" + direction
+        if position != "mid":
+            name += "-%s-pass" % position
+        if gamma == "encode":
+            name += "-gamma-encode-every-fbo"
+        self.name = name + ".slang"
+
+    @property
+    def slot(self):
+        base = {"vertical": "v", "horizontal": "h", None: "1p"}[self.direction]
+        return base if self.position == "mid" else "%s-%s" % (base, self.position)
+
+    def render(self):
+        layout = LAYOUTS.get(self.name, ())
+        def toggle(define, on):
+            return ("#define " if on else "//#define ") + define
+        if "license-first" in layout:
+            head = _VERSION + _LICENSE + _PUSH
+        else:
+            head = _VERSION + _PUSH + _LICENSE + "\n"
+        settings = string.Template(_SETTINGS).substitute(
+            gamma=toggle("GAMMA_ENCODE_EVERY_FBO", self.gamma == "encode"),
+            first=toggle("FIRST_PASS", self.position == "first"),
+            last=toggle("LAST_PASS", self.position == "last"))
+        if "gap" in layout:
+            settings += "\n"
+        if self.row[1] == "shared":
+            body = _SHARED
+        elif "shared-includes" in layout:
+            body = _SHARED_INCLUDES + _FRAGMENT.replace("$includes", "")
+        else:
+            body = _VERTEX_INCLUDES + _FRAGMENT.replace("$includes", _FRAGMENT_INCLUDES)
+        cg = "cg-names" in layout
+        text = head + settings + string.Template(body).substitute(
+            vertex=self.vertex, function=self.function,
+            texture="input_texture" if cg else "Source", vec4="float4" if cg else "vec4")
+        return text + "\n" if "newline" in layout else text
+
+    def render_at(self, blurs, include):
+        """The variant with its includes relative to another directory:
+        blurs and include are the paths of blurs/ and include/ from there."""
+        blurs, include = blurs.replace(os.sep, "/"), include.replace(os.sep, "/")
+        text = self.render().replace('#include "../include/', '#include "%s/' % include)
+        return text.replace('#include "%s"' % self.vertex, '#include "%s/%s"' % (blurs, self.vertex))
+
+
+def load_table(path):
+    """Rows of the table as ((kernel, kind), positions, gamma, bench)."""
+    rows = []
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            fields = line.split("#", 1)[0].split()
+            if not fields:
+                continue
+            where = "%s:%d" % (path, number)
+            if len(fields) not in (4, 5) or fields[4:] not in ([], ["bench"]):
+                raise BlurGenError("%s: expected KERNEL KIND POSITIONS GAMMA [bench]" % where)
+            kernel, kind, positions, gamma = fields[:4]
+            positions, gamma = positions.split(","), gamma.split(",")
+            if kind not in KINDS:
+                raise BlurGenError("%s: unknown kind '%s'" % (where, kind))
+            for value, allowed in [(p, POSITIONS) for p in positions] + [(g, GAMMA) for g in gamma]:
+                if value not in allowed:
+                    raise BlurGenError("%s: '%s' is not one of %s"
+                                       % (where, value, ", ".join(allowed)))
+            rows.append(((kernel, kind), positions, gamma, len(fields) == 5))
+    return rows
+
+
+def variants(rows):
+    out = []
+    for row, positions, gammas, bench in rows:
+        separable = KINDS[row[1]][2]
+        for gamma in GAMMA:
+            if gamma not in gammas:
+                continue
+            for position in POSITIONS:
+                if position not in positions:
+                    continue
+                if not separable:
+                    out.append(Variant(row, None, position, gamma, bench))
+                elif position == "first":
+                    out.append(Variant(row, "vertical", position, gamma, bench))
+                elif position == "last":
+                    out.append(Variant(row, "horizontal", position, gamma, bench))
+                else:
+                    out.append(Variant(row, "vertical", position, gamma, bench))
+                    out.append(Variant(row, "horizontal", position, gamma, bench))
+    return out
+
+
+def check_functions(vs, header):
+    """Raises unless header defines every kernel the variants call."""
+    with open(header) as f:
+        text = f.read()
+    for v in vs:
+        if not re.search(r"\b(?:blur_)?float3\s+%s\s*\(" % v.function, text):
+            raise BlurGenError("%s: %s does not define %s"
+                               % (v.name, os.path.basename(header), v.function))
+
+
+def bench_preset(v, shader):
+    """A one pass preset timing variant v, whose shader is at path shader."""
+    return ("shaders = 1\n\n"
+            "shader0 = %s\n"
+            "filter_linear0 = true\n"
+            "scale_type0 = source\n"
+            "scale0 = 1.0\n" % shader.replace(os.sep, "/"))
+
+
+# The templates are blurs/blur11fast-horizontal.slang cut at the settings and
+# the kernel; the shared one is blur12x12shared.slang with its varying
+# locations matching the vertex shader.
+_VERSION = '''#version 450
+
+'''
+
+_PUSH = '''layout(push_constant) uniform Push
+{
+	vec4 SourceSize;
+	vec4 OriginalSize;
+	vec4 OutputSize;
+	uint FrameCount;
+} params;
+
+layout(std140, set = 0, binding = 0) uniform UBO
+{
+	mat4 MVP;
+} global;
+
+'''
+
+_LICENSE = '''/////////////////////////////////  MIT LICENSE  ////////////////////////////////
+
+//  Copyright (C) 2014 TroggleMonkey
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+'''
+
+_SETTINGS = '''/////////////////////////////  SETTINGS MANAGEMENT  ////////////////////////////
+
+//  PASS SETTINGS:
+//  gamma-management.h needs to know what kind of pipeline we're using and
+//  what pass this is in that pipeline.  This will become obsolete if/when we
+//  can #define things like this in the .cgp preset file.
+$gamma
+$first
+$last
+//#define SIMULATE_CRT_ON_LCD
+//#define SIMULATE_GBA_ON_LCD
+//#define SIMULATE_LCD_ON_CRT
+//#define SIMULATE_GBA_ON_CRT
+
+'''
+
+_VERTEX_INCLUDES = '''///////////////////////////////  VERTEX INCLUDES  ///////////////////////////////
+
+#include "../include/compat_macros.inc"
+#pragma stage vertex
+#include "$vertex"
+'''
+
+_SHARED_INCLUDES = '''//////////////////////////////////  INCLUDES  //////////////////////////////////
+
+//  #included by vertex shader:
+#include "../include/gamma-management.h"
+#include "../include/blur-functions.h"
+
+#pragma stage vertex
+#include "$vertex"
+'''
+
+_FRAGMENT_INCLUDES = '''#define input_texture Source
+
+/////////////////////////////  FRAGMENT INCLUDES  /////////////////////////////
+#include "../include/gamma-management.h"
+#include "../include/blur-functions.h"
+'''
+
+_FRAGMENT = '''
+///////////////////////////////  FRAGMENT SHADER  //////////////////////////////
+
+#pragma stage fragment
+layout(location = 0) in vec2 tex_uv;
+layout(location = 1) in vec2 blur_dxdy;
+layout(location = 0) out vec4 FragColor;
+layout(set = 0, binding = 2) uniform sampler2D Source;
+$includes
+void main()
+{
+	vec3 color = $function($texture, tex_uv, blur_dxdy);
+    //  Encode and output the blurred image:
+   FragColor = encode_output($vec4(color, 1.0));
+}'''
+
+_SHARED = '''//  blur-functions.h needs to know our profile's capabilities:
+//  1.) DRIVERS_ALLOW_DERIVATIVES is mandatory for one-pass shared-sample blurs.
+//  2.) DRIVERS_ALLOW_TEX2DLOD is optional, but mipmapped blurs will have awful
+//      artifacts without it due to funky texture sampling derivatives.
+#define DRIVERS_ALLOW_DERIVATIVES
+#define DRIVERS_ALLOW_TEX2DLOD
+
+///////////////////////////////  VERTEX INCLUDES  ///////////////////////////////
+
+#include "../include/compat_macros.inc"
+#pragma stage vertex
+#include "$vertex"
+
+#pragma stage fragment
+layout(location = 0) in vec4 tex_uv;
+layout(location = 1) in vec4 output_pixel_num;
+layout(location = 2) in vec2 blur_dxdy;
+layout(location = 0) out vec4 FragColor;
+layout(set = 0, binding = 2) uniform sampler2D Source;
+#define input_texture Source
+
+/////////////////////////////  FRAGMENT INCLUDES  /////////////////////////////
+#include "../include/gamma-management.h"
+#include "../include/blur-functions.h"
+
+void main()
+{
+    //  Get the integer output pixel number from two origins (uv and screen):
+    float4 output_pixel_num_integer = floor(output_pixel_num);
+    //  Get the fragment's position in the pixel quad and do a shared-sample blur:
+    float4 quad_vector = get_quad_vector(output_pixel_num_integer);
+    float3 color = $function(input_texture, tex_uv,
+        blur_dxdy, quad_vector);
+    //  Encode and output the blurred image:
+    FragColor = encode_output(float4(color, 1.0));
+}'''
@@ -0,0 +1,132 @@
+"""Framebuffer memory and bandwidth of a resolved filter chain.
+
+The model, per frame:
+
+  allocated  every pass framebuffer (output size x bytes per texel, with a
+             full mip chain when the next pass sets mipmap_input, doubled for
+             passes read as feedback), the input plus OriginalHistoryN copies
+             at the original size, and the lookup textures.  The last pass
+             renders to the frontend's backbuffer unless it has a scale, and
+             is not counted.
+  written    every pass output once, plus its mip levels.
+  read       per sampled texture, the smaller of its size and
+             output pixels x taps x bytes per texel: texture caches absorb
+             overlapping taps, and downsampling passes skip texels.  Taps are
+             the calls naming the sampler in the fragment stage, so taps in
+             loops or helper functions count once; this is an estimate.
+"""
+
+import re
+
+from . import chain, png
+
+INPUT_FORMAT = "R8G8B8A8_UNORM"
+MB = 1024.0 * 1024.0
+
+
+class BudgetError(Exception):
+    pass
+
+
+def mip_bytes(width, height, bytes_per_texel, mipmap):
+    total = 0
+    while True:
+        total += width * height * bytes_per_texel
+        if not mipmap or (width == 1 and height == 1):
+            return total
+        width, height = max(1, width // 2), max(1, height // 2)
+
+
+def taps(fragment, sampler):
+    """Calls in fragment with sampler as their first argument."""
+    return len(re.findall(r'\b\w+\s*\(\s*%s\s*[,)]' % re.escape(sampler), fragment))
+
+
+class PassBudget(object):
+    def __init__(self, plan):
+        self.plan = plan
+        self.allocated = 0
+        self.written = 0
+        self.read = 0
+        self.notes = []
+
+
+class Budget(object):
+    def __init__(self):
+        self.passes = []
+        self.input_allocated = 0
+        self.history = 0
+        self.texture_allocated = 0
+        self.textures = 0
+
+    @property
+    def allocated(self):
+        return (sum(p.allocated for p in self.passes) + self.input_allocated +
+                self.texture_allocated)
+
+    @property
+    def written(self):
+        return sum(p.written for p in self.passes)
+
+    @property
+    def read(self):
+        return sum(p.read for p in self.passes)
+
+
+def compute(preset, plans):
+    """Budget of preset, resolved as plans by chain.plan()."""
+    original = plans[0].input_size
+    input_bpp = chain.FORMAT_BYTES[INPUT_FORMAT]
+    mipmapped = set(pp.index - 1 for pp in plans if pp.pass_.mipmap_input)
+    feedback = chain.feedback_passes(plans)
+    budget = Budget()
+
+    luts = {}
+    for tex in preset.textures:
+        try:
+            w, h = png.size(tex.path)
+        except (IOError, png.PngError) as e:
+            raise BudgetError("texture %s: %s" % (tex.name, e))
+        luts[tex.name] = (w, h, tex.mipmap)
+        budget.texture_allocated += mip_bytes(w, h, 4, tex.mipmap)
+    budget.textures = len(luts)
+
+    budget.history = chain.history_depth(plans)
+    budget.input_allocated = (1 + budget.history) * mip_bytes(
+        original[0], original[1], input_bpp, -1 in mipmapped)
+
+    sizes = {}
+    for pp in plans:
+        bpp = pp.bytes_per_texel
+        frame = mip_bytes(pp.output_size[0], pp.output_size[1], bpp, pp.index in mipmapped)
+        sizes[pp.index] = (pp.output_size, bpp)
+        pb = PassBudget(pp)
+        pb.written = frame
+        if pp.final:
+            pb.notes.append("backbuffer")
+        else:
+            pb.allocated = frame * (2 if pp.index in feedback else 1)
+        if pp.index in mipmapped:
+            pb.notes.append("mipmapped")
+        if pp.index in feedback:
+            pb.notes.append("feedback")
+        budget.passes.append(pb)
+
+    # Samplers only declared in code the preprocessor drops do not count.
+    bindings = chain.schedule(plans, preset.textures, 0, strict=False)
+    for pb, sched in zip(budget.passes, bindings):
+        pp = pb.plan
+        pixels = pp.output_size[0] * pp.output_size[1]
+        fragment = pp.shader.stages["fragment"]
+        for sampler, bind in sched["bindings"].items():
+            kind, _, what = bind.partition(":")
+            if kind == "input":
+                (w, h), bpp = original, input_bpp
+            elif kind == "texture":
+                w, h, _ = luts[what]
+                bpp = 4
+            else:
+                (w, h), bpp = sizes[int(what)]
+            n = max(1, taps(fragment, sampler))
+            pb.read += min(w * h * bpp, pixels * n * bpp)
+    return budget
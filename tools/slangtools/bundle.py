@@ -0,0 +1,105 @@
+"""Reading and writing of pre-reflected preset bundles (.slangpb).
+
+A bundle holds everything the filter chain needs to build its pipelines for
+one preset, so that loading it needs no preprocessing, glslang or reflection.
+All integers are little endian:
+
+    char     magic[4]         "SLPB"
+    uint32   version          1
+    uint32   section_count
+    uint32   reserved         0
+    section  sections[section_count]
+        char     tag[4]
+        uint32   pass         pass index, 0xffffffff for preset-wide data
+        uint32   offset       from the start of the file, 4 byte aligned
+        uint32   size
+
+Sections:
+
+    META  preset-wide  JSON: pass settings, #pragma name/format, resolved
+                       lookup textures and the merged #pragma parameter table
+    VERT  per pass     vertex SPIR-V
+    FRAG  per pass     fragment SPIR-V
+    REFL  per pass     JSON: {"vertex": ..., "fragment": ...} as returned by
+                       spirv.reflect()
+
+JSON sections are UTF-8 without a terminator.  Texture paths in META are
+relative to the directory holding the bundle, which is installed next to the
+.slangp it was built from.
+"""
+
+import json
+import mmap
+import struct
+
+MAGIC = b"SLPB"
+VERSION = 1
+PRESET_WIDE = 0xffffffff
+
+_HEADER = struct.Struct("<4sIII")
+_SECTION = struct.Struct("<4sIII")
+
+
+class BundleError(Exception):
+    pass
+
+
+def write(path, meta, passes):
+    """Writes a bundle.  passes is a list of (vertex, fragment, reflection)."""
+    sections = [(b"META", PRESET_WIDE, json.dumps(meta, sort_keys=True).encode("utf-8"))]
+    for i, (vert, frag, refl) in enumerate(passes):
+        sections.append((b"VERT", i, vert))
+        sections.append((b"FRAG", i, frag))
+        sections.append((b"REFL", i, json.dumps(refl, sort_keys=True).encode("utf-8")))
+
+    offset = _HEADER.size + _SECTION.size * len(sections)
+    table = []
+    for tag, index, data in sections:
+        offset = (offset + 3) & ~3
+        table.append(_SECTION.pack(tag, index, offset, len(data)))
+        offset += len(data)
+
+    with open(path, "wb") as f:
+        f.write(_HEADER.pack(MAGIC, VERSION, len(sections), 0))
+        f.write(b"".join(table))
+        for tag, index, data in sections:
+            f.write(b"\0" * (-f.tell() & 3))
+            f.write(data)
+
+
+class Bundle(object):
+    """A memory mapped bundle.  Section data is returned as memoryviews."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        if len(self._map) < _HEADER.size:
+            raise BundleError("%s: truncated header" % path)
+        magic, version, count, _ = _HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC or version != VERSION:
+            raise BundleError("%s: not a version %d bundle" % (path, VERSION))
+        self._sections = {}
+        view = memoryview(self._map)
+        for i in range(count):
+            tag, index, offset, size = _SECTION.unpack_from(
+                self._map, _HEADER.size + i * _SECTION.size)
+            if offset + size > len(self._map):
+                raise BundleError("%s: section out of bounds" % path)
+            self._sections[(tag, index)] = view[offset:offset + size]
+        self.meta = json.loads(bytes(self.section(b"META")).decode("utf-8"))
+
+    def section(self, tag, index=PRESET_WIDE):
+        try:
+            return self._sections[(tag, index)]
+        except KeyError:
+            raise BundleError("missing %s section for pass %d" % (tag.decode(), index))
+
+    @property
+    def pass_count(self):
+        return len(self.meta["passes"])
+
+    def spirv(self, index, stage):
+        return self.section(b"VERT" if stage == "vertex" else b"FRAG", index)
+
+    def reflection(self, index):
+        return json.loads(bytes(self.section(b"REFL", index)).decode("utf-8"))
@@ -0,0 +1,64 @@
+"""Content addressed SPIR-V cache.
+
+Entries are keyed on the SHA-256 of the fully expanded source of a single
+stage, so editing a shared header only invalidates the stages whose text it
+actually ends up in, and the vertex stage of a shader survives edits that only
+touch its fragment stage.  The compiler version is part of the key.
+
+Layout: DIR/<first two hex digits>/<key>.spv
+"""
+
+import hashlib
+import os
+import tempfile
+
+from . import compiler
+
+FORMAT = b"slang-cache 1"
+
+
+class Cache(object):
+    def __init__(self, directory):
+        self.directory = directory
+        self.hits = 0
+        self.misses = 0
+
+    def key(self, stage, text):
+        h = hashlib.sha256()
+        for part in (FORMAT, compiler.version().encode("utf-8"),
+                     stage.encode("utf-8"), text.encode("utf-8")):
+            h.update(part)
+            h.update(b"\0")
+        return h.hexdigest()
+
+    def path(self, key):
+        return os.path.join(self.directory, key[:2], key + ".spv")
+
+    def contains(self, stage, text):
+        return os.path.exists(self.path(self.key(stage, text)))
+
+    def lookup(self, stage, text):
+        try:
+            with open(self.path(self.key(stage, text)), "rb") as f:
+                return f.read()
+        except IOError:
+            return None
+
+    def store(self, stage, text, code):
+        path = self.path(self.key(stage, text))
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        fd, tmp = tempfile.mkstemp(dir=os.path.dirname(path))
+        with os.fdopen(fd, "wb") as f:
+            f.write(code)
+        os.replace(tmp, path)
+
+    def compile_stage(self, text, stage, name="<slang>"):
+        """compiler.compile_stage() that only runs glslang on a miss."""
+        code = self.lookup(stage, text)
+        if code is not None:
+            self.hits += 1
+            return code
+        self.misses += 1
+        code = compiler.compile_stage(text, stage, name)
+        self.store(stage, text, code)
+        return code
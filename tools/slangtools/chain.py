@@ -0,0 +1,200 @@
+"""Resolution of a preset into the filter chain the frontend would build.
+
+This covers the parts of spec/SHADER_SPEC.md which do not need a GPU: the
+output size and format of every pass for a given input and viewport size, and
+which history and feedback textures the passes sample.
+"""
+
+import re
+
+from . import glsl, source
+
+DEFAULT_FORMAT = "R8G8B8A8_UNORM"
+
+# Bytes per texel of every render target format in the spec.
+FORMAT_BYTES = {
+    "R8_UNORM": 1, "R8_UINT": 1, "R8_SINT": 1,
+    "R8G8_UNORM": 2, "R8G8_UINT": 2, "R8G8_SINT": 2,
+    "R8G8B8A8_UNORM": 4, "R8G8B8A8_UINT": 4, "R8G8B8A8_SINT": 4,
+    "R8G8B8A8_SRGB": 4,
+    "A2B10G10R10_UNORM_PACK32": 4, "A2B10G10R10_UINT_PACK32": 4,
+    "R16_UINT": 2, "R16_SINT": 2, "R16_SFLOAT": 2,
+    "R16G16_UINT": 4, "R16G16_SINT": 4, "R16G16_SFLOAT": 4,
+    "R16G16B16A16_UINT": 8, "R16G16B16A16_SINT": 8, "R16G16B16A16_SFLOAT": 8,
+    "R32_UINT": 4, "R32_SINT": 4, "R32_SFLOAT": 4,
+    "R32G32_UINT": 8, "R32G32_SINT": 8, "R32G32_SFLOAT": 8,
+    "R32G32B32A32_UINT": 16, "R32G32B32A32_SINT": 16, "R32G32B32A32_SFLOAT": 16,
+}
+
+_SAMPLER = re.compile(r'\buniform\s+[iu]?sampler2D\s+(\w+)')
+_HISTORY = re.compile(r'^OriginalHistory(\d+)$')
+_PASS_OUTPUT = re.compile(r'^PassOutput(\d+)$')
+_PASS_FEEDBACK = re.compile(r'^PassFeedback(\d+)$')
+
+
+class ChainError(Exception):
+    pass
+
+
+class PassPlan(object):
+    def __init__(self, p, shader):
+        self.index = p.index
+        self.pass_ = p
+        self.shader = shader
+        self.input_size = None
+        self.output_size = None
+        self.final = False
+        self.format = DEFAULT_FORMAT
+        # Reflection only sees the samplers the preprocessor keeps.
+        self.samplers = sorted(set(_SAMPLER.findall(glsl.active(shader.stages["fragment"]))))
+
+    @property
+    def alias(self):
+        return self.pass_.alias or self.shader.name
+
+    @property
+    def bytes_per_texel(self):
+        return FORMAT_BYTES.get(self.format, 4)
+
+
+def framebuffer_format(p, shader):
+    """#pragma format wins over the preset's float/sRGB framebuffer flags."""
+    if shader.format:
+        if shader.format not in FORMAT_BYTES:
+            raise ChainError("%s: unknown format %s" % (shader.path, shader.format))
+        return shader.format
+    if p.float_framebuffer:
+        return "R16G16B16A16_SFLOAT"
+    if p.srgb_framebuffer:
+        return "R8G8B8A8_SRGB"
+    return DEFAULT_FORMAT
+
+
+def plan(preset, original, viewport, shaders=None):
+    """Returns one PassPlan per pass for the given (w, h) input and viewport.
+
+    shaders optionally maps shader paths to already loaded source.Shaders.
+    """
+    shaders = shaders if shaders is not None else {}
+    plans = []
+    size = original
+    last = len(preset.passes) - 1
+    for p in preset.passes:
+        if p.shader not in shaders:
+            shaders[p.shader] = source.load(p.shader)
+        pp = PassPlan(p, shaders[p.shader])
+        pp.input_size = size
+        if p.explicit_scale:
+            size = (p.scale_x.resolve(original[0], size[0], viewport[0]),
+                    p.scale_y.resolve(original[1], size[1], viewport[1]))
+        elif p.index == last:
+            size = viewport
+        pp.output_size = size
+        pp.final = p.index == last and not p.explicit_scale
+        pp.format = framebuffer_format(p, pp.shader)
+        plans.append(pp)
+    return plans
+
+
+def history_depth(plans):
+    """Number of previous input frames the chain keeps (OriginalHistoryN)."""
+    depth = 0
+    for pp in plans:
+        for name in pp.samplers:
+            m = _HISTORY.match(name)
+            if m:
+                depth = max(depth, int(m.group(1)))
+    return depth
+
+
+def _alias_index(plans):
+    index = {}
+    for pp in plans:
+        if pp.alias:
+            index[pp.alias] = pp.index
+    return index
+
+
+def feedback_passes(plans):
+    """Indices of the passes whose previous frame output is sampled."""
+    aliases = _alias_index(plans)
+    result = set()
+    for pp in plans:
+        for name in pp.samplers:
+            m = _PASS_FEEDBACK.match(name)
+            if m:
+                result.add(int(m.group(1)))
+            elif name.endswith("Feedback") and name[:-len("Feedback")] in aliases:
+                result.add(aliases[name[:-len("Feedback")]])
+    return result
+
+
+def _resolve(plans, pp, name, aliases, luts, strict):
+    history = _HISTORY.match(name)
+    output = _PASS_OUTPUT.match(name)
+    feedback = _PASS_FEEDBACK.match(name)
+    if name == "Original":
+        bind = "input:0"
+    elif name == "Source":
+        bind = "pass:%d" % (pp.index - 1) if pp.index else "input:0"
+    elif history:
+        bind = "input:%d" % int(history.group(1))
+    elif output or name in aliases:
+        target = int(output.group(1)) if output else aliases[name]
+        if target >= pp.index:
+            if not strict:
+                return None
+            raise ChainError("pass %d: %s is not causal" % (pp.index, name))
+        bind = "pass:%d" % target
+    elif feedback:
+        bind = "feedback:%d" % int(feedback.group(1))
+    elif name.endswith("Feedback") and name[:-len("Feedback")] in aliases:
+        bind = "feedback:%d" % aliases[name[:-len("Feedback")]]
+    elif name in luts:
+        bind = "texture:%s" % name
+    elif not strict:
+        return None
+    else:
+        raise ChainError("pass %d: sampler %s has no meaning" % (pp.index, name))
+    if bind.startswith("feedback:") and int(bind[9:]) >= len(plans):
+        raise ChainError("pass %d: %s refers to a missing pass" % (pp.index, name))
+    return bind
+
+
+def resolve(plans, textures, pp, name, strict=True):
+    """What pass pp binds for the sampler name, in the notation of schedule().
+
+    Without strict, None is returned where schedule() would leave the sampler
+    out.
+    """
+    return _resolve(plans, pp, name, _alias_index(plans),
+                    set(t.name for t in textures), strict)
+
+
+def schedule(plans, textures, frame, strict=True):
+    """What every pass of the chain binds on the given frame.
+
+    Returns one {"frame_count": N, "bindings": {sampler: source}} per pass.
+    A source is "input:K" (the input frame K frames back, black before the
+    first frame), "pass:N" (this frame's output of pass N), "feedback:N"
+    (the previous frame's output of pass N, black on the first frame) or
+    "texture:NAME" (a lookup texture).  Samplers which mean nothing to the
+    frontend and non-causal PassOutputN accesses raise ChainError, as the
+    frontend would refuse them if the stage uses them; without strict they
+    are left out instead.
+    """
+    aliases = _alias_index(plans)
+    luts = set(t.name for t in textures)
+    result = []
+    for pp in plans:
+        bindings = {}
+        for name in pp.samplers:
+            bind = _resolve(plans, pp, name, aliases, luts, strict)
+            if bind is not None:
+                bindings[name] = bind
+        mod = pp.pass_.frame_count_mod
+        result.append({
+            "frame_count": frame % mod if mod > 0 else frame,
+            "bindings": bindings,
+        })
+    return result
@@ -0,0 +1,51 @@
+"""GLSL -> SPIR-V compilation through glslangValidator."""
+
+import os
+import subprocess
+import tempfile
+
+GLSLANG = os.environ.get("GLSLANG", "glslangValidator")
+
+_STAGE_FLAGS = {"vertex": "vert", "fragment": "frag"}
+
+
+class CompileError(Exception):
+    pass
+
+
+def compile_stage(source, stage, name="<slang>"):
+    """Compiles one stage source (as produced by source.load) to SPIR-V."""
+    fd, out = tempfile.mkstemp(suffix=".spv")
+    os.close(fd)
+    try:
+        try:
+            proc = subprocess.run(
+                [GLSLANG, "-V", "--target-env", "vulkan1.0", "--stdin",
+                 "-S", _STAGE_FLAGS[stage], "-o", out],
+                input=source.encode("utf-8"),
+                stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        except OSError as e:
+            raise CompileError("cannot run %s: %s" % (GLSLANG, e.strerror))
+        if proc.returncode != 0:
+            log = proc.stdout.decode("utf-8", "replace").strip()
+            raise CompileError("%s (%s):\n%s" % (name, stage, log))
+        with open(out, "rb") as f:
+            return f.read()
+    finally:
+        os.unlink(out)
+
+
+_version = None
+
+
+def version():
+    """The compiler's version banner, or "" if it cannot be run."""
+    global _version
+    if _version is None:
+        try:
+            proc = subprocess.run([GLSLANG, "--version"],
+                                  stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+            _version = proc.stdout.decode("utf-8", "replace").strip()
+        except OSError:
+            _version = ""
+    return _version
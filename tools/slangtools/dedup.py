@@ -0,0 +1,293 @@
+"""Variant families and hardlinks for smaller install trees.
+
+Shader variants such as blurs/blur9fast-vertical.slang and
+blurs/blur9fast-vertical-gamma-encode-every-fbo.slang, or crt-royale's
+user-settings-*.h, are copies of one file that only differ in which macros
+they #define.  dedup() finds such families: files in one directory with the
+same extension and the same lines, except for lines that define, undefine or
+comment out a macro.  The family's text moves to one body, <stem>.inc next to
+it (stem being the shortest member's name), with a marker comment in place of
+each line the members disagree on, and every member becomes a define stub: its
+#version line, its own versions of those lines and an #include of the body.
+
+A define is only moved up to the stub if that cannot change its meaning: it
+must not sit inside a conditional other than an include guard, and nothing
+before it, includes expanded, may mention its macro.  resolve() puts the lines
+back where they were, so verify() can check every installed file against the
+bytes it was copied from.
+
+Afterwards files with identical contents are hardlinked to one another.
+"""
+
+import collections
+import hashlib
+import os
+import re
+import tempfile
+
+from . import glsl
+
+EXTENSIONS = (".slang", ".h", ".inc")
+BODY = ".inc"
+MIN_BODY = 1024
+HEADER = b"// Shared body of "
+
+_LINE = re.compile(br'[^\n]*\n|[^\n]+\Z')
+_INCLUDE = re.compile(br'^\s*#\s*include\s+"([^"]+)"')
+_TOGGLE = re.compile(br'^([ \t]*)(?://[ \t]*)?#[ \t]*(?:define|undef)[ \t]+(\w+)\b[^\\\n]*\r?\n?\Z')
+_MARKER = re.compile(br'^[ \t]*// (\w+): set by the including file\r?\n?\Z')
+_DIRECTIVE = re.compile(r'^[ \t]*#[ \t]*(\w+)[ \t]*(\w*)')
+_IDENT = re.compile(r'\b[A-Za-z_]\w*\b')
+_DEPTH = 32
+
+
+class DedupError(Exception):
+    pass
+
+
+class Stats(object):
+    def __init__(self):
+        self.stubs = 0
+        self.bodies = 0
+        self.links = 0
+
+
+def _files(root):
+    for directory, dirs, names in os.walk(root):
+        dirs.sort()
+        for name in sorted(names):
+            path = os.path.join(directory, name)
+            if os.path.isfile(path) and not os.path.islink(path):
+                yield path
+
+
+def _lines(data):
+    return _LINE.findall(data)
+
+
+def _newline(data):
+    return b"\r\n" if b"\r\n" in data else b"\n"
+
+
+def _toggle(line):
+    """The macro line defines, undefines or comments out, or None."""
+    m = _TOGGLE.match(line)
+    if not m or b"/*" in line or b"*/" in line:
+        return None
+    return m.group(2)
+
+
+def _read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def _write(path, data):
+    fd, tmp = tempfile.mkstemp(dir=os.path.dirname(path))
+    with os.fdopen(fd, "wb") as f:
+        f.write(data)
+    os.chmod(tmp, 0o644)
+    os.replace(tmp, path)
+
+
+def _expand(path, lines, depth=0):
+    """lines of path with their includes expanded, as text for analysis."""
+    if depth > _DEPTH:
+        raise DedupError("%s: includes nested too deeply" % path)
+    out = []
+    for line in lines:
+        m = _INCLUDE.match(line)
+        if m:
+            target = os.path.join(os.path.dirname(path), m.group(1).decode("utf-8", "replace"))
+            out.append(_expand(target, _lines(_read(target)), depth + 1))
+        else:
+            out.append(line.decode("latin-1"))
+    return "".join(out)
+
+
+def families(sources):
+    """(paths, differing line indices) of the variant families in {path: data}."""
+    groups = collections.defaultdict(list)
+    for path, data in sources.items():
+        key = tuple((_toggle(line),) if _toggle(line) else line for line in _lines(data))
+        groups[(os.path.dirname(path), os.path.splitext(path)[1], key)].append(path)
+    out = []
+    for paths in groups.values():
+        if len(set(sources[p] for p in paths)) < 2:
+            continue
+        texts = [_lines(sources[p]) for p in paths]
+        differ = [i for i in range(len(texts[0])) if len(set(t[i] for t in texts)) > 1]
+        out.append((sorted(paths), differ))
+    return sorted(out)
+
+
+def _movable(path, lines, differ):
+    """Whether the differing lines of path can move up to its stub unchanged."""
+    start = 1 if lines[0].lstrip().startswith(b"#version") else 0
+    if differ[0] < start or not all(lines[i].endswith(b"\n") for i in differ):
+        return False
+    # Probe lines show whether a differing line sits inside a block comment.
+    probe = list(lines)
+    for i in differ:
+        probe[i] = b"#dedup\n"
+    blank = _lines(glsl.blank_comments(b"".join(probe).decode("latin-1")).encode("latin-1"))
+    if any(b"#dedup" not in blank[i] for i in differ):
+        return False
+
+    directives = []
+    for i, line in enumerate(blank):
+        m = _DIRECTIVE.match(line.decode("latin-1"))
+        if m:
+            directives.append((i, m.group(1), m.group(2)))
+    guard = (len(directives) > 2 and directives[0][1] == "ifndef"
+             and directives[1][1:] == ("define", directives[0][2])
+             and directives[-1][1] == "endif")
+    depth = 0
+    depths = {}
+    for n, (i, name, _) in enumerate(directives):
+        depths[i] = depth
+        if name in ("if", "ifdef", "ifndef"):
+            depth += 1
+        elif name == "endif":
+            depth -= 1
+            if depth == 0 and guard and n != len(directives) - 1:
+                guard = False
+    allowed = 1 if guard else 0
+    if any(depths.get(i) != allowed for i in differ):
+        return False
+
+    kept = [line for i, line in enumerate(lines) if i not in differ]
+    for n, i in enumerate(differ):
+        before = kept[start:i - n]
+        try:
+            text = glsl.blank_comments(_expand(path, before))
+        except (IOError, OSError, DedupError):
+            return False
+        if _toggle(lines[i]).decode("latin-1") in _IDENT.findall(text):
+            return False
+    return True
+
+
+def resolve(path):
+    """The bytes of path with its variant family body substituted back."""
+    data = _read(path)
+    lines = _lines(data)
+    for n, line in enumerate(lines):
+        m = _INCLUDE.match(line)
+        if not m:
+            continue
+        target = os.path.join(os.path.dirname(path), m.group(1).decode("utf-8", "replace"))
+        if not os.path.isfile(target):
+            continue
+        body = _lines(_read(target))
+        if not body or not body[0].startswith(HEADER):
+            continue
+        markers = sum(1 for b in body[1:] if _MARKER.match(b))
+        if markers > n:
+            raise DedupError("%s: %s has more markers than the stub has lines"
+                             % (path, m.group(1).decode("utf-8", "replace")))
+        own = iter(lines[n - markers:n])
+        out = lines[:n - markers]
+        out.extend(next(own) if _MARKER.match(b) else b for b in body[1:])
+        return b"".join(out + lines[n + 1:])
+    return data
+
+
+def dedup(root, min_body=MIN_BODY):
+    """Turns the variant families under root into stubs and hardlinks duplicates."""
+    stats = Stats()
+    sources = {}
+    for path in _files(root):
+        if path.endswith(EXTENSIONS):
+            sources[path] = _read(path)
+
+    for paths, differ in families(sources):
+        stem = min(paths, key=lambda p: (len(os.path.basename(p)), p))
+        body_path = os.path.splitext(stem)[0] + BODY
+        if os.path.exists(body_path):
+            continue
+        lines = _lines(sources[stem])
+        if not _movable(stem, lines, differ):
+            continue
+        start = 1 if lines[0].lstrip().startswith(b"#version") else 0
+        nl = _newline(sources[stem])
+        body = [HEADER + b", ".join(os.path.basename(p).encode() for p in paths)
+                + b"; see tools/slang-dedup.py" + nl]
+        for i, line in enumerate(lines[start:], start):
+            if i in differ:
+                indent = line[:len(line) - len(line.lstrip())]
+                body.append(indent + b"// " + _toggle(line) + b": set by the including file"
+                            + line[len(line.rstrip(b"\r\n")):])
+            elif _MARKER.match(line):
+                body = None
+                break
+            else:
+                body.append(line)
+        if body is None or len(b"".join(body)) < min_body:
+            continue
+        _write(body_path, b"".join(body))
+        include = b'#include "' + os.path.basename(body_path).encode() + b'"' + nl
+        for path in paths:
+            own = _lines(sources[path])
+            _write(path, b"".join(own[:start] + [own[i] for i in differ] + [include]))
+            if resolve(path) != sources[path]:
+                _write(path, sources[path])
+                raise DedupError("%s: stub does not resolve to the original" % path)
+            stats.stubs += 1
+        stats.bodies += 1
+    stats.links = hardlink(root)
+    return stats
+
+
+def hardlink(root):
+    """Hardlinks regular files under root with equal contents; returns links made."""
+    seen = {}
+    links = 0
+    for path in _files(root):
+        st = os.stat(path)
+        h = hashlib.sha256()
+        with open(path, "rb") as f:
+            for block in iter(lambda: f.read(1 << 16), b""):
+                h.update(block)
+        key = (st.st_size, h.digest())
+        first = seen.setdefault(key, path)
+        if first == path or os.path.samefile(first, path):
+            continue
+        fd, tmp = tempfile.mkstemp(dir=os.path.dirname(path))
+        os.close(fd)
+        os.unlink(tmp)
+        os.link(first, tmp)
+        os.replace(tmp, path)
+        links += 1
+    return links
+
+
+def size(root):
+    """Bytes used by the files under root, counting hardlinked files once."""
+    inodes = {}
+    for path in _files(root):
+        st = os.stat(path)
+        inodes[(st.st_dev, st.st_ino)] = st.st_size
+    return sum(inodes.values()), len(inodes)
+
+
+def verify(source, root):
+    """Files under root that do not resolve to their counterpart in source.
+
+    Files with no counterpart (bundles, family bodies) are not checked.
+    """
+    errors = []
+    for path in _files(root):
+        rel = os.path.relpath(path, root)
+        original = os.path.join(source, rel)
+        if not os.path.isfile(original):
+            continue
+        expected = _read(original)
+        try:
+            actual = resolve(path)
+        except (IOError, DedupError) as e:
+            errors.append("%s: %s" % (rel, e))
+            continue
+        if actual != expected:
+            errors.append("%s: differs from %s" % (rel, original))
+    return errors
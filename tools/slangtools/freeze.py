@@ -0,0 +1,135 @@
+"""Freezing #pragma parameters into compile time constants.
+
+A preset with
+
+    parameters_frozen = true
+
+asks for every parameter to be compiled in at its preset value (or its
+initial value when the preset does not set it); a ';' separated list of names
+freezes only those.  Every 'instance.NAME' access of a frozen parameter is
+replaced by a literal, the member is dropped from its uniform block and the
+#pragma parameter line goes away, so the compiler folds branches on it and the
+frontend no longer offers it.  This is what crt-royale's
+user-settings-fast-static-*.h do by hand.
+
+Literals are used rather than SPIR-V specialization constants, as the slang
+spec gives the frontend no way to supply those.
+"""
+
+import copy
+import re
+
+from . import glsl, preset
+
+OPTION = "parameters_frozen"
+
+_PARAMETER = re.compile(r'^[ \t]*#[ \t]*pragma[ \t]+parameter[ \t]+(\w+)[^\n]*\n?', re.M)
+_ALIAS = r'^[ \t]*#[ \t]*define[ \t]+(\w+)[ \t]+%s[ \t]*$'
+
+
+class FreezeError(Exception):
+    pass
+
+
+def frozen_names(p, shaders):
+    """Names of the parameters p freezes, given its loaded shaders."""
+    value = p.option(OPTION)
+    if value is None or value.strip().lower() in ("", "false", "0", "no", "off"):
+        return set()
+    declared = set(param.name for s in shaders for param in s.parameters)
+    if preset.parse_bool(value):
+        return declared
+    names = set(filter(None, (n.strip() for n in value.split(";"))))
+    unknown = names - declared
+    if unknown:
+        raise FreezeError("%s names undeclared parameters: %s"
+                          % (OPTION, ", ".join(sorted(unknown))))
+    return names
+
+
+def values(p, shaders):
+    """{name: value} of the frozen parameters of p."""
+    names = frozen_names(p, shaders)
+    result = {}
+    for s in shaders:
+        for param in s.parameters:
+            if param.name in names and param.name not in result:
+                result[param.name] = p.parameters.get(param.name, param.initial)
+    return result
+
+
+def _literal(t, value):
+    if t == "float":
+        text = repr(float(value))
+    elif t == "int":
+        text = "%d" % int(round(value))
+    elif t == "uint":
+        text = "%du" % max(0, int(round(value)))
+    else:
+        raise FreezeError("parameter member of type %s" % t)
+    return "(%s)" % text if text.startswith("-") else text
+
+
+def _drop_pragmas(text, frozen):
+    blank = glsl.blank_comments(text)
+    spans = [m.span() for m in _PARAMETER.finditer(blank) if m.group(1) in frozen]
+    for start, end in reversed(spans):
+        text = text[:start] + text[end:]
+    return text
+
+
+def freeze_stage(text, frozen):
+    """text with the parameters in frozen ({name: value}) compiled in.
+
+    Comments are only blanked out for the analysis; the edits are applied to
+    text itself, so license headers and the like survive.
+    """
+    blank = glsl.blank_comments(text)
+    literals = {}
+    instances = set()
+    blocks = glsl.blocks(blank)
+    for blk in blocks:
+        for t, name in blk.members:
+            if name in frozen:
+                if not blk.instance:
+                    raise FreezeError("'%s' is in an anonymous block" % name)
+                instances.add(blk.instance)
+                literals[name] = _literal(t, frozen[name])
+    if not literals:
+        return _drop_pragmas(text, frozen)
+
+    # '#define IN params' style aliases access the members as well.
+    for inst in list(instances):
+        instances |= set(re.findall(_ALIAS % inst, blank, re.M))
+    access = re.compile(r'\b(%s)\s*\.\s*(\w+)\b' % "|".join(sorted(instances)))
+    edits = [(m.span(), literals[m.group(2)]) for m in access.finditer(blank)
+             if m.group(2) in literals]
+    remaining = access.sub(lambda m: literals.get(m.group(2), m.group(0)), blank)
+
+    for blk in blocks:
+        kept = [(t, n) for t, n in blk.members if n not in literals]
+        if len(kept) == len(blk.members):
+            continue
+        if kept:
+            blk.members = kept
+            edits.append((blk.span, blk.declaration()))
+        elif len(re.findall(r'\b%s\b' % blk.instance, remaining)) == 1:
+            edits.append((blk.span, ""))
+        # Otherwise the instance is still named, if only in code that is
+        # preprocessed away; blocks cannot be empty, so this one stays.
+    for (start, end), new in sorted(edits, reverse=True):
+        text = text[:start] + new + text[end:]
+    return _drop_pragmas(text, frozen)
+
+
+def freeze(shader, frozen):
+    """A copy of the source.Shader with the frozen parameters compiled in."""
+    if not any(param.name in frozen for param in shader.parameters):
+        return shader
+    result = copy.copy(shader)
+    result.lines = freeze_stage(shader.text, frozen).splitlines(True)
+    result.stages = dict((stage, freeze_stage(text, frozen))
+                         for stage, text in shader.stages.items())
+    result.parameters = [param for param in shader.parameters
+                         if param.name not in frozen]
+    return result
@@ -0,0 +1,282 @@
+"""Fusion of a point-wise pass into the pass that consumes it.
+
+A pass A can be folded into the following pass B when A's output pixel only
+depends on the input texel at the same position, A does not resize, and
+nothing but B's Source reads A's output.  A's fragment main() then becomes a
+function and every texture(Source, uv) in B becomes a call of that function,
+which saves A's framebuffer write and B's read of it.
+
+Every check errs on the side of refusing: shaders are only understood
+textually (see glsl.py), so anything unusual is reported rather than fused.
+"""
+
+import re
+
+from . import chain, glsl, preset
+
+PUSH_CONSTANT_LIMIT = 128
+
+_IN = re.compile(r'layout\s*\([^)]*\)\s*in\s+(\w+)\s+(\w+)\s*;')
+_OUT = re.compile(r'layout\s*\([^)]*\)\s*out\s+(\w+)\s+(\w+)\s*;')
+_SAMPLER = re.compile(r'layout\s*\([^)]*\)\s*uniform\s+(\w*sampler\w*)\s+(\w+)\s*;')
+_PRAGMA_LINE = re.compile(r'^[ \t]*#[ \t]*pragma[ \t]+(name|format)\b[^\n]*\n?', re.M)
+_PARAMETER = re.compile(r'^[ \t]*#[ \t]*pragma[ \t]+parameter[ \t]+(\w+)([^\n]*)\n?', re.M)
+_VERSION = re.compile(r'^[ \t]*#[ \t]*version[^\n]*\n?', re.M)
+_EXTENSION = re.compile(r'^[ \t]*#[ \t]*extension\b', re.M)
+_FORBIDDEN_IN_A = ("dFdx", "dFdy", "fwidth", "gl_FragCoord", "discard",
+                   "texelFetch", "textureLod", "textureSize", "textureOffset",
+                   "textureGather")
+
+
+class FuseError(Exception):
+    pass
+
+
+class Stage(object):
+    """A pass during fusion: its settings and its comment-free source."""
+
+    def __init__(self, plan, origin):
+        self.pass_ = plan.pass_
+        self.text = glsl.strip_comments(plan.shader.text)
+        self.format = plan.format
+        self.origin = origin
+
+
+def _refs(text, instance):
+    """Member names accessed through instance, refusing any other use of it."""
+    members = re.findall(r'\b%s\s*\.\s*(\w+)' % instance, text)
+    if len(re.findall(r'\b%s\b' % instance, text)) != len(members):
+        raise FuseError("block instance '%s' is used other than as "
+                        "'%s.member'" % (instance, instance))
+    return members
+
+
+def _source_taps(text, coord=None):
+    """Number of texture(Source, ...) calls; refuses any other Source use."""
+    taps = 0
+    for _, _, args in glsl.calls(text, "texture"):
+        if args[0] != "Source":
+            continue
+        if len(args) != 2:
+            raise FuseError("texture(Source) with a bias")
+        if coord is not None and args[1] not in (coord, coord + ".xy"):
+            raise FuseError("samples Source at '%s', not at its own "
+                            "coordinate" % args[1])
+        taps += 1
+    if len(re.findall(r'\bSource\b', text)) != taps:
+        raise FuseError("uses Source other than through texture()")
+    return taps
+
+
+def _check_vertex(vertex, varying):
+    """A's vertex shader must only pass TexCoord through unchanged."""
+    _, brace, end = glsl.function_body(vertex, "main")
+    body = re.sub(r'\s+', '', vertex[brace + 1:end - 1])
+    statements = set(s for s in body.split(";") if s)
+    mvp = set(["gl_Position=MVP*Position", "gl_Position=global.MVP*Position"])
+    for s in statements:
+        if s in mvp:
+            continue
+        if re.match(r'^gl_Position=\w+\.MVP\*Position$', s):
+            continue
+        # Many shaders nudge TexCoord by 1.0001 against rounding; at 1:1 with
+        # point sampling that selects the same texel.
+        if re.match(r'^%s=TexCoord(\*(vec2\()?1\.0*1?\)?)?$' % varying, s):
+            continue
+        raise FuseError("vertex shader does more than pass TexCoord through "
+                        "('%s')" % s)
+
+
+def _analyze_point_wise(stage):
+    common, vertex, fragment = glsl.sections(stage.text.splitlines(True))
+    if _EXTENSION.search(stage.text):
+        raise FuseError("uses #extension")
+    ins = _IN.findall(fragment)
+    outs = _OUT.findall(fragment)
+    if len(ins) != 1 or ins[0][0] != "vec2":
+        raise FuseError("fragment shader needs exactly one vec2 input")
+    if len(outs) != 1 or outs[0][0] != "vec4":
+        raise FuseError("fragment shader needs exactly one vec4 output")
+    samplers = _SAMPLER.findall(common + fragment)
+    if [s[1] for s in samplers] != ["Source"]:
+        raise FuseError("samples more than Source")
+    code = common + fragment
+    for token in _FORBIDDEN_IN_A:
+        if re.search(r'\b%s\b' % token, code):
+            raise FuseError("uses %s" % token)
+    varying = ins[0][1]
+    _check_vertex(vertex, varying)
+    body = _SAMPLER.sub("", _OUT.sub("", _IN.sub("", fragment)))
+    if not _source_taps(common + body, varying):
+        raise FuseError("never samples Source")
+    return common, body, varying, outs[0][1]
+
+
+def _map_members(a_blocks, b_blocks, code, a_mod, b_mod):
+    """Decides where each member A reads lives in the fused shader.
+
+    Returns {(instance, member): "instance.member"} and extends b_blocks.
+    A renders 1:1, so its OutputSize is its SourceSize.
+    """
+    mapping = {}
+    push = next((b for b in b_blocks if b.push_constant), None)
+    ubo = next((b for b in b_blocks if not b.push_constant), None)
+    for blk in a_blocks:
+        if not blk.instance:
+            raise FuseError("anonymous uniform block")
+        for member in sorted(set(_refs(code, blk.instance))):
+            t = blk.member(member)
+            if t is None:
+                raise FuseError("'%s.%s' is not a block member" % (blk.instance, member))
+            name = "SourceSize" if member == "OutputSize" else member
+            if name == "FrameCount" and a_mod != b_mod:
+                raise FuseError("FrameCount used with a different frame_count_mod")
+            target = next((b for b in b_blocks if b.member(name)), None)
+            if target is not None:
+                if target.member(name) != t:
+                    raise FuseError("'%s' has different types in both passes" % name)
+            elif push is not None and glsl.block_size(
+                    push.members + [(t, name)], False) <= PUSH_CONSTANT_LIMIT:
+                target = push
+                push.members.append((t, name))
+            elif ubo is not None:
+                target = ubo
+                ubo.members.append((t, name))
+            else:
+                raise FuseError("no room for '%s' in the consumer's blocks" % name)
+            mapping[(blk.instance, member)] = "%s.%s" % (target.instance, name)
+    return mapping
+
+
+def _replace_spans(text, replacements):
+    for start, end, new in sorted(replacements, reverse=True):
+        text = text[:start] + new + text[end:]
+    return text
+
+
+def _function_from_main(fragment, name, varying, output, clamp):
+    start, brace, end = glsl.function_body(fragment, "main")
+    result = "clamp(%s, 0.0, 1.0)" % output if clamp else output
+    body = re.sub(r'\breturn\s*;', "return %s;" % result, fragment[brace + 1:end - 1])
+    func = "vec4 %s(vec2 %s)\n{\n\tvec4 %s = vec4(0.0);%s\n\treturn %s;\n}\n" % (
+        name, varying, output, body, result)
+    return fragment[:start] + func + fragment[end:]
+
+
+def fuse_sources(a, b, function_name, max_taps):
+    """Returns the fused source of stages a and b.  Raises FuseError."""
+    a_common, a_fragment, varying, output = _analyze_point_wise(a)
+    b_text = b.text
+    b_common, b_vertex, b_fragment = glsl.sections(b_text.splitlines(True))
+    if re.search(r'\bSource\b', b_common + b_vertex):
+        raise FuseError("consumer uses Source outside its fragment stage")
+    taps = _source_taps(_SAMPLER.sub("", b_fragment))
+    if taps == 0:
+        raise FuseError("consumer does not sample Source")
+    if taps > max_taps:
+        raise FuseError("consumer samples Source %d times (limit %d)" % (taps, max_taps))
+    own = set(n for t, n in _IN.findall(b_fragment) if t == "vec2")
+    own |= set(n + ".xy" for n in own)
+    if b.pass_.wrap_mode == "clamp_to_border" and any(
+            args[1] not in own for _, _, args in glsl.calls(b_fragment, "texture")
+            if args[0] == "Source"):
+        # Off-edge taps read black from A's output but A(black) when fused.
+        raise FuseError("consumer samples Source off its own coordinate "
+                        "with clamp_to_border")
+    if _EXTENSION.search(b_common):
+        raise FuseError("consumer uses #extension before its stages")
+
+    a_blocks = glsl.blocks(a_common + a_fragment)
+    a_code = a_common + a_fragment
+    for blk in sorted(glsl.blocks(a_code), key=lambda x: x.span, reverse=True):
+        a_code = a_code[:blk.span[0]] + a_code[blk.span[1]:]
+    a_code = _PRAGMA_LINE.sub("", _VERSION.sub("", a_code))
+
+    # Everything A defines must be invisible to B and vice versa.
+    b_idents = glsl.identifiers(b_text)
+    clash = glsl.top_level_names(a_code) & b_idents
+    clash |= glsl.defines(b_common) & glsl.identifiers(a_code)
+    if clash:
+        raise FuseError("names clash between the passes: %s" % ", ".join(sorted(clash)))
+
+    b_params = dict(_PARAMETER.findall(b_text))
+    for name, rest in _PARAMETER.findall(a_code):
+        if name in b_params and b_params[name].split() != rest.split():
+            raise FuseError("parameter '%s' is declared differently" % name)
+    a_code = _PARAMETER.sub(
+        lambda m: "" if m.group(1) in b_params else m.group(0), a_code)
+
+    b_blocks = glsl.blocks(b_common)
+    if glsl.blocks(b_vertex + b_fragment):
+        raise FuseError("consumer declares uniform blocks inside a stage")
+    mapping = _map_members(a_blocks, b_blocks, a_code,
+                           a.pass_.frame_count_mod, b.pass_.frame_count_mod)
+    a_code = re.sub(r'\b(\w+)\s*\.\s*(\w+)',
+                    lambda m: mapping.get((m.group(1), m.group(2)), m.group(0)),
+                    a_code)
+    clamp = not a.format.endswith("SFLOAT")
+    a_code = _function_from_main(a_code, function_name, varying, output, clamp)
+    a_code += "".join("#undef %s\n" % d for d in sorted(glsl.defines(a_code)))
+
+    b_common = _replace_spans(b_common, [blk.span + (blk.declaration(),) for blk in b_blocks])
+    b_common = _VERSION.sub("", b_common, count=1)
+    # A's function samples B's Source, so B's interface goes above it.
+    decls = sorted((m for r in (_IN, _OUT, _SAMPLER) for m in r.finditer(b_fragment)),
+                   key=lambda m: m.start())
+    interface = "".join(m.group(0) + "\n" for m in decls)
+    b_fragment = _replace_spans(b_fragment, [(m.start(), m.end(), "") for m in decls])
+    b_fragment = _replace_spans(b_fragment, [
+        (start, end, "%s(%s)" % (function_name, args[1]))
+        for start, end, args in glsl.calls(b_fragment, "texture")
+        if args[0] == "Source"])
+
+    text = ("#version 450\n\n"
+            "// Generated by tools/slang-fuse.py from\n"
+            "//   %s\n"
+            "// See those files for authorship and license terms.\n\n"
+            "%s#pragma stage vertex\n%s#pragma stage fragment\n%s\n%s\n%s"
+            % ("\n//   ".join(a.origin + b.origin), b_common, b_vertex,
+               interface, a_code, b_fragment))
+    return glsl.tidy(text)
+
+
+def check_pair(plans, i):
+    """Preset level conditions for folding pass i into pass i + 1."""
+    a, b = plans[i], plans[i + 1]
+    pa, pb = a.pass_, b.pass_
+    if pa.explicit_scale and not (pa.scale_x.scale_type == "source" == pa.scale_y.scale_type
+                                  and pa.scale_x.scale == 1.0 == pa.scale_y.scale):
+        raise FuseError("pass %d resizes" % i)
+    if pb.filter_linear is not False:
+        raise FuseError("pass %d does not set filter_linear = false" % (i + 1))
+    if pb.mipmap_input:
+        raise FuseError("pass %d mipmaps its input" % (i + 1))
+    if "_UINT" in a.format or "_SINT" in a.format:
+        raise FuseError("pass %d renders to an integer format" % i)
+    if i in chain.feedback_passes(plans):
+        raise FuseError("pass %d is read as feedback" % i)
+    names = set([a.alias, a.alias + "Size", a.alias + "Feedback",
+                 a.alias + "FeedbackSize"]) if a.alias else set()
+    for pp in plans:
+        idents = glsl.identifiers(pp.shader.text)
+        if names & idents:
+            raise FuseError("pass %d is read by pass %d through its alias" % (i, pp.index))
+        # Passes from i on are renumbered by the merge.
+        for ident in idents:
+            m = re.match(r'^Pass(?:Output|Feedback)(?:Size)?(\d+)$', ident)
+            if m and int(m.group(1)) >= i:
+                raise FuseError("pass %d refers to %s by number" % (pp.index, ident))
+
+
+def renumber(conf, index):
+    """Preset keys after pass index + 1 replaced passes index and index + 1."""
+    out = {}
+    for key, value in conf.items():
+        m = preset.PASS_KEYS.match(key)
+        n = int(m.group(2)) if m else None
+        if n is None:
+            out[key] = value
+        elif n != index:
+            out["%s%d" % (m.group(1), n - 1 if n > index else n)] = value
+    out["shaders"] = str(int(conf["shaders"]) - 1)
+    return out
@@ -0,0 +1,244 @@
+"""Where a chain pays for gamma-management.h's pow() calls, and how not to.
+
+With GAMMA_ENCODE_EVERY_FBO every pass encodes its output with pow() and the
+next pass decodes every texture tap with pow() again, which is most of the
+ALU cost of a wide blur.  Neither is needed when the framebuffer between the
+two passes stores linear values: an sRGB framebuffer encodes on write and
+decodes (before filtering) on read, and a float framebuffer has the precision
+to store linear light without banding.  analyze() finds those pass
+boundaries in a preset, and rewrite() switches them to linear storage: the
+upstream pass gets srgb_framebufferN (unless its framebuffer is float
+already) and #define GAMMA_LINEAR_OUTPUT, the downstream pass #define
+GAMMA_LINEAR_INPUT.  A boundary qualifies only if both passes manage gamma
+through gamma-management.h and nothing but the next pass reads the upstream
+output, since every other reader would decode it too.
+
+The passes that still decode per tap (the first pass, and passes behind a
+boundary that does not qualify) can use GAMMA_FAST_POW, whose coefficients
+fit_decode() computes, unless their gammas are runtime parameters.
+"""
+
+import math
+import re
+
+from . import chain, glsl
+
+HEADER = "gamma-management.h"
+LINEAR_FORMATS = ("_SRGB", "_SFLOAT")
+
+_DEFINE = re.compile(r'^[ \t]*#[ \t]*define[ \t]+(\w+)', re.M)
+
+
+class GammaError(Exception):
+    pass
+
+
+class PassGamma(object):
+    """What one pass does about gamma, from its preset entry and source."""
+
+    def __init__(self, plan):
+        self.plan = plan
+        self.index = plan.index
+        self.managed = any(path.endswith(HEADER) for path in plan.shader.includes)
+        self.defines = set(_DEFINE.findall(glsl.strip_comments(plan.shader.text)))
+        self.linear_storage = plan.format.endswith(LINEAR_FORMATS)
+
+    def defined(self, name):
+        return name in self.defines
+
+    @property
+    def every_fbo(self):
+        return self.managed and self.defined("GAMMA_ENCODE_EVERY_FBO")
+
+    @property
+    def static_gamma(self):
+        """Whether GAMMA_FAST_POW can take effect: no runtime gamma overrides."""
+        return self.defined("GAMMA_OVERRIDES_STATIC") or not any(
+            self.defined("OVERRIDE_%s_GAMMA" % kind) for kind in ("STANDARD", "DEVICE", "FINAL"))
+
+    @property
+    def decodes(self):
+        """Whether every texture tap of the input pays a pow()."""
+        if not self.managed:
+            return False
+        if self.defined("FIRST_PASS"):
+            return True
+        return self.every_fbo and not self.defined("GAMMA_LINEAR_INPUT")
+
+    @property
+    def encodes_between(self):
+        """Whether the output is pow() encoded for the next pass."""
+        return self.every_fbo and not self.defined("LAST_PASS") and \
+            not self.defined("GAMMA_LINEAR_OUTPUT")
+
+
+class Boundary(object):
+    """The framebuffer between pass index - 1 and pass index."""
+
+    def __init__(self, upstream, downstream, reason=None):
+        self.upstream = upstream
+        self.downstream = downstream
+        self.reason = reason
+
+    @property
+    def index(self):
+        return self.downstream.index
+
+    @property
+    def linear(self):
+        return self.reason is None
+
+
+def _outputs(plans, index):
+    """Sampler names under which later passes read the output of pass index."""
+    names = set(["PassOutput%d" % index, "PassFeedback%d" % index])
+    alias = plans[index].pass_.alias
+    if alias:
+        names.update([alias, alias + "Feedback"])
+    return names
+
+
+def _conflicts(plans, index):
+    """Why the output of pass index cannot be stored linear, or None.
+
+    Only the next pass may read it, and the next pass may not read any other
+    pass output or the original, which it would then stop decoding as well.
+    """
+    own = _outputs(plans, index)
+    readers = [pp.index for pp in plans
+               if pp.index != index + 1 and own & set(pp.samplers)]
+    if readers:
+        return "also read by pass %s" % ", ".join(str(i) for i in readers)
+    others = set()
+    for pp in plans:
+        if pp.index != index:
+            others |= _outputs(plans, pp.index)
+    down = plans[index + 1]
+    foreign = sorted(name for name in down.samplers
+                     if name in others or name.startswith("Original"))
+    if foreign:
+        return "pass %d also samples %s" % (down.index, ", ".join(foreign))
+    return None
+
+
+def analyze(p):
+    """(PassGamma per pass, Boundary per encoded pass boundary) of preset p."""
+    plans = chain.plan(p, (256, 224), (1024, 896))
+    passes = [PassGamma(pp) for pp in plans]
+    boundaries = []
+    for up, down in zip(passes, passes[1:]):
+        if not up.encodes_between:
+            continue
+        reason = None
+        if not down.decodes:
+            reason = "pass %d does not decode its input" % down.index
+        else:
+            reason = _conflicts(plans, up.index)
+        if reason is None and up.plan.shader.format and not up.linear_storage:
+            reason = "pass %d sets #pragma format %s" % (up.index, up.plan.shader.format)
+        boundaries.append(Boundary(up, down, reason))
+    return passes, boundaries
+
+
+def rewrite(p, passes, boundaries, fast_pow):
+    """(preset keys to set, {pass index: #defines to add}) for linear storage.
+
+    fast_pow adds GAMMA_FAST_POW to the passes still decoding per tap whose
+    gammas are static.
+    """
+    keys = {}
+    defines = {}
+    linear_inputs = set()
+    for b in boundaries:
+        if not b.linear:
+            continue
+        if not b.upstream.linear_storage:
+            keys["srgb_framebuffer%d" % b.upstream.index] = "true"
+        defines.setdefault(b.upstream.index, []).append("GAMMA_LINEAR_OUTPUT")
+        defines.setdefault(b.downstream.index, []).append("GAMMA_LINEAR_INPUT")
+        linear_inputs.add(b.downstream.index)
+    if fast_pow:
+        for pg in passes:
+            if pg.decodes and pg.static_gamma and pg.index not in linear_inputs and \
+                    not pg.defined("GAMMA_FAST_POW"):
+                defines.setdefault(pg.index, []).append("GAMMA_FAST_POW")
+    return keys, defines
+
+
+def add_defines(text, names):
+    """Shader text with #defines for names right after its #version line."""
+    first, _, rest = text.partition("\n")
+    return first + "\n" + "".join("#define %s\n" % n for n in names) + rest
+
+
+#################################  FAST POW  ###################################
+
+# The gammas gamma-management.h defines, plus sRGB's 2.4.
+FAST_POW_GAMMAS = (2.2, 2.35, 2.4, 2.5, 2.8, 3.5)
+
+
+def _solve(a, b):
+    n = len(b)
+    m = [row[:] + [v] for row, v in zip(a, b)]
+    for i in range(n):
+        pivot = max(range(i, n), key=lambda r: abs(m[r][i]))
+        m[i], m[pivot] = m[pivot], m[i]
+        for r in range(n):
+            if r != i:
+                f = m[r][i] / m[i][i]
+                for c in range(i, n + 1):
+                    m[r][c] -= f * m[i][c]
+    return [m[i][n] / m[i][i] for i in range(n)]
+
+
+def decode_fast(x, coeffs):
+    s = math.sqrt(x)
+    return x * x * (coeffs[0] + s * (coeffs[1] + s * (coeffs[2] + s * coeffs[3])))
+
+
+def decode_error(gamma, coeffs):
+    """Largest error of decode_fast over 8 bit inputs, in 8 bit steps of the
+    input re-encoded exactly."""
+    worst = 0.0
+    for k in range(256):
+        x = k / 255.0
+        worst = max(worst, abs(max(decode_fast(x, coeffs), 0.0) ** (1.0 / gamma) - x) * 255.0)
+    return worst
+
+
+def fit_decode(gamma, iterations=200):
+    """Coefficients c of pow(x, gamma) ~= x^2 (c0 + c1 s + c2 s^2 + c3 s^3),
+    s = sqrt(x), for gamma in [2, 4).
+
+    The error is minimized in steps of the re-encoded 8 bit input, which
+    weights it towards black the way the eye does, by iteratively reweighted
+    least squares with the sum pinned to 1 so that white decodes exactly.
+    """
+    if not 2.0 <= gamma < 4.0:
+        raise GammaError("gamma %g is outside [2, 4)" % gamma)
+    xs = [k / 255.0 for k in range(1, 256)]
+    weights = [1.0] * len(xs)
+    rows = []
+    for x in xs:
+        s = math.sqrt(x)
+        # d(encoded)/d(decoded), times x^2, makes the residual 8 bit steps.
+        scale = 255.0 / gamma * x ** (1.0 - gamma) * x * x
+        rows.append(([(s ** i - 1.0) * scale for i in (1, 2, 3)],
+                     (x ** (gamma - 2.0) - 1.0) * scale))
+    coeffs = None
+    for _ in range(iterations):
+        a = [[0.0] * 3 for _ in range(3)]
+        b = [0.0] * 3
+        for (phi, r), w in zip(rows, weights):
+            for i in range(3):
+                b[i] += w * phi[i] * r
+                for j in range(3):
+                    a[i][j] += w * phi[i] * phi[j]
+        c = _solve(a, b)
+        coeffs = [1.0 - sum(c)] + c
+        errors = [abs(max(decode_fast(x, coeffs), 0.0) ** (1.0 / gamma) - x) + 1e-12
+                  for x in xs]
+        weights = [w * e for w, e in zip(weights, errors)]
+        total = sum(weights)
+        weights = [w * len(weights) / total for w in weights]
+    return coeffs
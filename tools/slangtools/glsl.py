@@ -0,0 +1,270 @@
+"""Light-weight textual analysis of Vulkan GLSL.
+
+This is not a parser.  It handles the regular shape slang shaders have in
+practice (uniform blocks, a main() per stage, texture() calls) and tools built
+on it must refuse anything they cannot prove they understood.
+"""
+
+import re
+
+_COMMENT = re.compile(r'//[^\n]*|/\*.*?\*/', re.S)
+_BLOCK = re.compile(r'layout\s*\(([^)]*)\)\s*uniform\s+(\w+)\s*\{([^}]*)\}\s*(\w*)\s*;')
+_MEMBER = re.compile(r'^\s*(?:(?:highp|mediump|lowp)\s+)?(\w+)\s+(\w+\s*(?:\[\s*\d+\s*\])?'
+                     r'(?:\s*,\s*\w+\s*(?:\[\s*\d+\s*\])?)*)\s*$')
+_DEFINE = re.compile(r'^[ \t]*#[ \t]*define[ \t]+(\w+)', re.M)
+_CONDITIONAL = re.compile(r'^[ \t]*#[ \t]*(?:if|ifdef|ifndef|elif|else|endif)\b[^\n]*$', re.M)
+_IDENT = re.compile(r'\b[A-Za-z_]\w*\b')
+_DIRECTIVE = re.compile(r'^[ \t]*#[ \t]*(\w+)[ \t]*(.*)$')
+_MACRO = re.compile(r'^(\w+)\b(?!\()\s*(.*)$')
+_DEFINED = re.compile(r'\bdefined\s*(?:\(\s*(\w+)\s*\)|(\w+))')
+_STAGE = re.compile(r'^\s*#\s*pragma\s+stage\s+(\w+)')
+
+# (size, alignment) of scalar, vector and matrix types under std140/std430.
+_TYPES = {
+    "float": (4, 4), "int": (4, 4), "uint": (4, 4), "bool": (4, 4),
+    "vec2": (8, 8), "ivec2": (8, 8), "uvec2": (8, 8), "bvec2": (8, 8),
+    "vec3": (12, 16), "ivec3": (12, 16), "uvec3": (12, 16), "bvec3": (12, 16),
+    "vec4": (16, 16), "ivec4": (16, 16), "uvec4": (16, 16), "bvec4": (16, 16),
+    "mat2": (32, 16), "mat3": (48, 16), "mat4": (64, 16),
+}
+
+
+class GlslError(Exception):
+    pass
+
+
+def strip_comments(text):
+    """Removes comments, keeping line structure for block comments."""
+    return _COMMENT.sub(lambda m: "\n" * m.group(0).count("\n") or " ", text)
+
+
+def blank_comments(text):
+    """Blanks comments out in place, so offsets still index the original."""
+    return _COMMENT.sub(lambda m: re.sub(r'[^\n]', ' ', m.group(0)), text)
+
+
+def tidy(text):
+    """Drops trailing blanks and the runs of empty lines stripping leaves."""
+    return re.sub(r'\n{3,}', '\n\n', re.sub(r'[ \t]+\n', '\n', text))
+
+
+def identifiers(text):
+    return set(_IDENT.findall(text))
+
+
+def defines(text):
+    return set(_DEFINE.findall(text))
+
+
+def _condition(expr, macros):
+    """Evaluates an #if expression; unknown identifiers are 0 as in C."""
+    expr = _DEFINED.sub(lambda m: " 1 " if (m.group(1) or m.group(2)) in macros else " 0 ", expr)
+    for _ in range(8):
+        expanded = _IDENT.sub(lambda m: "(%s)" % macros[m.group(0)] if macros.get(m.group(0)) else m.group(0), expr)
+        if expanded == expr:
+            break
+        expr = expanded
+    expr = _IDENT.sub("0", expr)
+    expr = expr.replace("&&", " and ").replace("||", " or ")
+    expr = re.sub(r'!(?!=)', " not ", expr)
+    try:
+        return bool(eval(expr, {"__builtins__": {}}, {}))
+    except Exception:
+        return True
+
+
+def active(text):
+    """Blanks the lines preprocessor conditionals exclude, keeping line
+    structure.  Only object-like #defines met along the way are known, and an
+    #if or #elif that cannot be evaluated counts as true."""
+    macros = {}
+    stack = []
+    on = True
+    out = []
+    for line in blank_comments(text).split("\n"):
+        m = _DIRECTIVE.match(line)
+        word, arg = (m.group(1), m.group(2).strip()) if m else (None, "")
+        if word in ("if", "ifdef", "ifndef"):
+            if word == "if":
+                cond = on and _condition(arg, macros)
+            else:
+                cond = (arg.split()[0] in macros if arg else False) == (word == "ifdef")
+            stack.append([on, cond])
+            on = on and cond
+        elif word == "elif" and stack:
+            outer, taken = stack[-1]
+            cond = outer and not taken and _condition(arg, macros)
+            stack[-1][1] = taken or cond
+            on = cond
+        elif word == "else" and stack:
+            outer, taken = stack[-1]
+            stack[-1][1] = True
+            on = outer and not taken
+        elif word == "endif" and stack:
+            on = stack.pop()[0]
+        elif not on:
+            line = ""
+        elif word == "define":
+            d = _MACRO.match(arg)
+            if d:
+                macros[d.group(1)] = d.group(2).rstrip("\\").strip()
+            elif arg:
+                macros[_IDENT.match(arg).group(0)] = ""
+        elif word == "undef" and arg:
+            macros.pop(arg.split()[0], None)
+        out.append(line)
+    return "\n".join(out)
+
+
+def sections(lines):
+    """Splits raw .slang lines into (common, vertex, fragment) texts."""
+    parts = {None: [], "vertex": [], "fragment": []}
+    active = None
+    for line in lines:
+        m = _STAGE.match(line)
+        if m:
+            active = m.group(1)
+            if active not in parts:
+                raise GlslError("unknown stage '%s'" % active)
+            continue
+        parts[active].append(line)
+    return "".join(parts[None]), "".join(parts["vertex"]), "".join(parts["fragment"])
+
+
+def matching(text, start, open_ch="(", close_ch=")"):
+    """Index just past the bracket closing the one at text[start]."""
+    depth = 0
+    for i in range(start, len(text)):
+        if text[i] == open_ch:
+            depth += 1
+        elif text[i] == close_ch:
+            depth -= 1
+            if depth == 0:
+                return i + 1
+    raise GlslError("unbalanced '%s'" % open_ch)
+
+
+def split_args(text):
+    """Splits a call's argument text on top level commas."""
+    args, depth, last = [], 0, 0
+    for i, c in enumerate(text):
+        if c in "([":
+            depth += 1
+        elif c in ")]":
+            depth -= 1
+        elif c == "," and depth == 0:
+            args.append(text[last:i].strip())
+            last = i + 1
+    args.append(text[last:].strip())
+    return args
+
+
+def calls(text, name):
+    """Yields (start, end, args) for every call of the function name."""
+    for m in re.finditer(r'\b%s\s*\(' % re.escape(name), text):
+        end = matching(text, m.end() - 1)
+        yield m.start(), end, split_args(text[m.end():end - 1])
+
+
+def function_body(text, name):
+    """(start of the definition, start of '{', end) of function name."""
+    m = re.search(r'\bvoid\s+%s\s*\(\s*(?:void)?\s*\)\s*\{' % re.escape(name), text)
+    if not m:
+        raise GlslError("no %s() found" % name)
+    brace = m.end() - 1
+    return m.start(), brace, matching(text, brace, "{", "}")
+
+
+class Block(object):
+    """A uniform block declaration: layout qualifiers, members and instance."""
+
+    def __init__(self, layout, type_name, instance, members, span=None):
+        self.span = span
+        self.layout = layout
+        self.type_name = type_name
+        self.instance = instance
+        self.members = members
+
+    @property
+    def push_constant(self):
+        return "push_constant" in self.layout
+
+    def member(self, name):
+        for t, n in self.members:
+            if n == name:
+                return t
+        return None
+
+    def declaration(self, indent="\t", newline="\n"):
+        body = "".join("%s%s %s;%s" % (indent, t, n, newline) for t, n in self.members)
+        return "layout(%s) uniform %s%s{%s%s} %s;%s" % (
+            self.layout, self.type_name, newline, newline, body, self.instance, newline)
+
+
+def _block(m):
+    members = []
+    # Members inside #ifdef and the like count as declared; a rewritten
+    # declaration() declares them unconditionally, which is harmless.
+    body = _CONDITIONAL.sub("", m.group(3))
+    for decl in body.split(";"):
+        if not decl.strip():
+            continue
+        mm = _MEMBER.match(decl)
+        if not mm:
+            raise GlslError("cannot parse block member '%s'" % decl.strip())
+        for name in mm.group(2).split(","):
+            members.append((mm.group(1), re.sub(r'\s+', '', name)))
+    return Block(m.group(1).strip(), m.group(2), m.group(4), members, m.span())
+
+
+def blocks(text):
+    return [_block(m) for m in _BLOCK.finditer(text)]
+
+
+def block_size(members, std140):
+    """Size in bytes of a block with the given (type, name) members."""
+    offset = 0
+    for t, name in members:
+        count = 1
+        m = re.search(r'\[\s*(\d+)\s*\]', name)
+        if m:
+            count = int(m.group(1))
+        if t not in _TYPES:
+            raise GlslError("unknown member type '%s'" % t)
+        size, align = _TYPES[t]
+        if std140 and (count > 1 or t.startswith("mat")):
+            align = 16
+        if not std140 and t.startswith("mat"):
+            size, align = {"mat2": (16, 8), "mat3": (48, 16), "mat4": (64, 16)}[t]
+        stride = size
+        if count > 1:
+            stride = (size + align - 1) // align * align
+        offset = (offset + align - 1) // align * align + stride * count
+    return offset
+
+
+_KEYWORDS = set(["layout", "uniform", "in", "out", "inout", "const", "struct",
+                 "void", "precision", "highp", "mediump", "lowp", "return",
+                 "if", "for", "while", "main"]) | set(_TYPES)
+
+
+def top_level_names(text):
+    """Names of the functions, globals and structs text declares."""
+    text = "\n".join(l for l in text.splitlines() if not l.lstrip().startswith("#"))
+    out, depth, parens = [], 0, 0
+    for c in text:
+        if c == "{":
+            depth += 1
+        elif c == "}":
+            depth -= 1
+            out.append(";")
+        elif depth == 0 and c == "(":
+            parens += 1
+            if parens == 1:
+                out.append(c)
+        elif depth == 0 and c == ")":
+            parens -= 1
+        elif depth == 0 and parens == 0:
+            out.append(c)
+    names = re.findall(r'\b([A-Za-z_]\w*)\s*[(=;\[,]', "".join(out))
+    return set(names) - _KEYWORDS
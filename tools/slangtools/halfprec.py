@@ -0,0 +1,1120 @@
+"""CPU emulation of blur functions at highp and at mediump.
+
+GPUs with 16 bit ALUs may run mediump math (RelaxedPrecision in SPIR-V) in
+FP16, but the Vulkan implementations in reach of these tools compute it in
+FP32, so rendering cannot show what BLUR_HALF_PRECISION costs.  This module
+evaluates the blurs on the CPU instead.  Program preprocesses the headers the
+way glslang would and interprets the subset of GLSL they are written in:
+every value gets the precision GLSL gives it (a declaration's qualifier, or
+the highest precision among an operation's operands, constants having none),
+highp results are rounded to FP32 and mediump results to FP16.  Rounding every
+mediump operation is the worst case a driver is allowed; real hardware keeps
+some intermediates wider.
+
+Values are evaluated for every pixel at once: a component is a float when it
+is uniform and a list with one float per pixel otherwise.  Branches and loops
+must be uniform, arrays can only be initialized and indexed with uniform
+ints, and out parameters and derivatives are not part of the subset;
+anything outside it raises HalfPrecError rather than guessing.
+"""
+
+import collections
+import math
+import os
+import re
+import struct
+
+from . import glsl
+
+
+class HalfPrecError(Exception):
+    pass
+
+
+_FLOAT_TYPES = {"float": 1, "vec2": 2, "vec3": 3, "vec4": 4}
+_INT_TYPES = {"int": 1, "ivec2": 2, "ivec3": 3, "ivec4": 4, "uint": 1}
+_BOOL_TYPES = {"bool": 1, "bvec2": 2, "bvec3": 3, "bvec4": 4}
+_SAMPLER_TYPES = ("sampler2D",)
+_PRECISIONS = {"highp": "high", "mediump": "half", "lowp": "half"}
+_QUALIFIERS = ("const", "in", "uniform", "static", "inline")
+_KEYWORDS = ("return", "if", "else", "for", "while", "do", "switch", "case",
+             "break", "continue", "discard", "true", "false")
+_RANK = {None: 0, "half": 1, "high": 2}
+_SWIZZLE = dict(zip("xyzwrgbastpq", (0, 1, 2, 3) * 3))
+
+
+def _type_size(name):
+    for table in (_FLOAT_TYPES, _INT_TYPES, _BOOL_TYPES):
+        if name in table:
+            return table[name]
+    return None
+
+
+def _type_kind(name):
+    if name in _FLOAT_TYPES:
+        return "float"
+    if name in _INT_TYPES:
+        return "int"
+    if name in _BOOL_TYPES:
+        return "bool"
+    if name in _SAMPLER_TYPES:
+        return "sampler"
+    raise HalfPrecError("unsupported type %s" % name)
+
+
+#####################################  ROUNDING  ###############################
+
+def _round_scalar(x, code):
+    try:
+        return struct.unpack(code, struct.pack(code, x))[0]
+    except OverflowError:
+        return math.copysign(math.inf, x)
+
+
+def _round(c, prec):
+    """Component c rounded to FP32 ("high") or FP16 ("half")."""
+    if prec is None:
+        return c
+    code = "e" if prec == "half" else "f"
+    if isinstance(c, list):
+        fmt = "%d%s" % (len(c), code)
+        try:
+            return list(struct.unpack(fmt, struct.pack(fmt, *c)))
+        except OverflowError:
+            return [_round_scalar(x, code) for x in c]
+    return _round_scalar(c, code)
+
+
+def _map(f, *cs):
+    """f applied per pixel to components, broadcasting uniform ones."""
+    n = None
+    for c in cs:
+        if isinstance(c, list):
+            n = len(c)
+            break
+    if n is None:
+        return f(*cs)
+    if len(cs) == 1:
+        return [f(x) for x in cs[0]]
+    if len(cs) == 2:
+        a, b = cs
+        if isinstance(a, list):
+            if isinstance(b, list):
+                return [f(x, y) for x, y in zip(a, b)]
+            return [f(x, b) for x in a]
+        return [f(a, y) for y in b]
+    cols = [c if isinstance(c, list) else [c] * n for c in cs]
+    return [f(*xs) for xs in zip(*cols)]
+
+
+def _safe(f):
+    def g(*args):
+        try:
+            return f(*args)
+        except OverflowError:
+            return math.inf
+        except (ValueError, ZeroDivisionError):
+            return math.nan
+    return g
+
+
+def _div(x, y):
+    try:
+        return x / y
+    except ZeroDivisionError:
+        if x == 0 or x != x:
+            return math.nan
+        return math.copysign(math.inf, x) * math.copysign(1.0, y)
+
+
+def _log2(x):
+    if x == 0:
+        return -math.inf
+    return math.log2(x) if x > 0 else math.nan
+
+
+def _pow(x, y):
+    # GLSL leaves pow undefined for x < 0, and x == 0 with y <= 0; this takes
+    # the exp2(y*log2(x)) most hardware uses.
+    return _safe(math.exp2)(y * _log2(x)) if x != 0 or y > 0 else \
+        (math.inf if y < 0 else math.nan)
+
+
+###################################  VALUES  ###################################
+
+class Val(object):
+    """A scalar or vector: kind is "float", "int" or "bool"."""
+
+    __slots__ = ("comps", "prec", "kind")
+
+    def __init__(self, comps, prec, kind):
+        self.comps = comps
+        self.prec = prec
+        self.kind = kind
+
+    @property
+    def uniform(self):
+        return not any(isinstance(c, list) for c in self.comps)
+
+
+class Texture(object):
+    """RGBA texels sampled with bilinear filtering and clamp to edge.
+
+    weight_bits rounds the filter weights the way GPUs do (most use 8 bits
+    of sub-texel precision); None filters exactly.
+    """
+
+    def __init__(self, width, height, texels, weight_bits=None):
+        self.width = width
+        self.height = height
+        self.channels = [[t[i] for t in texels] for i in range(4)]
+        self.weight_bits = weight_bits
+
+    def sample(self, u, v):
+        w, h = self.width, self.height
+        channels = self.channels
+        steps = 1 << self.weight_bits if self.weight_bits else 0
+
+        def one(u, v):
+            x = u * w - 0.5
+            y = v * h - 0.5
+            x0 = math.floor(x)
+            y0 = math.floor(y)
+            fx = x - x0
+            fy = y - y0
+            if steps:
+                fx = round(fx * steps) / steps
+                fy = round(fy * steps) / steps
+            xa = min(max(x0, 0), w - 1)
+            xb = min(max(x0 + 1, 0), w - 1)
+            ya = min(max(y0, 0), h - 1) * w
+            yb = min(max(y0 + 1, 0), h - 1) * w
+            out = []
+            for ch in channels:
+                top = ch[ya + xa] + (ch[ya + xb] - ch[ya + xa]) * fx
+                bottom = ch[yb + xa] + (ch[yb + xb] - ch[yb + xa]) * fx
+                out.append(top + (bottom - top) * fy)
+            return out
+
+        if not isinstance(u, list) and not isinstance(v, list):
+            return one(u, v)
+        texels = _map(one, u, v)
+        return [[t[i] for t in texels] for i in range(4)]
+
+    def gather(self, u, v, comp):
+        """textureGather: channel comp of the 2x2 texels bilinear filtering
+        at (u, v) reads, in the order (0, 1), (1, 1), (1, 0), (0, 0)."""
+        w, h = self.width, self.height
+        ch = self.channels[comp]
+
+        def one(u, v):
+            x0 = math.floor(u * w - 0.5)
+            y0 = math.floor(v * h - 0.5)
+            xa = min(max(x0, 0), w - 1)
+            xb = min(max(x0 + 1, 0), w - 1)
+            ya = min(max(y0, 0), h - 1) * w
+            yb = min(max(y0 + 1, 0), h - 1) * w
+            return [ch[yb + xa], ch[yb + xb], ch[ya + xb], ch[ya + xa]]
+
+        if not isinstance(u, list) and not isinstance(v, list):
+            return one(u, v)
+        texels = _map(one, u, v)
+        return [[t[i] for t in texels] for i in range(4)]
+
+    def fetch(self, x, y):
+        if not 0 <= x < self.width or not 0 <= y < self.height:
+            return [0.0] * 4
+        return [ch[y * self.width + x] for ch in self.channels]
+
+
+################################  PREPROCESSOR  ################################
+
+_TOKEN = re.compile(r'\s*(?:'
+                    r'((?:\d+\.\d*|\.\d+)(?:[eE][-+]?\d+)?|\d+[eE][-+]?\d+)[fF]?|'
+                    r'(\d+)[uU]?|'
+                    r'([A-Za-z_]\w*)|'
+                    r'(\+\+|--|\+=|-=|\*=|/=|<=|>=|==|!=|&&|\|\||[-+*/%<>=!?:;,.(){}\[\]]))')
+_DIRECTIVE = re.compile(r'^\s*#\s*(\w*)\s*(.*?)\s*$')
+_FUNCTION_MACRO = re.compile(r'(\w+)\(([^)]*)\)\s*(.*)$')
+
+
+def tokenize(text):
+    out = []
+    pos = 0
+    text = text.rstrip()
+    while pos < len(text):
+        m = _TOKEN.match(text, pos)
+        if not m:
+            raise HalfPrecError("cannot tokenize %r" % text[pos:pos + 20])
+        pos = m.end()
+        if m.group(1) is not None:
+            out.append(("num", float(m.group(1))))
+        elif m.group(2) is not None:
+            out.append(("int", int(m.group(2))))
+        elif m.group(3) is not None:
+            out.append(("id", m.group(3)))
+        else:
+            out.append(("op", m.group(4)))
+    return out
+
+
+def _expand(tokens, macros, hidden=frozenset()):
+    out = []
+    i = 0
+    while i < len(tokens):
+        t = tokens[i]
+        macro = macros.get(t[1]) if t[0] == "id" and t[1] not in hidden else None
+        if macro is None:
+            out.append(t)
+            i += 1
+            continue
+        params, body = macro
+        if params is None:
+            out.extend(_expand(body, macros, hidden | {t[1]}))
+            i += 1
+            continue
+        if i + 1 >= len(tokens) or tokens[i + 1] != ("op", "("):
+            out.append(t)
+            i += 1
+            continue
+        args = [[]]
+        depth = 0
+        j = i + 2
+        while True:
+            if j >= len(tokens):
+                raise HalfPrecError("unterminated call of macro %s" % t[1])
+            tok = tokens[j]
+            if tok == ("op", ")") and depth == 0:
+                break
+            if tok == ("op", ",") and depth == 0:
+                args.append([])
+            else:
+                depth += {"(": 1, ")": -1}.get(tok[1], 0) if tok[0] == "op" else 0
+                args[-1].append(tok)
+            j += 1
+        if params == [] and args == [[]]:
+            args = []
+        if len(args) != len(params):
+            raise HalfPrecError("macro %s takes %d arguments" % (t[1], len(params)))
+        sub = []
+        for b in body:
+            if b[0] == "id" and b[1] in params:
+                sub.extend(args[params.index(b[1])])
+            else:
+                sub.append(b)
+        out.extend(_expand(sub, macros, hidden | {t[1]}))
+        i = j + 1
+    return out
+
+
+def preprocess(path, defines=(), _macros=None, _stack=None):
+    """Tokens of path with includes, conditionals and macros resolved."""
+    macros = _macros if _macros is not None else \
+        dict((d, (None, [])) for d in defines)
+    stack = [] if _stack is None else _stack
+    if len(stack) > 32:
+        raise HalfPrecError("%s: includes nest too deeply" % path)
+    with open(path) as f:
+        text = glsl.strip_comments(f.read().replace("\\\n", ""))
+    out = []
+    conditions = []  # [active, taken] per open #if
+    for number, line in enumerate(text.split("\n"), 1):
+        active = all(c[0] for c in conditions)
+        m = _DIRECTIVE.match(line)
+        if not m:
+            if active and line.strip():
+                out.extend(_expand(tokenize(line), macros))
+            continue
+        directive, rest = m.groups()
+        where = "%s:%d" % (path, number)
+        if directive in ("ifdef", "ifndef"):
+            value = (rest in macros) == (directive == "ifdef")
+            conditions.append([value, value])
+        elif directive == "if":
+            if active:
+                raise HalfPrecError("%s: #if is not supported" % where)
+            conditions.append([False, True])
+        elif directive == "else":
+            if not conditions:
+                raise HalfPrecError("%s: #else without #if" % where)
+            conditions[-1][0] = not conditions[-1][1]
+            conditions[-1][1] = True
+        elif directive == "endif":
+            if not conditions:
+                raise HalfPrecError("%s: #endif without #if" % where)
+            conditions.pop()
+        elif not active:
+            continue
+        elif directive == "define":
+            fm = _FUNCTION_MACRO.match(rest)
+            if fm:
+                params = [p.strip() for p in fm.group(2).split(",") if p.strip()]
+                macros[fm.group(1)] = (params, tokenize(fm.group(3)))
+            else:
+                words = rest.split(None, 1)
+                macros[words[0]] = (None, tokenize(words[1] if len(words) > 1 else ""))
+        elif directive == "undef":
+            macros.pop(rest, None)
+        elif directive == "include":
+            target = os.path.join(os.path.dirname(path), rest.strip('"'))
+            out.extend(preprocess(target, defines, macros, stack + [path]))
+        elif directive == "error":
+            raise HalfPrecError("%s: #error %s" % (where, rest))
+        elif directive not in ("pragma", "version", "extension", "line", ""):
+            raise HalfPrecError("%s: #%s is not supported" % (where, directive))
+    if conditions:
+        raise HalfPrecError("%s: unterminated #if" % path)
+    return out
+
+
+###################################  PARSER  ###################################
+
+_BINARY = {
+    "||": 1, "&&": 2, "==": 3, "!=": 3,
+    "<": 4, ">": 4, "<=": 4, ">=": 4,
+    "+": 5, "-": 5, "*": 6, "/": 6, "%": 6,
+}
+_ASSIGN = ("=", "+=", "-=", "*=", "/=")
+
+
+class _Function(object):
+    def __init__(self, name, ret, params, body):
+        self.name = name
+        self.ret = ret        # (prec, type)
+        self.params = params  # [(prec, type, name)]
+        self.body = body      # tokens, parsed on first call
+        self.ast = None
+
+
+class _Parser(object):
+    def __init__(self, tokens):
+        self.tokens = tokens
+        self.pos = 0
+
+    def peek(self, offset=0):
+        i = self.pos + offset
+        return self.tokens[i] if i < len(self.tokens) else (None, None)
+
+    def next(self):
+        t = self.peek()
+        if t[0] is None:
+            raise HalfPrecError("unexpected end of source")
+        self.pos += 1
+        return t
+
+    def accept(self, op):
+        if self.peek() == ("op", op):
+            self.pos += 1
+            return True
+        return False
+
+    def expect(self, op):
+        t = self.next()
+        if t != ("op", op):
+            raise HalfPrecError("expected %r, found %r" % (op, t[1]))
+
+    def ident(self):
+        t = self.next()
+        if t[0] != "id":
+            raise HalfPrecError("expected a name, found %r" % (t[1],))
+        return t[1]
+
+    def type_spec(self):
+        """(precision, type) after any qualifiers, or None."""
+        prec = None
+        start = self.pos
+        while self.peek()[0] == "id" and (self.peek()[1] in _QUALIFIERS or
+                                          self.peek()[1] in _PRECISIONS):
+            word = self.next()[1]
+            if word in _PRECISIONS:
+                prec = word
+        t = self.peek()
+        # Types this cannot evaluate still parse; using them raises.
+        if t[0] == "id" and t[1] not in _KEYWORDS and self.peek(1)[0] == "id" \
+                and self.peek(1)[1] not in _KEYWORDS:
+            self.pos += 1
+            return prec, t[1]
+        self.pos = start
+        return None
+
+    # Top level.
+
+    def unit(self):
+        functions = {}
+        globals_ = {}
+        while self.peek()[0] is not None:
+            if self.accept(";"):
+                continue
+            start = self.pos
+            spec = self.type_spec()
+            if spec is None:
+                self._skip_item(start)
+                continue
+            name = self.ident()
+            if self.accept("("):
+                try:
+                    params = self._params()
+                except HalfPrecError:
+                    self._skip_item(start)
+                    continue
+                if self.accept(";"):
+                    continue
+                body_start = self.pos
+                self._skip_braces()
+                functions.setdefault(name, []).append(
+                    _Function(name, spec, params, self.tokens[body_start:self.pos]))
+                continue
+            try:
+                self.pos -= 1
+                for var, expr in self._declarators():
+                    globals_[var] = (spec, expr)
+            except HalfPrecError:
+                self._skip_item(start)
+        return functions, globals_
+
+    def _skip_item(self, start):
+        self.pos = start
+        depth = 0
+        while self.peek()[0] is not None:
+            t = self.next()
+            if t == ("op", "{"):
+                depth += 1
+            elif t == ("op", "}"):
+                depth -= 1
+                if depth == 0 and not self.peek() == ("op", ";"):
+                    return
+            elif t == ("op", ";") and depth == 0:
+                return
+
+    def _skip_braces(self):
+        self.expect("{")
+        depth = 1
+        while depth:
+            t = self.next()
+            if t == ("op", "{"):
+                depth += 1
+            elif t == ("op", "}"):
+                depth -= 1
+
+    def _params(self):
+        params = []
+        if self.accept(")"):
+            return params
+        if self.peek() == ("id", "void") and self.peek(1) == ("op", ")"):
+            self.pos += 2
+            return params
+        while True:
+            for word in ("out", "inout"):
+                if self.peek() == ("id", word):
+                    raise HalfPrecError("%s parameters are not supported" % word)
+            spec = self.type_spec()
+            if spec is None:
+                raise HalfPrecError("bad parameter near %r" % (self.peek()[1],))
+            params.append((spec[0], spec[1], self.ident()))
+            if self.accept(")"):
+                return params
+            self.expect(",")
+
+    def _declarators(self):
+        out = []
+        while True:
+            name = self.ident()
+            dims = 0
+            while self.accept("["):
+                if not self.accept("]"):
+                    self.expression()
+                    self.expect("]")
+                dims += 1
+            expr = self.expression() if self.accept("=") else None
+            out.append((name, ("array", expr) if dims else expr))
+            if self.accept(";"):
+                return out
+            self.expect(",")
+
+    # Statements.
+
+    def statements(self):
+        out = []
+        while self.peek()[0] is not None:
+            out.append(self.statement())
+        return out
+
+    def statement(self):
+        t = self.peek()
+        if self.accept("{"):
+            body = []
+            while not self.accept("}"):
+                body.append(self.statement())
+            return ("block", body)
+        if self.accept(";"):
+            return ("block", [])
+        if t == ("id", "return"):
+            self.pos += 1
+            if self.accept(";"):
+                return ("return", None)
+            e = self.expression()
+            self.expect(";")
+            return ("return", e)
+        if t == ("id", "if"):
+            self.pos += 1
+            self.expect("(")
+            cond = self.expression()
+            self.expect(")")
+            then = self.statement()
+            other = None
+            if self.peek() == ("id", "else"):
+                self.pos += 1
+                other = self.statement()
+            return ("if", cond, then, other)
+        if t == ("id", "for"):
+            self.pos += 1
+            self.expect("(")
+            init = self.statement()
+            cond = None if self.peek() == ("op", ";") else self.expression()
+            self.expect(";")
+            step = None if self.peek() == ("op", ")") else self.expression()
+            self.expect(")")
+            return ("for", init, cond, step, self.statement())
+        if t[0] == "id" and t[1] in ("while", "do", "switch", "break", "continue",
+                                     "discard"):
+            raise HalfPrecError("%s is not supported" % t[1])
+        spec = self.type_spec()
+        if spec is not None:
+            return ("decl", spec, self._declarators())
+        e = self.expression()
+        self.expect(";")
+        return ("expr", e)
+
+    # Expressions.
+
+    def expression(self):
+        left = self.ternary()
+        t = self.peek()
+        if t[0] == "op" and t[1] in _ASSIGN:
+            self.pos += 1
+            return ("assign", t[1], left, self.expression())
+        return left
+
+    def ternary(self):
+        cond = self.binary(1)
+        if not self.accept("?"):
+            return cond
+        a = self.expression()
+        self.expect(":")
+        return ("select", cond, a, self.expression())
+
+    def binary(self, level):
+        left = self.unary()
+        while True:
+            t = self.peek()
+            prec = _BINARY.get(t[1]) if t[0] == "op" else None
+            if prec is None or prec < level:
+                return left
+            self.pos += 1
+            left = ("bin", t[1], left, self.binary(prec + 1))
+
+    def unary(self):
+        t = self.peek()
+        if t[0] == "op" and t[1] in ("-", "+", "!"):
+            self.pos += 1
+            return ("unary", t[1], self.unary())
+        if t[0] == "op" and t[1] in ("++", "--"):
+            self.pos += 1
+            return ("assign", t[1][0] + "=", self.unary(), ("int", 1))
+        return self.postfix()
+
+    def postfix(self):
+        e = self.primary()
+        while True:
+            if self.accept("."):
+                e = ("member", e, self.ident())
+            elif self.accept("["):
+                e = ("index", e, self.expression())
+                self.expect("]")
+            elif self.peek() in (("op", "++"), ("op", "--")):
+                e = ("post", self.next()[1][0] + "=", e)
+            else:
+                return e
+
+    def primary(self):
+        t = self.next()
+        if t[0] in ("num", "int"):
+            return t
+        if t == ("op", "{"):
+            return ("list", self._list("}"))
+        if t == ("op", "("):
+            e = self.expression()
+            self.expect(")")
+            return e
+        if t[0] != "id":
+            raise HalfPrecError("unexpected %r" % (t[1],))
+        if t[1] in ("true", "false"):
+            return ("bool", t[1] == "true")
+        if self.peek() == ("op", "[") and self.peek(1) == ("op", "]"):
+            # An array constructor, vec3[](...).
+            self.pos += 2
+            self.expect("(")
+            return ("list", self._list(")"))
+        if self.accept("("):
+            return ("call", t[1], self._list(")"))
+        return ("var", t[1])
+
+    def _list(self, close):
+        items = []
+        if not self.accept(close):
+            while True:
+                items.append(self.expression())
+                if self.accept(close):
+                    break
+                self.expect(",")
+        return items
+
+
+#################################  EVALUATION  #################################
+
+class _Return(Exception):
+    def __init__(self, value):
+        Exception.__init__(self)
+        self.value = value
+
+
+def _join(*vals):
+    return max((v.prec for v in vals), key=_RANK.get)
+
+
+def _float(v):
+    if isinstance(v, Texture):
+        raise HalfPrecError("sampler used as a value")
+    if v.kind == "float":
+        return v
+    return Val([_map(float, c) for c in v.comps], None, "float")
+
+
+def _broadcast(a, b):
+    if len(a.comps) == len(b.comps):
+        return a.comps, b.comps
+    if len(a.comps) == 1:
+        return a.comps * len(b.comps), b.comps
+    if len(b.comps) == 1:
+        return a.comps, b.comps * len(a.comps)
+    raise HalfPrecError("size mismatch: %d and %d components"
+                        % (len(a.comps), len(b.comps)))
+
+
+def _convert(v, prec, type_name):
+    """v as a variable of the given declared precision and type."""
+    if isinstance(v, Texture):
+        if type_name not in _SAMPLER_TYPES:
+            raise HalfPrecError("sampler passed as %s" % type_name)
+        return v
+    kind = _type_kind(type_name)
+    size = _type_size(type_name)
+    if len(v.comps) != size:
+        if len(v.comps) == 1:
+            raise HalfPrecError("scalar assigned to %s" % type_name)
+        raise HalfPrecError("%d components assigned to %s" % (len(v.comps), type_name))
+    if kind == "float":
+        p = _PRECISIONS.get(prec, "high")
+        return Val([_round(c, p) for c in _float(v).comps], p, "float")
+    if kind != v.kind:
+        raise HalfPrecError("%s assigned to %s" % (v.kind, type_name))
+    return v
+
+
+_COMPARE = {
+    "<": lambda x, y: x < y, ">": lambda x, y: x > y,
+    "<=": lambda x, y: x <= y, ">=": lambda x, y: x >= y,
+    "==": lambda x, y: x == y, "!=": lambda x, y: x != y,
+}
+_ARITH = {
+    "+": lambda x, y: x + y, "-": lambda x, y: x - y,
+    "*": lambda x, y: x * y, "/": _div,
+}
+
+
+def _int_div(x, y):
+    if y == 0:
+        raise HalfPrecError("integer division by zero")
+    q = abs(x) // abs(y)
+    return q if (x < 0) == (y < 0) else -q
+
+
+def _binary(op, a, b):
+    if op in _COMPARE:
+        if a.kind != b.kind:
+            a, b = _float(a), _float(b)
+        ac, bc = _broadcast(a, b)
+        if len(ac) != 1 and op not in ("==", "!="):
+            raise HalfPrecError("%s on vectors" % op)
+        f = _COMPARE[op]
+        comps = [_map(f, x, y) for x, y in zip(ac, bc)]
+        if len(comps) > 1:
+            if any(isinstance(c, list) for c in comps):
+                raise HalfPrecError("non-uniform vector comparison")
+            comps = [all(comps) if op == "==" else any(comps)]
+        return Val(comps, None, "bool")
+    if op in ("&&", "||"):
+        raise HalfPrecError("%s is evaluated by the caller" % op)
+    if a.kind == "bool" or b.kind == "bool":
+        raise HalfPrecError("arithmetic on bool")
+    if a.kind == "int" and b.kind == "int":
+        ac, bc = _broadcast(a, b)
+        if op == "%":
+            f = lambda x, y: x - _int_div(x, y) * y
+        else:
+            f = _int_div if op == "/" else _ARITH[op]
+        return Val([_map(f, x, y) for x, y in zip(ac, bc)], None, "int")
+    if op == "%":
+        raise HalfPrecError("% on float")
+    a, b = _float(a), _float(b)
+    prec = _join(a, b)
+    ac, bc = _broadcast(a, b)
+    f = _ARITH[op]
+    return Val([_round(_map(f, x, y), prec) for x, y in zip(ac, bc)], prec, "float")
+
+
+def _componentwise(f, *vals):
+    """A builtin applied per component, with GLSL's precision rule."""
+    if all(v.kind == "int" for v in vals) and f in (abs, min, max, _clamp):
+        size = max(len(v.comps) for v in vals)
+        cols = [v.comps * size if len(v.comps) == 1 else v.comps for v in vals]
+        return Val([_map(f, *xs) for xs in zip(*cols)], None, "int")
+    vals = [_float(v) for v in vals]
+    size = max(len(v.comps) for v in vals)
+    cols = [v.comps * size if len(v.comps) == 1 else v.comps for v in vals]
+    if any(len(c) != size for c in cols):
+        raise HalfPrecError("size mismatch in builtin call")
+    prec = _join(*vals)
+    f = _safe(f)
+    return Val([_round(_map(f, *xs), prec) for xs in zip(*cols)], prec, "float")
+
+
+def _fract(x):
+    return x - math.floor(x)
+
+
+def _sign(x):
+    return (x > 0) - (x < 0) if x == x else x
+
+
+def _clamp(x, lo, hi):
+    return min(max(x, lo), hi)
+
+
+def _mix(x, y, a):
+    return x * (1.0 - a) + y * a
+
+
+def _dot(a, b):
+    a, b = _float(a), _float(b)
+    if len(a.comps) != len(b.comps):
+        raise HalfPrecError("dot of different sizes")
+    prec = _join(a, b)
+    total = None
+    for x, y in zip(a.comps, b.comps):
+        term = _round(_map(lambda p, q: p * q, x, y), prec)
+        total = term if total is None else _round(_map(lambda p, q: p + q, total, term), prec)
+    return Val([total], prec, "float")
+
+
+def _length(a):
+    d = _dot(a, a)
+    return Val([_round(_map(_safe(math.sqrt), d.comps[0]), d.prec)], d.prec, "float")
+
+
+_BUILTINS = {
+    "exp": math.exp, "exp2": math.exp2, "log": math.log, "log2": _log2,
+    "pow": _pow, "sqrt": math.sqrt, "inversesqrt": lambda x: 1.0 / math.sqrt(x),
+    "abs": abs, "sign": _sign, "floor": math.floor, "ceil": math.ceil,
+    "fract": _fract, "min": min, "max": max, "clamp": _clamp, "mix": _mix,
+    "step": lambda e, x: 0.0 if x < e else 1.0,
+    "mod": lambda x, y: x - y * math.floor(x / y),
+    "sin": math.sin, "cos": math.cos, "tanh": math.tanh,
+}
+
+
+class Program(object):
+    """The functions and globals of a preprocessed source.
+
+    ops counts the operations evaluated per pixel, by operator or builtin
+    name and per component; operations on uniform values are left out, since
+    a compiler would fold or hoist them.
+    """
+
+    def __init__(self, path, defines=()):
+        self.path = path
+        self.defines = tuple(defines)
+        self.functions, self._globals = _Parser(preprocess(path, defines)).unit()
+        self._global_values = {}
+        self.pixels = None
+        self.ops = collections.Counter()
+
+    def bind(self, name, value):
+        """Gives the uniform global name (a sampler, say) a value."""
+        if name not in self._globals:
+            raise HalfPrecError("no global %s" % name)
+        self._global_values[name] = value
+
+    def signatures(self):
+        """(name, [parameter types]) of every function definition."""
+        return [(name, [p[1] for p in f.params])
+                for name, fs in sorted(self.functions.items()) for f in fs]
+
+    def call(self, name, args):
+        return self._call(name, list(args), None)
+
+    def evaluate(self, text, env):
+        """The value of the expression text with env's names in scope."""
+        p = _Parser(tokenize(text))
+        e = p.expression()
+        if p.peek()[0] is not None:
+            raise HalfPrecError("trailing tokens in %r" % text)
+        return self._eval(e, [dict((k, (None, v)) for k, v in env.items())])
+
+    # Scopes map names to (declared (prec, type) or None, value).
+
+    def _lookup(self, name, scopes):
+        for scope in reversed(scopes):
+            if name in scope:
+                return scope[name][1]
+        if name in self._global_values:
+            return self._global_values[name]
+        if name in self._globals:
+            spec, expr = self._globals[name]
+            if expr is None:
+                raise HalfPrecError("uninitialized global %s" % name)
+            value = self._declared(spec, expr, [])
+            self._global_values[name] = value
+            return value
+        raise HalfPrecError("undefined name %s" % name)
+
+    def _store(self, target, value, scopes):
+        if target[0] != "var":
+            raise HalfPrecError("only plain variables can be assigned")
+        for scope in reversed(scopes):
+            if target[1] in scope:
+                spec = scope[target[1]][0]
+                if spec is not None:
+                    value = _convert(value, spec[0], spec[1])
+                scope[target[1]] = (spec, value)
+                return value
+        raise HalfPrecError("assignment to unknown or global %s" % target[1])
+
+    def _condition(self, e, scopes):
+        v = self._eval(e, scopes)
+        if v.kind != "bool" or len(v.comps) != 1:
+            raise HalfPrecError("condition is not a bool")
+        if isinstance(v.comps[0], list):
+            raise HalfPrecError("non-uniform condition")
+        return v.comps[0]
+
+    def _eval(self, e, scopes):
+        kind = e[0]
+        if kind == "num":
+            # Literals are single precision, but carry no precision qualifier.
+            return Val([_round_scalar(e[1], "f")], None, "float")
+        if kind == "int":
+            return Val([e[1]], None, "int")
+        if kind == "bool":
+            return Val([e[1]], None, "bool")
+        if kind == "var":
+            return self._lookup(e[1], scopes)
+        if kind == "bin":
+            if e[1] in ("&&", "||"):
+                first = self._condition(e[2], scopes)
+                if first == (e[1] == "||"):
+                    return Val([first], None, "bool")
+                return Val([self._condition(e[3], scopes)], None, "bool")
+            return self._count(e[1], _binary(e[1], self._eval(e[2], scopes),
+                                             self._eval(e[3], scopes)))
+        if kind == "unary":
+            v = self._eval(e[2], scopes)
+            if e[1] == "+":
+                return v
+            if e[1] == "!":
+                if v.kind != "bool":
+                    raise HalfPrecError("! on %s" % v.kind)
+                return Val([_map(lambda x: not x, c) for c in v.comps], None, "bool")
+            return Val([_map(lambda x: -x, c) for c in v.comps], v.prec, v.kind)
+        if kind == "assign":
+            value = self._eval(e[3], scopes)
+            if e[1] != "=":
+                value = self._count(e[1][0], _binary(e[1][0], self._eval(e[2], scopes), value))
+            return self._store(e[2], value, scopes)
+        if kind == "post":
+            old = self._eval(e[2], scopes)
+            self._store(e[2], _binary(e[1][0], old, Val([1], None, "int")), scopes)
+            return old
+        if kind == "member":
+            v = self._eval(e[1], scopes)
+            if isinstance(v, Texture):
+                raise HalfPrecError("member of a sampler")
+            try:
+                return Val([v.comps[_SWIZZLE[ch]] for ch in e[2]], v.prec, v.kind)
+            except (KeyError, IndexError):
+                raise HalfPrecError("bad swizzle .%s" % e[2])
+        if kind == "index":
+            v = self._eval(e[1], scopes)
+            i = self._eval(e[2], scopes)
+            if i.kind != "int" or not i.uniform:
+                raise HalfPrecError("index is not a uniform int")
+            if isinstance(v, list):
+                if not 0 <= i.comps[0] < len(v):
+                    raise HalfPrecError("array index %d out of range" % i.comps[0])
+                return v[i.comps[0]]
+            return Val([v.comps[i.comps[0]]], v.prec, v.kind)
+        if kind == "list":
+            return [self._eval(x, scopes) for x in e[1]]
+        if kind == "select":
+            cond = self._eval(e[1], scopes)
+            if cond.kind != "bool" or len(cond.comps) != 1:
+                raise HalfPrecError("?: condition is not a bool")
+            c = cond.comps[0]
+            if not isinstance(c, list):
+                return self._eval(e[2] if c else e[3], scopes)
+            a, b = self._eval(e[2], scopes), self._eval(e[3], scopes)
+            if a.kind != b.kind:
+                a, b = _float(a), _float(b)
+            ac, bc = _broadcast(a, b)
+            return Val([_map(lambda s, x, y: x if s else y, c, x, y) for x, y in zip(ac, bc)],
+                       _join(a, b), a.kind)
+        if kind == "call":
+            return self._call(e[1], [self._eval(a, scopes) for a in e[2]], scopes)
+        raise HalfPrecError("cannot evaluate %s" % kind)
+
+    def _construct(self, type_name, args):
+        size = _type_size(type_name)
+        kind = _type_kind(type_name)
+        comps = []
+        for a in args:
+            if isinstance(a, Texture):
+                raise HalfPrecError("sampler in a constructor")
+            comps.extend((_float(a) if kind == "float" else a).comps)
+        if len(comps) == 1:
+            comps = comps * size
+        if len(comps) < size:
+            raise HalfPrecError("%s from %d components" % (type_name, len(comps)))
+        comps = comps[:size]
+        if kind == "int":
+            comps = [_map(lambda x: int(x) if x == x else 0, c) for c in comps]
+        elif kind == "bool":
+            comps = [_map(bool, c) for c in comps]
+        prec = _join(*args) if kind == "float" else None
+        return Val([_round(c, prec) for c in comps], prec, kind)
+
+    def _call(self, name, args, scopes):
+        if _type_size(name):
+            return self._construct(name, args)
+        if name in self.functions:
+            return self._call_user(name, args)
+        if name in _BUILTINS:
+            return self._count(name, _componentwise(_BUILTINS[name], *args))
+        if name == "dot":
+            return self._count(name, _dot(*args))
+        if name == "length":
+            return self._count(name, _length(*args))
+        if name in ("texture", "textureLod"):
+            tex, uv = args[0], args[1]
+            if not isinstance(tex, Texture) or len(uv.comps) != 2:
+                raise HalfPrecError("%s needs a sampler and a vec2" % name)
+            comps = tex.sample(uv.comps[0], uv.comps[1])
+            self.ops[name] += 1
+            return Val([_round(c, "high") for c in comps], "high", "float")
+        if name == "textureGather":
+            tex, uv = args[0], args[1]
+            comp = args[2] if len(args) > 2 else Val([0], None, "int")
+            if not isinstance(tex, Texture) or len(uv.comps) != 2 or \
+                    comp.kind != "int" or not comp.uniform:
+                raise HalfPrecError("textureGather needs a sampler, a vec2 and a constant component")
+            comps = tex.gather(uv.comps[0], uv.comps[1], comp.comps[0])
+            self.ops[name] += 1
+            return Val([_round(c, "high") for c in comps], "high", "float")
+        if name == "texelFetch":
+            tex, xy = args[0], args[1]
+            if not isinstance(tex, Texture) or xy.kind != "int" or not xy.uniform:
+                raise HalfPrecError("texelFetch needs a sampler and a uniform ivec2")
+            self.ops[name] += 1
+            return Val(tex.fetch(xy.comps[0], xy.comps[1]), "high", "float")
+        if name == "textureSize":
+            tex = args[0]
+            if not isinstance(tex, Texture):
+                raise HalfPrecError("textureSize needs a sampler")
+            return Val([tex.width, tex.height], None, "int")
+        raise HalfPrecError("unsupported function %s" % name)
+
+    def _count(self, name, value):
+        if not value.uniform:
+            self.ops[name] += 1 if name in ("dot", "length") else len(value.comps)
+        return value
+
+    def _call_user(self, name, args):
+        candidates = [f for f in self.functions[name] if len(f.params) == len(args)]
+        for f in candidates:
+            if all(isinstance(a, Texture) == (p[1] in _SAMPLER_TYPES) and
+                   (isinstance(a, Texture) or len(a.comps) == _type_size(p[1]))
+                   for a, p in zip(args, f.params)):
+                break
+        else:
+            raise HalfPrecError("no overload of %s for %d arguments" % (name, len(args)))
+        if f.ast is None:
+            f.ast = _Parser(f.body).statement()
+        scope = {}
+        for (prec, type_name, pname), a in zip(f.params, args):
+            scope[pname] = ((prec, type_name), _convert(a, prec, type_name))
+        try:
+            self._exec(f.ast, [scope])
+        except _Return as r:
+            if f.ret[1] == "void":
+                return None
+            return _convert(r.value, f.ret[0], f.ret[1])
+        if f.ret[1] != "void":
+            raise HalfPrecError("%s ends without returning" % name)
+        return None
+
+    def _declared(self, spec, expr, scopes):
+        """The initial value of a variable declared spec = expr."""
+        if expr[0] != "array":
+            return _convert(self._eval(expr, scopes), spec[0], spec[1])
+
+        def convert(v):
+            if isinstance(v, list):
+                return [convert(x) for x in v]
+            return _convert(v, spec[0], spec[1])
+        if expr[1] is None:
+            raise HalfPrecError("uninitialized array")
+        return convert(self._eval(expr[1], scopes))
+
+    def _exec(self, s, scopes):
+        kind = s[0]
+        if kind == "block":
+            scopes = scopes + [{}]
+            for sub in s[1]:
+                self._exec(sub, scopes)
+        elif kind == "decl":
+            spec = s[1]
+            for name, expr in s[2]:
+                value = None
+                if expr is not None:
+                    value = self._declared(spec, expr, scopes)
+                scopes[-1][name] = (spec, value)
+        elif kind == "expr":
+            self._eval(s[1], scopes)
+        elif kind == "return":
+            raise _Return(None if s[1] is None else self._eval(s[1], scopes))
+        elif kind == "if":
+            if self._condition(s[1], scopes):
+                self._exec(s[2], scopes)
+            elif s[3] is not None:
+                self._exec(s[3], scopes)
+        elif kind == "for":
+            scopes = scopes + [{}]
+            self._exec(s[1], scopes)
+            for _ in range(1 << 16):
+                if s[2] is not None and not self._condition(s[2], scopes):
+                    return
+                self._exec(s[4], scopes)
+                if s[3] is not None:
+                    self._eval(s[3], scopes)
+            raise HalfPrecError("loop does not terminate")
+        else:
+            raise HalfPrecError("cannot execute %s" % kind)
@@ -0,0 +1,851 @@
+"""A headless filter chain host on Vulkan, executing runner jobs.
+
+This is the runner slangtools/runner.py talks to: it builds the chain a job
+describes the way spec/SHADER_SPEC.md lays it out, renders the requested
+frames and reports per pass GPU time from timestamp queries.  It is meant to
+run on lavapipe and favours being obviously right over being fast: every pass
+is followed by a full barrier and every frame is waited for.
+
+The chain itself comes from chain.py, so sizes, formats, FrameCount and which
+texture every sampler sees are the same ones the other tools resolve; when the
+job carries a schedule it is followed to the letter.  Shaders come from the
+job's bundle when it has one, otherwise they are frozen and compiled like
+slang-bundle.py does.  Semantics:
+
+  - the quad is a triangle strip of Position (vec4) and TexCoord (vec2) over
+    [0, 1], with MVP mapping it onto the render target;
+  - Original, OriginalHistoryN and the input sizes use pass 0's filter, wrap
+    and mipmap settings, the output of pass N those of pass N + 1, lookup
+    textures their own; integer formats are always sampled nearest;
+  - history and feedback textures are black until the chain has produced
+    them; FrameDirection is 1, Rotation 0 and there are no sub-frames;
+  - parameters take the preset's value, or their initial one.
+"""
+
+import ctypes
+import math
+import re
+import struct
+from ctypes import byref, c_uint32, c_uint64
+
+from . import bundle, chain, compiler, freeze, png, preset, source, spirv
+from . import vulkan as vk
+
+# Ortho projection of the [0, 1] quad onto clip space, column major.
+MVP = (2.0, 0.0, 0.0, 0.0,
+       0.0, 2.0, 0.0, 0.0,
+       0.0, 0.0, 1.0, 0.0,
+       -1.0, -1.0, 0.0, 1.0)
+
+# Position.xyzw, TexCoord.xy for the four corners of the strip.
+QUAD = (0.0, 0.0, 0.0, 1.0, 0.0, 0.0,
+        1.0, 0.0, 0.0, 1.0, 1.0, 0.0,
+        0.0, 1.0, 0.0, 1.0, 0.0, 1.0,
+        1.0, 1.0, 0.0, 1.0, 1.0, 1.0)
+
+CONSTANTS = {"FrameDirection": 1, "Rotation": 0, "TotalSubFrames": 1,
+             "CurrentSubFrame": 1}
+
+_SIZE = re.compile(r'^(OriginalHistory|PassOutput|PassFeedback)Size(\d+)$')
+_COMPONENT = re.compile(r'[RGBA](\d+)')
+_PACK = {("B", 8): "B", ("B", 16): "H", ("B", 32): "I",
+         ("b", 8): "b", ("b", 16): "h", ("b", 32): "i",
+         ("f", 16): "e", ("f", 32): "f"}
+
+
+class HostError(Exception):
+    pass
+
+
+class Device(object):
+    """Instance, device, queue and the single command buffer of the host."""
+
+    def __init__(self):
+        self.vk = vk.Library()
+        app = vk.ApplicationInfo(sType=vk.ST_APPLICATION_INFO,
+                                 pApplicationName=b"slang-runner",
+                                 apiVersion=vk.API_VERSION_1_0)
+        info = vk.InstanceCreateInfo(sType=vk.ST_INSTANCE_CREATE_INFO,
+                                     pApplicationInfo=ctypes.pointer(app))
+        self.instance = vk.Instance()
+        self.vk.CreateInstance(byref(info), None, byref(self.instance))
+
+        count = c_uint32()
+        self.vk.EnumeratePhysicalDevices(self.instance, byref(count), None)
+        if not count.value:
+            raise HostError("no Vulkan device")
+        devices = (vk.PhysicalDevice * count.value)()
+        self.vk.EnumeratePhysicalDevices(self.instance, byref(count), devices)
+        self.physical = devices[0]
+        props = vk.PhysicalDeviceProperties()
+        self.vk.GetPhysicalDeviceProperties(self.physical, byref(props))
+        self.name = props.deviceName.decode("utf-8", "replace")
+        self.timestamp_period = props.limits.timestampPeriod
+        self.memory_properties = vk.PhysicalDeviceMemoryProperties()
+        self.vk.GetPhysicalDeviceMemoryProperties(self.physical,
+                                                  byref(self.memory_properties))
+
+        self.vk.GetPhysicalDeviceQueueFamilyProperties(self.physical, byref(count), None)
+        families = (vk.QueueFamilyProperties * count.value)()
+        self.vk.GetPhysicalDeviceQueueFamilyProperties(self.physical, byref(count), families)
+        for i, family in enumerate(families):
+            if family.queueFlags & vk.QUEUE_GRAPHICS:
+                self.family = i
+                self.timestamp_bits = family.timestampValidBits
+                break
+        else:
+            raise HostError("%s has no graphics queue" % self.name)
+        if not self.timestamp_bits:
+            raise HostError("%s has no timestamp queries" % self.name)
+
+        priority = ctypes.c_float(1.0)
+        queue_info = vk.DeviceQueueCreateInfo(
+            sType=vk.ST_DEVICE_QUEUE_CREATE_INFO, queueFamilyIndex=self.family,
+            queueCount=1, pQueuePriorities=ctypes.pointer(priority))
+        info = vk.DeviceCreateInfo(sType=vk.ST_DEVICE_CREATE_INFO,
+                                   queueCreateInfoCount=1,
+                                   pQueueCreateInfos=ctypes.pointer(queue_info))
+        self.device = vk.Device()
+        self.vk.CreateDevice(self.physical, byref(info), None, byref(self.device))
+        self.queue = vk.Queue()
+        self.vk.GetDeviceQueue(self.device, self.family, 0, byref(self.queue))
+
+        pool = vk.CommandPoolCreateInfo(
+            sType=vk.ST_COMMAND_POOL_CREATE_INFO, queueFamilyIndex=self.family,
+            flags=vk.COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER)
+        self.command_pool = vk.handle(self.vk.CreateCommandPool, self.device, byref(pool))
+        alloc = vk.CommandBufferAllocateInfo(
+            sType=vk.ST_COMMAND_BUFFER_ALLOCATE_INFO, commandPool=self.command_pool,
+            level=vk.COMMAND_BUFFER_LEVEL_PRIMARY, commandBufferCount=1)
+        self.cmd = vk.CommandBuffer()
+        self.vk.AllocateCommandBuffers(self.device, byref(alloc), byref(self.cmd))
+        fence = vk.FenceCreateInfo(sType=vk.ST_FENCE_CREATE_INFO)
+        self.fence = vk.handle(self.vk.CreateFence, self.device, byref(fence))
+        self._render_passes = {}
+        self._samplers = {}
+
+    def close(self):
+        self.vk.DeviceWaitIdle(self.device)
+        self.vk.DestroyDevice(self.device, None)
+        self.vk.DestroyInstance(self.instance, None)
+
+    def allocate(self, requirements, flags):
+        types = self.memory_properties.memoryTypes
+        for wanted in (flags, 0):
+            for i in range(self.memory_properties.memoryTypeCount):
+                if (requirements.memoryTypeBits & (1 << i)
+                        and types[i].propertyFlags & wanted == wanted):
+                    info = vk.MemoryAllocateInfo(sType=vk.ST_MEMORY_ALLOCATE_INFO,
+                                                 allocationSize=requirements.size,
+                                                 memoryTypeIndex=i)
+                    return vk.handle(self.vk.AllocateMemory, self.device, byref(info))
+            if flags & vk.MEMORY_PROPERTY_HOST_VISIBLE:
+                break
+        raise HostError("no memory type for %d bytes" % requirements.size)
+
+    def features(self, fmt):
+        props = vk.FormatProperties()
+        self.vk.GetPhysicalDeviceFormatProperties(self.physical, vk.FORMATS[fmt],
+                                                  byref(props))
+        return props.optimalTilingFeatures
+
+    def begin(self):
+        self.vk.ResetCommandBuffer(self.cmd, 0)
+        info = vk.CommandBufferBeginInfo(sType=vk.ST_COMMAND_BUFFER_BEGIN_INFO,
+                                         flags=vk.COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT)
+        self.vk.BeginCommandBuffer(self.cmd, byref(info))
+        return self.cmd
+
+    def submit(self):
+        """Ends the command buffer, runs it and waits for it."""
+        self.vk.EndCommandBuffer(self.cmd)
+        cmd = vk.CommandBuffer(self.cmd.value)
+        info = vk.SubmitInfo(sType=vk.ST_SUBMIT_INFO, commandBufferCount=1,
+                             pCommandBuffers=ctypes.pointer(cmd))
+        self.vk.QueueSubmit(self.queue, 1, byref(info), self.fence)
+        fence = vk.Handle(self.fence)
+        self.vk.WaitForFences(self.device, 1, byref(fence), 1, 0xffffffffffffffff)
+        self.vk.ResetFences(self.device, 1, byref(fence))
+
+    def barrier(self, image, old, new, base=0, count=None):
+        """A full barrier on some levels of image, changing their layout."""
+        b = vk.ImageMemoryBarrier(
+            sType=vk.ST_IMAGE_MEMORY_BARRIER,
+            srcAccessMask=vk.ACCESS_MEMORY_WRITE,
+            dstAccessMask=vk.ACCESS_MEMORY_READ | vk.ACCESS_MEMORY_WRITE,
+            oldLayout=old, newLayout=new,
+            srcQueueFamilyIndex=vk.QUEUE_FAMILY_IGNORED,
+            dstQueueFamilyIndex=vk.QUEUE_FAMILY_IGNORED, image=image.image,
+            subresourceRange=vk.ImageSubresourceRange(
+                vk.IMAGE_ASPECT_COLOR, base,
+                image.levels - base if count is None else count, 0, 1))
+        self.vk.CmdPipelineBarrier(self.cmd, vk.PIPELINE_STAGE_ALL_COMMANDS,
+                                   vk.PIPELINE_STAGE_ALL_COMMANDS, 0,
+                                   0, None, 0, None, 1, byref(b))
+
+    def memory_barrier(self):
+        b = vk.MemoryBarrier(sType=vk.ST_MEMORY_BARRIER,
+                             srcAccessMask=vk.ACCESS_MEMORY_WRITE,
+                             dstAccessMask=vk.ACCESS_MEMORY_READ | vk.ACCESS_MEMORY_WRITE)
+        self.vk.CmdPipelineBarrier(self.cmd, vk.PIPELINE_STAGE_ALL_COMMANDS,
+                                   vk.PIPELINE_STAGE_ALL_COMMANDS, 0,
+                                   1, byref(b), 0, None, 0, None)
+
+    def render_pass(self, fmt):
+        if fmt not in self._render_passes:
+            attachment = vk.AttachmentDescription(
+                format=vk.FORMATS[fmt], samples=vk.SAMPLE_COUNT_1,
+                loadOp=vk.ATTACHMENT_LOAD_OP_CLEAR,
+                storeOp=vk.ATTACHMENT_STORE_OP_STORE,
+                stencilLoadOp=vk.ATTACHMENT_LOAD_OP_DONT_CARE,
+                stencilStoreOp=vk.ATTACHMENT_STORE_OP_DONT_CARE,
+                initialLayout=vk.IMAGE_LAYOUT_UNDEFINED,
+                finalLayout=vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+            ref = vk.AttachmentReference(0, vk.IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)
+            subpass = vk.SubpassDescription(
+                pipelineBindPoint=vk.PIPELINE_BIND_POINT_GRAPHICS,
+                colorAttachmentCount=1, pColorAttachments=ctypes.pointer(ref))
+            info = vk.RenderPassCreateInfo(
+                sType=vk.ST_RENDER_PASS_CREATE_INFO, attachmentCount=1,
+                pAttachments=ctypes.pointer(attachment), subpassCount=1,
+                pSubpasses=ctypes.pointer(subpass))
+            self._render_passes[fmt] = vk.handle(self.vk.CreateRenderPass,
+                                                 self.device, byref(info))
+        return self._render_passes[fmt]
+
+    def sampler(self, linear, mipmap, wrap_mode):
+        key = (linear, mipmap, wrap_mode)
+        if key not in self._samplers:
+            if wrap_mode not in vk.ADDRESS_MODES:
+                raise HostError("unknown wrap mode %s" % wrap_mode)
+            filter_ = vk.FILTER_LINEAR if linear else vk.FILTER_NEAREST
+            address = vk.ADDRESS_MODES[wrap_mode]
+            info = vk.SamplerCreateInfo(
+                sType=vk.ST_SAMPLER_CREATE_INFO, magFilter=filter_, minFilter=filter_,
+                mipmapMode=(vk.SAMPLER_MIPMAP_MODE_LINEAR if linear
+                            else vk.SAMPLER_MIPMAP_MODE_NEAREST),
+                addressModeU=address, addressModeV=address, addressModeW=address,
+                maxAnisotropy=1.0, maxLod=1000.0 if mipmap else 0.0,
+                borderColor=vk.BORDER_COLOR_FLOAT_TRANSPARENT_BLACK)
+            self._samplers[key] = vk.handle(self.vk.CreateSampler, self.device,
+                                            byref(info))
+        return self._samplers[key]
+
+
+class Buffer(object):
+    """A persistently mapped host visible buffer."""
+
+    def __init__(self, dev, size, usage):
+        self.size = max(4, size)
+        info = vk.BufferCreateInfo(sType=vk.ST_BUFFER_CREATE_INFO, size=self.size,
+                                   usage=usage)
+        self.buffer = vk.handle(dev.vk.CreateBuffer, dev.device, byref(info))
+        req = vk.MemoryRequirements()
+        dev.vk.GetBufferMemoryRequirements(dev.device, self.buffer, byref(req))
+        self.memory = dev.allocate(req, vk.MEMORY_PROPERTY_HOST_VISIBLE |
+                                   vk.MEMORY_PROPERTY_HOST_COHERENT)
+        dev.vk.BindBufferMemory(dev.device, self.buffer, self.memory, 0)
+        pointer = ctypes.c_void_p()
+        dev.vk.MapMemory(dev.device, self.memory, 0, vk.WHOLE_SIZE, 0, byref(pointer))
+        self.pointer = pointer.value
+
+    def write(self, data, offset=0):
+        data = bytes(data)
+        ctypes.memmove(self.pointer + offset, data, len(data))
+
+    def read(self, size, offset=0):
+        return ctypes.string_at(self.pointer + offset, size)
+
+    def destroy(self, dev):
+        dev.vk.DestroyBuffer(dev.device, self.buffer, None)
+        dev.vk.FreeMemory(dev.device, self.memory, None)
+
+
+class Image(object):
+    """A 2D image with a view of all its levels and one for rendering to."""
+
+    def __init__(self, dev, size, fmt, mipmap=False, attachment=False):
+        self.size = size
+        self.format = fmt
+        features = dev.features(fmt)
+        blit = vk.FORMAT_FEATURE_BLIT_SRC | vk.FORMAT_FEATURE_BLIT_DST
+        self.levels = 1
+        if mipmap and features & blit == blit:
+            self.levels = int(math.floor(math.log(max(size), 2))) + 1
+        self.linear_blit = bool(features & vk.FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR)
+        usage = (vk.IMAGE_USAGE_SAMPLED | vk.IMAGE_USAGE_TRANSFER_SRC |
+                 vk.IMAGE_USAGE_TRANSFER_DST)
+        if attachment:
+            usage |= vk.IMAGE_USAGE_COLOR_ATTACHMENT
+        info = vk.ImageCreateInfo(
+            sType=vk.ST_IMAGE_CREATE_INFO, imageType=vk.IMAGE_TYPE_2D,
+            format=vk.FORMATS[fmt], extent=vk.Extent3D(size[0], size[1], 1),
+            mipLevels=self.levels, arrayLayers=1, samples=vk.SAMPLE_COUNT_1,
+            tiling=vk.IMAGE_TILING_OPTIMAL, usage=usage,
+            initialLayout=vk.IMAGE_LAYOUT_UNDEFINED)
+        self.image = vk.handle(dev.vk.CreateImage, dev.device, byref(info))
+        req = vk.MemoryRequirements()
+        dev.vk.GetImageMemoryRequirements(dev.device, self.image, byref(req))
+        self.memory = dev.allocate(req, vk.MEMORY_PROPERTY_DEVICE_LOCAL)
+        dev.vk.BindImageMemory(dev.device, self.image, self.memory, 0)
+        self.view = self._view(dev, self.levels)
+        self.framebuffer = None
+        if attachment:
+            self.attachment_view = self._view(dev, 1)
+            views = (vk.Handle * 1)(self.attachment_view)
+            fb = vk.FramebufferCreateInfo(
+                sType=vk.ST_FRAMEBUFFER_CREATE_INFO, renderPass=dev.render_pass(fmt),
+                attachmentCount=1, pAttachments=views, width=size[0],
+                height=size[1], layers=1)
+            self.framebuffer = vk.handle(dev.vk.CreateFramebuffer, dev.device, byref(fb))
+
+    def _view(self, dev, levels):
+        info = vk.ImageViewCreateInfo(
+            sType=vk.ST_IMAGE_VIEW_CREATE_INFO, image=self.image,
+            viewType=vk.IMAGE_VIEW_TYPE_2D, format=vk.FORMATS[self.format],
+            subresourceRange=vk.ImageSubresourceRange(vk.IMAGE_ASPECT_COLOR, 0,
+                                                      levels, 0, 1))
+        return vk.handle(dev.vk.CreateImageView, dev.device, byref(info))
+
+    def mipmaps(self, dev, layout):
+        """Records filling levels 1.. from level 0, which is in layout.
+
+        Leaves every level readable by shaders.
+        """
+        if self.levels == 1:
+            dev.barrier(self, layout, vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+            return
+        dev.barrier(self, layout, vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 1)
+        w, h = self.size
+        for level in range(1, self.levels):
+            nw, nh = max(1, w // 2), max(1, h // 2)
+            dev.barrier(self, vk.IMAGE_LAYOUT_UNDEFINED,
+                        vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, level, 1)
+            region = vk.ImageBlit(
+                srcSubresource=vk.ImageSubresourceLayers(vk.IMAGE_ASPECT_COLOR,
+                                                         level - 1, 0, 1),
+                srcOffsets=(vk.Offset3D * 2)(vk.Offset3D(0, 0, 0), vk.Offset3D(w, h, 1)),
+                dstSubresource=vk.ImageSubresourceLayers(vk.IMAGE_ASPECT_COLOR,
+                                                         level, 0, 1),
+                dstOffsets=(vk.Offset3D * 2)(vk.Offset3D(0, 0, 0), vk.Offset3D(nw, nh, 1)))
+            dev.vk.CmdBlitImage(dev.cmd, self.image, vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                self.image, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                1, byref(region),
+                                vk.FILTER_LINEAR if self.linear_blit else vk.FILTER_NEAREST)
+            dev.barrier(self, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, level, 1)
+            w, h = nw, nh
+        dev.barrier(self, vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+
+    def clear(self, dev):
+        """Records clearing the image to black, leaving it readable."""
+        dev.barrier(self, vk.IMAGE_LAYOUT_UNDEFINED, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        black = vk.ClearColorValue()
+        levels = vk.ImageSubresourceRange(vk.IMAGE_ASPECT_COLOR, 0, self.levels, 0, 1)
+        dev.vk.CmdClearColorImage(dev.cmd, self.image, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  byref(black), 1, byref(levels))
+        dev.barrier(self, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+
+    def copy(self, dev, buf, offset=0):
+        """Records copying level 0 into buf, which needs to be host visible."""
+        dev.barrier(self, vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 0, 1)
+        region = vk.BufferImageCopy(
+            bufferOffset=offset,
+            imageSubresource=vk.ImageSubresourceLayers(vk.IMAGE_ASPECT_COLOR, 0, 0, 1),
+            imageExtent=vk.Extent3D(self.size[0], self.size[1], 1))
+        dev.vk.CmdCopyImageToBuffer(dev.cmd, self.image, vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                    buf.buffer, 1, byref(region))
+        dev.barrier(self, vk.IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                    vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, 1)
+
+
+class Texture(object):
+    """An image as some pass samples it."""
+
+    def __init__(self, image, sampler):
+        self.image = image
+        self.sampler = sampler
+
+
+def _rgba8(img):
+    """png.Image pixels as tightly packed RGBA8."""
+    shift = 8 if img.depth == 16 else 0
+    out = bytearray()
+    for p in img.pixels:
+        p = tuple(v >> shift for v in p)
+        if img.channels <= 2:
+            p = (p[0],) * 3 + (p[1] if img.channels == 2 else 255,)
+        elif img.channels == 3:
+            p = p + (255,)
+        out.extend(p)
+    return bytes(out)
+
+
+def upload(dev, path, mipmap):
+    """An R8G8B8A8_UNORM image holding the PNG at path."""
+    try:
+        img = png.read(path)
+    except (IOError, png.PngError) as e:
+        raise HostError(str(e))
+    image = Image(dev, (img.width, img.height), "R8G8B8A8_UNORM", mipmap)
+    staging = Buffer(dev, img.width * img.height * 4, vk.BUFFER_USAGE_TRANSFER_SRC)
+    staging.write(_rgba8(img))
+    dev.begin()
+    dev.barrier(image, vk.IMAGE_LAYOUT_UNDEFINED, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    region = vk.BufferImageCopy(
+        imageSubresource=vk.ImageSubresourceLayers(vk.IMAGE_ASPECT_COLOR, 0, 0, 1),
+        imageExtent=vk.Extent3D(img.width, img.height, 1))
+    dev.vk.CmdCopyBufferToImage(dev.cmd, staging.buffer, image.image,
+                                vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, byref(region))
+    image.mipmaps(dev, vk.IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+    dev.submit()
+    staging.destroy(dev)
+    return image
+
+
+def decode(fmt, data, size):
+    """Texels of a render target format as an RGBA png.Image.
+
+    8 bit normalized formats keep their 8 bit values, everything else becomes
+    16 bit: floats are clamped to [0, 1], integers to the PNG range.
+    """
+    w, h = size
+    kind = fmt.split("_")[1]
+    if fmt.startswith("A2B10G10R10"):
+        depth = 16
+        texels = []
+        for v, in struct.iter_unpack("<I", data):
+            texels.append((v & 0x3ff, (v >> 10) & 0x3ff, (v >> 20) & 0x3ff, v >> 30))
+        if kind == "UNORM":
+            texels = [(r * 65535 // 1023, g * 65535 // 1023, b * 65535 // 1023,
+                       a * 65535 // 3) for r, g, b, a in texels]
+    else:
+        bits = [int(b) for b in _COMPONENT.findall(fmt.split("_")[0])]
+        n = len(bits)
+        sign = "f" if kind == "SFLOAT" else "b" if kind == "SINT" else "B"
+        values = struct.unpack("<%d%s" % (w * h * n, _PACK[(sign, bits[0])]),
+                               data[:w * h * n * bits[0] // 8])
+        depth = 8 if bits[0] == 8 and kind in ("UNORM", "SRGB", "UINT", "SINT") else 16
+        top = (1 << depth) - 1
+        if kind == "SFLOAT":
+            values = [int(min(max(v, 0.0), 1.0) * top + 0.5) if v == v else 0
+                      for v in values]
+        elif kind in ("UINT", "SINT"):
+            values = [min(max(v, 0), top) for v in values]
+        pad = (0, 0, top)[n - 1:] if n < 4 else ()
+        texels = [tuple(values[i:i + n]) + pad for i in range(0, len(values), n)]
+    return png.Image(w, h, 4, depth, texels)
+
+
+class Pass(object):
+    """Pipeline, descriptor set and render targets of one pass."""
+
+    def __init__(self, dev, plan, code, refl, pool, targets):
+        self.plan = plan
+        self.targets = targets
+        stages = (("vertex", vk.SHADER_STAGE_VERTEX), ("fragment", vk.SHADER_STAGE_FRAGMENT))
+        self.ubo = _merge(refl["vertex"]["ubo"], refl["fragment"]["ubo"])
+        self.push = _merge(refl["vertex"]["push_constant"],
+                           refl["fragment"]["push_constant"])
+        self.textures = {}
+        for stage, _ in stages:
+            for t in refl[stage]["textures"]:
+                self.textures[t["binding"]] = t["name"]
+        all_stages = vk.SHADER_STAGE_VERTEX | vk.SHADER_STAGE_FRAGMENT
+
+        bindings = [vk.DescriptorSetLayoutBinding(b, vk.DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                  1, all_stages, None)
+                    for b in sorted(self.textures)]
+        self.uniforms = None
+        if self.ubo:
+            bindings.append(vk.DescriptorSetLayoutBinding(
+                self.ubo["binding"], vk.DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, all_stages, None))
+            self.uniforms = Buffer(dev, self.ubo["size"], vk.BUFFER_USAGE_UNIFORM_BUFFER)
+        info = vk.DescriptorSetLayoutCreateInfo(
+            sType=vk.ST_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, bindingCount=len(bindings),
+            pBindings=vk.array(vk.DescriptorSetLayoutBinding, bindings))
+        self.set_layout = vk.handle(dev.vk.CreateDescriptorSetLayout, dev.device, byref(info))
+        layouts = (vk.Handle * 1)(self.set_layout)
+        ranges = []
+        if self.push:
+            ranges.append(vk.PushConstantRange(all_stages, 0, self.push["size"]))
+        info = vk.PipelineLayoutCreateInfo(
+            sType=vk.ST_PIPELINE_LAYOUT_CREATE_INFO, setLayoutCount=1, pSetLayouts=layouts,
+            pushConstantRangeCount=len(ranges),
+            pPushConstantRanges=vk.array(vk.PushConstantRange, ranges))
+        self.layout = vk.handle(dev.vk.CreatePipelineLayout, dev.device, byref(info))
+        alloc = vk.DescriptorSetAllocateInfo(
+            sType=vk.ST_DESCRIPTOR_SET_ALLOCATE_INFO, descriptorPool=pool,
+            descriptorSetCount=1, pSetLayouts=layouts)
+        self.set = vk.Handle()
+        dev.vk.AllocateDescriptorSets(dev.device, byref(alloc), byref(self.set))
+
+        modules = []
+        shader_stages = []
+        for stage, flag in stages:
+            spv = bytes(code[stage])
+            blob = ctypes.create_string_buffer(spv, len(spv))
+            info = vk.ShaderModuleCreateInfo(sType=vk.ST_SHADER_MODULE_CREATE_INFO,
+                                             codeSize=len(spv),
+                                             pCode=ctypes.cast(blob, ctypes.c_void_p))
+            modules.append(vk.handle(dev.vk.CreateShaderModule, dev.device, byref(info)))
+            shader_stages.append(vk.PipelineShaderStageCreateInfo(
+                sType=vk.ST_PIPELINE_SHADER_STAGE_CREATE_INFO, stage=flag,
+                module=modules[-1], pName=b"main"))
+        self.pipeline = _pipeline(dev, shader_stages, self.layout,
+                                  dev.render_pass(plan.format))
+        for module in modules:
+            dev.vk.DestroyShaderModule(dev.device, module, None)
+
+
+def _merge(a, b):
+    """One uniform block out of the vertex and fragment stage reflections."""
+    if not a or not b:
+        return a or b
+    members = dict((m["name"], m) for m in a["members"] + b["members"])
+    return {"name": a["name"], "binding": a["binding"], "size": max(a["size"], b["size"]),
+            "members": sorted(members.values(), key=lambda m: m["offset"])}
+
+
+def _pipeline(dev, stages, layout, render_pass):
+    vertex_binding = vk.VertexInputBindingDescription(0, 24, vk.VERTEX_INPUT_RATE_VERTEX)
+    attributes = (vk.VertexInputAttributeDescription * 2)(
+        vk.VertexInputAttributeDescription(0, 0, vk.FORMATS["R32G32B32A32_SFLOAT"], 0),
+        vk.VertexInputAttributeDescription(1, 0, vk.FORMATS["R32G32_SFLOAT"], 16))
+    vertex_input = vk.PipelineVertexInputStateCreateInfo(
+        sType=vk.ST_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        vertexBindingDescriptionCount=1,
+        pVertexBindingDescriptions=ctypes.pointer(vertex_binding),
+        vertexAttributeDescriptionCount=2, pVertexAttributeDescriptions=attributes)
+    assembly = vk.PipelineInputAssemblyStateCreateInfo(
+        sType=vk.ST_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        topology=vk.PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)
+    viewport = vk.PipelineViewportStateCreateInfo(
+        sType=vk.ST_PIPELINE_VIEWPORT_STATE_CREATE_INFO, viewportCount=1, scissorCount=1)
+    raster = vk.PipelineRasterizationStateCreateInfo(
+        sType=vk.ST_PIPELINE_RASTERIZATION_STATE_CREATE_INFO, lineWidth=1.0)
+    multisample = vk.PipelineMultisampleStateCreateInfo(
+        sType=vk.ST_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        rasterizationSamples=vk.SAMPLE_COUNT_1)
+    attachment = vk.PipelineColorBlendAttachmentState(colorWriteMask=vk.COLOR_COMPONENT_RGBA)
+    blend = vk.PipelineColorBlendStateCreateInfo(
+        sType=vk.ST_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO, attachmentCount=1,
+        pAttachments=ctypes.pointer(attachment))
+    dynamic_states = (c_uint32 * 2)(vk.DYNAMIC_STATE_VIEWPORT, vk.DYNAMIC_STATE_SCISSOR)
+    dynamic = vk.PipelineDynamicStateCreateInfo(
+        sType=vk.ST_PIPELINE_DYNAMIC_STATE_CREATE_INFO, dynamicStateCount=2,
+        pDynamicStates=dynamic_states)
+    info = vk.GraphicsPipelineCreateInfo(
+        sType=vk.ST_GRAPHICS_PIPELINE_CREATE_INFO, stageCount=len(stages),
+        pStages=vk.array(vk.PipelineShaderStageCreateInfo, stages),
+        pVertexInputState=ctypes.pointer(vertex_input),
+        pInputAssemblyState=ctypes.pointer(assembly),
+        pViewportState=ctypes.pointer(viewport),
+        pRasterizationState=ctypes.pointer(raster),
+        pMultisampleState=ctypes.pointer(multisample),
+        pColorBlendState=ctypes.pointer(blend), pDynamicState=ctypes.pointer(dynamic),
+        layout=layout, renderPass=render_pass, basePipelineIndex=-1)
+    pipeline = vk.Handle()
+    dev.vk.CreateGraphicsPipelines(dev.device, vk.NULL_HANDLE, 1, byref(info), None,
+                                   byref(pipeline))
+    return pipeline.value
+
+
+def _pack(member, value):
+    kind = member["type"]
+    if kind in ("uint", "int"):
+        return struct.pack("<I" if kind == "uint" else "<i", int(value))
+    if not isinstance(value, tuple):
+        value = (value,)
+    count = member["size"] // 4
+    return struct.pack("<%df" % count, *(tuple(value) + (0.0,) * count)[:count])
+
+
+def shaders(p, plans, bundle_path=None):
+    """(code, reflection, {parameter: value}) for every pass of the chain.
+
+    code maps stages to SPIR-V.  The bundle is used when given, otherwise the
+    passes are frozen and compiled like slang-bundle.py does.
+    """
+    if bundle_path:
+        b = bundle.Bundle(bundle_path)
+        if b.pass_count != len(plans):
+            raise HostError("%s has %d passes, the preset %d"
+                            % (bundle_path, b.pass_count, len(plans)))
+        values = dict((param["name"], param["value"]) for param in b.meta["parameters"])
+        return [(dict((stage, b.spirv(i, stage)) for stage in source.STAGES),
+                 b.reflection(i), values) for i in range(len(plans))]
+
+    loaded = [pp.shader for pp in plans]
+    frozen = freeze.values(p, loaded)
+    values = {}
+    compiled = {}
+    result = []
+    for sh in loaded:
+        for param in sh.parameters:
+            values.setdefault(param.name, p.parameters.get(param.name, param.initial))
+        if sh.path not in compiled:
+            variant = freeze.freeze(sh, frozen)
+            code = {}
+            refl = {}
+            for stage in source.STAGES:
+                code[stage] = compiler.compile_stage(variant.stages[stage], stage, sh.path)
+                refl[stage] = spirv.reflect(code[stage])
+            compiled[sh.path] = (code, refl)
+        result.append(compiled[sh.path] + (values,))
+    return result
+
+
+class Chain(object):
+    """Everything one job needs on the device."""
+
+    def __init__(self, dev, job):
+        self.dev = dev
+        self.job = job
+        self.content = tuple(job["content"])
+        self.viewport = tuple(job["viewport"])
+        self.preset = preset.load(job["preset"])
+        self.plans = chain.plan(self.preset, self.content, self.viewport)
+        expected = [(tuple(p["output"]), p["format"]) for p in job.get("passes") or []]
+        resolved = [(pp.output_size, pp.format) for pp in self.plans]
+        if expected and expected != resolved:
+            raise HostError("the job's passes %s do not match the chain %s"
+                            % (expected, resolved))
+        self.feedback = chain.feedback_passes(self.plans) | set(job.get("feedback") or [])
+        compiled = shaders(self.preset, self.plans, job.get("bundle"))
+        self.values = compiled[0][2] if compiled else {}
+
+        first = self.plans[0].pass_
+        self.inputs = [Texture(upload(dev, path, first.mipmap_input),
+                               self._sampler(first, "R8G8B8A8_UNORM"))
+                       for path in job["inputs"]]
+        if not self.inputs:
+            raise HostError("the job has no input frames")
+        self.black = Texture(Image(dev, (1, 1), "R8G8B8A8_UNORM"),
+                             dev.sampler(False, False, "clamp_to_edge"))
+        self.luts = {}
+        for t in self.preset.textures:
+            image = upload(dev, t.path, t.mipmap)
+            self.luts[t.name] = Texture(image, dev.sampler(t.linear, image.levels > 1,
+                                                           t.wrap_mode))
+
+        count = len(self.plans)
+        sizes = [vk.DescriptorPoolSize(vk.DESCRIPTOR_TYPE_UNIFORM_BUFFER, count),
+                 vk.DescriptorPoolSize(vk.DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                       max(1, sum(len(r["fragment"]["textures"]) +
+                                                  len(r["vertex"]["textures"])
+                                                  for _, r, _ in compiled)))]
+        info = vk.DescriptorPoolCreateInfo(
+            sType=vk.ST_DESCRIPTOR_POOL_CREATE_INFO, maxSets=count, poolSizeCount=2,
+            pPoolSizes=vk.array(vk.DescriptorPoolSize, sizes))
+        self.pool = vk.handle(dev.vk.CreateDescriptorPool, dev.device, byref(info))
+
+        self.passes = []
+        dev.begin()
+        self.black.image.clear(dev)
+        for pp, (code, refl, _) in zip(self.plans, compiled):
+            consumer = self.plans[pp.index + 1].pass_ if pp.index + 1 < count else pp.pass_
+            sampler = self._sampler(consumer, pp.format)
+            targets = []
+            for _ in range(2 if pp.index in self.feedback else 1):
+                image = Image(dev, pp.output_size, pp.format,
+                              consumer.mipmap_input and consumer is not pp.pass_,
+                              attachment=True)
+                image.clear(dev)
+                targets.append(Texture(image, sampler))
+            self.passes.append(Pass(dev, pp, code, refl, self.pool, targets))
+        dev.submit()
+
+        self.quad = Buffer(dev, 4 * len(QUAD), vk.BUFFER_USAGE_VERTEX_BUFFER)
+        self.quad.write(struct.pack("<%df" % len(QUAD), *QUAD))
+        self.timestamps = vk.handle(dev.vk.CreateQueryPool, dev.device, byref(
+            vk.QueryPoolCreateInfo(sType=vk.ST_QUERY_POOL_CREATE_INFO,
+                                   queryType=vk.QUERY_TYPE_TIMESTAMP,
+                                   queryCount=2 * count)))
+
+    def _sampler(self, p, fmt):
+        integer = fmt.endswith("INT") or fmt.endswith("INT_PACK32")
+        return self.dev.sampler(bool(p.filter_linear) and not integer,
+                                p.mipmap_input and not integer, p.wrap_mode)
+
+    def texture(self, bind, frame):
+        """The Texture a schedule source refers to on the given frame."""
+        kind, _, arg = bind.partition(":")
+        if kind == "input":
+            index = frame - int(arg)
+            return self.inputs[index % len(self.inputs)] if index >= 0 else self.black
+        if kind == "texture":
+            return self.luts[arg]
+        targets = self.passes[int(arg)].targets
+        if kind == "pass":
+            return targets[frame % len(targets)]
+        return targets[(frame + 1) % len(targets)] if len(targets) > 1 else self.black
+
+    def size(self, bind):
+        kind, _, arg = bind.partition(":")
+        if kind == "input":
+            return self.content
+        if kind == "texture":
+            return self.luts[arg].image.size
+        return self.plans[int(arg)].output_size
+
+    def semantic(self, pp, name, frame_count):
+        """The value of a uniform member, or None if it means nothing."""
+        if name == "MVP":
+            return MVP
+        if name == "OutputSize":
+            size = pp.output_size
+        elif name == "FinalViewportSize":
+            size = self.viewport
+        elif name == "FrameCount":
+            return frame_count
+        elif name in CONSTANTS:
+            return CONSTANTS[name]
+        elif name in self.values:
+            return self.values[name]
+        elif name.endswith("Size") or _SIZE.match(name):
+            m = _SIZE.match(name)
+            texture = m.group(1) + m.group(2) if m else name[:-len("Size")]
+            bind = chain.resolve(self.plans, self.preset.textures, pp, texture, False)
+            if bind is None:
+                return None
+            size = self.size(bind)
+        else:
+            return None
+        return (float(size[0]), float(size[1]), 1.0 / size[0], 1.0 / size[1])
+
+    def block(self, pp, block, frame_count):
+        data = bytearray(block["size"])
+        for m in block["members"]:
+            value = self.semantic(pp, m["name"], frame_count)
+            if value is not None:
+                packed = _pack(m, value)
+                data[m["offset"]:m["offset"] + len(packed)] = packed
+        return bytes(data)
+
+    def frame(self, frame, sched):
+        """Renders one frame and returns the GPU time of every pass in ns."""
+        dev = self.dev
+        for ps, entry in zip(self.passes, sched):
+            pp = ps.plan
+            writes = []
+            infos = []
+            for binding, name in sorted(ps.textures.items()):
+                bind = entry["bindings"].get(name)
+                if bind is None:
+                    bind = chain.resolve(self.plans, self.preset.textures, pp, name, False)
+                tex = self.texture(bind, frame) if bind else self.black
+                infos.append(vk.DescriptorImageInfo(
+                    tex.sampler, tex.image.view, vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL))
+                writes.append((binding, vk.DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                               ctypes.pointer(infos[-1]), None))
+            if ps.ubo:
+                ps.uniforms.write(self.block(pp, ps.ubo, entry["frame_count"]))
+                info = vk.DescriptorBufferInfo(ps.uniforms.buffer, 0, ps.ubo["size"])
+                infos.append(info)
+                writes.append((ps.ubo["binding"], vk.DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                               None, ctypes.pointer(info)))
+            updates = [vk.WriteDescriptorSet(
+                sType=vk.ST_WRITE_DESCRIPTOR_SET, dstSet=ps.set.value, dstBinding=b,
+                descriptorCount=1, descriptorType=t, pImageInfo=image, pBufferInfo=buf)
+                for b, t, image, buf in writes]
+            if updates:
+                dev.vk.UpdateDescriptorSets(dev.device, len(updates),
+                                            vk.array(vk.WriteDescriptorSet, updates), 0, None)
+
+        cmd = dev.begin()
+        dev.vk.CmdResetQueryPool(cmd, self.timestamps, 0, 2 * len(self.passes))
+        offsets = (vk.DeviceSize * 1)(0)
+        quad = (vk.Handle * 1)(self.quad.buffer)
+        for ps, entry in zip(self.passes, sched):
+            pp = ps.plan
+            target = ps.targets[frame % len(ps.targets)].image
+            w, h = pp.output_size
+            dev.vk.CmdWriteTimestamp(cmd, vk.PIPELINE_STAGE_TOP_OF_PIPE, self.timestamps,
+                                     2 * pp.index)
+            black = vk.ClearColorValue()
+            begin = vk.RenderPassBeginInfo(
+                sType=vk.ST_RENDER_PASS_BEGIN_INFO, renderPass=dev.render_pass(pp.format),
+                framebuffer=target.framebuffer,
+                renderArea=vk.Rect2D(vk.Offset2D(0, 0), vk.Extent2D(w, h)),
+                clearValueCount=1, pClearValues=ctypes.pointer(black))
+            dev.vk.CmdBeginRenderPass(cmd, byref(begin), vk.SUBPASS_CONTENTS_INLINE)
+            dev.vk.CmdBindPipeline(cmd, vk.PIPELINE_BIND_POINT_GRAPHICS, ps.pipeline)
+            sets = (vk.Handle * 1)(ps.set.value)
+            dev.vk.CmdBindDescriptorSets(cmd, vk.PIPELINE_BIND_POINT_GRAPHICS, ps.layout,
+                                         0, 1, sets, 0, None)
+            if ps.push:
+                data = self.block(pp, ps.push, entry["frame_count"])
+                dev.vk.CmdPushConstants(cmd, ps.layout,
+                                        vk.SHADER_STAGE_VERTEX | vk.SHADER_STAGE_FRAGMENT,
+                                        0, len(data), data)
+            viewport = vk.Viewport(0.0, 0.0, float(w), float(h), 0.0, 1.0)
+            scissor = vk.Rect2D(vk.Offset2D(0, 0), vk.Extent2D(w, h))
+            dev.vk.CmdSetViewport(cmd, 0, 1, byref(viewport))
+            dev.vk.CmdSetScissor(cmd, 0, 1, byref(scissor))
+            dev.vk.CmdBindVertexBuffers(cmd, 0, 1, quad, offsets)
+            dev.vk.CmdDraw(cmd, 4, 1, 0, 0)
+            dev.vk.CmdEndRenderPass(cmd)
+            if target.levels > 1:
+                target.mipmaps(dev, vk.IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+            dev.vk.CmdWriteTimestamp(cmd, vk.PIPELINE_STAGE_BOTTOM_OF_PIPE,
+                                     self.timestamps, 2 * pp.index + 1)
+            dev.memory_barrier()
+        dev.submit()
+
+        ticks = (c_uint64 * (2 * len(self.passes)))()
+        dev.vk.GetQueryPoolResults(dev.device, self.timestamps, 0, len(ticks),
+                                   ctypes.sizeof(ticks), ticks, 8,
+                                   vk.QUERY_RESULT_64 | vk.QUERY_RESULT_WAIT)
+        mask = (1 << dev.timestamp_bits) - 1 if dev.timestamp_bits < 64 else (1 << 64) - 1
+        return [((ticks[2 * i + 1] - ticks[2 * i]) & mask) * dev.timestamp_period
+                for i in range(len(self.passes))]
+
+    def dump(self, frame, directory, name):
+        """Writes the output of every pass on frame to directory."""
+        dev = self.dev
+        targets = [ps.targets[frame % len(ps.targets)].image for ps in self.passes]
+        offsets = []
+        total = 0
+        for pp in self.plans:
+            offsets.append(total)
+            total += pp.output_size[0] * pp.output_size[1] * pp.bytes_per_texel
+            total = (total + 15) & ~15
+        buf = Buffer(dev, total, vk.BUFFER_USAGE_TRANSFER_DST)
+        dev.begin()
+        for image, offset in zip(targets, offsets):
+            image.copy(dev, buf, offset)
+        dev.submit()
+        for pp, offset in zip(self.plans, offsets):
+            w, h = pp.output_size
+            data = buf.read(w * h * pp.bytes_per_texel, offset)
+            png.write("%s/%s" % (directory, name % pp.index),
+                      decode(pp.format, data, pp.output_size))
+        buf.destroy(dev)
+
+
+def run(job, dev=None):
+    """Executes a runner job and returns its result, see runner.py."""
+    dev = dev or Device()
+    c = Chain(dev, job)
+    frames = job["frames"]
+    warmup = job.get("warmup") or 0
+    sched = job.get("schedule")
+    if sched is not None and len(sched) < warmup + frames:
+        raise HostError("the schedule covers %d frames, the job runs %d"
+                        % (len(sched), warmup + frames))
+    totals = [0.0] * len(c.plans)
+    for i in range(warmup + frames):
+        entry = sched[i] if sched is not None else \
+            chain.schedule(c.plans, c.preset.textures, i, False)
+        times = c.frame(i, entry)
+        if i < warmup:
+            continue
+        totals = [t + ns for t, ns in zip(totals, times)]
+        if job.get("dump"):
+            c.dump(i, job["dump"], "frame%d-pass%%d.png" % (i - warmup))
+    return {"device": dev.name,
+            "passes": [{"ns": t / max(1, frames)} for t in totals]}
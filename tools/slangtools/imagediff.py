@@ -0,0 +1,46 @@
+"""Image comparison for golden image tests."""
+
+import math
+
+from . import png
+
+
+class DiffError(Exception):
+    pass
+
+
+class Diff(object):
+    def __init__(self, psnr, max_abs, differing):
+        self.psnr = psnr
+        self.max_abs = max_abs
+        self.differing = differing
+
+    def within(self, min_psnr, max_abs):
+        return self.psnr >= min_psnr and self.max_abs <= max_abs
+
+
+def compare(a, b):
+    """PSNR (dB) and largest channel error (in 1/255 units) between images.
+
+    Images of different bit depth are compared on a common [0, 1] scale, so a
+    16 bit dump can be checked against an 8 bit golden image.
+    """
+    if (a.width, a.height) != (b.width, b.height):
+        raise DiffError("size %dx%d does not match %dx%d"
+                        % (a.width, a.height, b.width, b.height))
+    sq = 0.0
+    worst = 0.0
+    differing = 0
+    for pa, pb in zip(a.normalized(), b.normalized()):
+        err = max(abs(x - y) for x, y in zip(pa, pb))
+        if err > 0.0:
+            differing += 1
+            worst = max(worst, err)
+            sq += sum((x - y) * (x - y) for x, y in zip(pa, pb))
+    mse = sq / (4.0 * a.width * a.height)
+    psnr = float("inf") if mse == 0.0 else -10.0 * math.log10(mse)
+    return Diff(psnr, worst * 255.0, differing)
+
+
+def compare_files(a, b):
+    return compare(png.read(a), png.read(b))
@@ -0,0 +1,243 @@
+"""The preset index (shaders_slang.idx).
+
+A shader menu needs the name, passes and parameters of every preset, which
+otherwise means opening every .slangp and expanding every .slang it uses.
+The index holds all of that in one file at the root of the tree, so the menu
+costs a single sequential read.  All integers are little endian:
+
+    char     magic[4]         "SLIX"
+    uint32   version          1
+    uint32   size             of the body
+    uint32   reserved         0
+    char     body[size]       UTF-8 JSON, no terminator
+
+The body, with every path relative to the directory holding the index and
+'/' separated:
+
+    files    [[path, size, mtime, sha256], ...] for every preset, shader and
+             include the index was built from; mtime is in whole seconds and
+             sha256 the first 16 hex digits.  A frontend compares size and
+             mtime to decide whether the index is stale.
+    shaders  [{"file", "name", "format", "includes", "parameters"}, ...]
+             "file" and "includes" index files; "parameters" is the #pragma
+             parameter list as [name, desc, initial, minimum, maximum, step]
+             with step null when the shader gives none.  A shader that
+             fails to load has "error" instead, and "path" instead of
+             "file" if it does not exist.
+    presets  [{"file", "passes", "textures", "parameters"}, ...]
+             "passes" is [[shader, alias], ...] with shader indexing shaders,
+             "textures" is [[name, path], ...] and "parameters" the preset's
+             overrides as {name: value}.  A preset that fails to load has
+             "error" instead.
+"""
+
+import hashlib
+import json
+import os
+import struct
+
+from . import preset, source
+
+MAGIC = b"SLIX"
+VERSION = 1
+NAME = "shaders_slang.idx"
+
+_HEADER = struct.Struct("<4sIII")
+
+
+class IndexFormatError(Exception):
+    pass
+
+
+def _rel(path, root):
+    return os.path.relpath(path, root).replace(os.sep, "/")
+
+
+def _stat(path, root):
+    st = os.stat(path)
+    with open(path, "rb") as f:
+        digest = hashlib.sha256(f.read()).hexdigest()[:16]
+    return [_rel(path, root), st.st_size, int(st.st_mtime), digest]
+
+
+def build(root, presets=None):
+    """The index body for the presets below root (or the given ones)."""
+    root = os.path.abspath(root)
+    files = []
+    file_ids = {}
+    shader_ids = {}
+    body = {"files": files, "shaders": [], "presets": []}
+
+    def file_id(path):
+        path = os.path.abspath(path)
+        if path not in file_ids:
+            file_ids[path] = len(files)
+            files.append(_stat(path, root))
+        return file_ids[path]
+
+    def shader_id(path):
+        path = os.path.abspath(path)
+        if path in shader_ids:
+            return shader_ids[path]
+        entry = {}
+        try:
+            sh = source.load(path)
+            entry["file"] = file_id(path)
+            entry["name"] = sh.name
+            entry["format"] = sh.format
+            entry["includes"] = [file_id(p) for p in sh.includes[1:]]
+            entry["parameters"] = [[p.name, p.desc, p.initial, p.minimum, p.maximum, p.step]
+                                   for p in sh.parameters]
+        except (IOError, OSError, source.SourceError) as e:
+            entry = {"error": str(e)}
+            if os.path.isfile(path):
+                entry["file"] = file_id(path)
+            else:
+                entry["path"] = _rel(path, root)
+        shader_ids[path] = len(body["shaders"])
+        body["shaders"].append(entry)
+        return shader_ids[path]
+
+    for path in presets if presets is not None else preset.find_presets(root):
+        try:
+            p = preset.load(path)
+        except (IOError, OSError, preset.PresetError) as e:
+            body["presets"].append({"file": file_id(path), "error": str(e)})
+            continue
+        body["presets"].append({
+            "file": file_id(path),
+            "passes": [[shader_id(ps.shader), ps.alias] for ps in p.passes],
+            "textures": [[t.name, _rel(t.path, root)] for t in p.textures],
+            "parameters": p.parameters,
+        })
+    return body
+
+
+def write(path, body):
+    data = json.dumps(body, separators=(",", ":"), sort_keys=True).encode("utf-8")
+    with open(path, "wb") as f:
+        f.write(_HEADER.pack(MAGIC, VERSION, len(data), 0))
+        f.write(data)
+
+
+class Preset(object):
+    """One preset entry, resolved against the shader table."""
+
+    def __init__(self, index, entry):
+        self.path = index.files[entry["file"]][0]
+        self.error = entry.get("error")
+        self.passes = []
+        self.textures = entry.get("textures", [])
+        self.overrides = entry.get("parameters", {})
+        for shader, alias in entry.get("passes", []):
+            self.passes.append((index.shaders[shader], alias))
+
+    def parameters(self):
+        """The merged parameter table as the frontend builds it.
+
+        Parameters are listed in pass order, the first declaration of a
+        name winning; each is [name, desc, value, minimum, maximum, step]
+        with value the preset's override or the initial value.
+        """
+        seen = set()
+        out = []
+        for shader, _ in self.passes:
+            for name, desc, initial, minimum, maximum, step in shader.get("parameters", []):
+                if name in seen:
+                    continue
+                seen.add(name)
+                out.append([name, desc, self.overrides.get(name, initial),
+                            minimum, maximum, step])
+        return out
+
+
+class Index(object):
+    """A loaded index.  Paths are relative to root, the index's directory."""
+
+    def __init__(self, path):
+        self.path = path
+        self.root = os.path.dirname(os.path.abspath(path))
+        with open(path, "rb") as f:
+            data = f.read()
+        if len(data) < _HEADER.size:
+            raise IndexFormatError("%s: truncated header" % path)
+        magic, version, size, _ = _HEADER.unpack_from(data, 0)
+        if magic != MAGIC or version != VERSION:
+            raise IndexFormatError("%s: not a version %d index" % (path, VERSION))
+        if _HEADER.size + size != len(data):
+            raise IndexFormatError("%s: body is %d bytes, header says %d"
+                                   % (path, len(data) - _HEADER.size, size))
+        try:
+            self.body = json.loads(data[_HEADER.size:].decode("utf-8"))
+        except ValueError as e:
+            raise IndexFormatError("%s: %s" % (path, e))
+        self.files = self.body["files"]
+        self.shaders = self.body["shaders"]
+        self._presets = dict((self.files[e["file"]][0], e) for e in self.body["presets"])
+
+    def presets(self):
+        """Preset paths in tree order."""
+        return [self.files[e["file"]][0] for e in self.body["presets"]]
+
+    def preset(self, path):
+        return Preset(self, self._presets[path])
+
+    def stale(self):
+        """Indexed files whose size or mtime no longer match."""
+        out = []
+        for path, size, mtime, _ in self.files:
+            try:
+                st = os.stat(os.path.join(self.root, path))
+            except OSError:
+                out.append(path)
+                continue
+            if st.st_size != size or int(st.st_mtime) != mtime:
+                out.append(path)
+        return out
+
+
+def check(idx):
+    """Differences between a loaded index and its tree, as strings.
+
+    Contents are compared by hash rather than mtime, and the index is
+    rebuilt from the tree to catch added, removed or changed entries.
+    """
+    errors = []
+    fresh = build(idx.root)
+    old = dict((f[0], f[3]) for f in idx.files)
+    new = dict((f[0], f[3]) for f in fresh["files"])
+    for path in sorted(set(old) | set(new)):
+        if path not in new:
+            errors.append("%s: indexed but no longer used" % path)
+        elif path not in old:
+            errors.append("%s: not indexed" % path)
+        elif old[path] != new[path]:
+            errors.append("%s: contents changed" % path)
+
+    def resolved(body):
+        files = [f[0] for f in body["files"]]
+        shaders = []
+        for s in body["shaders"]:
+            s = dict(s)
+            if "file" in s:
+                s["file"] = files[s["file"]]
+            s["includes"] = [files[i] for i in s.get("includes", [])]
+            shaders.append(s)
+        presets = {}
+        for p in body["presets"]:
+            p = dict(p)
+            p["passes"] = [[shaders[s], a] for s, a in p.get("passes", [])]
+            presets[files[p.pop("file")]] = p
+        return presets
+
+    # Round trip through JSON so both sides compare the same types.
+    old_presets = resolved(idx.body)
+    new_presets = resolved(json.loads(json.dumps(fresh)))
+    for path in sorted(set(old_presets) | set(new_presets)):
+        if path not in new_presets:
+            errors.append("%s: indexed preset is gone" % path)
+        elif path not in old_presets:
+            errors.append("%s: preset not indexed" % path)
+        elif old_presets[path] != new_presets[path]:
+            errors.append("%s: indexed entry is out of date" % path)
+    return errors
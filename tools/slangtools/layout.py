@@ -0,0 +1,147 @@
+"""Splitting uniform data between the push constant block and the UBO.
+
+spec/SHADER_SPEC.md recommends push constants for data the fragment stage
+reads, within the 128 bytes Vulkan guarantees, and the UBO for the MVP and
+anything else.  plan() computes that split for one shader: members the
+fragment stage reads are ranked by how often it reads them and then by size,
+and packed into the push constant block as long as they fit; the MVP and
+members only the vertex stage or nothing reads go to the UBO.
+
+Member use comes from SPIR-V reflection when a compiler is available and is
+approximated from the source otherwise (accesses through '#define NAME
+instance.member' count where NAME is used).  Access counts, used for ranking,
+always come from the source.
+"""
+
+import collections
+import re
+
+from . import compiler, glsl, source, spirv
+
+PUSH_CONSTANT_LIMIT = 128
+
+_DEFINE = re.compile(r'^[ \t]*#[ \t]*define[ \t]+(\w+)(\([^)]*\))?([^\n]*)$', re.M)
+
+
+class LayoutError(Exception):
+    pass
+
+
+class Usage(object):
+    """How often each stage accesses each member, and whether it uses it."""
+
+    def __init__(self):
+        self.count = {"vertex": collections.Counter(),
+                      "fragment": collections.Counter()}
+        self.used = {"vertex": set(), "fragment": set()}
+        self.reflected = False
+
+    def hot(self, name):
+        return name in self.used["fragment"]
+
+
+def _accesses(text, instances):
+    """Counter of members accessed through instances in text."""
+    if not instances:
+        return collections.Counter()
+    access = re.compile(r'\b(?:%s)\s*\.\s*(\w+)' % "|".join(sorted(instances)))
+    macros = {}
+    for m in _DEFINE.finditer(text):
+        members = access.findall(m.group(3))
+        if members:
+            macros[m.group(1)] = members
+    body = _DEFINE.sub("", text)
+    counts = collections.Counter(access.findall(body))
+    for name, members in macros.items():
+        uses = len(re.findall(r'\b%s\b' % name, body))
+        for member in members:
+            counts[member] += uses
+    return counts
+
+
+def textual_usage(shader, instances):
+    usage = Usage()
+    for stage in source.STAGES:
+        text = glsl.strip_comments(shader.stages[stage])
+        usage.count[stage] = _accesses(text, instances)
+        usage.used[stage] = set(n for n, c in usage.count[stage].items() if c)
+    return usage
+
+
+def spirv_usage(shader, instances, compile_stage=compiler.compile_stage):
+    """Usage with the used sets from reflection; raises CompileError."""
+    usage = textual_usage(shader, instances)
+    for stage in source.STAGES:
+        refl = spirv.reflect(compile_stage(shader.stages[stage], stage, shader.path))
+        usage.used[stage] = set()
+        for key in ("ubo", "push_constant"):
+            if refl[key]:
+                usage.used[stage] |= set(m["name"] for m in refl[key]["members"]
+                                         if m["used"])
+    usage.reflected = True
+    return usage
+
+
+class Plan(object):
+    """The current and proposed split of one shader's block members."""
+
+    def __init__(self, ubo, push, usage):
+        self.ubo = ubo
+        self.push = push
+        self.usage = usage
+        self.push_members = list(push.members) if push else []
+        self.ubo_members = list(ubo.members) if ubo else []
+
+    @property
+    def push_bytes(self):
+        return glsl.block_size(self.push.members, False) if self.push else 0
+
+    @property
+    def new_push_bytes(self):
+        return glsl.block_size(self.push_members, False)
+
+    def hot_in_ubo(self):
+        return [m for m in self.ubo.members if self.usage.hot(m[1])] if self.ubo else []
+
+    def moved(self):
+        """{member name: "push" or "ubo"} for every member changing blocks."""
+        before = set(self.push.members) if self.push else set()
+        result = dict((n, "push") for t, n in self.push_members
+                      if (t, n) not in before)
+        result.update((n, "ubo") for t, n in self.ubo_members if (t, n) in before)
+        return result
+
+    @property
+    def changed(self):
+        return bool(self.moved())
+
+
+def plan(ubo, push, usage):
+    """Proposed split for a shader with the given blocks (either may be None)."""
+    result = Plan(ubo, push, usage)
+    if ubo is None:
+        return result
+    members = list(ubo.members) + (list(push.members) if push else [])
+    order = dict((m, i) for i, m in enumerate(members))
+
+    def rank(m):
+        return (-usage.count["fragment"][m[1]], glsl.block_size([m], False), order[m])
+
+    chosen = []
+    for m in sorted((m for m in members if usage.hot(m[1])), key=rank):
+        if glsl.block_size(chosen + [m], False) <= PUSH_CONSTANT_LIMIT:
+            chosen.append(m)
+    # Keep declaration order within each block, existing push members first;
+    # if that order pads past the limit, drop the coldest until it fits.
+    ranked = sorted(chosen, key=rank)
+    while True:
+        result.push_members = ([m for m in (push.members if push else []) if m in ranked] +
+                               [m for m in ubo.members if m in ranked])
+        if glsl.block_size(result.push_members, False) <= PUSH_CONSTANT_LIMIT:
+            break
+        ranked.pop()
+    chosen = set(ranked)
+    result.ubo_members = [m for m in members if m not in chosen]
+    if not result.ubo_members:
+        raise LayoutError("the UBO would be left empty")
+    return result
@@ -0,0 +1,247 @@
+"""The pre-resized phosphor mask atlas of crt-royale's PHOSPHOR_MASK_ATLAS.
+
+crt-royale's default mask sample mode Lanczos-resizes a 64x64 mask tile to
+the on-screen tile size every frame, in two passes (vertical, then
+horizontal) that each write an RGBA8 texture.  The tile size is an integer
+number of pixels, floor(mask_triads_per_tile * triad size) clamped to
+[ceil(mask_min_allowed_triad_size * mask_triads_per_tile), 64] (the passes
+never upsize), so there are only a few dozen tiles per mask type.  This
+module bakes all of them into one texture the scanline pass samples instead:
+
+    band m      rows m*band..(m+1)*band-1, mask type m (grille, slot, shadow)
+    tile t      columns x(t)..x(t)+t+2*BORDER-1 of every band, t from
+                min_tile to max_tile
+
+with band = max_tile + 2*BORDER and x(t) the sum of the widths of the tiles
+before it.  Each tile is surrounded by BORDER texels of its own wrapped
+content, so filtered fetches near its edges stay in the tile.  Presets load
+2D textures only, hence the bands rather than an array texture.
+
+resize() reproduces downsample_vertical_sinc_tiled() and
+downsample_horizontal_sinc_tiled() from phosphor-mask-resizing.h tap for tap,
+including the 8 bit rounding after each pass, so the atlas holds what
+MASK_RESIZE would.  error() measures it against the same resize without the
+8 bit rounding.
+"""
+
+import math
+import re
+
+from . import png
+
+BORDER = 2
+MASK_TYPES = ("grille", "slot", "shadow")
+# No worse than the runtime passes: one rounding per pass, the first one
+# scaled by the horizontal filter's negative lobes.
+TOLERANCE = 2.0 / 255.0
+UNDER_HALF = 0.4995
+
+LAYOUT_BEGIN = "// BEGIN MASK ATLAS LAYOUT: generated by tools/slang-maskatlas.py"
+LAYOUT_END = "// END MASK ATLAS LAYOUT"
+
+
+class MaskAtlasError(Exception):
+    pass
+
+
+class Settings(object):
+    """The static settings the resize depends on, read from crt-royale's
+    headers: triads_per_tile, min_triad_size, lobes, lanczos (the window is
+    on) and dynamic_loops (the tap count follows the tile size rather than
+    always being the largest, as without dynamic branches)."""
+
+    def __init__(self, triads_per_tile, min_triad_size, lobes, lanczos,
+                 dynamic_loops):
+        self.triads_per_tile = triads_per_tile
+        self.min_triad_size = min_triad_size
+        self.lobes = lobes
+        self.lanczos = lanczos
+        self.dynamic_loops = dynamic_loops
+
+    @classmethod
+    def parse(cls, user_settings, cgp_constants):
+        def constant(text, name):
+            m = re.search(r"static const float %s\s*=\s*([0-9.]+)\s*;" % name, text)
+            if not m:
+                raise MaskAtlasError("no static const float %s" % name)
+            return float(m.group(1))
+
+        def defined(name):
+            return re.search(r"^\s*#define\s+%s\b" % name, user_settings, re.M) is not None
+        return cls(constant(cgp_constants, "mask_triads_per_tile"),
+                   constant(user_settings, "mask_min_allowed_triad_size"),
+                   constant(user_settings, "mask_sinc_lobes"),
+                   defined("PHOSPHOR_MASK_RESIZE_LANCZOS_WINDOW"),
+                   defined("DRIVERS_ALLOW_DYNAMIC_BRANCHES") or
+                   defined("ACCOMODATE_POSSIBLE_DYNAMIC_LOOPS"))
+
+
+#################################  RESIZING  ###################################
+
+def _weight(dist, settings):
+    pi_dist = math.pi * dist
+    if pi_dist == 0.0:
+        # sin(0)/0 is NaN on the GPU too, and min(NaN, 1.0) picks 1.0.
+        return 1.0
+    if settings.lanczos:
+        pi_dist_over_lobes = pi_dist / settings.lobes
+        w = math.sin(pi_dist) * math.sin(pi_dist_over_lobes) / (pi_dist * pi_dist_over_lobes)
+    else:
+        w = math.sin(pi_dist) / pi_dist
+    return min(w, 1.0)
+
+
+def _taps(size, src_size, min_tile, settings):
+    """[(first source texel, [weights])] per output texel of a size texel
+    tile, as the shader's sample loop computes them."""
+    scale = float(size) / src_size
+    samples = math.ceil(2.0 * settings.lobes * src_size / min_tile * 0.25) * 4.0
+    if settings.dynamic_loops:
+        samples = min(math.ceil(2.0 * settings.lobes / scale * 0.25) * 4.0, samples, 128.0)
+    samples = int(samples)
+    out = []
+    for j in range(size):
+        curr = (j + 0.5) / size * src_size
+        first = math.floor(curr - UNDER_HALF) + 0.5 - (samples / 2.0 - 1.0)
+        dist = curr - first
+        out.append((int(first - 0.5),
+                    [_weight(scale * abs(dist - i), settings) for i in range(samples)]))
+    return out
+
+
+def _resize_line(line, taps):
+    n = len(line)
+    out = []
+    for first, weights in taps:
+        color = [0.0, 0.0, 0.0]
+        for i, w in enumerate(weights):
+            texel = line[(first + i) % n]
+            for c in range(3):
+                color[c] += w * texel[c]
+        total = sum(weights)
+        out.append(tuple(c / total for c in color))
+    return out
+
+
+def _store(line, rounded):
+    """line as an RGBA8 UNORM render target stores it: clamped, and rounded
+    to 8 bits if rounded."""
+    if rounded:
+        return [tuple(min(max(round(c * 255.0), 0), 255) / 255.0 for c in px)
+                for px in line]
+    return [tuple(min(max(c, 0.0), 1.0) for c in px) for px in line]
+
+
+def tile_sizes(settings, src_size):
+    """(min_tile, max_tile) of the tiles the runtime resize can produce."""
+    lo = int(math.ceil(settings.min_triad_size * settings.triads_per_tile))
+    if lo > src_size:
+        raise MaskAtlasError("the smallest tile (%d) is larger than the %d texel LUT"
+                             % (lo, src_size))
+    return lo, src_size
+
+
+def resize(tile, size, settings, rounded=True):
+    """tile (rows of RGB floats in [0, 1], square) resized to size x size the
+    way the two mask resize passes do; rounded=False skips their 8 bit
+    rounding but still clamps like their UNORM outputs."""
+    src_size = len(tile)
+    min_tile = tile_sizes(settings, src_size)[0]
+    taps = _taps(size, src_size, min_tile, settings)
+    columns = [_store(_resize_line([row[x] for row in tile], taps), rounded)
+               for x in range(src_size)]
+    return [_store(_resize_line([col[y] for col in columns], taps), rounded)
+            for y in range(size)]
+
+
+def read_tile(path):
+    """The mask LUT at path as rows of RGB floats."""
+    img = png.read(path)
+    if img.width != img.height:
+        raise MaskAtlasError("%s: mask LUT's must be square" % path)
+    if img.channels < 3:
+        raise MaskAtlasError("%s: expected an RGB image" % path)
+    scale = float(img.maximum)
+    return [[tuple(c / scale for c in img.get(x, y)[:3]) for x in range(img.width)]
+            for y in range(img.height)]
+
+
+##################################  LAYOUT  ####################################
+
+class Layout(object):
+    def __init__(self, min_tile, max_tile):
+        self.min_tile = min_tile
+        self.max_tile = max_tile
+        self.band = max_tile + 2 * BORDER
+
+    def x(self, size):
+        """First column of the tile of size, border included.  The shader
+        computes the same sum in closed form."""
+        return sum(t + 2 * BORDER for t in range(self.min_tile, size))
+
+    @property
+    def width(self):
+        return self.x(self.max_tile + 1)
+
+    @property
+    def height(self):
+        return self.band * len(MASK_TYPES)
+
+
+def bake(tiles, settings):
+    """(png.Image, Layout) of the atlas for tiles, the three 64x64 mask LUT's
+    in MASK_TYPES order."""
+    sizes = set(len(t) for t in tiles)
+    if len(sizes) != 1:
+        raise MaskAtlasError("the mask LUT's differ in size")
+    layout = Layout(*tile_sizes(settings, sizes.pop()))
+    pixels = [(0, 0, 0)] * (layout.width * layout.height)
+    for m, tile in enumerate(tiles):
+        for size in range(layout.min_tile, layout.max_tile + 1):
+            resized = resize(tile, size, settings)
+            x0, y0 = layout.x(size), m * layout.band
+            for y in range(size + 2 * BORDER):
+                row = resized[(y - BORDER) % size]
+                for x in range(size + 2 * BORDER):
+                    px = row[(x - BORDER) % size]
+                    pixels[(y0 + y) * layout.width + x0 + x] = \
+                        tuple(int(round(c * 255.0)) for c in px)
+    return png.Image(layout.width, layout.height, 3, 8, pixels), layout
+
+
+def error(img, layout, tiles, settings):
+    """Largest absolute difference between a tile of img and the resize
+    without 8 bit rounding, as (error, mask type, size)."""
+    worst = (0.0, None, None)
+    for m, tile in enumerate(tiles):
+        for size in range(layout.min_tile, layout.max_tile + 1):
+            exact = resize(tile, size, settings, rounded=False)
+            x0, y0 = layout.x(size) + BORDER, m * layout.band + BORDER
+            for y in range(size):
+                for x in range(size):
+                    got = img.get(x0 + x, y0 + y)
+                    for c in range(3):
+                        e = abs(got[c] / 255.0 - exact[y][x][c])
+                        if e > worst[0]:
+                            worst = (e, MASK_TYPES[m], size)
+    return worst
+
+
+def layout_text(layout, newline="\n"):
+    """The MASK ATLAS LAYOUT block of phosphor-mask-resizing.h."""
+    lines = [LAYOUT_BEGIN,
+             "static const float mask_atlas_min_tile_size = %.1f;" % layout.min_tile,
+             "static const float mask_atlas_max_tile_size = %.1f;" % layout.max_tile,
+             "static const float mask_atlas_border_texels = %.1f;" % BORDER,
+             LAYOUT_END]
+    return newline.join(lines)
+
+
+def replace_layout(text, layout):
+    """Header text with its MASK ATLAS LAYOUT block replaced."""
+    begin = text.find(LAYOUT_BEGIN)
+    end = text.find(LAYOUT_END)
+    if begin < 0 or end < begin:
+        raise MaskAtlasError("no %r block in the header" % LAYOUT_BEGIN)
+    newline = "\r\n" if "\r\n" in text else "\n"
+    return text[:begin] + layout_text(layout, newline) + text[end + len(LAYOUT_END):]
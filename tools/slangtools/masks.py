@@ -0,0 +1,228 @@
+"""The phosphor mask texture subpixel_masks.h reads with SUBPIXEL_MASKS_USE_LUT.
+
+mask_weights() picks one of 19 phosphor layouts per pixel through an if/else
+chain, builds the layout's pattern in local arrays and indexes it with
+floor(mod()) on every fragment.  Every layout is a small tile of pixels that
+are either lit (1.0) or dimmed (1 - mask_intensity) per channel, so the tiles
+can be baked once and read back with a single texelFetch.
+
+Slang presets load 2D textures only, so the tiles are stacked in one atlas
+rather than an array texture, each starting at column 0 of its own rows:
+
+    row 0           the blank tile (alpha 0) out of range layouts read
+    rows y..y+h-1   layout n's w x h tile, with (w, h, y) in TILE_TABLE
+
+RGB is 255 where a channel is lit and 0 where it is dimmed, alpha 255.
+tiles() takes the patterns from mask_weights() itself, evaluated on the CPU
+by slangtools/halfprec.py, so the texture cannot drift from the ALU path.
+"""
+
+from . import halfprec, png
+
+LAYOUTS = 19
+# Twice the largest tile mask_weights() uses in each direction, so that a
+# period found over the window repeats at least once.
+WINDOW = (28, 12)
+INTENSITIES = (0.5, 0.25, 1.0)
+
+SAMPLER = "subpixel_masks_lut"
+TABLE_BEGIN = "// BEGIN TILE TABLE: generated by tools/slang-masks.py"
+TABLE_END = "// END TILE TABLE"
+
+
+class MaskError(Exception):
+    pass
+
+
+def _window(prog, layout, intensity):
+    """mask_weights() over WINDOW as rows of RGB tuples."""
+    rows = []
+    for y in range(WINDOW[1]):
+        row = []
+        for x in range(WINDOW[0]):
+            env = {"coord": halfprec.Val([x + 0.5, y + 0.5], "high", "float"),
+                   "mask_intensity": halfprec.Val([intensity], "high", "float"),
+                   "phosphor_layout": halfprec.Val([layout], None, "int")}
+            out = prog.evaluate("mask_weights(coord, mask_intensity, phosphor_layout)", env)
+            row.append(tuple(out.comps))
+        rows.append(row)
+    return rows
+
+
+def _period(rows, size, axis):
+    """Smallest period along axis that repeats within rows."""
+    for p in range(1, size // 2 + 1):
+        if all(rows[y][x] == rows[y - p if axis else y][x if axis else x - p]
+               for y in range(p if axis else 0, WINDOW[1])
+               for x in range(0 if axis else p, WINDOW[0])):
+            return p
+    raise MaskError("a tile is larger than half the %dx%d window" % WINDOW)
+
+
+def tiles(prog):
+    """[(width, height, rows of lit RGB bits)] for layouts 0..LAYOUTS, or
+    None for a blank layout, from the ALU mask_weights() in prog."""
+    intensity = INTENSITIES[0]
+    dim = 1.0 - intensity
+    out = []
+    for layout in range(LAYOUTS + 1):
+        rows = _window(prog, layout, intensity)
+        if all(c == 0.0 for row in rows for px in row for c in px):
+            out.append(None)
+            continue
+        bits = []
+        for row in rows:
+            line = []
+            for px in row:
+                if any(c not in (1.0, dim) for c in px):
+                    raise MaskError("layout %d: weights %s are not lit or dimmed"
+                                    % (layout, px))
+                line.append(tuple(int(c == 1.0) for c in px))
+            bits.append(line)
+        w = _period(bits, WINDOW[0], 0)
+        h = _period(bits, WINDOW[1], 1)
+        out.append((w, h, [line[:w] for line in bits[:h]]))
+    return out
+
+
+def bake(layouts):
+    """(png.Image, [(width, height, first row)] per layout) of the atlas."""
+    if layouts[0] is not None:
+        raise MaskError("layout 0 is expected to be blank")
+    width = max(t[0] for t in layouts if t)
+    pixels = [(0, 0, 0, 0)] * width
+    table = []
+    y = 1
+    for t in layouts:
+        if t is None:
+            table.append((1, 1, 0))
+            continue
+        w, h, bits = t
+        table.append((w, h, y))
+        for line in bits:
+            row = [tuple(255 * b for b in px) + (255,) for px in line]
+            pixels.extend(row + [(0, 0, 0, 0)] * (width - w))
+        y += h
+    return png.Image(width, y, 4, 8, pixels), table
+
+
+def table_text(table, newline="\n"):
+    """The TILE_TABLE block of subpixel_masks.h for table."""
+    lines = [TABLE_BEGIN,
+             "const ivec3 subpixel_mask_tiles[%d] = ivec3[](" % len(table)]
+    for i, (w, h, y) in enumerate(table):
+        entry = "   ivec3(%d, %d, %d)%s" % (w, h, y, "," if i + 1 < len(table) else "")
+        lines.append("%-22s// layout %d" % (entry, i))
+    lines += [");", TABLE_END]
+    return newline.join(lines)
+
+
+def replace_table(text, table):
+    """Header text with its TILE_TABLE block replaced."""
+    begin = text.find(TABLE_BEGIN)
+    end = text.find(TABLE_END)
+    if begin < 0 or end < begin:
+        raise MaskError("no %r block in the header" % TABLE_BEGIN)
+    newline = "\r\n" if "\r\n" in text else "\n"
+    return text[:begin] + table_text(table, newline) + text[end + len(TABLE_END):]
+
+
+def texture(img):
+    """img as a halfprec.Texture."""
+    return halfprec.Texture(img.width, img.height,
+                            [tuple(c / 255.0 for c in p) for p in img.pixels])
+
+
+def compare(alu, lut):
+    """[(layout, intensity)] where the two programs' mask_weights() differ."""
+    out = []
+    for layout in (-1,) + tuple(range(LAYOUTS + 2)):
+        for intensity in INTENSITIES:
+            if _window(alu, layout, intensity) != _window(lut, layout, intensity):
+                out.append((layout, intensity))
+    return out
+
+
+################################  BENCHMARK  ###################################
+
+BENCH_LAYOUTS = (1, 3, 19)
+
+
+def bench_shader(includes, lut):
+    """A one pass shader applying mask_weights() to its input at the output
+    resolution.  includes is the path of the include/ directory relative to
+    the shader."""
+    return _BENCH.replace("$define", "#define SUBPIXEL_MASKS_USE_LUT\n" if lut else "") \
+        .replace("$sampler", _BENCH_SAMPLER if lut else "") \
+        .replace("$include", includes.replace("\\", "/"))
+
+
+def bench_preset(shader, layout, texture=None):
+    """A one pass preset for shader at phosphor layout, loading the mask
+    texture at path texture if given (both relative to the preset)."""
+    text = ("shaders = 1\n\n"
+            "shader0 = %s\n"
+            "filter_linear0 = false\n"
+            "scale_type0 = viewport\n"
+            "scale0 = 1.0\n" % shader.replace("\\", "/"))
+    if texture:
+        text += ('\ntextures = "%s"\n'
+                 '%s = "%s"\n'
+                 '%s_linear = "false"\n'
+                 % (SAMPLER, SAMPLER, texture.replace("\\", "/"), SAMPLER))
+    text += ('\nparameters = "phosphor_layout"\n'
+             'phosphor_layout = "%.1f"\n' % layout)
+    return text
+
+
+_BENCH_SAMPLER = "layout(set = 0, binding = 3) uniform sampler2D subpixel_masks_lut;\n"
+
+_BENCH = '''#version 450
+
+layout(push_constant) uniform Push
+{
+	vec4 SourceSize;
+	vec4 OriginalSize;
+	vec4 OutputSize;
+	uint FrameCount;
+	float phosphor_layout;
+	float mask_intensity;
+} params;
+
+#pragma parameter phosphor_layout "Phosphor Layout" 3.0 0.0 19.0 1.0
+#pragma parameter mask_intensity "Mask Intensity" 0.5 0.0 1.0 0.05
+
+layout(std140, set = 0, binding = 0) uniform UBO
+{
+	mat4 MVP;
+} global;
+
+//  Generated by tools/slang-masks.py presets: subpixel_masks.h's
+//  mask_weights() over the whole output, through the ALU path or the baked
+//  mask texture.
+$define
+#pragma stage vertex
+layout(location = 0) in vec4 Position;
+layout(location = 1) in vec2 TexCoord;
+layout(location = 0) out vec2 vTexCoord;
+
+void main()
+{
+	gl_Position = global.MVP * Position;
+	vTexCoord = TexCoord;
+}
+
+#pragma stage fragment
+layout(location = 0) in vec2 vTexCoord;
+layout(location = 0) out vec4 FragColor;
+layout(set = 0, binding = 2) uniform sampler2D Source;
+$sampler
+#include "$include/subpixel_masks.h"
+
+void main()
+{
+	vec3 color = texture(Source, vTexCoord).rgb;
+	FragColor = vec4(color * mask_weights(vTexCoord * params.OutputSize.xy,
+		params.mask_intensity, int(params.phosphor_layout)), 1.0);
+}
+'''
@@ -0,0 +1,161 @@
+"""Just enough PNG support for test images, dumps and generated LUTs.
+
+Images are plain row-major lists of pixels with 1-4 channels, each channel an
+integer in [0, 2^depth - 1].  Reading handles every non-interlaced 8 and 16 bit
+colour type; palette images are expanded to RGB(A).
+"""
+
+import struct
+import zlib
+
+SIGNATURE = b"\x89PNG\r\n\x1a\n"
+
+_CHANNELS = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}
+_COLOR_TYPE = {1: 0, 2: 4, 3: 2, 4: 6}
+
+
+class PngError(Exception):
+    pass
+
+
+class Image(object):
+    def __init__(self, width, height, channels, depth=8, pixels=None):
+        self.width = width
+        self.height = height
+        self.channels = channels
+        self.depth = depth
+        self.pixels = pixels if pixels is not None else \
+            [(0,) * channels] * (width * height)
+
+    @property
+    def maximum(self):
+        return (1 << self.depth) - 1
+
+    def get(self, x, y):
+        return self.pixels[y * self.width + x]
+
+    def set(self, x, y, value):
+        self.pixels[y * self.width + x] = tuple(value)
+
+    def normalized(self):
+        """Pixels as RGBA float tuples in [0, 1]."""
+        m = float(self.maximum)
+        out = []
+        for p in self.pixels:
+            if self.channels <= 2:
+                c = (p[0] / m,) * 3 + ((p[1] / m,) if self.channels == 2 else (1.0,))
+            else:
+                c = tuple(v / m for v in p[:3]) + ((p[3] / m,) if self.channels == 4 else (1.0,))
+            out.append(c)
+        return out
+
+
+def _chunk(kind, data):
+    crc = zlib.crc32(kind + data) & 0xffffffff
+    return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", crc)
+
+
+def write(path, image):
+    fmt = ">%dH" if image.depth == 16 else "%dB"
+    rows = []
+    n = image.width * image.channels
+    for y in range(image.height):
+        row = image.pixels[y * image.width:(y + 1) * image.width]
+        flat = [v for p in row for v in p]
+        rows.append(b"\0" + struct.pack(fmt % n, *flat))
+    header = struct.pack(">IIBBBBB", image.width, image.height, image.depth,
+                         _COLOR_TYPE[image.channels], 0, 0, 0)
+    with open(path, "wb") as f:
+        f.write(SIGNATURE)
+        f.write(_chunk(b"IHDR", header))
+        f.write(_chunk(b"IDAT", zlib.compress(b"".join(rows), 9)))
+        f.write(_chunk(b"IEND", b""))
+
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def size(path):
+    """(width, height) from the IHDR chunk, without decoding the image."""
+    with open(path, "rb") as f:
+        data = f.read(len(SIGNATURE) + 16)
+    if not data.startswith(SIGNATURE) or data[len(SIGNATURE) + 4:len(SIGNATURE) + 8] != b"IHDR":
+        raise PngError("%s: not a PNG file" % path)
+    return struct.unpack(">II", data[len(SIGNATURE) + 8:len(SIGNATURE) + 16])
+
+
+def read(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if not data.startswith(SIGNATURE):
+        raise PngError("%s: not a PNG file" % path)
+    pos = len(SIGNATURE)
+    idat = []
+    palette = None
+    trns = None
+    header = None
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat.append(body)
+        elif kind == b"IEND":
+            break
+    if header is None:
+        raise PngError("%s: missing IHDR" % path)
+    width, height, depth, ctype, _, _, interlace = header
+    if interlace or depth not in (8, 16) or ctype not in _CHANNELS:
+        raise PngError("%s: unsupported PNG (depth %d, type %d, interlace %d)"
+                       % (path, depth, ctype, interlace))
+
+    channels = _CHANNELS[ctype]
+    bpp = channels * depth // 8
+    stride = width * bpp
+    raw = zlib.decompress(b"".join(idat))
+    prev = bytearray(stride)
+    samples = []
+    for y in range(height):
+        ftype = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xff
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xff
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xff
+            elif ftype == 4:
+                line[i] = (line[i] + _paeth(a, b, c)) & 0xff
+        prev = line
+        if depth == 16:
+            samples.extend(struct.unpack(">%dH" % (stride // 2), bytes(line)))
+        else:
+            samples.extend(line)
+
+    pixels = [tuple(samples[i:i + channels]) for i in range(0, len(samples), channels)]
+    if ctype == 3:
+        if palette is None:
+            raise PngError("%s: palette image without PLTE" % path)
+        if trns:
+            alpha = list(trns) + [255] * (len(palette) - len(trns))
+            pixels = [palette[p[0]] + (alpha[p[0]],) for p in pixels]
+            channels = 4
+        else:
+            pixels = [palette[p[0]] for p in pixels]
+            channels = 3
+    return Image(width, height, channels, depth, pixels)
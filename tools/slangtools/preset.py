@@ -0,0 +1,268 @@
+"""Parsing of .slangp presets.
+
+The format is the RetroArch config file format: one `key = value` per line,
+values optionally quoted, `#` starting a comment outside of quotes.  Pass
+settings are suffixed with the pass index (`shader0`, `scale_type_x3`, ...),
+lookup textures are listed in `textures` and parameter overrides in
+`parameters`.
+"""
+
+import math
+import os
+import re
+
+SCALE_TYPES = ("source", "viewport", "absolute", "original")
+
+# Per-pass preset keys, suffixed with the pass index.
+PASS_KEYS = re.compile(r'^(shader|alias|filter_linear|wrap_mode|mipmap_input|'
+                       r'float_framebuffer|srgb_framebuffer|frame_count_mod|'
+                       r'scale_type_x|scale_type_y|scale_type|scale_x|scale_y|'
+                       r'scale)(\d+)$')
+
+
+class PresetError(Exception):
+    pass
+
+
+def parse_config(text):
+    """Returns an ordered dict of key -> value for a RetroArch config file."""
+    conf = {}
+    for line in text.splitlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        key, sep, value = line.partition("=")
+        if not sep:
+            continue
+        key = key.strip()
+        value = value.strip()
+        if value.startswith('"'):
+            end = value.find('"', 1)
+            value = value[1:] if end < 0 else value[1:end]
+        else:
+            value = value.split("#", 1)[0].strip()
+        conf[key] = value
+    return conf
+
+
+def parse_bool(value, default=False):
+    if value is None:
+        return default
+    return value.strip().lower() in ("true", "1", "yes", "on")
+
+
+_LEADING_NUMBER = re.compile(r"\s*[-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?")
+
+
+def parse_float(value, default=None):
+    """Parses the numeric prefix of value the way strtod() would."""
+    if value is None or value == "":
+        return default
+    m = _LEADING_NUMBER.match(value)
+    if not m:
+        raise PresetError("invalid number '%s'" % value)
+    return float(m.group(0))
+
+
+def resolve_path(base, path):
+    """Resolves a preset-relative path, accepting Windows separators."""
+    return os.path.normpath(os.path.join(base, path.replace("\\", "/")))
+
+
+class Axis(object):
+    """Scale of one framebuffer axis: scale_type plus its factor or size."""
+
+    def __init__(self, scale_type, scale):
+        self.scale_type = scale_type
+        self.scale = scale
+
+    def resolve(self, original, source, viewport):
+        """Output size along this axis, rounded like the frontend does."""
+        base = {"source": source, "viewport": viewport,
+                "original": original}.get(self.scale_type, 1.0)
+        return max(1, int(math.floor(base * self.scale + 0.5)))
+
+    def __repr__(self):
+        return "%s %g" % (self.scale_type, self.scale)
+
+
+class Pass(object):
+    def __init__(self, index):
+        self.index = index
+        self.shader = None
+        self.alias = None
+        self.filter_linear = None
+        self.wrap_mode = "clamp_to_border"
+        self.mipmap_input = False
+        self.float_framebuffer = False
+        self.srgb_framebuffer = False
+        self.frame_count_mod = 0
+        # None means the pass has no explicit scale: it renders to the
+        # viewport when it is the last pass and at source scale otherwise.
+        self.scale_x = None
+        self.scale_y = None
+
+    @property
+    def explicit_scale(self):
+        return self.scale_x is not None
+
+
+class Texture(object):
+    def __init__(self, name, path):
+        self.name = name
+        self.path = path
+        self.linear = False
+        self.mipmap = False
+        self.wrap_mode = "clamp_to_border"
+
+
+class Preset(object):
+    def __init__(self, path):
+        self.path = path
+        self.passes = []
+        self.textures = []
+        self.parameters = {}
+        self.conf = {}
+
+    @property
+    def directory(self):
+        return os.path.dirname(os.path.abspath(self.path))
+
+    def option(self, key, default=None):
+        """Raw access to preset keys which are not pass settings."""
+        return self.conf.get(key, default)
+
+
+def _axis(conf, i, suffix):
+    scale_type = conf.get("scale_type%s%d" % (suffix, i),
+                          conf.get("scale_type%d" % i))
+    if scale_type is None:
+        return None
+    if scale_type not in SCALE_TYPES:
+        raise PresetError("pass %d: unknown scale_type '%s'" % (i, scale_type))
+    default = 1.0 if scale_type != "absolute" else None
+    scale = parse_float(conf.get("scale%s%d" % (suffix, i),
+                                 conf.get("scale%d" % i)), default)
+    if scale is None:
+        raise PresetError("pass %d: absolute scale without a size" % i)
+    return Axis(scale_type, scale)
+
+
+def load(path):
+    """Parses the preset at path and resolves shader and texture paths."""
+    with open(path, "r", encoding="utf-8", errors="replace") as f:
+        conf = parse_config(f.read())
+
+    preset = Preset(path)
+    preset.conf = conf
+    base = preset.directory
+
+    try:
+        count = int(conf.get("shaders", "0"))
+    except ValueError:
+        raise PresetError("invalid shader count '%s'" % conf.get("shaders"))
+    if count <= 0:
+        raise PresetError("preset has no shaders")
+
+    for i in range(count):
+        p = Pass(i)
+        shader = conf.get("shader%d" % i)
+        if not shader:
+            raise PresetError("pass %d has no shader" % i)
+        p.shader = resolve_path(base, shader)
+        p.alias = conf.get("alias%d" % i) or None
+        if "filter_linear%d" % i in conf:
+            p.filter_linear = parse_bool(conf["filter_linear%d" % i])
+        p.wrap_mode = conf.get("wrap_mode%d" % i, p.wrap_mode)
+        p.mipmap_input = parse_bool(conf.get("mipmap_input%d" % i))
+        p.float_framebuffer = parse_bool(conf.get("float_framebuffer%d" % i))
+        p.srgb_framebuffer = parse_bool(conf.get("srgb_framebuffer%d" % i))
+        p.frame_count_mod = int(parse_float(conf.get("frame_count_mod%d" % i), 0))
+        p.scale_x = _axis(conf, i, "_x")
+        p.scale_y = _axis(conf, i, "_y")
+        if (p.scale_x is None) != (p.scale_y is None):
+            # RetroArch defaults the missing axis to source scale.
+            if p.scale_x is None:
+                p.scale_x = Axis("source", 1.0)
+            else:
+                p.scale_y = Axis("source", 1.0)
+        preset.passes.append(p)
+
+    for name in filter(None, conf.get("textures", "").split(";")):
+        if name not in conf:
+            raise PresetError("texture '%s' has no path" % name)
+        tex = Texture(name, resolve_path(base, conf[name]))
+        tex.linear = parse_bool(conf.get(name + "_linear"))
+        tex.mipmap = parse_bool(conf.get(name + "_mipmap"))
+        tex.wrap_mode = conf.get(name + "_wrap_mode", tex.wrap_mode)
+        preset.textures.append(tex)
+
+    for name in filter(None, conf.get("parameters", "").split(";")):
+        if name in conf:
+            preset.parameters[name] = parse_float(conf[name])
+
+    return preset
+
+
+def find_presets(root):
+    """Yields every .slangp below root in a stable order."""
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames[:] = sorted(d for d in dirnames
+                             if not d.startswith(".") and d not in ("tools", "build"))
+        for name in sorted(filenames):
+            if name.endswith(".slangp"):
+                yield os.path.join(dirpath, name)
+
+
+def shader_paths(args):
+    """Shaders of the presets in args, plus the shaders in args themselves.
+
+    Without args every preset below the current directory is used.  Returns
+    (sorted paths, error strings).
+    """
+    paths, errors = [], []
+    for arg in args or find_presets("."):
+        if arg.endswith(".slangp"):
+            try:
+                paths.extend(p.shader for p in load(arg).passes)
+            except (IOError, PresetError) as e:
+                errors.append("%s: %s" % (arg, e))
+        else:
+            paths.append(os.path.normpath(arg))
+    return sorted(set(paths)), errors
+
+
+def relocated(p, directory=None):
+    """p.conf with shader and texture paths relative to directory.
+
+    Without a directory the paths are made absolute.
+    """
+    conf = dict(p.conf)
+    paths = [("shader%d" % ps.index, ps.shader) for ps in p.passes]
+    paths += [(tex.name, tex.path) for tex in p.textures]
+    for key, path in paths:
+        path = os.path.abspath(path)
+        conf[key] = os.path.relpath(path, directory) if directory else path
+    return conf
+
+
+def write(path, conf):
+    """Writes conf with the shader count first and passes grouped in order."""
+    passes = {}
+    rest = []
+    for key, value in conf.items():
+        m = PASS_KEYS.match(key)
+        if m:
+            passes.setdefault(int(m.group(2)), []).append((key, value))
+        elif key != "shaders":
+            rest.append((key, value))
+    with open(path, "w") as f:
+        f.write('shaders = "%s"\n' % conf["shaders"])
+        for n in sorted(passes):
+            f.write("\n")
+            for key, value in passes[n]:
+                f.write('%s = "%s"\n' % (key, value))
+        if rest:
+            f.write("\n")
+        for key, value in rest:
+            f.write('%s = "%s"\n' % (key, value))
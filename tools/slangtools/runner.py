@@ -0,0 +1,135 @@
+"""Driving a Vulkan runner on lavapipe.
+
+Tools that need pixels or timings resolve everything they can here, write a
+JSON job to the runner's stdin and read a JSON result from its stdout.  The
+runner is tools/slang-runner.py (see slangtools/host.py) unless another
+command is given.  A job looks like
+
+    {"preset": PATH, "bundle": PATH or null, "frames": N, "warmup": N,
+     "content": [W, H], "viewport": [W, H], "inputs": [PNG, ...],
+     "history": DEPTH, "feedback": [PASS, ...],
+     "passes": [{"output": [W, H], "format": FORMAT}, ...],
+     "dump": DIR or null, "schedule": [FRAME, ...] or null}
+
+"inputs" are fed as Original in order, repeating; history and feedback
+textures start out black.  When "dump" is set the runner writes the output of
+every pass of every frame to DIR/frame<F>-pass<N>.png (16 bit for float
+formats).  "schedule", when present, holds chain.schedule() for every frame
+and the runner must bind textures and FrameCount exactly as listed.  The
+result is
+
+    {"device": NAME, "passes": [{"ns": NS_PER_FRAME}, ...]}
+"""
+
+import glob
+import json
+import os
+import shlex
+import subprocess
+import sys
+
+from . import chain, png
+
+LAVAPIPE_ICDS = [
+    "/usr/share/vulkan/icd.d/lvp_icd.*.json",
+    "/usr/local/share/vulkan/icd.d/lvp_icd.*.json",
+    "/etc/vulkan/icd.d/lvp_icd.*.json",
+]
+
+ENV = "SLANG_RUNNER"
+
+DEFAULT = "%s %s" % (shlex.quote(sys.executable), shlex.quote(os.path.join(
+    os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "slang-runner.py")))
+
+
+class RunnerError(Exception):
+    pass
+
+
+def lavapipe_icd():
+    for pattern in LAVAPIPE_ICDS:
+        found = sorted(glob.glob(pattern))
+        if found:
+            return found[0]
+    return None
+
+
+def environment(force_lavapipe=True):
+    """os.environ, with the Vulkan loader pointed at lavapipe only."""
+    env = dict(os.environ)
+    if force_lavapipe:
+        icd = lavapipe_icd()
+        if not icd:
+            raise RunnerError("lavapipe ICD not found; install Mesa's Vulkan drivers")
+        env["VK_ICD_FILENAMES"] = env["VK_DRIVER_FILES"] = icd
+    return env
+
+
+def test_pattern(width, height, frame):
+    """SMPTE-ish bars, a ramp, a fine checkerboard and a moving edge."""
+    bars = [(192, 192, 192), (192, 192, 0), (0, 192, 192), (0, 192, 0),
+            (192, 0, 192), (192, 0, 0), (0, 0, 192)]
+    img = png.Image(width, height, 3)
+    shift = frame * 3
+    for y in range(height):
+        band = 4 * y // height
+        for x in range(width):
+            xs = (x + shift) % width
+            if band == 0:
+                c = bars[7 * xs // width]
+            elif band == 1:
+                v = 255 * xs // max(1, width - 1)
+                c = (v, v, v)
+            elif band == 2:
+                v = 255 if (xs + y) & 1 else 0
+                c = (v, v, v)
+            else:
+                c = (255, 255, 255) if (xs // 8) % 2 else (16, 16, 16)
+            img.set(x, y, c)
+    return img
+
+
+def write_inputs(directory, content, count):
+    """Writes count test pattern frames and returns their paths."""
+    paths = []
+    for f in range(count):
+        path = os.path.join(directory, "input-%dx%d-%d.png" % (content + (f,)))
+        if not os.path.exists(path):
+            png.write(path, test_pattern(content[0], content[1], f))
+        paths.append(path)
+    return paths
+
+
+def job(preset_path, plans, content, viewport, inputs, frames, warmup=0,
+        bundle=None, dump=None, schedule=None):
+    return {
+        "preset": os.path.abspath(preset_path),
+        "bundle": bundle,
+        "frames": frames,
+        "warmup": warmup,
+        "content": list(content),
+        "viewport": list(viewport),
+        "inputs": inputs,
+        "history": chain.history_depth(plans),
+        "feedback": sorted(chain.feedback_passes(plans)),
+        "passes": [{"output": list(pp.output_size), "format": pp.format}
+                   for pp in plans],
+        "dump": dump,
+        "schedule": schedule,
+    }
+
+
+def run(command, job, env):
+    proc = subprocess.run(command, shell=True, env=env,
+                          input=json.dumps(job).encode("utf-8"),
+                          stdout=subprocess.PIPE)
+    if proc.returncode != 0:
+        raise RunnerError("runner exited with status %d" % proc.returncode)
+    try:
+        result = json.loads(proc.stdout.decode("utf-8"))
+    except ValueError as e:
+        raise RunnerError("runner output is not JSON: %s" % e)
+    if len(result.get("passes", [])) != len(job["passes"]):
+        raise RunnerError("runner reported %d passes, expected %d"
+                          % (len(result.get("passes", [])), len(job["passes"])))
+    return result
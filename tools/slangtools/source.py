@@ -0,0 +1,114 @@
+"""Preprocessing of .slang sources as described in spec/SHADER_SPEC.md.
+
+Includes are resolved textually, relative to the including file and without
+regard to preprocessor conditionals.  The expanded source is then scanned for
+the #pragma statements the frontend understands and split into the vertex and
+fragment stage sources.  Tools that need what reflection would see, such as
+the samplers a pass binds, filter the stage sources with glsl.active().
+"""
+
+import os
+import re
+
+STAGES = ("vertex", "fragment")
+
+_INCLUDE = re.compile(r'^\s*#\s*include\s+"([^"]+)"')
+_PRAGMA = re.compile(r'^\s*#\s*pragma\s+(\w+)\s*(.*)$')
+_NUMBER = r'([-+]?(?:\d+\.?\d*|\.\d+)(?:[eE][-+]?\d+)?)'
+_PARAMETER = re.compile(r'(\w+)\s+"([^"]*)"\s+' + r'\s+'.join([_NUMBER] * 3) +
+                        r'(?:\s+' + _NUMBER + r')?')
+
+
+class SourceError(Exception):
+    pass
+
+
+class Parameter(object):
+    def __init__(self, name, desc, initial, minimum, maximum, step):
+        self.name = name
+        self.desc = desc
+        self.initial = initial
+        self.minimum = minimum
+        self.maximum = maximum
+        self.step = step
+
+
+class Shader(object):
+    """An expanded .slang file and the metadata from its #pragmas."""
+
+    def __init__(self, path):
+        self.path = path
+        self.lines = []
+        self.includes = []
+        self.name = None
+        self.format = None
+        self.parameters = []
+        self.stages = {}
+
+    @property
+    def text(self):
+        return "".join(self.lines)
+
+
+def _expand(path, lines, includes, depth):
+    if depth > 32:
+        raise SourceError("%s: includes nested too deeply" % path)
+    try:
+        with open(path, "r", encoding="utf-8", errors="replace") as f:
+            data = f.read()
+    except IOError as e:
+        raise SourceError("%s: %s" % (path, e.strerror))
+    if includes is not None:
+        includes.append(os.path.normpath(path))
+    base = os.path.dirname(path)
+    for line in data.splitlines():
+        m = _INCLUDE.match(line)
+        if m:
+            _expand(os.path.normpath(os.path.join(base, m.group(1))),
+                    lines, includes, depth + 1)
+        else:
+            lines.append(line + "\n")
+
+
+def load(path):
+    """Loads path, expands its includes and splits it into stages."""
+    shader = Shader(os.path.normpath(path))
+    _expand(shader.path, shader.lines, shader.includes, 0)
+    if not shader.lines or not shader.lines[0].lstrip().startswith("#version"):
+        raise SourceError("%s: first line must be a #version statement" % path)
+
+    stages = dict((s, []) for s in STAGES)
+    active = None
+    for line in shader.lines:
+        m = _PRAGMA.match(line)
+        if m:
+            kind, arg = m.group(1), m.group(2).strip()
+            if kind == "stage":
+                if arg not in STAGES:
+                    raise SourceError("%s: unknown stage '%s'" % (path, arg))
+                active = arg
+                continue
+            elif kind == "name":
+                shader.name = arg
+            elif kind == "format":
+                shader.format = arg
+            elif kind == "parameter":
+                p = parse_parameter(arg)
+                if p and not any(q.name == p.name for q in shader.parameters):
+                    shader.parameters.append(p)
+        for stage in STAGES:
+            if active is None or active == stage:
+                stages[stage].append(line)
+
+    shader.stages = dict((s, "".join(l)) for s, l in stages.items())
+    return shader
+
+
+def parse_parameter(arg):
+    m = _PARAMETER.match(arg)
+    if not m:
+        return None
+    step = m.group(6)
+    return Parameter(m.group(1), m.group(2), float(m.group(3)),
+                     float(m.group(4)), float(m.group(5)),
+                     float(step) if step is not None else None)
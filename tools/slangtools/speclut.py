@@ -0,0 +1,353 @@
+"""The lookup texture special-functions.h's *_lut() functions read.
+
+crt-royale's scanline pass evaluates erf() or, for generalized Gaussian
+beams, gamma() and the normalized lower incomplete gamma function for every
+color channel at two distances from each of the scanlines it blends: chains
+of exp(), pow() and divides.  All three are smooth over the small domains the
+scanlines use, so one filtered fetch from a baked texture can replace them.
+
+The texture is RGBA8, since that is what RetroArch loads from a PNG, and each
+value is stored in 16 bits split over two channels (high byte, low byte):
+bilinear filtering is linear, so the two filtered channels still add up to
+the filtered 16 bit value.  Layout, with (s, u) the generalized Gaussian's
+1/shape and distance in units of its alpha:
+
+    row 0       .rg erf(x), x in [0, ERF_MAX]
+                .ba gamma(s + 1), s in [0, S_MAX]
+    rows 1..n   .rg normalized_ligamma(s, u**(1/s)), u in [0, U_MAX],
+                    s = 0 in row 1 to S_MAX in row n
+
+The ligamma rows are indexed by u rather than z = u**(1/s) because the
+function is smooth in u (it is the beam's CDF) and steep in z near 0.
+
+resolution() picks the smallest texture whose error, with the filter weights
+rounded to 8 bits the way GPUs round them, is within given tolerances.
+"""
+
+import math
+
+from . import png
+
+ERF_MAX = 4.0
+S_MAX = 0.5
+U_MAX = 4.5
+# crt-royale's beam shapes (1/s) go up to 32; below this s the ligamma rows
+# are kept but not held to the tolerance, since the beam profile becomes a
+# box and nothing but a much taller texture would resolve its edge.
+S_MIN = 1.0 / 32.0
+WEIGHT_BITS = 8
+
+# No worse than the analytic versions the texture replaces: erf6's documented
+# absolute bound and gamma_impl's relative one.  normalized_ligamma_impl's
+# worst absolute error measures 1.45e-3 (its documented 0.00182 is relative);
+# the ligamma rows are held to a third of that, since the scanlines take the
+# difference of two lookups and twice the rows still make a small texture.
+TOLERANCES = {"erf": 2.5e-5, "gamma": 4.63e-4, "ligamma": 5e-4}
+
+MAX_WIDTH = 4096
+MAX_ROWS = 256
+
+
+class SpecLutError(Exception):
+    pass
+
+
+##############################  REFERENCE VALUES  ##############################
+
+def erf(x):
+    return math.erf(x)
+
+
+def gamma_plus_one(s):
+    return math.gamma(s + 1.0)
+
+
+def ligamma(s, u):
+    """normalized_ligamma(s, z) for z = u**(1/s), in double precision.
+
+    A series for z < s + 1 and Lentz's continued fraction for the upper
+    function otherwise.  z**s is u exactly, which keeps small u accurate
+    where z underflows.
+    """
+    if u <= 0.0:
+        return 0.0
+    if s <= 0.0:
+        return min(u, 1.0)
+    log_z = math.log(u) / s
+    if log_z > 700.0:
+        return 1.0
+    z = math.exp(log_z)
+    if z < s + 1.0:
+        term = 1.0 / math.gamma(s + 1.0)
+        total = term
+        n = 0
+        while term > total * 1e-17:
+            n += 1
+            term *= z / (s + n)
+            total += term
+        return u * math.exp(-z) * total
+    b = z + 1.0 - s
+    c = 1e300
+    d = 1.0 / b
+    h = d
+    for i in range(1, 1000):
+        a = -i * (i - s)
+        b += 2.0
+        d = a * d + b
+        d = 1.0 / d if d else 1e300
+        c = b + a / c
+        delta = c * d
+        h *= delta
+        if abs(delta - 1.0) < 1e-16:
+            break
+    return 1.0 - math.exp(s * log_z - z - math.lgamma(s)) * h
+
+
+##################################  BAKING  ####################################
+
+def _quantize(v):
+    return int(round(min(max(v, 0.0), 1.0) * 65535.0))
+
+
+def _row_s(j, rows):
+    return S_MAX * j / (rows - 1)
+
+
+def bake(width, rows):
+    """The texture as a png.Image: width texels, rows ligamma rows."""
+    if width < 2 or rows < 2:
+        raise SpecLutError("the texture needs at least 2x2 texels per table")
+    last = width - 1.0
+    values = [[(erf(ERF_MAX * i / last), gamma_plus_one(S_MAX * i / last))
+               for i in range(width)]]
+    for j in range(rows):
+        s = _row_s(j, rows)
+        values.append([(ligamma(s, U_MAX * i / last), 0.0) for i in range(width)])
+    pixels = []
+    for row in values:
+        for a, b in row:
+            qa, qb = _quantize(a), _quantize(b)
+            pixels.append((qa >> 8, qa & 255, qb >> 8, qb & 255))
+    return png.Image(width, rows + 1, 4, 8, pixels)
+
+
+def unpack(img):
+    """The two 16 bit tables per texel of img, as floats in [0, 1]."""
+    if img.channels != 4 or img.depth != 8:
+        raise SpecLutError("expected an 8 bit RGBA image")
+    return [((r * 256 + g) / 65535.0, (b * 256 + a) / 65535.0)
+            for r, g, b, a in img.pixels]
+
+
+######################################  ERROR  #################################
+
+def _weight(f):
+    steps = 1 << WEIGHT_BITS
+    return round(f * steps) / steps
+
+
+def _lerp(row, x):
+    """row filtered at texel position x, clamped to the row."""
+    x = min(max(x, 0.0), len(row) - 1.0)
+    i = min(int(x), len(row) - 2)
+    f = _weight(x - i)
+    return row[i] + (row[i + 1] - row[i]) * f
+
+
+# Where to probe between two texel centers: spread over the cell, each just
+# short of half a weight step off the 8 bit grid, where rounding the weight
+# costs the most.
+_FRACTIONS = [(2 * k + 1) / 16.0 + 1.0 / 600.0 for k in range(8)]
+
+
+def _probes(n, lo, hi):
+    """Points between every pair of texel centers on [lo, hi]."""
+    out = []
+    for k in range(n - 1):
+        for f in _FRACTIONS:
+            out.append(lo + (hi - lo) * (k + f) / (n - 1))
+    return out
+
+
+def _table(width, fn, hi):
+    last = width - 1.0
+    return [_quantize(fn(hi * i / last)) / 65535.0 for i in range(width)]
+
+
+def erf_error(width):
+    table = _table(width, erf, ERF_MAX)
+    scale = (width - 1) / ERF_MAX
+    return max(abs(_lerp(table, x * scale) - erf(x)) for x in _probes(width, 0.0, ERF_MAX))
+
+
+def gamma_error(width):
+    """Largest relative error of gamma(s) = gamma(s + 1)/s."""
+    table = _table(width, gamma_plus_one, S_MAX)
+    scale = (width - 1) / S_MAX
+    return max(abs(_lerp(table, s * scale) / gamma_plus_one(s) - 1.0)
+               for s in _probes(width, 0.0, S_MAX))
+
+
+def ligamma_error(width, rows, u_probes=None):
+    """Largest absolute error of the ligamma rows for s in [S_MIN, S_MAX].
+
+    u is probed between texel centers up to where every row has reached 1,
+    and s between rows.
+    """
+    last = width - 1.0
+    table = []
+    for j in range(rows):
+        s = _row_s(j, rows)
+        table.append([_quantize(ligamma(s, U_MAX * i / last)) / 65535.0
+                      for i in range(width)])
+    if u_probes is None:
+        u_probes = [u for u in _probes(width, 0.0, U_MAX) if u < 3.5]
+    worst = 0.0
+    for s in _probes(rows, 0.0, S_MAX):
+        if s < S_MIN:
+            continue
+        y = s / S_MAX * (rows - 1)
+        j = min(int(y), rows - 2)
+        fy = _weight(y - j)
+        top, bottom = table[j], table[j + 1]
+        for u in u_probes:
+            x = u / U_MAX * last
+            a = _lerp(top, x)
+            v = a + (_lerp(bottom, x) - a) * fy
+            worst = max(worst, abs(v - ligamma(s, u)))
+    return worst
+
+
+def resolution(tolerances=TOLERANCES):
+    """(width, rows) of the smallest texture within tolerances.
+
+    Both are powers of two: the width the smallest for erf and gamma, the
+    row count the smallest for the ligamma rows at that width (the width
+    doubles if no row count up to MAX_ROWS is enough).
+    """
+    width = 64
+    while erf_error(width) > tolerances["erf"] or \
+            gamma_error(width) > tolerances["gamma"]:
+        width *= 2
+        if width > MAX_WIDTH:
+            raise SpecLutError("erf/gamma need more than %d texels" % MAX_WIDTH)
+    while True:
+        rows = 8
+        while rows <= MAX_ROWS:
+            if ligamma_error(width, rows) <= tolerances["ligamma"]:
+                return width, rows
+            rows *= 2
+        width *= 2
+        if width > MAX_WIDTH:
+            raise SpecLutError("ligamma needs more than %dx%d texels"
+                               % (MAX_WIDTH, MAX_ROWS))
+
+
+################################  BENCHMARK  ###################################
+
+def bench_shader(includes, lut):
+    """A one pass shader doing the special function work of crt-royale's
+    scanline pass: erf() and the generalized Gaussian integral at both edges
+    of a pixel, for three scanlines and three channels.  includes is the path
+    of the include/ directory relative to the shader."""
+    return _BENCH.replace("$sampler", _BENCH_SAMPLER if lut else "") \
+        .replace("$loop", _BENCH_LUT if lut else _BENCH_ANALYTIC) \
+        .replace("$include", includes.replace("\\", "/"))
+
+
+def bench_preset(shader, texture=None):
+    """A one pass preset for shader, loading the lookup texture at path
+    texture if given (both relative to the preset)."""
+    text = ("shaders = 1\n\n"
+            "shader0 = %s\n"
+            "filter_linear0 = true\n"
+            "scale_type0 = source\n"
+            "scale0 = 1.0\n" % shader.replace("\\", "/"))
+    if texture:
+        text += ('\ntextures = "special_functions_lut"\n'
+                 'special_functions_lut = "%s"\n'
+                 'special_functions_lut_linear = "true"\n'
+                 'special_functions_lut_wrap_mode = "clamp_to_edge"\n'
+                 % texture.replace("\\", "/"))
+    return text
+
+
+_BENCH_SAMPLER = "layout(set = 0, binding = 3) uniform sampler2D special_functions_lut;\n"
+
+_BENCH_ANALYTIC = '''	float3 gamma_s_inv = float3(1.0)/gamma_impl(s, beta);
+	for(int i = -1; i <= 1; ++i)
+	{
+		float3 dist0 = float3(float(i) + ph - 0.5);
+		float3 dist1 = dist0 + float3(params.SourceSize.w);
+		sum += erf(dist1*denom_inv) - erf(dist0*denom_inv);
+		sum += sign(dist1) * normalized_ligamma_impl(s,
+			pow(abs(dist1)*alpha_inv, beta), beta, gamma_s_inv);
+		sum -= sign(dist0) * normalized_ligamma_impl(s,
+			pow(abs(dist0)*alpha_inv, beta), beta, gamma_s_inv);
+	}
+'''
+
+_BENCH_LUT = '''	for(int i = -1; i <= 1; ++i)
+	{
+		float3 dist0 = float3(float(i) + ph - 0.5);
+		float3 dist1 = dist0 + float3(params.SourceSize.w);
+		sum += erf_lut(special_functions_lut, dist1*denom_inv) -
+			erf_lut(special_functions_lut, dist0*denom_inv);
+		sum += sign(dist1) * normalized_ligamma_lut(special_functions_lut, s,
+			pow(abs(dist1)*alpha_inv, beta));
+		sum -= sign(dist0) * normalized_ligamma_lut(special_functions_lut, s,
+			pow(abs(dist0)*alpha_inv, beta));
+	}
+'''
+
+_BENCH = '''#version 450
+
+layout(push_constant) uniform Push
+{
+	vec4 SourceSize;
+	vec4 OriginalSize;
+	vec4 OutputSize;
+	uint FrameCount;
+} params;
+
+layout(std140, set = 0, binding = 0) uniform UBO
+{
+	mat4 MVP;
+} global;
+
+//  Generated by tools/slang-speclut.py presets: special-functions.h's share
+//  of crt-royale's scanline pass, with the analytic functions or the lookup
+//  texture.
+#include "$include/compat_macros.inc"
+
+#pragma stage vertex
+layout(location = 0) in vec4 Position;
+layout(location = 1) in vec2 TexCoord;
+layout(location = 0) out vec2 vTexCoord;
+
+void main()
+{
+	gl_Position = global.MVP * Position;
+	vTexCoord = TexCoord;
+}
+
+#pragma stage fragment
+layout(location = 0) in vec2 vTexCoord;
+layout(location = 0) out vec4 FragColor;
+layout(set = 0, binding = 2) uniform sampler2D Source;
+$sampler
+#include "$include/special-functions.h"
+
+void main()
+{
+	float3 color = texture(Source, vTexCoord).rgb;
+	//  Beam shapes from 2 to 6 and sigmas from 0.3 to 0.5, by brightness:
+	float3 beta = float3(2.0) + 4.0*color;
+	float3 s = float3(1.0)/beta;
+	float3 alpha_inv = float3(1.0)/(float3(0.3) + 0.2*color);
+	float3 denom_inv = alpha_inv * 0.70710678;
+	float ph = fract(vTexCoord.y * params.SourceSize.y);
+	float3 sum = float3(0.0);
+$loop	FragColor = float4(0.25 * sum, 1.0);
+}
+'''
@@ -0,0 +1,199 @@
+"""Minimal SPIR-V reflection.
+
+Only the subset the filter chain needs is understood: the UBO and push
+constant block layouts, sampler bindings, and which of those resources a stage
+actually touches.  This is the information RetroArch otherwise recovers with
+SPIRV-Cross every time a preset is loaded.
+"""
+
+import struct
+
+MAGIC = 0x07230203
+
+OP_NAME = 5
+OP_MEMBER_NAME = 6
+OP_TYPE_INT = 21
+OP_TYPE_FLOAT = 22
+OP_TYPE_VECTOR = 23
+OP_TYPE_MATRIX = 24
+OP_TYPE_SAMPLED_IMAGE = 27
+OP_TYPE_ARRAY = 28
+OP_TYPE_STRUCT = 30
+OP_TYPE_POINTER = 32
+OP_CONSTANT = 43
+OP_VARIABLE = 59
+OP_LOAD = 61
+OP_ACCESS_CHAIN = 65
+OP_IN_BOUNDS_ACCESS_CHAIN = 66
+OP_DECORATE = 71
+OP_MEMBER_DECORATE = 72
+
+DEC_BLOCK = 2
+DEC_ARRAY_STRIDE = 6
+DEC_MATRIX_STRIDE = 7
+DEC_BINDING = 33
+DEC_DESCRIPTOR_SET = 34
+DEC_OFFSET = 35
+
+SC_UNIFORM_CONSTANT = 0
+SC_UNIFORM = 2
+SC_PUSH_CONSTANT = 9
+
+
+class SpirvError(Exception):
+    pass
+
+
+def _string(words):
+    data = struct.pack("<%dI" % len(words), *words)
+    return data.split(b"\0", 1)[0].decode("utf-8", "replace")
+
+
+class Module(object):
+    def __init__(self, code):
+        if len(code) % 4 or len(code) < 20:
+            raise SpirvError("truncated module")
+        words = struct.unpack("<%dI" % (len(code) // 4), code)
+        if words[0] != MAGIC:
+            raise SpirvError("bad magic number")
+        self.names = {}
+        self.member_names = {}
+        self.decorations = {}
+        self.member_decorations = {}
+        self.types = {}
+        self.constants = {}
+        self.variables = {}
+        self.loaded = set()
+        self.accessed_members = {}
+
+        i = 5
+        while i < len(words):
+            count, op = words[i] >> 16, words[i] & 0xffff
+            if count == 0:
+                raise SpirvError("invalid instruction at word %d" % i)
+            ops = words[i + 1:i + count]
+            i += count
+            if op == OP_NAME:
+                self.names[ops[0]] = _string(ops[1:])
+            elif op == OP_MEMBER_NAME:
+                self.member_names[(ops[0], ops[1])] = _string(ops[2:])
+            elif op == OP_DECORATE:
+                self.decorations.setdefault(ops[0], {})[ops[1]] = ops[2:]
+            elif op == OP_MEMBER_DECORATE:
+                self.member_decorations.setdefault((ops[0], ops[1]), {})[ops[2]] = ops[3:]
+            elif op == OP_TYPE_INT:
+                self.types[ops[0]] = ("int", ops[1], ops[2])
+            elif op == OP_TYPE_FLOAT:
+                self.types[ops[0]] = ("float", ops[1])
+            elif op == OP_TYPE_VECTOR:
+                self.types[ops[0]] = ("vector", ops[1], ops[2])
+            elif op == OP_TYPE_MATRIX:
+                self.types[ops[0]] = ("matrix", ops[1], ops[2])
+            elif op == OP_TYPE_SAMPLED_IMAGE:
+                self.types[ops[0]] = ("sampled_image",)
+            elif op == OP_TYPE_ARRAY:
+                self.types[ops[0]] = ("array", ops[1], ops[2])
+            elif op == OP_TYPE_STRUCT:
+                self.types[ops[0]] = ("struct",) + tuple(ops[1:])
+            elif op == OP_TYPE_POINTER:
+                self.types[ops[0]] = ("pointer", ops[1], ops[2])
+            elif op == OP_CONSTANT:
+                self.constants[ops[1]] = ops[2] if len(ops) > 2 else 0
+            elif op == OP_VARIABLE:
+                self.variables[ops[1]] = (ops[0], ops[2])
+            elif op == OP_LOAD:
+                self.loaded.add(ops[2])
+            elif op in (OP_ACCESS_CHAIN, OP_IN_BOUNDS_ACCESS_CHAIN):
+                if len(ops) > 3 and ops[3] in self.constants:
+                    self.accessed_members.setdefault(ops[2], set()).add(
+                        self.constants[ops[3]])
+
+    def size_of(self, type_id, parent=None, member=None):
+        t = self.types.get(type_id)
+        if t is None:
+            raise SpirvError("unknown type %d" % type_id)
+        if t[0] in ("int", "float"):
+            return t[1] // 8
+        if t[0] == "vector":
+            return self.size_of(t[1]) * t[2]
+        if t[0] == "matrix":
+            stride = self.member_decorations.get((parent, member), {}).get(
+                DEC_MATRIX_STRIDE, [self.size_of(t[1])])[0]
+            return stride * t[2]
+        if t[0] == "array":
+            stride = self.decorations.get(type_id, {}).get(DEC_ARRAY_STRIDE)
+            length = self.constants.get(t[2], 0)
+            if stride:
+                return stride[0] * length
+            return self.size_of(t[1]) * length
+        if t[0] == "struct":
+            size = 0
+            for m, mt in enumerate(t[1:]):
+                offset = self.member_decorations.get((type_id, m), {}).get(DEC_OFFSET, [0])[0]
+                size = max(size, offset + self.size_of(mt, type_id, m))
+            return size
+        raise SpirvError("type %d has no size" % type_id)
+
+    def type_name(self, type_id):
+        t = self.types[type_id]
+        if t[0] == "float":
+            return "float"
+        if t[0] == "int":
+            return "int" if t[2] else "uint"
+        if t[0] == "vector":
+            base = self.type_name(t[1])
+            prefix = {"float": "", "int": "i", "uint": "u"}.get(base, "")
+            return "%svec%d" % (prefix, t[2])
+        if t[0] == "matrix":
+            return "mat%d" % t[2]
+        if t[0] == "array":
+            return "%s[%d]" % (self.type_name(t[1]), self.constants.get(t[2], 0))
+        return t[0]
+
+
+def reflect(code):
+    """Returns the resources used by one stage as plain data.
+
+    {"ubo": block or None, "push_constant": block or None, "textures": [...]}
+    where a block is {"name", "binding", "size", "members": [{"name", "offset",
+    "size", "type", "used"}]} and a texture is {"name", "binding", "used"}.
+    """
+    mod = Module(code)
+    result = {"ubo": None, "push_constant": None, "textures": []}
+    for var, (ptr, storage) in sorted(mod.variables.items()):
+        pointee = mod.types.get(ptr, (None, None, None))[2]
+        dec = mod.decorations.get(var, {})
+        if storage in (SC_UNIFORM, SC_PUSH_CONSTANT):
+            t = mod.types.get(pointee)
+            if not t or t[0] != "struct":
+                continue
+            used = mod.accessed_members.get(var, set())
+            whole = var in mod.loaded
+            members = []
+            for m, mt in enumerate(t[1:]):
+                members.append({
+                    "name": mod.member_names.get((pointee, m), "_m%d" % m),
+                    "offset": mod.member_decorations.get((pointee, m), {}).get(DEC_OFFSET, [0])[0],
+                    "size": mod.size_of(mt, pointee, m),
+                    "type": mod.type_name(mt),
+                    "used": whole or m in used,
+                })
+            block = {
+                "name": mod.names.get(var, ""),
+                "binding": dec.get(DEC_BINDING, [None])[0],
+                "size": mod.size_of(pointee),
+                "members": members,
+            }
+            key = "ubo" if storage == SC_UNIFORM else "push_constant"
+            if result[key] is not None:
+                raise SpirvError("more than one %s block" % key)
+            result[key] = block
+        elif storage == SC_UNIFORM_CONSTANT:
+            if mod.types.get(pointee, (None,))[0] != "sampled_image":
+                continue
+            result["textures"].append({
+                "name": mod.names.get(var, ""),
+                "binding": dec.get(DEC_BINDING, [None])[0],
+                "used": var in mod.loaded,
+            })
+    return result
@@ -0,0 +1,638 @@
+"""ctypes bindings for the part of Vulkan 1.0 the filter chain host uses.
+
+Only what slangtools/host.py needs is declared: one graphics queue, images,
+buffers, samplers, single subpass render passes, graphics pipelines,
+descriptor sets, push constants and timestamp queries.  The loader is found as
+libvulkan.so.1 (or $SLANG_VULKAN_LIBRARY); the ICD is whatever the loader
+picks, which slangtools/runner.py pins to lavapipe.
+"""
+
+import ctypes
+import os
+from ctypes import (POINTER, Structure, Union, byref, c_char, c_char_p, c_float,
+                    c_int32, c_size_t, c_uint8, c_uint32, c_uint64, c_void_p)
+
+LIBRARY = os.environ.get("SLANG_VULKAN_LIBRARY", "libvulkan.so.1")
+
+
+class VulkanError(Exception):
+    pass
+
+
+# Dispatchable handles are pointers, the others 64 bit integers.
+Instance = PhysicalDevice = Device = Queue = CommandBuffer = c_void_p
+Handle = c_uint64
+Flags = c_uint32
+Bool32 = c_uint32
+DeviceSize = c_uint64
+
+API_VERSION_1_0 = 1 << 22
+NULL_HANDLE = 0
+QUEUE_FAMILY_IGNORED = 0xffffffff
+WHOLE_SIZE = 0xffffffffffffffff
+
+# VkStructureType
+ST_APPLICATION_INFO = 0
+ST_INSTANCE_CREATE_INFO = 1
+ST_DEVICE_QUEUE_CREATE_INFO = 2
+ST_DEVICE_CREATE_INFO = 3
+ST_SUBMIT_INFO = 4
+ST_MEMORY_ALLOCATE_INFO = 5
+ST_FENCE_CREATE_INFO = 8
+ST_QUERY_POOL_CREATE_INFO = 11
+ST_BUFFER_CREATE_INFO = 12
+ST_IMAGE_CREATE_INFO = 14
+ST_IMAGE_VIEW_CREATE_INFO = 15
+ST_SHADER_MODULE_CREATE_INFO = 16
+ST_PIPELINE_SHADER_STAGE_CREATE_INFO = 18
+ST_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO = 19
+ST_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO = 20
+ST_PIPELINE_VIEWPORT_STATE_CREATE_INFO = 22
+ST_PIPELINE_RASTERIZATION_STATE_CREATE_INFO = 23
+ST_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO = 24
+ST_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO = 26
+ST_PIPELINE_DYNAMIC_STATE_CREATE_INFO = 27
+ST_GRAPHICS_PIPELINE_CREATE_INFO = 28
+ST_PIPELINE_LAYOUT_CREATE_INFO = 30
+ST_SAMPLER_CREATE_INFO = 31
+ST_DESCRIPTOR_SET_LAYOUT_CREATE_INFO = 32
+ST_DESCRIPTOR_POOL_CREATE_INFO = 33
+ST_DESCRIPTOR_SET_ALLOCATE_INFO = 34
+ST_WRITE_DESCRIPTOR_SET = 35
+ST_FRAMEBUFFER_CREATE_INFO = 37
+ST_RENDER_PASS_CREATE_INFO = 38
+ST_COMMAND_POOL_CREATE_INFO = 39
+ST_COMMAND_BUFFER_ALLOCATE_INFO = 40
+ST_COMMAND_BUFFER_BEGIN_INFO = 42
+ST_RENDER_PASS_BEGIN_INFO = 43
+ST_IMAGE_MEMORY_BARRIER = 45
+ST_MEMORY_BARRIER = 46
+
+# VkFormat, for the formats #pragma format allows and the vertex attributes.
+FORMATS = {
+    "R8_UNORM": 9, "R8_UINT": 13, "R8_SINT": 14,
+    "R8G8_UNORM": 16, "R8G8_UINT": 20, "R8G8_SINT": 21,
+    "R8G8B8A8_UNORM": 37, "R8G8B8A8_UINT": 41, "R8G8B8A8_SINT": 42,
+    "R8G8B8A8_SRGB": 43,
+    "A2B10G10R10_UNORM_PACK32": 64, "A2B10G10R10_UINT_PACK32": 68,
+    "R16_UINT": 74, "R16_SINT": 75, "R16_SFLOAT": 76,
+    "R16G16_UINT": 81, "R16G16_SINT": 82, "R16G16_SFLOAT": 83,
+    "R16G16B16A16_UINT": 95, "R16G16B16A16_SINT": 96, "R16G16B16A16_SFLOAT": 97,
+    "R32_UINT": 98, "R32_SINT": 99, "R32_SFLOAT": 100,
+    "R32G32_UINT": 101, "R32G32_SINT": 102, "R32G32_SFLOAT": 103,
+    "R32G32B32A32_UINT": 107, "R32G32B32A32_SINT": 108, "R32G32B32A32_SFLOAT": 109,
+}
+
+IMAGE_LAYOUT_UNDEFINED = 0
+IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL = 2
+IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL = 5
+IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL = 6
+IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL = 7
+
+IMAGE_USAGE_TRANSFER_SRC = 0x1
+IMAGE_USAGE_TRANSFER_DST = 0x2
+IMAGE_USAGE_SAMPLED = 0x4
+IMAGE_USAGE_COLOR_ATTACHMENT = 0x10
+
+BUFFER_USAGE_TRANSFER_SRC = 0x1
+BUFFER_USAGE_TRANSFER_DST = 0x2
+BUFFER_USAGE_UNIFORM_BUFFER = 0x10
+BUFFER_USAGE_VERTEX_BUFFER = 0x80
+
+MEMORY_PROPERTY_DEVICE_LOCAL = 0x1
+MEMORY_PROPERTY_HOST_VISIBLE = 0x2
+MEMORY_PROPERTY_HOST_COHERENT = 0x4
+
+FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR = 0x1000
+FORMAT_FEATURE_BLIT_SRC = 0x400
+FORMAT_FEATURE_BLIT_DST = 0x800
+
+DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER = 1
+DESCRIPTOR_TYPE_UNIFORM_BUFFER = 6
+
+SHADER_STAGE_VERTEX = 0x1
+SHADER_STAGE_FRAGMENT = 0x10
+
+PIPELINE_STAGE_TOP_OF_PIPE = 0x1
+PIPELINE_STAGE_TRANSFER = 0x1000
+PIPELINE_STAGE_BOTTOM_OF_PIPE = 0x2000
+PIPELINE_STAGE_ALL_COMMANDS = 0x10000
+
+ACCESS_SHADER_READ = 0x20
+ACCESS_COLOR_ATTACHMENT_WRITE = 0x100
+ACCESS_TRANSFER_READ = 0x800
+ACCESS_TRANSFER_WRITE = 0x1000
+ACCESS_HOST_READ = 0x2000
+ACCESS_MEMORY_READ = 0x8000
+ACCESS_MEMORY_WRITE = 0x10000
+
+FILTER_NEAREST = 0
+FILTER_LINEAR = 1
+SAMPLER_MIPMAP_MODE_NEAREST = 0
+SAMPLER_MIPMAP_MODE_LINEAR = 1
+ADDRESS_MODES = {"repeat": 0, "mirrored_repeat": 1, "clamp_to_edge": 2,
+                 "clamp_to_border": 3}
+BORDER_COLOR_FLOAT_TRANSPARENT_BLACK = 0
+
+ATTACHMENT_LOAD_OP_CLEAR = 1
+ATTACHMENT_LOAD_OP_DONT_CARE = 2
+ATTACHMENT_STORE_OP_STORE = 0
+ATTACHMENT_STORE_OP_DONT_CARE = 1
+
+PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP = 4
+DYNAMIC_STATE_VIEWPORT = 0
+DYNAMIC_STATE_SCISSOR = 1
+PIPELINE_BIND_POINT_GRAPHICS = 0
+SUBPASS_CONTENTS_INLINE = 0
+COMMAND_BUFFER_LEVEL_PRIMARY = 0
+COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT = 0x1
+COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER = 0x2
+QUERY_TYPE_TIMESTAMP = 2
+QUERY_RESULT_64 = 0x1
+QUERY_RESULT_WAIT = 0x2
+IMAGE_ASPECT_COLOR = 0x1
+IMAGE_TYPE_2D = 1
+IMAGE_VIEW_TYPE_2D = 1
+IMAGE_TILING_OPTIMAL = 0
+QUEUE_GRAPHICS = 0x1
+VERTEX_INPUT_RATE_VERTEX = 0
+COLOR_COMPONENT_RGBA = 0xf
+SAMPLE_COUNT_1 = 0x1
+
+
+def _struct(name, fields):
+    return type(name, (Structure,), {"_fields_": fields})
+
+
+def _info(name, fields):
+    """A structure starting with sType and pNext."""
+    return _struct(name, [("sType", c_uint32), ("pNext", c_void_p)] + fields)
+
+
+Extent2D = _struct("VkExtent2D", [("width", c_uint32), ("height", c_uint32)])
+Extent3D = _struct("VkExtent3D", [("width", c_uint32), ("height", c_uint32),
+                                  ("depth", c_uint32)])
+Offset2D = _struct("VkOffset2D", [("x", c_int32), ("y", c_int32)])
+Offset3D = _struct("VkOffset3D", [("x", c_int32), ("y", c_int32), ("z", c_int32)])
+Rect2D = _struct("VkRect2D", [("offset", Offset2D), ("extent", Extent2D)])
+
+ApplicationInfo = _info("VkApplicationInfo", [
+    ("pApplicationName", c_char_p), ("applicationVersion", c_uint32),
+    ("pEngineName", c_char_p), ("engineVersion", c_uint32),
+    ("apiVersion", c_uint32)])
+InstanceCreateInfo = _info("VkInstanceCreateInfo", [
+    ("flags", Flags), ("pApplicationInfo", POINTER(ApplicationInfo)),
+    ("enabledLayerCount", c_uint32), ("ppEnabledLayerNames", c_void_p),
+    ("enabledExtensionCount", c_uint32), ("ppEnabledExtensionNames", c_void_p)])
+
+PhysicalDeviceLimits = _struct("VkPhysicalDeviceLimits", [
+    ("maxImageDimension1D", c_uint32), ("maxImageDimension2D", c_uint32),
+    ("maxImageDimension3D", c_uint32), ("maxImageDimensionCube", c_uint32),
+    ("maxImageArrayLayers", c_uint32), ("maxTexelBufferElements", c_uint32),
+    ("maxUniformBufferRange", c_uint32), ("maxStorageBufferRange", c_uint32),
+    ("maxPushConstantsSize", c_uint32), ("maxMemoryAllocationCount", c_uint32),
+    ("maxSamplerAllocationCount", c_uint32),
+    ("bufferImageGranularity", DeviceSize), ("sparseAddressSpaceSize", DeviceSize),
+    ("maxBoundDescriptorSets", c_uint32),
+    ("maxPerStageDescriptorSamplers", c_uint32),
+    ("maxPerStageDescriptorUniformBuffers", c_uint32),
+    ("maxPerStageDescriptorStorageBuffers", c_uint32),
+    ("maxPerStageDescriptorSampledImages", c_uint32),
+    ("maxPerStageDescriptorStorageImages", c_uint32),
+    ("maxPerStageDescriptorInputAttachments", c_uint32),
+    ("maxPerStageResources", c_uint32),
+    ("maxDescriptorSetSamplers", c_uint32),
+    ("maxDescriptorSetUniformBuffers", c_uint32),
+    ("maxDescriptorSetUniformBuffersDynamic", c_uint32),
+    ("maxDescriptorSetStorageBuffers", c_uint32),
+    ("maxDescriptorSetStorageBuffersDynamic", c_uint32),
+    ("maxDescriptorSetSampledImages", c_uint32),
+    ("maxDescriptorSetStorageImages", c_uint32),
+    ("maxDescriptorSetInputAttachments", c_uint32),
+    ("maxVertexInputAttributes", c_uint32), ("maxVertexInputBindings", c_uint32),
+    ("maxVertexInputAttributeOffset", c_uint32),
+    ("maxVertexInputBindingStride", c_uint32),
+    ("maxVertexOutputComponents", c_uint32),
+    ("maxTessellationGenerationLevel", c_uint32),
+    ("maxTessellationPatchSize", c_uint32),
+    ("maxTessellationControlPerVertexInputComponents", c_uint32),
+    ("maxTessellationControlPerVertexOutputComponents", c_uint32),
+    ("maxTessellationControlPerPatchOutputComponents", c_uint32),
+    ("maxTessellationControlTotalOutputComponents", c_uint32),
+    ("maxTessellationEvaluationInputComponents", c_uint32),
+    ("maxTessellationEvaluationOutputComponents", c_uint32),
+    ("maxGeometryShaderInvocations", c_uint32),
+    ("maxGeometryInputComponents", c_uint32),
+    ("maxGeometryOutputComponents", c_uint32),
+    ("maxGeometryOutputVertices", c_uint32),
+    ("maxGeometryTotalOutputComponents", c_uint32),
+    ("maxFragmentInputComponents", c_uint32),
+    ("maxFragmentOutputAttachments", c_uint32),
+    ("maxFragmentDualSrcAttachments", c_uint32),
+    ("maxFragmentCombinedOutputResources", c_uint32),
+    ("maxComputeSharedMemorySize", c_uint32),
+    ("maxComputeWorkGroupCount", c_uint32 * 3),
+    ("maxComputeWorkGroupInvocations", c_uint32),
+    ("maxComputeWorkGroupSize", c_uint32 * 3),
+    ("subPixelPrecisionBits", c_uint32), ("subTexelPrecisionBits", c_uint32),
+    ("mipmapPrecisionBits", c_uint32), ("maxDrawIndexedIndexValue", c_uint32),
+    ("maxDrawIndirectCount", c_uint32), ("maxSamplerLodBias", c_float),
+    ("maxSamplerAnisotropy", c_float), ("maxViewports", c_uint32),
+    ("maxViewportDimensions", c_uint32 * 2), ("viewportBoundsRange", c_float * 2),
+    ("viewportSubPixelBits", c_uint32), ("minMemoryMapAlignment", c_size_t),
+    ("minTexelBufferOffsetAlignment", DeviceSize),
+    ("minUniformBufferOffsetAlignment", DeviceSize),
+    ("minStorageBufferOffsetAlignment", DeviceSize),
+    ("minTexelOffset", c_int32), ("maxTexelOffset", c_uint32),
+    ("minTexelGatherOffset", c_int32), ("maxTexelGatherOffset", c_uint32),
+    ("minInterpolationOffset", c_float), ("maxInterpolationOffset", c_float),
+    ("subPixelInterpolationOffsetBits", c_uint32),
+    ("maxFramebufferWidth", c_uint32), ("maxFramebufferHeight", c_uint32),
+    ("maxFramebufferLayers", c_uint32),
+    ("framebufferColorSampleCounts", Flags),
+    ("framebufferDepthSampleCounts", Flags),
+    ("framebufferStencilSampleCounts", Flags),
+    ("framebufferNoAttachmentsSampleCounts", Flags),
+    ("maxColorAttachments", c_uint32),
+    ("sampledImageColorSampleCounts", Flags),
+    ("sampledImageIntegerSampleCounts", Flags),
+    ("sampledImageDepthSampleCounts", Flags),
+    ("sampledImageStencilSampleCounts", Flags),
+    ("storageImageSampleCounts", Flags), ("maxSampleMaskWords", c_uint32),
+    ("timestampComputeAndGraphics", Bool32), ("timestampPeriod", c_float),
+    ("maxClipDistances", c_uint32), ("maxCullDistances", c_uint32),
+    ("maxCombinedClipAndCullDistances", c_uint32),
+    ("discreteQueuePriorities", c_uint32), ("pointSizeRange", c_float * 2),
+    ("lineWidthRange", c_float * 2), ("pointSizeGranularity", c_float),
+    ("lineWidthGranularity", c_float), ("strictLines", Bool32),
+    ("standardSampleLocations", Bool32),
+    ("optimalBufferCopyOffsetAlignment", DeviceSize),
+    ("optimalBufferCopyRowPitch", DeviceSize),
+    ("nonCoherentAtomSize", DeviceSize)])
+PhysicalDeviceSparseProperties = _struct("VkPhysicalDeviceSparseProperties", [
+    ("residencyStandard2DBlockShape", Bool32),
+    ("residencyStandard2DMultisampleBlockShape", Bool32),
+    ("residencyStandard3DBlockShape", Bool32),
+    ("residencyAlignedMipSize", Bool32),
+    ("residencyNonResidentStrict", Bool32)])
+PhysicalDeviceProperties = _struct("VkPhysicalDeviceProperties", [
+    ("apiVersion", c_uint32), ("driverVersion", c_uint32),
+    ("vendorID", c_uint32), ("deviceID", c_uint32), ("deviceType", c_uint32),
+    ("deviceName", c_char * 256), ("pipelineCacheUUID", c_uint8 * 16),
+    ("limits", PhysicalDeviceLimits),
+    ("sparseProperties", PhysicalDeviceSparseProperties)])
+
+QueueFamilyProperties = _struct("VkQueueFamilyProperties", [
+    ("queueFlags", Flags), ("queueCount", c_uint32),
+    ("timestampValidBits", c_uint32),
+    ("minImageTransferGranularity", Extent3D)])
+MemoryType = _struct("VkMemoryType", [("propertyFlags", Flags), ("heapIndex", c_uint32)])
+MemoryHeap = _struct("VkMemoryHeap", [("size", DeviceSize), ("flags", Flags)])
+PhysicalDeviceMemoryProperties = _struct("VkPhysicalDeviceMemoryProperties", [
+    ("memoryTypeCount", c_uint32), ("memoryTypes", MemoryType * 32),
+    ("memoryHeapCount", c_uint32), ("memoryHeaps", MemoryHeap * 16)])
+FormatProperties = _struct("VkFormatProperties", [
+    ("linearTilingFeatures", Flags), ("optimalTilingFeatures", Flags),
+    ("bufferFeatures", Flags)])
+
+DeviceQueueCreateInfo = _info("VkDeviceQueueCreateInfo", [
+    ("flags", Flags), ("queueFamilyIndex", c_uint32), ("queueCount", c_uint32),
+    ("pQueuePriorities", POINTER(c_float))])
+DeviceCreateInfo = _info("VkDeviceCreateInfo", [
+    ("flags", Flags), ("queueCreateInfoCount", c_uint32),
+    ("pQueueCreateInfos", POINTER(DeviceQueueCreateInfo)),
+    ("enabledLayerCount", c_uint32), ("ppEnabledLayerNames", c_void_p),
+    ("enabledExtensionCount", c_uint32), ("ppEnabledExtensionNames", c_void_p),
+    ("pEnabledFeatures", c_void_p)])
+
+MemoryRequirements = _struct("VkMemoryRequirements", [
+    ("size", DeviceSize), ("alignment", DeviceSize), ("memoryTypeBits", c_uint32)])
+MemoryAllocateInfo = _info("VkMemoryAllocateInfo", [
+    ("allocationSize", DeviceSize), ("memoryTypeIndex", c_uint32)])
+BufferCreateInfo = _info("VkBufferCreateInfo", [
+    ("flags", Flags), ("size", DeviceSize), ("usage", Flags),
+    ("sharingMode", c_uint32), ("queueFamilyIndexCount", c_uint32),
+    ("pQueueFamilyIndices", c_void_p)])
+ImageCreateInfo = _info("VkImageCreateInfo", [
+    ("flags", Flags), ("imageType", c_uint32), ("format", c_uint32),
+    ("extent", Extent3D), ("mipLevels", c_uint32), ("arrayLayers", c_uint32),
+    ("samples", c_uint32), ("tiling", c_uint32), ("usage", Flags),
+    ("sharingMode", c_uint32), ("queueFamilyIndexCount", c_uint32),
+    ("pQueueFamilyIndices", c_void_p), ("initialLayout", c_uint32)])
+ComponentMapping = _struct("VkComponentMapping", [
+    ("r", c_uint32), ("g", c_uint32), ("b", c_uint32), ("a", c_uint32)])
+ImageSubresourceRange = _struct("VkImageSubresourceRange", [
+    ("aspectMask", Flags), ("baseMipLevel", c_uint32), ("levelCount", c_uint32),
+    ("baseArrayLayer", c_uint32), ("layerCount", c_uint32)])
+ImageSubresourceLayers = _struct("VkImageSubresourceLayers", [
+    ("aspectMask", Flags), ("mipLevel", c_uint32), ("baseArrayLayer", c_uint32),
+    ("layerCount", c_uint32)])
+ImageViewCreateInfo = _info("VkImageViewCreateInfo", [
+    ("flags", Flags), ("image", Handle), ("viewType", c_uint32),
+    ("format", c_uint32), ("components", ComponentMapping),
+    ("subresourceRange", ImageSubresourceRange)])
+SamplerCreateInfo = _info("VkSamplerCreateInfo", [
+    ("flags", Flags), ("magFilter", c_uint32), ("minFilter", c_uint32),
+    ("mipmapMode", c_uint32), ("addressModeU", c_uint32),
+    ("addressModeV", c_uint32), ("addressModeW", c_uint32),
+    ("mipLodBias", c_float), ("anisotropyEnable", Bool32),
+    ("maxAnisotropy", c_float), ("compareEnable", Bool32),
+    ("compareOp", c_uint32), ("minLod", c_float), ("maxLod", c_float),
+    ("borderColor", c_uint32), ("unnormalizedCoordinates", Bool32)])
+
+AttachmentDescription = _struct("VkAttachmentDescription", [
+    ("flags", Flags), ("format", c_uint32), ("samples", c_uint32),
+    ("loadOp", c_uint32), ("storeOp", c_uint32), ("stencilLoadOp", c_uint32),
+    ("stencilStoreOp", c_uint32), ("initialLayout", c_uint32),
+    ("finalLayout", c_uint32)])
+AttachmentReference = _struct("VkAttachmentReference", [
+    ("attachment", c_uint32), ("layout", c_uint32)])
+SubpassDescription = _struct("VkSubpassDescription", [
+    ("flags", Flags), ("pipelineBindPoint", c_uint32),
+    ("inputAttachmentCount", c_uint32), ("pInputAttachments", c_void_p),
+    ("colorAttachmentCount", c_uint32),
+    ("pColorAttachments", POINTER(AttachmentReference)),
+    ("pResolveAttachments", c_void_p), ("pDepthStencilAttachment", c_void_p),
+    ("preserveAttachmentCount", c_uint32), ("pPreserveAttachments", c_void_p)])
+RenderPassCreateInfo = _info("VkRenderPassCreateInfo", [
+    ("flags", Flags), ("attachmentCount", c_uint32),
+    ("pAttachments", POINTER(AttachmentDescription)),
+    ("subpassCount", c_uint32), ("pSubpasses", POINTER(SubpassDescription)),
+    ("dependencyCount", c_uint32), ("pDependencies", c_void_p)])
+FramebufferCreateInfo = _info("VkFramebufferCreateInfo", [
+    ("flags", Flags), ("renderPass", Handle), ("attachmentCount", c_uint32),
+    ("pAttachments", POINTER(Handle)), ("width", c_uint32),
+    ("height", c_uint32), ("layers", c_uint32)])
+
+ShaderModuleCreateInfo = _info("VkShaderModuleCreateInfo", [
+    ("flags", Flags), ("codeSize", c_size_t), ("pCode", c_void_p)])
+DescriptorSetLayoutBinding = _struct("VkDescriptorSetLayoutBinding", [
+    ("binding", c_uint32), ("descriptorType", c_uint32),
+    ("descriptorCount", c_uint32), ("stageFlags", Flags),
+    ("pImmutableSamplers", c_void_p)])
+DescriptorSetLayoutCreateInfo = _info("VkDescriptorSetLayoutCreateInfo", [
+    ("flags", Flags), ("bindingCount", c_uint32),
+    ("pBindings", POINTER(DescriptorSetLayoutBinding))])
+PushConstantRange = _struct("VkPushConstantRange", [
+    ("stageFlags", Flags), ("offset", c_uint32), ("size", c_uint32)])
+PipelineLayoutCreateInfo = _info("VkPipelineLayoutCreateInfo", [
+    ("flags", Flags), ("setLayoutCount", c_uint32),
+    ("pSetLayouts", POINTER(Handle)), ("pushConstantRangeCount", c_uint32),
+    ("pPushConstantRanges", POINTER(PushConstantRange))])
+
+PipelineShaderStageCreateInfo = _info("VkPipelineShaderStageCreateInfo", [
+    ("flags", Flags), ("stage", c_uint32), ("module", Handle),
+    ("pName", c_char_p), ("pSpecializationInfo", c_void_p)])
+VertexInputBindingDescription = _struct("VkVertexInputBindingDescription", [
+    ("binding", c_uint32), ("stride", c_uint32), ("inputRate", c_uint32)])
+VertexInputAttributeDescription = _struct("VkVertexInputAttributeDescription", [
+    ("location", c_uint32), ("binding", c_uint32), ("format", c_uint32),
+    ("offset", c_uint32)])
+PipelineVertexInputStateCreateInfo = _info("VkPipelineVertexInputStateCreateInfo", [
+    ("flags", Flags), ("vertexBindingDescriptionCount", c_uint32),
+    ("pVertexBindingDescriptions", POINTER(VertexInputBindingDescription)),
+    ("vertexAttributeDescriptionCount", c_uint32),
+    ("pVertexAttributeDescriptions", POINTER(VertexInputAttributeDescription))])
+PipelineInputAssemblyStateCreateInfo = _info("VkPipelineInputAssemblyStateCreateInfo", [
+    ("flags", Flags), ("topology", c_uint32), ("primitiveRestartEnable", Bool32)])
+Viewport = _struct("VkViewport", [
+    ("x", c_float), ("y", c_float), ("width", c_float), ("height", c_float),
+    ("minDepth", c_float), ("maxDepth", c_float)])
+PipelineViewportStateCreateInfo = _info("VkPipelineViewportStateCreateInfo", [
+    ("flags", Flags), ("viewportCount", c_uint32), ("pViewports", c_void_p),
+    ("scissorCount", c_uint32), ("pScissors", c_void_p)])
+PipelineRasterizationStateCreateInfo = _info("VkPipelineRasterizationStateCreateInfo", [
+    ("flags", Flags), ("depthClampEnable", Bool32),
+    ("rasterizerDiscardEnable", Bool32), ("polygonMode", c_uint32),
+    ("cullMode", Flags), ("frontFace", c_uint32), ("depthBiasEnable", Bool32),
+    ("depthBiasConstantFactor", c_float), ("depthBiasClamp", c_float),
+    ("depthBiasSlopeFactor", c_float), ("lineWidth", c_float)])
+PipelineMultisampleStateCreateInfo = _info("VkPipelineMultisampleStateCreateInfo", [
+    ("flags", Flags), ("rasterizationSamples", c_uint32),
+    ("sampleShadingEnable", Bool32), ("minSampleShading", c_float),
+    ("pSampleMask", c_void_p), ("alphaToCoverageEnable", Bool32),
+    ("alphaToOneEnable", Bool32)])
+PipelineColorBlendAttachmentState = _struct("VkPipelineColorBlendAttachmentState", [
+    ("blendEnable", Bool32), ("srcColorBlendFactor", c_uint32),
+    ("dstColorBlendFactor", c_uint32), ("colorBlendOp", c_uint32),
+    ("srcAlphaBlendFactor", c_uint32), ("dstAlphaBlendFactor", c_uint32),
+    ("alphaBlendOp", c_uint32), ("colorWriteMask", Flags)])
+PipelineColorBlendStateCreateInfo = _info("VkPipelineColorBlendStateCreateInfo", [
+    ("flags", Flags), ("logicOpEnable", Bool32), ("logicOp", c_uint32),
+    ("attachmentCount", c_uint32),
+    ("pAttachments", POINTER(PipelineColorBlendAttachmentState)),
+    ("blendConstants", c_float * 4)])
+PipelineDynamicStateCreateInfo = _info("VkPipelineDynamicStateCreateInfo", [
+    ("flags", Flags), ("dynamicStateCount", c_uint32),
+    ("pDynamicStates", POINTER(c_uint32))])
+GraphicsPipelineCreateInfo = _info("VkGraphicsPipelineCreateInfo", [
+    ("flags", Flags), ("stageCount", c_uint32),
+    ("pStages", POINTER(PipelineShaderStageCreateInfo)),
+    ("pVertexInputState", POINTER(PipelineVertexInputStateCreateInfo)),
+    ("pInputAssemblyState", POINTER(PipelineInputAssemblyStateCreateInfo)),
+    ("pTessellationState", c_void_p),
+    ("pViewportState", POINTER(PipelineViewportStateCreateInfo)),
+    ("pRasterizationState", POINTER(PipelineRasterizationStateCreateInfo)),
+    ("pMultisampleState", POINTER(PipelineMultisampleStateCreateInfo)),
+    ("pDepthStencilState", c_void_p),
+    ("pColorBlendState", POINTER(PipelineColorBlendStateCreateInfo)),
+    ("pDynamicState", POINTER(PipelineDynamicStateCreateInfo)),
+    ("layout", Handle), ("renderPass", Handle), ("subpass", c_uint32),
+    ("basePipelineHandle", Handle), ("basePipelineIndex", c_int32)])
+
+DescriptorPoolSize = _struct("VkDescriptorPoolSize", [
+    ("type", c_uint32), ("descriptorCount", c_uint32)])
+DescriptorPoolCreateInfo = _info("VkDescriptorPoolCreateInfo", [
+    ("flags", Flags), ("maxSets", c_uint32), ("poolSizeCount", c_uint32),
+    ("pPoolSizes", POINTER(DescriptorPoolSize))])
+DescriptorSetAllocateInfo = _info("VkDescriptorSetAllocateInfo", [
+    ("descriptorPool", Handle), ("descriptorSetCount", c_uint32),
+    ("pSetLayouts", POINTER(Handle))])
+DescriptorImageInfo = _struct("VkDescriptorImageInfo", [
+    ("sampler", Handle), ("imageView", Handle), ("imageLayout", c_uint32)])
+DescriptorBufferInfo = _struct("VkDescriptorBufferInfo", [
+    ("buffer", Handle), ("offset", DeviceSize), ("range", DeviceSize)])
+WriteDescriptorSet = _info("VkWriteDescriptorSet", [
+    ("dstSet", Handle), ("dstBinding", c_uint32), ("dstArrayElement", c_uint32),
+    ("descriptorCount", c_uint32), ("descriptorType", c_uint32),
+    ("pImageInfo", POINTER(DescriptorImageInfo)),
+    ("pBufferInfo", POINTER(DescriptorBufferInfo)),
+    ("pTexelBufferView", c_void_p)])
+
+CommandPoolCreateInfo = _info("VkCommandPoolCreateInfo", [
+    ("flags", Flags), ("queueFamilyIndex", c_uint32)])
+CommandBufferAllocateInfo = _info("VkCommandBufferAllocateInfo", [
+    ("commandPool", Handle), ("level", c_uint32), ("commandBufferCount", c_uint32)])
+CommandBufferBeginInfo = _info("VkCommandBufferBeginInfo", [
+    ("flags", Flags), ("pInheritanceInfo", c_void_p)])
+
+
+class ClearColorValue(Union):
+    _fields_ = [("float32", c_float * 4), ("int32", c_int32 * 4),
+                ("uint32", c_uint32 * 4)]
+
+
+RenderPassBeginInfo = _info("VkRenderPassBeginInfo", [
+    ("renderPass", Handle), ("framebuffer", Handle), ("renderArea", Rect2D),
+    ("clearValueCount", c_uint32), ("pClearValues", POINTER(ClearColorValue))])
+MemoryBarrier = _info("VkMemoryBarrier", [
+    ("srcAccessMask", Flags), ("dstAccessMask", Flags)])
+ImageMemoryBarrier = _info("VkImageMemoryBarrier", [
+    ("srcAccessMask", Flags), ("dstAccessMask", Flags), ("oldLayout", c_uint32),
+    ("newLayout", c_uint32), ("srcQueueFamilyIndex", c_uint32),
+    ("dstQueueFamilyIndex", c_uint32), ("image", Handle),
+    ("subresourceRange", ImageSubresourceRange)])
+BufferImageCopy = _struct("VkBufferImageCopy", [
+    ("bufferOffset", DeviceSize), ("bufferRowLength", c_uint32),
+    ("bufferImageHeight", c_uint32), ("imageSubresource", ImageSubresourceLayers),
+    ("imageOffset", Offset3D), ("imageExtent", Extent3D)])
+ImageBlit = _struct("VkImageBlit", [
+    ("srcSubresource", ImageSubresourceLayers), ("srcOffsets", Offset3D * 2),
+    ("dstSubresource", ImageSubresourceLayers), ("dstOffsets", Offset3D * 2)])
+SubmitInfo = _info("VkSubmitInfo", [
+    ("waitSemaphoreCount", c_uint32), ("pWaitSemaphores", c_void_p),
+    ("pWaitDstStageMask", c_void_p), ("commandBufferCount", c_uint32),
+    ("pCommandBuffers", POINTER(CommandBuffer)),
+    ("signalSemaphoreCount", c_uint32), ("pSignalSemaphores", c_void_p)])
+FenceCreateInfo = _info("VkFenceCreateInfo", [("flags", Flags)])
+QueryPoolCreateInfo = _info("VkQueryPoolCreateInfo", [
+    ("flags", Flags), ("queryType", c_uint32), ("queryCount", c_uint32),
+    ("pipelineStatistics", Flags)])
+
+
+_P = POINTER
+# name: (returns a VkResult, argtypes)
+_FUNCTIONS = {
+    "vkCreateInstance": (True, [_P(InstanceCreateInfo), c_void_p, _P(Instance)]),
+    "vkDestroyInstance": (False, [Instance, c_void_p]),
+    "vkEnumeratePhysicalDevices": (True, [Instance, _P(c_uint32), _P(PhysicalDevice)]),
+    "vkGetPhysicalDeviceProperties": (False, [PhysicalDevice, _P(PhysicalDeviceProperties)]),
+    "vkGetPhysicalDeviceQueueFamilyProperties":
+        (False, [PhysicalDevice, _P(c_uint32), _P(QueueFamilyProperties)]),
+    "vkGetPhysicalDeviceMemoryProperties":
+        (False, [PhysicalDevice, _P(PhysicalDeviceMemoryProperties)]),
+    "vkGetPhysicalDeviceFormatProperties":
+        (False, [PhysicalDevice, c_uint32, _P(FormatProperties)]),
+    "vkCreateDevice": (True, [PhysicalDevice, _P(DeviceCreateInfo), c_void_p, _P(Device)]),
+    "vkDestroyDevice": (False, [Device, c_void_p]),
+    "vkGetDeviceQueue": (False, [Device, c_uint32, c_uint32, _P(Queue)]),
+    "vkDeviceWaitIdle": (True, [Device]),
+    "vkAllocateMemory": (True, [Device, _P(MemoryAllocateInfo), c_void_p, _P(Handle)]),
+    "vkFreeMemory": (False, [Device, Handle, c_void_p]),
+    "vkMapMemory": (True, [Device, Handle, DeviceSize, DeviceSize, Flags, _P(c_void_p)]),
+    "vkUnmapMemory": (False, [Device, Handle]),
+    "vkCreateBuffer": (True, [Device, _P(BufferCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyBuffer": (False, [Device, Handle, c_void_p]),
+    "vkGetBufferMemoryRequirements": (False, [Device, Handle, _P(MemoryRequirements)]),
+    "vkBindBufferMemory": (True, [Device, Handle, Handle, DeviceSize]),
+    "vkCreateImage": (True, [Device, _P(ImageCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyImage": (False, [Device, Handle, c_void_p]),
+    "vkGetImageMemoryRequirements": (False, [Device, Handle, _P(MemoryRequirements)]),
+    "vkBindImageMemory": (True, [Device, Handle, Handle, DeviceSize]),
+    "vkCreateImageView": (True, [Device, _P(ImageViewCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyImageView": (False, [Device, Handle, c_void_p]),
+    "vkCreateSampler": (True, [Device, _P(SamplerCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroySampler": (False, [Device, Handle, c_void_p]),
+    "vkCreateRenderPass": (True, [Device, _P(RenderPassCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyRenderPass": (False, [Device, Handle, c_void_p]),
+    "vkCreateFramebuffer": (True, [Device, _P(FramebufferCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyFramebuffer": (False, [Device, Handle, c_void_p]),
+    "vkCreateShaderModule": (True, [Device, _P(ShaderModuleCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyShaderModule": (False, [Device, Handle, c_void_p]),
+    "vkCreateDescriptorSetLayout":
+        (True, [Device, _P(DescriptorSetLayoutCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyDescriptorSetLayout": (False, [Device, Handle, c_void_p]),
+    "vkCreatePipelineLayout": (True, [Device, _P(PipelineLayoutCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyPipelineLayout": (False, [Device, Handle, c_void_p]),
+    "vkCreateGraphicsPipelines": (True, [Device, Handle, c_uint32,
+                                         _P(GraphicsPipelineCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyPipeline": (False, [Device, Handle, c_void_p]),
+    "vkCreateDescriptorPool": (True, [Device, _P(DescriptorPoolCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyDescriptorPool": (False, [Device, Handle, c_void_p]),
+    "vkAllocateDescriptorSets": (True, [Device, _P(DescriptorSetAllocateInfo), _P(Handle)]),
+    "vkUpdateDescriptorSets": (False, [Device, c_uint32, _P(WriteDescriptorSet),
+                                       c_uint32, c_void_p]),
+    "vkCreateCommandPool": (True, [Device, _P(CommandPoolCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyCommandPool": (False, [Device, Handle, c_void_p]),
+    "vkAllocateCommandBuffers": (True, [Device, _P(CommandBufferAllocateInfo), _P(CommandBuffer)]),
+    "vkBeginCommandBuffer": (True, [CommandBuffer, _P(CommandBufferBeginInfo)]),
+    "vkEndCommandBuffer": (True, [CommandBuffer]),
+    "vkResetCommandBuffer": (True, [CommandBuffer, Flags]),
+    "vkCreateFence": (True, [Device, _P(FenceCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyFence": (False, [Device, Handle, c_void_p]),
+    "vkWaitForFences": (True, [Device, c_uint32, _P(Handle), Bool32, c_uint64]),
+    "vkResetFences": (True, [Device, c_uint32, _P(Handle)]),
+    "vkQueueSubmit": (True, [Queue, c_uint32, _P(SubmitInfo), Handle]),
+    "vkCreateQueryPool": (True, [Device, _P(QueryPoolCreateInfo), c_void_p, _P(Handle)]),
+    "vkDestroyQueryPool": (False, [Device, Handle, c_void_p]),
+    "vkGetQueryPoolResults": (True, [Device, Handle, c_uint32, c_uint32, c_size_t,
+                                     c_void_p, DeviceSize, Flags]),
+    "vkCmdPipelineBarrier": (False, [CommandBuffer, Flags, Flags, Flags,
+                                     c_uint32, _P(MemoryBarrier), c_uint32, c_void_p,
+                                     c_uint32, _P(ImageMemoryBarrier)]),
+    "vkCmdBeginRenderPass": (False, [CommandBuffer, _P(RenderPassBeginInfo), c_uint32]),
+    "vkCmdEndRenderPass": (False, [CommandBuffer]),
+    "vkCmdBindPipeline": (False, [CommandBuffer, c_uint32, Handle]),
+    "vkCmdBindDescriptorSets": (False, [CommandBuffer, c_uint32, Handle, c_uint32,
+                                        c_uint32, _P(Handle), c_uint32, c_void_p]),
+    "vkCmdPushConstants": (False, [CommandBuffer, Handle, Flags, c_uint32, c_uint32,
+                                   c_void_p]),
+    "vkCmdBindVertexBuffers": (False, [CommandBuffer, c_uint32, c_uint32, _P(Handle),
+                                       _P(DeviceSize)]),
+    "vkCmdDraw": (False, [CommandBuffer, c_uint32, c_uint32, c_uint32, c_uint32]),
+    "vkCmdSetViewport": (False, [CommandBuffer, c_uint32, c_uint32, _P(Viewport)]),
+    "vkCmdSetScissor": (False, [CommandBuffer, c_uint32, c_uint32, _P(Rect2D)]),
+    "vkCmdCopyBufferToImage": (False, [CommandBuffer, Handle, Handle, c_uint32,
+                                       c_uint32, _P(BufferImageCopy)]),
+    "vkCmdCopyImageToBuffer": (False, [CommandBuffer, Handle, c_uint32, Handle,
+                                       c_uint32, _P(BufferImageCopy)]),
+    "vkCmdBlitImage": (False, [CommandBuffer, Handle, c_uint32, Handle, c_uint32,
+                               c_uint32, _P(ImageBlit), c_uint32]),
+    "vkCmdClearColorImage": (False, [CommandBuffer, Handle, c_uint32,
+                                     _P(ClearColorValue), c_uint32,
+                                     _P(ImageSubresourceRange)]),
+    "vkCmdResetQueryPool": (False, [CommandBuffer, Handle, c_uint32, c_uint32]),
+    "vkCmdWriteTimestamp": (False, [CommandBuffer, c_uint32, Handle, c_uint32]),
+}
+
+
+class Library(object):
+    """The loader's entry points, as attributes without the vk prefix.
+
+    Functions returning a VkResult raise VulkanError on failure.
+    """
+
+    def __init__(self, path=LIBRARY):
+        try:
+            self._lib = ctypes.CDLL(path)
+        except OSError as e:
+            raise VulkanError("cannot load the Vulkan loader %s: %s" % (path, e))
+        for name, (checked, argtypes) in _FUNCTIONS.items():
+            fn = getattr(self._lib, name)
+            fn.argtypes = argtypes
+            fn.restype = c_int32 if checked else None
+            setattr(self, name[2:], self._checked(name, fn) if checked else fn)
+
+    @staticmethod
+    def _checked(name, fn):
+        def call(*args):
+            result = fn(*args)
+            if result < 0:
+                raise VulkanError("%s failed with VkResult %d" % (name, result))
+            return result
+        return call
+
+
+def array(ctype, items):
+    """A ctypes array of items, or None for an empty list."""
+    items = list(items)
+    if not items:
+        return None
+    return (ctype * len(items))(*items)
+
+
+def handle(fn, *args):
+    """Calls a vkCreate*-style function and returns the handle it wrote."""
+    out = Handle()
+    fn(*(args + (None, byref(out))))
+    return out.value